@@ -0,0 +1,196 @@
+/**
+ * @file FrustumCuller.cpp
+ * @brief SoA frustum teszt: skalár, SSE és AVX2 változat, a határok frissítése szálakra bontva.
+ */
+#include "FrustumCuller.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FRUSTUM_CULLER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define FRUSTUM_TARGET_AVX2
+#else
+#define FRUSTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define FRUSTUM_CULLER_X86 0
+#endif
+
+namespace {
+
+    // A kernelek bemenete: a SoA tömbök és a síkok (a normál abszolút értékével az AABB teszthez)
+    struct CullInput {
+        const float *cx, *cy, *cz, *ex, *ey, *ez, *sx, *sy, *sz, *r;
+        glm::vec4 planes[6];
+        glm::vec3 absNormals[6];
+    };
+
+    // --- KERNELEK ---
+    // Mindhárom változat ugyanazt számolja: a gömb középpontjának és az AABB legközelebbi sarkának
+    // előjeles távolsága síkonként; ha bármelyik negatív, az objektum kívül van.
+
+    void kernelScalar(const CullInput& in, size_t count, std::vector<uint32_t>& visible) {
+        for (size_t i = 0; i < count; i++) {
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; p++) {
+                const glm::vec4& plane = in.planes[p];
+                const glm::vec3& absNormal = in.absNormals[p];
+                float boxDistance = plane.x * in.cx[i] + plane.y * in.cy[i] + plane.z * in.cz[i] + plane.w
+                                  + absNormal.x * in.ex[i] + absNormal.y * in.ey[i] + absNormal.z * in.ez[i];
+                float sphereDistance = plane.x * in.sx[i] + plane.y * in.sy[i] + plane.z * in.sz[i] + plane.w + in.r[i];
+                inside = boxDistance >= 0.0f && sphereDistance >= 0.0f;
+            }
+            if (inside) visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+#if FRUSTUM_CULLER_X86
+    // A sáv maszk bitjeiből a látható indexek (a count-on túli kitöltő sávok nélkül)
+    inline void appendVisible(unsigned mask, size_t base, size_t count, std::vector<uint32_t>& visible) {
+        while (mask != 0) {
+            unsigned lane = 0;
+            while ((mask & (1u << lane)) == 0) lane++;
+            mask &= mask - 1;
+            if (base + lane < count) visible.push_back(static_cast<uint32_t>(base + lane));
+        }
+    }
+
+    // 4 objektum egyszerre; a SoA tömbök LANE_COUNT-ra vannak kerekítve
+    void kernelSSE(const CullInput& in, size_t count, std::vector<uint32_t>& visible) {
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t i = 0; i < count; i += 4) {
+            __m128 cx = _mm_loadu_ps(in.cx + i), cy = _mm_loadu_ps(in.cy + i), cz = _mm_loadu_ps(in.cz + i);
+            __m128 ex = _mm_loadu_ps(in.ex + i), ey = _mm_loadu_ps(in.ey + i), ez = _mm_loadu_ps(in.ez + i);
+            __m128 sx = _mm_loadu_ps(in.sx + i), sy = _mm_loadu_ps(in.sy + i), sz = _mm_loadu_ps(in.sz + i);
+            __m128 r = _mm_loadu_ps(in.r + i);
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (int p = 0; p < 6; p++) {
+                __m128 nx = _mm_set1_ps(in.planes[p].x), ny = _mm_set1_ps(in.planes[p].y);
+                __m128 nz = _mm_set1_ps(in.planes[p].z), nw = _mm_set1_ps(in.planes[p].w);
+                __m128 ax = _mm_set1_ps(in.absNormals[p].x), ay = _mm_set1_ps(in.absNormals[p].y);
+                __m128 az = _mm_set1_ps(in.absNormals[p].z);
+
+                __m128 boxDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                                           _mm_add_ps(_mm_mul_ps(nz, cz), nw)),
+                                                _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, ex), _mm_mul_ps(ay, ey)), _mm_mul_ps(az, ez)));
+                __m128 sphereDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, sx), _mm_mul_ps(ny, sy)),
+                                                              _mm_add_ps(_mm_mul_ps(nz, sz), nw)), r);
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(boxDistance, zero), _mm_cmpge_ps(sphereDistance, zero)));
+            }
+            appendVisible(static_cast<unsigned>(_mm_movemask_ps(inside)), i, count, visible);
+        }
+    }
+
+    // 8 objektum egyszerre; csak akkor hívjuk, ha a CPU támogatja az AVX2-t
+    FRUSTUM_TARGET_AVX2 void kernelAVX2(const CullInput& in, size_t count, std::vector<uint32_t>& visible) {
+        const __m256 zero = _mm256_setzero_ps();
+        for (size_t i = 0; i < count; i += 8) {
+            __m256 cx = _mm256_loadu_ps(in.cx + i), cy = _mm256_loadu_ps(in.cy + i), cz = _mm256_loadu_ps(in.cz + i);
+            __m256 ex = _mm256_loadu_ps(in.ex + i), ey = _mm256_loadu_ps(in.ey + i), ez = _mm256_loadu_ps(in.ez + i);
+            __m256 sx = _mm256_loadu_ps(in.sx + i), sy = _mm256_loadu_ps(in.sy + i), sz = _mm256_loadu_ps(in.sz + i);
+            __m256 r = _mm256_loadu_ps(in.r + i);
+
+            __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+            for (int p = 0; p < 6; p++) {
+                __m256 nx = _mm256_set1_ps(in.planes[p].x), ny = _mm256_set1_ps(in.planes[p].y);
+                __m256 nz = _mm256_set1_ps(in.planes[p].z), nw = _mm256_set1_ps(in.planes[p].w);
+                __m256 ax = _mm256_set1_ps(in.absNormals[p].x), ay = _mm256_set1_ps(in.absNormals[p].y);
+                __m256 az = _mm256_set1_ps(in.absNormals[p].z);
+
+                __m256 boxDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)),
+                                                                 _mm256_add_ps(_mm256_mul_ps(nz, cz), nw)),
+                                                   _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, ex), _mm256_mul_ps(ay, ey)),
+                                                                 _mm256_mul_ps(az, ez)));
+                __m256 sphereDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, sx), _mm256_mul_ps(ny, sy)),
+                                                                    _mm256_add_ps(_mm256_mul_ps(nz, sz), nw)), r);
+                inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(boxDistance, zero, _CMP_GE_OQ),
+                                                             _mm256_cmp_ps(sphereDistance, zero, _CMP_GE_OQ)));
+            }
+            appendVisible(static_cast<unsigned>(_mm256_movemask_ps(inside)), i, count, visible);
+        }
+    }
+#endif
+}
+
+void FrustumCuller::extractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+    // Vulkan mélység: 0 <= z <= w
+    auto row = [&](int r) { return glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]); };
+    planes[0] = row(3) + row(0); // Bal
+    planes[1] = row(3) - row(0); // Jobb
+    planes[2] = row(3) + row(1); // Alsó
+    planes[3] = row(3) - row(1); // Felső
+    planes[4] = row(2);          // Közeli
+    planes[5] = row(3) - row(2); // Távoli
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+void FrustumCuller::resize(size_t count) {
+    objectCount = count;
+    size_t padded = (count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+    for (std::vector<float>* array : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ,
+                                      &sphereX, &sphereY, &sphereZ, &radius}) {
+        array->assign(padded, 0.0f);
+    }
+}
+
+void FrustumCuller::setBounds(size_t index, const glm::vec3& center, const glm::vec3& extent, const glm::vec4& sphere) {
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extent.x;
+    extentY[index] = extent.y;
+    extentZ[index] = extent.z;
+    sphereX[index] = sphere.x;
+    sphereY[index] = sphere.y;
+    sphereZ[index] = sphere.z;
+    radius[index] = sphere.w;
+}
+
+void FrustumCuller::update(const std::vector<MeshObject*>& objects, float animationTime) {
+    if (objects.size() != objectCount) resize(objects.size());
+
+    unsigned threads = objects.size() >= PARALLEL_THRESHOLD ? resolveThreadCount(0) : 1;
+    parallelFor(objects.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const MeshObject* obj = objects[i];
+            glm::vec3 center, extent;
+            obj->getWorldBounds(animationTime, center, extent);
+            glm::vec3 sphereCenter = glm::vec3(obj->getWorldMatrix(animationTime) * glm::vec4(glm::vec3(obj->boundingSphere), 1.0f));
+
+            setBounds(i, center, extent, glm::vec4(sphereCenter, obj->boundingSphere.w));
+        }
+    });
+}
+
+void FrustumCuller::cull(const glm::mat4& viewProjection, size_t count, std::vector<uint32_t>& visible, Isa isa) const {
+    visible.clear();
+    count = std::min(count, objectCount);
+    if (count == 0) return;
+
+    CullInput in{centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data(),
+                 sphereX.data(), sphereY.data(), sphereZ.data(), radius.data(), {}, {}};
+    extractPlanes(viewProjection, in.planes);
+    for (int p = 0; p < 6; p++) {
+        in.absNormals[p] = glm::abs(glm::vec3(in.planes[p]));
+    }
+
+#if FRUSTUM_CULLER_X86
+    if (isa == Isa::AVX2) {
+        kernelAVX2(in, count, visible);
+        return;
+    }
+    if (isa == Isa::SSE) {
+        kernelSSE(in, count, visible);
+        return;
+    }
+#endif
+    kernelScalar(in, count, visible);
+}
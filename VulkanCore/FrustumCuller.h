@@ -0,0 +1,76 @@
+/**
+ * @file FrustumCuller.h
+ * @brief Objektum szintű frustum culling a CPU-n, SIMD (SSE/AVX2) sík teszttel.
+ * A befoglaló térfogatok (AABB és gömb, világtérben) Structure-of-Arrays alakban vannak tárolva,
+ * így egy sík teszt egyszerre 4 (SSE) vagy 8 (AVX2) objektumot dolgoz fel.
+ */
+#pragma once
+
+#include "MeshObject.h"
+#include "TangentKernel.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+class FrustumCuller {
+public:
+    // Az utasításkészlet választás és felismerés a tangens kernellel közös
+    using Isa = TangentKernel::Isa;
+
+    // Ennyi objektum alatt a világbeli határok számítását nem osztjuk szálakra
+    static constexpr size_t PARALLEL_THRESHOLD = 16384;
+
+    /**
+     * @brief Normalizált frustum síkok (Gribb-Hartmann) egy View * Projection mátrixból, a MeshletCuller-rel azonos módon.
+     * Egy pont a síkon belül van, ha dot(xyz, p) + w >= 0.
+     */
+    static void extractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+    /**
+     * @brief Az objektumok világbeli befoglaló térfogatainak frissítése (képkockánként, az animáció miatt).
+     * Az AABB a mesh terű doboz elforgatott befoglalója (a középpont transzformálva, a fél-kiterjedés |R|-rel),
+     * a gömb középpontja transzformálva, a sugara változatlan (a világ mátrix nem skáláz).
+     * @param animationTime Időbélyeg a forgatási animációhoz.
+     */
+    void update(const std::vector<MeshObject*>& objects, float animationTime);
+
+    /**
+     * @brief Az objektumok száma és a SoA tömbök mérete (a SIMD szélességre kerekítve); a határokat setBounds tölti.
+     */
+    void resize(size_t count);
+
+    /**
+     * @brief Egy objektum világbeli befoglaló térfogata (AABB középpont és fél-kiterjedés, gömb sugár a középpont körül).
+     */
+    void setBounds(size_t index, const glm::vec3& center, const glm::vec3& extent, const glm::vec4& sphere);
+
+    /**
+     * @brief Az első count objektum tesztelése a frustum ellen.
+     * Egy objektum kiesik, ha valamelyik sík mögött van a gömbje vagy az AABB-je (a kettő közül a szorosabb dönt).
+     * @param viewProjection A nézőpont (kamera vagy fény) View * Projection mátrixa.
+     * @param count A tesztelt objektumok száma (az első count; pl. csak az árnyékvetők).
+     * @param visible Kimenet: a látható objektumok indexei növekvő sorrendben.
+     * @param isa A használt utasításkészlet (alapértelmezés: a legjobb elérhető).
+     */
+    void cull(const glm::mat4& viewProjection, size_t count, std::vector<uint32_t>& visible, Isa isa) const;
+
+    void cull(const glm::mat4& viewProjection, size_t count, std::vector<uint32_t>& visible) const {
+        cull(viewProjection, count, visible, detectedIsa);
+    }
+
+    size_t size() const { return objectCount; }
+
+private:
+    // A SoA tömbök mérete ennek többszöröse (AVX2: 8 sáv)
+    static const size_t LANE_COUNT = 8;
+
+    size_t objectCount = 0;
+    Isa detectedIsa = TangentKernel::detectIsa();
+
+    // AABB középpont és fél-kiterjedés, gömb középpont és sugár (világtér), objektumonként egy-egy float
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> sphereX, sphereY, sphereZ, radius;
+};
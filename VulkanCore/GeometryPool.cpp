@@ -0,0 +1,380 @@
+/**
+ * @file GeometryPool.cpp
+ * @brief Közös vertex/index puffer: first-fit szabad lista szomszéd-összevonással, növelés és tömörítés GPU másolással.
+ */
+#include "GeometryPool.h"
+
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+namespace {
+    // A staging területek igazítása (float és 16 bites adatok közvetlen írásához bőven elég)
+    const uint32_t STAGING_ALIGNMENT = 16;
+
+    // Felfelé kerekítés tetszőleges (nem csak kettő hatvány) igazításra
+    VkDeviceSize alignUp(VkDeviceSize value, uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+void GeometryPool::create(VulkanContext* ctx, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity) {
+    this->context = ctx;
+    this->initialVertexCapacity = vertexCapacity;
+
+    // Az index puffer másolás forrása is (növelés és tömörítés); a meshlet culling storage-ként olvassa
+    createArena(indexArena, indexCapacity,
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, {1});
+    createStaging(DEFAULT_STAGING_CAPACITY);
+}
+
+void GeometryPool::cleanup() {
+    destroyStaging();
+    for (Arena& arena : vertexArenas) destroyArena(arena);
+    destroyArena(indexArena);
+}
+
+GeometryPool::Arena& GeometryPool::getVertexArena(VertexFormat format) {
+    Arena& arena = vertexArenas[formatIndex(format)];
+    if (arena.streams.empty()) {
+        // Egy vertex egység: pozíció és attribútum folyam, a formátum szerinti méretekkel
+        createArena(arena, initialVertexCapacity,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    {VertexLayout::getPositionStride(format), VertexLayout::getAttributeStride(format)});
+    }
+    return arena;
+}
+
+void GeometryPool::createStaging(VkDeviceSize capacity) {
+    context->createBuffer(capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          stagingBuffer, stagingMemory);
+
+    // Egyszer képezzük le, a pool teljes élettartamára
+    void* mapped;
+    vkMapMemory(context->getDevice(), stagingMemory, 0, capacity, 0, &mapped);
+    stagingMapped = static_cast<uint8_t*>(mapped);
+    stagingCapacity = capacity;
+    stagingUsed = 0;
+}
+
+void GeometryPool::destroyStaging() {
+    if (stagingMemory != VK_NULL_HANDLE) {
+        vkUnmapMemory(context->getDevice(), stagingMemory);
+        vkFreeMemory(context->getDevice(), stagingMemory, nullptr);
+        stagingMemory = VK_NULL_HANDLE;
+    }
+    if (stagingBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(context->getDevice(), stagingBuffer, nullptr);
+        stagingBuffer = VK_NULL_HANDLE;
+    }
+    stagingMapped = nullptr;
+    stagingCapacity = 0;
+    stagingUsed = 0;
+}
+
+VkDeviceSize GeometryPool::reserveStaging(VkDeviceSize size) {
+    VkDeviceSize offset = alignUp(stagingUsed, STAGING_ALIGNMENT);
+    if (offset + size > stagingCapacity) {
+        // A korábbi feltöltések kimennek, utána a puffer elölről használható
+        flushUploads();
+        offset = 0;
+        if (size > stagingCapacity) {
+            destroyStaging();
+            createStaging(alignUp(size, STAGING_ALIGNMENT));
+        }
+    }
+    stagingUsed = offset + size;
+    return offset;
+}
+
+GeometryPool::Upload GeometryPool::reserveUpload(VertexFormat format, uint32_t vertexCount, VkDeviceSize indexBytes, uint32_t indexSize) {
+    Arena& vertexArena = getVertexArena(format);
+
+    // Előbb a staging hely (egyben, hogy a későbbi foglalás ne küldje ki a korábbi még üres területét), utána a blokkok
+    VkDeviceSize positionBytes = VkDeviceSize(vertexCount) * vertexArena.streams[POSITION_STREAM].unitSize;
+    VkDeviceSize attributeBytes = VkDeviceSize(vertexCount) * vertexArena.streams[ATTRIBUTE_STREAM].unitSize;
+    VkDeviceSize attributeStagingOffset = alignUp(positionBytes, STAGING_ALIGNMENT);
+    VkDeviceSize indexStagingOffset = alignUp(attributeStagingOffset + attributeBytes, STAGING_ALIGNMENT);
+    VkDeviceSize stagingOffset = reserveStaging(indexStagingOffset + indexBytes);
+
+    Upload upload;
+    upload.vertexAllocation = allocateBlock(vertexArena, vertexCount, 1);
+    upload.indexAllocation = allocateBlock(indexArena, indexBytes, indexSize);
+    upload.positionData = stagingMapped + stagingOffset;
+    upload.attributeData = stagingMapped + stagingOffset + attributeStagingOffset;
+    upload.indexData = stagingMapped + stagingOffset + indexStagingOffset;
+
+    if (upload.vertexAllocation != INVALID_HANDLE) {
+        pendingCopies.push_back({&vertexArena, POSITION_STREAM, upload.vertexAllocation, stagingOffset});
+        pendingCopies.push_back({&vertexArena, ATTRIBUTE_STREAM, upload.vertexAllocation, stagingOffset + attributeStagingOffset});
+    }
+    if (upload.indexAllocation != INVALID_HANDLE) {
+        pendingCopies.push_back({&indexArena, 0, upload.indexAllocation, stagingOffset + indexStagingOffset});
+    }
+    return upload;
+}
+
+void GeometryPool::flushUploads() {
+    if (!pendingCopies.empty()) {
+        // Pufferenként egy vkCmdCopyBuffer az összes régióval
+        std::map<VkBuffer, std::vector<VkBufferCopy>> regions;
+        for (const PendingCopy& copy : pendingCopies) {
+            // A feltöltés előtt felszabadított területek másolásai a release-ben törlődtek
+            const Block& block = copy.arena->blocks[copy.handle];
+            const Stream& stream = copy.arena->streams[copy.stream];
+            regions[stream.buffer].push_back({copy.stagingOffset, block.offset * stream.unitSize, block.size * stream.unitSize});
+        }
+
+        context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+            for (const auto& bufferRegions : regions) {
+                vkCmdCopyBuffer(commandBuffer, stagingBuffer, bufferRegions.first,
+                                static_cast<uint32_t>(bufferRegions.second.size()), bufferRegions.second.data());
+            }
+        });
+        pendingCopies.clear();
+    }
+    stagingUsed = 0;
+
+    // Egy nagy (pl. importált) mesh miatt megnőtt puffert nem tartjuk meg
+    if (stagingCapacity > DEFAULT_STAGING_CAPACITY) {
+        destroyStaging();
+        createStaging(DEFAULT_STAGING_CAPACITY);
+    }
+}
+
+void GeometryPool::createArena(Arena& arena, VkDeviceSize capacity, VkBufferUsageFlags usage, const std::vector<uint32_t>& unitSizes) {
+    arena.capacity = capacity;
+    arena.usage = usage;
+    arena.streams.assign(unitSizes.size(), Stream{});
+    for (size_t i = 0; i < unitSizes.size(); i++) {
+        Stream& stream = arena.streams[i];
+        stream.unitSize = unitSizes[i];
+        context->createBuffer(capacity * stream.unitSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, stream.buffer, stream.memory);
+    }
+
+    arena.freeBlocks.clear();
+    arena.freeBlocks[0] = capacity;
+    arena.blocks.clear();
+    arena.freeHandles.clear();
+}
+
+void GeometryPool::destroyArena(Arena& arena) {
+    for (Stream& stream : arena.streams) {
+        if (stream.buffer != VK_NULL_HANDLE) vkDestroyBuffer(context->getDevice(), stream.buffer, nullptr);
+        if (stream.memory != VK_NULL_HANDLE) vkFreeMemory(context->getDevice(), stream.memory, nullptr);
+    }
+    arena.streams.clear();
+}
+
+GeometryPool::Handle GeometryPool::allocateVertices(VertexFormat format, const void* positionData, const void* attributeData,
+                                                    uint32_t vertexCount) {
+    const void* streamData[] = {positionData, attributeData};
+    return allocate(getVertexArena(format), streamData, vertexCount, 1);
+}
+
+GeometryPool::Handle GeometryPool::allocateIndices(const void* data, VkDeviceSize size, uint32_t indexSize) {
+    return allocate(indexArena, &data, size, indexSize);
+}
+
+void GeometryPool::freeVertices(VertexFormat format, Handle handle) {
+    release(vertexArenas[formatIndex(format)], handle);
+}
+
+void GeometryPool::freeIndices(Handle handle) {
+    release(indexArena, handle);
+}
+
+int32_t GeometryPool::getVertexOffset(VertexFormat format, Handle handle) const {
+    const Block& block = vertexArenas[formatIndex(format)].blocks[handle];
+    return static_cast<int32_t>(block.offset / block.alignment);
+}
+
+uint32_t GeometryPool::getFirstIndex(Handle handle) const {
+    const Block& block = indexArena.blocks[handle];
+    return static_cast<uint32_t>(block.offset / block.alignment);
+}
+
+bool GeometryPool::takeFreeRange(Arena& arena, VkDeviceSize size, uint32_t alignment, VkDeviceSize& offset) {
+    for (auto it = arena.freeBlocks.begin(); it != arena.freeBlocks.end(); ++it) {
+        VkDeviceSize blockStart = it->first;
+        VkDeviceSize blockEnd = it->first + it->second;
+        VkDeviceSize alignedStart = alignUp(blockStart, alignment);
+        if (alignedStart + size > blockEnd) continue;
+
+        // A blokk kettévágása: az igazítás előtti és a foglalás utáni maradék szabad marad
+        arena.freeBlocks.erase(it);
+        if (alignedStart > blockStart) arena.freeBlocks[blockStart] = alignedStart - blockStart;
+        if (alignedStart + size < blockEnd) arena.freeBlocks[alignedStart + size] = blockEnd - (alignedStart + size);
+
+        offset = alignedStart;
+        return true;
+    }
+    return false;
+}
+
+GeometryPool::Handle GeometryPool::allocateBlock(Arena& arena, VkDeviceSize size, uint32_t alignment) {
+    if (size == 0) return INVALID_HANDLE;
+
+    VkDeviceSize offset = 0;
+    if (!takeFreeRange(arena, size, alignment, offset)) {
+        // Ha összesen van elég hely, csak töredezett: tömörítés; különben növelés (duplázás, amíg el nem fér)
+        Stats stats = getStats(arena);
+        VkDeviceSize required = stats.used + size + alignment;
+        VkDeviceSize newCapacity = arena.capacity;
+        while (newCapacity < required + stats.allocationCount * VkDeviceSize(alignment)) newCapacity *= 2;
+
+        // (Az igazítási hézagok miatt a tömörített puffer ritkán mégis kicsi lehet: ekkor tovább növelünk)
+        do {
+            rebuild(arena, newCapacity);
+            newCapacity *= 2;
+        } while (!takeFreeRange(arena, size, alignment, offset));
+    }
+
+    Handle handle;
+    if (!arena.freeHandles.empty()) {
+        handle = arena.freeHandles.back();
+        arena.freeHandles.pop_back();
+    } else {
+        handle = static_cast<Handle>(arena.blocks.size());
+        arena.blocks.emplace_back();
+    }
+    arena.blocks[handle] = {offset, size, alignment, true};
+    return handle;
+}
+
+GeometryPool::Handle GeometryPool::allocate(Arena& arena, const void* const* streamData, VkDeviceSize size, uint32_t alignment) {
+    if (size == 0) return INVALID_HANDLE;
+
+    // Feltöltés a tartósan leképezett staging pufferen keresztül, azonnali másolással (folyamonként egy terület)
+    std::vector<VkDeviceSize> streamOffsets(arena.streams.size());
+    VkDeviceSize stagingSize = 0;
+    for (size_t i = 0; i < arena.streams.size(); i++) {
+        streamOffsets[i] = alignUp(stagingSize, STAGING_ALIGNMENT);
+        stagingSize = streamOffsets[i] + size * arena.streams[i].unitSize;
+    }
+    VkDeviceSize stagingOffset = reserveStaging(stagingSize);
+
+    Handle handle = allocateBlock(arena, size, alignment);
+    for (uint32_t i = 0; i < arena.streams.size(); i++) {
+        memcpy(stagingMapped + stagingOffset + streamOffsets[i], streamData[i], (size_t)(size * arena.streams[i].unitSize));
+        pendingCopies.push_back({&arena, i, handle, stagingOffset + streamOffsets[i]});
+    }
+    flushUploads();
+    return handle;
+}
+
+void GeometryPool::release(Arena& arena, Handle handle) {
+    if (handle == INVALID_HANDLE || handle >= arena.blocks.size() || !arena.blocks[handle].live) return;
+
+    Block& block = arena.blocks[handle];
+    block.live = false;
+    arena.freeHandles.push_back(handle);
+
+    // A még ki nem ment feltöltései elvesznek: a handle újrafoglalás után már egy másik mesh területe lenne
+    pendingCopies.erase(std::remove_if(pendingCopies.begin(), pendingCopies.end(),
+                                       [&](const PendingCopy& copy) { return copy.arena == &arena && copy.handle == handle; }),
+                        pendingCopies.end());
+
+    // Visszahelyezés a szabad listába, összevonva a közvetlen szomszédokkal
+    VkDeviceSize start = block.offset;
+    VkDeviceSize end = block.offset + block.size;
+
+    auto next = arena.freeBlocks.lower_bound(start);
+    if (next != arena.freeBlocks.end() && next->first == end) {
+        end += next->second;
+        next = arena.freeBlocks.erase(next);
+    }
+    if (next != arena.freeBlocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start) {
+            start = previous->first;
+            arena.freeBlocks.erase(previous);
+        }
+    }
+    arena.freeBlocks[start] = end - start;
+}
+
+void GeometryPool::rebuild(Arena& arena, VkDeviceSize newCapacity) {
+    // A futó frame-ek a régi puffert és eltolásokat használhatják
+    vkDeviceWaitIdle(context->getDevice());
+
+    // Élő foglalások címsorrendben, szorosan egymás után (az igazítás megtartásával)
+    std::vector<Handle> order;
+    for (Handle h = 0; h < arena.blocks.size(); h++) {
+        if (arena.blocks[h].live) order.push_back(h);
+    }
+    std::sort(order.begin(), order.end(), [&](Handle a, Handle b) { return arena.blocks[a].offset < arena.blocks[b].offset; });
+
+    std::vector<VkBufferCopy> regions;
+    VkDeviceSize cursor = 0;
+    for (Handle h : order) {
+        Block& block = arena.blocks[h];
+        VkDeviceSize newOffset = alignUp(cursor, block.alignment);
+        regions.push_back({block.offset, newOffset, block.size});
+        block.offset = newOffset;
+        cursor = newOffset + block.size;
+    }
+
+    // Folyamonként új puffer; külön forrás és cél, így a régiók nem fedhetik át egymást
+    std::vector<Stream> newStreams = arena.streams;
+    for (Stream& stream : newStreams) {
+        context->createBuffer(newCapacity * stream.unitSize, arena.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, stream.buffer, stream.memory);
+    }
+    if (!regions.empty()) {
+        context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+            for (size_t i = 0; i < arena.streams.size(); i++) {
+                uint32_t unitSize = arena.streams[i].unitSize;
+                std::vector<VkBufferCopy> streamRegions(regions);
+                for (VkBufferCopy& region : streamRegions) {
+                    region.srcOffset *= unitSize;
+                    region.dstOffset *= unitSize;
+                    region.size *= unitSize;
+                }
+                vkCmdCopyBuffer(commandBuffer, arena.streams[i].buffer, newStreams[i].buffer,
+                                static_cast<uint32_t>(streamRegions.size()), streamRegions.data());
+            }
+        });
+    }
+
+    destroyArena(arena);
+    arena.streams = newStreams;
+    arena.capacity = newCapacity;
+
+    arena.freeBlocks.clear();
+    if (cursor < newCapacity) arena.freeBlocks[cursor] = newCapacity - cursor;
+}
+
+GeometryPool::Stats GeometryPool::getStats(const Arena& arena) const {
+    // Egységekből byte: az összes folyam egy egységre jutó mérete
+    VkDeviceSize unitBytes = 0;
+    for (const Stream& stream : arena.streams) unitBytes += stream.unitSize;
+
+    Stats stats;
+    stats.capacity = arena.capacity * unitBytes;
+    for (const Block& block : arena.blocks) {
+        if (!block.live) continue;
+        stats.used += block.size * unitBytes;
+        stats.allocationCount++;
+    }
+    for (const auto& freeBlock : arena.freeBlocks) {
+        stats.largestFree = std::max(stats.largestFree, freeBlock.second * unitBytes);
+    }
+    stats.freeBlockCount = static_cast<uint32_t>(arena.freeBlocks.size());
+    return stats;
+}
+
+void GeometryPool::printStats() const {
+    auto print = [](const char* name, const Stats& stats) {
+        std::cout << "  " << name << ": " << stats.allocationCount << " allocations, "
+                  << stats.used / 1024 << " / " << stats.capacity / 1024 << " KB used, "
+                  << stats.freeBlockCount << " free blocks (largest " << stats.largestFree / 1024 << " KB)" << std::endl;
+    };
+    std::cout << "Geometry pool:" << std::endl;
+    if (!vertexArenas[formatIndex(VertexFormat::Full)].streams.empty()) print("vertex (full)", getVertexStats(VertexFormat::Full));
+    if (!vertexArenas[formatIndex(VertexFormat::Compact)].streams.empty()) print("vertex (compact)", getVertexStats(VertexFormat::Compact));
+    print("index", getIndexStats());
+}
@@ -0,0 +1,203 @@
+/**
+ * @file GeometryPool.h
+ * @brief Közös (mega) vertex és index puffer az összes mesh számára, szabadlistás rész-foglalással.
+ * A mesh-ek nem kapnak saját VkBuffer-t és VkDeviceMemory-t: a rajzolás egyszer köti be a puffereket,
+ * és a vertexOffset / firstIndex paraméterekkel címzi az egyes mesh-eket.
+ *
+ * A vertexek vertex formátumonként külön területen vannak, két párhuzamos pufferben (pozíció és attribútum folyam,
+ * lásd VertexFormat.h). A két folyam foglalásai vertex egységben, közös szabad listával történnek, ezért egy mesh
+ * vertexOffset-je mindkét pufferben ugyanaz, és a csak mélységet író pass-ok a pozíció puffert egyedül is köthetik.
+ */
+#pragma once
+
+#include "VulkanContext.h"
+#include "VertexFormat.h"
+
+#include <vector>
+#include <array>
+#include <map>
+#include <cstdint>
+
+class GeometryPool {
+public:
+    // Egy foglalás azonosítója; töredezettség-mentesítés után is érvényes marad (csak az eltolás változik)
+    using Handle = uint32_t;
+    static const Handle INVALID_HANDLE = 0xFFFFFFFFu;
+
+    // Kezdeti méretek (vertex formátumonként vertexben, indexeknél byte-ban); ha elfogy a hely,
+    // a puffer duplázódik (a meglévő adatok átmásolódnak)
+    static const VkDeviceSize DEFAULT_VERTEX_CAPACITY = 512ull * 1024;
+    static const VkDeviceSize DEFAULT_INDEX_CAPACITY = 8ull * 1024 * 1024;
+
+    // Tartósan leképezett staging puffer; nagyobb feltöltéshez ideiglenesen megnő, majd flushUploads után visszaáll
+    static const VkDeviceSize DEFAULT_STAGING_CAPACITY = 4ull * 1024 * 1024;
+
+    /**
+     * @brief Egy lefoglalt, még fel nem töltött mesh terület (lásd reserveUpload).
+     * A positionData / attributeData / indexData a leképezett staging memóriába mutat: a hívó ide írja
+     * a végleges adatokat, a következő reserveUpload vagy flushUploads hívás előtt.
+     */
+    struct Upload {
+        Handle vertexAllocation = INVALID_HANDLE;
+        Handle indexAllocation = INVALID_HANDLE;
+        void* positionData = nullptr;   // vertexCount * VertexLayout::getPositionStride(format) byte
+        void* attributeData = nullptr;  // vertexCount * VertexLayout::getAttributeStride(format) byte
+        void* indexData = nullptr;
+    };
+
+    // Egy terület (egy formátum vertexei a két folyammal együtt, vagy az indexek) kihasználtsága byte-ban
+    struct Stats {
+        VkDeviceSize capacity = 0;
+        VkDeviceSize used = 0;          // Élő foglalások összmérete
+        VkDeviceSize largestFree = 0;   // A legnagyobb összefüggő szabad blokk
+        uint32_t allocationCount = 0;
+        uint32_t freeBlockCount = 0;    // Szabad blokkok száma (1 = nincs töredezettség)
+    };
+
+    /**
+     * @brief Az index puffer és a tartósan leképezett staging puffer létrehozása.
+     * A vertex pufferek formátumonként az első foglaláskor jönnek létre (vertexCapacity vertexszel).
+     */
+    void create(VulkanContext* ctx, VkDeviceSize vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+                VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY);
+
+    void cleanup();
+
+    /**
+     * @brief Vertex és index terület foglalása másolás nélküli feltöltéshez.
+     * A hívó közvetlenül a visszaadott staging memóriába generálja a végleges adatokat (köztes vektor nélkül);
+     * a GPU másolás a flushUploads hívásakor történik, az összes függő feltöltésre egyetlen parancspufferrel.
+     * Ha a staging puffer megtelt, előbb a korábbi feltöltések mennek ki.
+     * @param format A vertexek formátuma (ez választja ki a vertex pufferpárt).
+     * @param vertexCount A vertexek száma.
+     * @param indexBytes Az index adatok mérete byte-ban.
+     * @param indexSize 2 (VK_INDEX_TYPE_UINT16) vagy 4 (VK_INDEX_TYPE_UINT32).
+     */
+    Upload reserveUpload(VertexFormat format, uint32_t vertexCount, VkDeviceSize indexBytes, uint32_t indexSize);
+
+    /**
+     * @brief A függő feltöltések másolása a közös pufferekbe (egy submit, megvárja a végét).
+     * A reserveUpload-dal létrehozott mesh-ek rajzolása előtt hívandó.
+     */
+    void flushUploads();
+
+    /**
+     * @brief Vertex adatok foglalása és feltöltése (a staging pufferen keresztül, azonnali másolással).
+     * @param positionData A pozíció folyam (vertexCount * VertexLayout::getPositionStride(format) byte).
+     * @param attributeData Az attribútum folyam (vertexCount * VertexLayout::getAttributeStride(format) byte).
+     */
+    Handle allocateVertices(VertexFormat format, const void* positionData, const void* attributeData, uint32_t vertexCount);
+
+    /**
+     * @brief Index adatok foglalása és feltöltése. Az eltolás az index méret többszöröse (firstIndex egész).
+     * @param indexSize 2 (VK_INDEX_TYPE_UINT16) vagy 4 (VK_INDEX_TYPE_UINT32).
+     */
+    Handle allocateIndices(const void* data, VkDeviceSize size, uint32_t indexSize);
+
+    void freeVertices(VertexFormat format, Handle handle);
+    void freeIndices(Handle handle);
+
+    // A foglalás helye a rajzolási parancsokhoz (vertexOffset vertexben, firstIndex indexben)
+    int32_t getVertexOffset(VertexFormat format, Handle handle) const;
+    uint32_t getFirstIndex(Handle handle) const;
+
+    // A közös pufferek (VK_NULL_HANDLE, ha az adott formátumú vertex még nem volt);
+    // növelés és tömörítés után (ha egy foglalás a töredezettség miatt nem fér el) a handle megváltozik
+    VkBuffer getPositionBuffer(VertexFormat format) const { return getBuffer(vertexArenas[formatIndex(format)], POSITION_STREAM); }
+    VkBuffer getAttributeBuffer(VertexFormat format) const { return getBuffer(vertexArenas[formatIndex(format)], ATTRIBUTE_STREAM); }
+    VkBuffer getIndexBuffer() const { return getBuffer(indexArena, 0); }
+
+    Stats getVertexStats(VertexFormat format) const { return getStats(vertexArenas[formatIndex(format)]); }
+    Stats getIndexStats() const { return getStats(indexArena); }
+    void printStats() const;
+
+private:
+    // Egy foglalás a pufferben
+    struct Block {
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        uint32_t alignment = 1;
+        bool live = false;
+    };
+
+    // Egy terület pufferei: a foglalások egységekben (vertex, illetve byte) értendők, folyamonként unitSize byte/egység
+    struct Stream {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint32_t unitSize = 1;
+    };
+
+    // A vertex területek két folyama
+    static const uint32_t POSITION_STREAM = 0;
+    static const uint32_t ATTRIBUTE_STREAM = 1;
+
+    // Egy vagy több párhuzamos puffer közös foglalásokkal és szabad listával
+    struct Arena {
+        std::vector<Stream> streams;
+        VkDeviceSize capacity = 0;                       // Egységben
+        VkBufferUsageFlags usage = 0;
+        std::map<VkDeviceSize, VkDeviceSize> freeBlocks; // Eltolás -> méret, címsorrendben (szomszédok összevonásához)
+        std::vector<Block> blocks;                       // Handle -> foglalás
+        std::vector<Handle> freeHandles;                 // Újrahasznosítható handle-ök
+    };
+
+    // Függő másolás: a cél eltolását a flush pillanatában olvassuk ki (közben a puffer nőhetett / tömörödhetett)
+    struct PendingCopy {
+        Arena* arena;
+        uint32_t stream;
+        Handle handle;
+        VkDeviceSize stagingOffset;
+    };
+
+    VulkanContext* context = nullptr;
+    VkDeviceSize initialVertexCapacity = DEFAULT_VERTEX_CAPACITY;
+    std::array<Arena, 2> vertexArenas;  // VertexFormat szerint (Full, Compact)
+    Arena indexArena;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    uint8_t* stagingMapped = nullptr;   // Tartós leképezés (HOST_COHERENT, nincs szükség flush-ra)
+    VkDeviceSize stagingCapacity = 0;
+    VkDeviceSize stagingUsed = 0;
+    std::vector<PendingCopy> pendingCopies;
+
+    static size_t formatIndex(VertexFormat format) { return static_cast<size_t>(format); }
+    static VkBuffer getBuffer(const Arena& arena, uint32_t stream) {
+        return stream < arena.streams.size() ? arena.streams[stream].buffer : VK_NULL_HANDLE;
+    }
+
+    void createArena(Arena& arena, VkDeviceSize capacity, VkBufferUsageFlags usage, const std::vector<uint32_t>& unitSizes);
+    void destroyArena(Arena& arena);
+
+    // A formátum vertex területe; az első használatkor jön létre
+    Arena& getVertexArena(VertexFormat format);
+
+    void createStaging(VkDeviceSize capacity);
+    void destroyStaging();
+
+    /**
+     * @brief Hely a staging pufferben (16 byte-ra igazítva); ha nincs elég, flush után elölről, szükség esetén nagyobb pufferrel.
+     * @return Eltolás a staging pufferben.
+     */
+    VkDeviceSize reserveStaging(VkDeviceSize size);
+
+    // Terület foglalása (feltöltés nélkül), size és alignment egységben; szükség esetén tömörít vagy növel
+    Handle allocateBlock(Arena& arena, VkDeviceSize size, uint32_t alignment);
+
+    // Foglalás és azonnali feltöltés; streamData folyamonként size * unitSize byte
+    Handle allocate(Arena& arena, const void* const* streamData, VkDeviceSize size, uint32_t alignment);
+    void release(Arena& arena, Handle handle);
+
+    /**
+     * @brief Első illeszkedő (first-fit) szabad blokk keresése és kivágása a szabad listából.
+     * @return Hamis, ha nincs elég nagy összefüggő szabad blokk.
+     */
+    bool takeFreeRange(Arena& arena, VkDeviceSize size, uint32_t alignment, VkDeviceSize& offset);
+
+    /**
+     * @brief Az élő foglalások átmásolása új, newCapacity egység méretű pufferekbe tömörítve (növelés / töredezettség-mentesítés).
+     */
+    void rebuild(Arena& arena, VkDeviceSize newCapacity);
+
+    Stats getStats(const Arena& arena) const;
+};
@@ -0,0 +1,465 @@
+/**
+ * @file GpuCuller.cpp
+ * @brief GPU-vezérelt rajzolás: objektum pufferek feltöltése, a culling compute pass és az indirekt rajzolások.
+ */
+#include "GpuCuller.h"
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * @brief Bináris shader fájlok (SPIR-V) beolvasása a lemezről.
+ */
+static std::vector<char> readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
+
+namespace {
+    // Munkacsoport méret (object_cull.comp local_size_x)
+    const uint32_t WORKGROUP_SIZE = 64;
+
+    // Bindingok: objektumok, LOD tábla, paraméterek, parancsok, számlálók, példány mátrixok
+    const uint32_t BINDING_COUNT = 6;
+}
+
+void GpuCuller::create(VulkanContext* ctx, uint32_t frameCount, GeometryPool* pool, VkDescriptorSetLayout instanceLayout) {
+    this->context = ctx;
+    this->framesInFlight = frameCount;
+    this->geometryPool = pool;
+    this->instanceSetLayout = instanceLayout;
+    VkDevice device = context->getDevice();
+
+    // Több parancs egy hívásban és a parancsonkénti firstInstance (a model mátrix helye) nélkül a mód nem használható
+    const VkPhysicalDeviceFeatures& features = context->getEnabledFeatures();
+    supported = features.multiDrawIndirect && features.drawIndirectFirstInstance;
+    drawIndexedIndirectCount = context->getCmdDrawIndexedIndirectCount();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context->getPhysicalDevice(), &properties);
+    maxDrawIndirectCount = std::max(1u, properties.limits.maxDrawIndirectCount);
+
+    // --- Descriptor Set Layout ---
+    std::array<VkDescriptorSetLayoutBinding, BINDING_COUNT> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = (i == 2) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create object cull descriptor set layout!");
+    }
+
+    // --- Descriptor Pool: frame-enként egy culling és egy példány set ---
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = framesInFlight * BINDING_COUNT;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[1].descriptorCount = framesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = framesInFlight * 2;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create object cull descriptor pool!");
+    }
+
+    // --- Frame-enkénti paraméter pufferek (tartósan leképezve) és descriptor set-ek ---
+    frames.resize(framesInFlight);
+    for (FrameResources& frame : frames) {
+        context->createBuffer(sizeof(GpuParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              frame.paramsBuffer, frame.paramsMemory);
+        void* mapped = nullptr;
+        vkMapMemory(device, frame.paramsMemory, 0, sizeof(GpuParams), 0, &mapped);
+        frame.mappedParams = static_cast<GpuParams*>(mapped);
+
+        std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, instanceSetLayout};
+        std::array<VkDescriptorSet, 2> sets{};
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(sets.size());
+        allocInfo.pSetLayouts = setLayouts.data();
+
+        if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate object cull descriptor sets!");
+        }
+        frame.cullDescriptorSet = sets[0];
+        frame.instanceDescriptorSet = sets[1];
+    }
+
+    // --- Pipeline Layout és Compute Pipeline ---
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create object cull pipeline layout!");
+    }
+
+    auto shaderCode = readFile("shaders/object_cull_comp.spv");
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = shaderCode.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create object cull shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create object cull pipeline!");
+    }
+
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+
+    if (!supported) {
+        std::cout << "GPU-driven rendering unavailable (multiDrawIndirect / drawIndirectFirstInstance not supported)" << std::endl;
+    } else if (drawIndexedIndirectCount == nullptr) {
+        std::cout << "VK_KHR_draw_indirect_count not supported, GPU-driven mode submits every command of a bucket" << std::endl;
+    }
+}
+
+void GpuCuller::cleanup() {
+    VkDevice device = context->getDevice();
+
+    destroySceneResources();
+    for (FrameResources& frame : frames) {
+        vkUnmapMemory(device, frame.paramsMemory);
+        vkDestroyBuffer(device, frame.paramsBuffer, nullptr);
+        vkFreeMemory(device, frame.paramsMemory, nullptr);
+    }
+    frames.clear();
+
+    // A descriptor set-ek a pool-lal együtt szabadulnak fel
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+}
+
+void GpuCuller::uploadBuffer(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    context->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          stagingBuffer, stagingMemory);
+
+    void* mapped = nullptr;
+    vkMapMemory(context->getDevice(), stagingMemory, 0, size, 0, &mapped);
+    std::memcpy(mapped, data, static_cast<size_t>(size));
+    vkUnmapMemory(context->getDevice(), stagingMemory);
+
+    context->createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+    context->copyBuffer(stagingBuffer, buffer, size);
+
+    vkDestroyBuffer(context->getDevice(), stagingBuffer, nullptr);
+    vkFreeMemory(context->getDevice(), stagingMemory, nullptr);
+}
+
+void GpuCuller::updateScene(const std::vector<MeshObject*>& objects, size_t shadowCasterCount) {
+    // Változatlan jelenet: ugyanaz a tömb és a geometria pufferek sem épültek újra (O(1) ellenőrzés)
+    if (objects.data() == sceneObjects && objects.size() == objectCount && shadowCasterCount == casterCount &&
+        geometryPool->getIndexBuffer() == sourceIndexBuffer &&
+        geometryPool->getPositionBuffer(VertexFormat::Full) == sourcePositionBuffers[0] &&
+        geometryPool->getPositionBuffer(VertexFormat::Compact) == sourcePositionBuffers[1]) {
+        return;
+    }
+
+    // A futó frame-ek még a régi pufferekből rajzolnak
+    vkDeviceWaitIdle(context->getDevice());
+    destroySceneResources();
+    sceneVersion++;
+
+    sceneObjects = objects.data();
+    objectCount = objects.size();
+    casterCount = shadowCasterCount;
+    sourceIndexBuffer = geometryPool->getIndexBuffer();
+    sourcePositionBuffers[0] = geometryPool->getPositionBuffer(VertexFormat::Full);
+    sourcePositionBuffers[1] = geometryPool->getPositionBuffer(VertexFormat::Compact);
+    if (objectCount == 0) return;
+
+    // --- Rajzolási csoportok: (formátum, index típus, textúra); a parancs tartományok a csoportok sorrendjében ---
+    using BucketKey = std::tuple<int, int, VkDescriptorSet>;
+    std::map<BucketKey, uint32_t> bucketIndices;
+    std::vector<uint32_t> objectBuckets(objectCount);
+    buckets.clear();
+    for (size_t i = 0; i < objectCount; i++) {
+        const MeshObject* obj = objects[i];
+        BucketKey key(static_cast<int>(obj->vertexFormat), static_cast<int>(obj->indexType), obj->getTexture());
+        auto found = bucketIndices.find(key);
+        if (found == bucketIndices.end()) {
+            found = bucketIndices.emplace(key, static_cast<uint32_t>(buckets.size())).first;
+            buckets.push_back({obj->vertexFormat, obj->indexType, obj->getTexture(), 0, 0});
+        }
+        objectBuckets[i] = found->second;
+    }
+    uint32_t firstCommand = 0;
+    for (size_t i = 0; i < objectCount; i++) buckets[objectBuckets[i]].capacity++;
+    for (Bucket& bucket : buckets) {
+        bucket.firstCommand = firstCommand;
+        firstCommand += bucket.capacity;
+        bucket.capacity = 0; // A rangok kiosztása közben újraszámolva
+    }
+
+    // --- Objektum leírók és LOD tábla ---
+    std::vector<GpuObject> gpuObjects(objectCount);
+    std::vector<GpuLod> gpuLods;
+    for (size_t i = 0; i < objectCount; i++) {
+        const MeshObject* obj = objects[i];
+        Bucket& bucket = buckets[objectBuckets[i]];
+
+        GpuObject& gpuObject = gpuObjects[i];
+        writeTransform(obj, gpuObject);
+        gpuObject.boundsCenter = glm::vec4((obj->boundsMin + obj->boundsMax) * 0.5f, obj->boundingSphere.w);
+        gpuObject.boundsExtent = glm::vec4((obj->boundsMax - obj->boundsMin) * 0.5f, 0.0f);
+        gpuObject.sphereCenter = glm::vec4(glm::vec3(obj->boundingSphere), 1.0f);
+        gpuObject.firstLod = static_cast<uint32_t>(gpuLods.size());
+        gpuObject.lodCount = static_cast<uint32_t>(obj->lods.size());
+        gpuObject.vertexOffset = obj->getVertexOffset();
+        gpuObject.bucket = objectBuckets[i];
+        gpuObject.bucketFirst = bucket.firstCommand;
+        gpuObject.bucketRank = bucket.capacity++;
+        gpuObject.shadowCaster = i < casterCount ? 1 : 0;
+        gpuObject.padding = 0;
+
+        for (const MeshObject::LodLevel& level : obj->lods) {
+            gpuLods.push_back({obj->getFirstIndex() + level.firstIndex, level.indexCount, level.error, 0});
+        }
+    }
+
+    uploadBuffer(gpuObjects.data(), sizeof(GpuObject) * gpuObjects.size(), objectBuffer, objectMemory);
+    uploadBuffer(gpuLods.data(), sizeof(GpuLod) * gpuLods.size(), lodBuffer, lodMemory);
+    createSceneResources();
+
+    std::cout << "GPU-driven scene: " << objectCount << " objects in " << buckets.size() << " draw buckets" << std::endl;
+}
+
+void GpuCuller::writeTransform(const MeshObject* obj, GpuObject& gpuObject) {
+    gpuObject.positionSpeed = glm::vec4(obj->position, obj->rotationSpeed);
+    gpuObject.rotationAxis = glm::vec4(obj->rotationAxis, 0.0f);
+    gpuObject.dequantization = obj->getModelMatrix(0.0f) * glm::inverse(obj->getWorldMatrix(0.0f));
+}
+
+void GpuCuller::updateObject(uint32_t objectIndex) {
+    if (sceneObjects == nullptr || objectIndex >= objectCount) return;
+
+    GpuObject gpuObject{};
+    writeTransform(sceneObjects[objectIndex], gpuObject);
+
+    // A futó frame-ek culling pass-a még olvassa a leírót
+    vkDeviceWaitIdle(context->getDevice());
+    VkDeviceSize offset = sizeof(GpuObject) * objectIndex;
+    VkDeviceSize size = offsetof(GpuObject, boundsCenter);
+    context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        vkCmdUpdateBuffer(commandBuffer, objectBuffer, offset, size, &gpuObject);
+    });
+}
+
+void GpuCuller::createSceneResources() {
+    VkDevice device = context->getDevice();
+    VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand) * PassCount * objectCount;
+    VkDeviceSize instanceSize = sizeof(glm::mat4) * PassCount * objectCount;
+    VkDeviceSize countSize = sizeof(uint32_t) * PassCount * (buckets.size() + 2);
+
+    for (FrameResources& frame : frames) {
+        // A compute shader írja, az indirekt rajzolás és a vertex shader olvassa
+        context->createBuffer(commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.commandBuffer, frame.commandMemory);
+        context->createBuffer(instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.instanceBuffer, frame.instanceMemory);
+        context->createBuffer(countSize,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                              VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.countBuffer, frame.countMemory);
+        context->createBuffer(countSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              frame.readbackBuffer, frame.readbackMemory);
+        void* mapped = nullptr;
+        vkMapMemory(device, frame.readbackMemory, 0, countSize, 0, &mapped);
+        frame.mappedReadback = static_cast<uint32_t*>(mapped);
+        frame.readbackWritten = false;
+
+        std::array<VkDescriptorBufferInfo, BINDING_COUNT> bufferInfos{};
+        bufferInfos[0] = {objectBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {lodBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {frame.paramsBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[3] = {frame.commandBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[4] = {frame.countBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[5] = {frame.instanceBuffer, 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, BINDING_COUNT + 1> writes{};
+        for (uint32_t b = 0; b < BINDING_COUNT; b++) {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = frame.cullDescriptorSet;
+            writes[b].dstBinding = b;
+            writes[b].descriptorType = (b == 2) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].descriptorCount = 1;
+            writes[b].pBufferInfo = &bufferInfos[b];
+        }
+
+        // A vertex shaderek példány puffere (fő pass: Set 2, árnyék pass: Set 0)
+        writes[BINDING_COUNT].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[BINDING_COUNT].dstSet = frame.instanceDescriptorSet;
+        writes[BINDING_COUNT].dstBinding = 0;
+        writes[BINDING_COUNT].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[BINDING_COUNT].descriptorCount = 1;
+        writes[BINDING_COUNT].pBufferInfo = &bufferInfos[5];
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+void GpuCuller::destroySceneResources() {
+    VkDevice device = context->getDevice();
+    for (FrameResources& frame : frames) {
+        if (frame.commandBuffer == VK_NULL_HANDLE) continue;
+        vkDestroyBuffer(device, frame.commandBuffer, nullptr);
+        vkFreeMemory(device, frame.commandMemory, nullptr);
+        vkDestroyBuffer(device, frame.instanceBuffer, nullptr);
+        vkFreeMemory(device, frame.instanceMemory, nullptr);
+        vkDestroyBuffer(device, frame.countBuffer, nullptr);
+        vkFreeMemory(device, frame.countMemory, nullptr);
+        vkUnmapMemory(device, frame.readbackMemory);
+        vkDestroyBuffer(device, frame.readbackBuffer, nullptr);
+        vkFreeMemory(device, frame.readbackMemory, nullptr);
+        frame.commandBuffer = VK_NULL_HANDLE;
+        frame.mappedReadback = nullptr;
+        frame.readbackWritten = false;
+    }
+    if (objectBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, objectBuffer, nullptr);
+        vkFreeMemory(device, objectMemory, nullptr);
+        vkDestroyBuffer(device, lodBuffer, nullptr);
+        vkFreeMemory(device, lodMemory, nullptr);
+        objectBuffer = VK_NULL_HANDLE;
+        lodBuffer = VK_NULL_HANDLE;
+    }
+    buckets.clear();
+}
+
+void GpuCuller::readStats(uint32_t frameIndex) {
+    const FrameResources& frame = frames[frameIndex];
+    if (!frame.readbackWritten) return;
+
+    // Pass-onként (látható objektum, háromszög) pár; a nem aktív kaszkádoké 0
+    const uint32_t* statistics = frame.mappedReadback + PassCount * buckets.size();
+    stats.mainVisibleObjects = statistics[0];
+    stats.mainTriangles = statistics[1];
+    stats.shadowVisibleObjects = 0;
+    stats.shadowTriangles = 0;
+    for (uint32_t pass = ShadowPass; pass < PassCount; pass++) {
+        stats.shadowVisibleObjects += statistics[pass * 2];
+        stats.shadowTriangles += statistics[pass * 2 + 1];
+    }
+}
+
+void GpuCuller::recordCulling(VkCommandBuffer commandBuffer, uint32_t frameIndex, const FrameParams& params) {
+    FrameResources& frame = frames[frameIndex];
+    if (objectCount == 0) return;
+
+    // --- 1. Paraméterek (a frame slot előző használata a fence miatt már befejeződött) ---
+    GpuParams& gpuParams = *frame.mappedParams;
+    uint32_t cascadeCount = std::min(std::max(params.cascadeCount, 1u), ShadowCascades::MAX_CASCADES);
+    FrustumCuller::extractPlanes(params.viewProjection, gpuParams.planes[MainPass]);
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        FrustumCuller::extractPlanes(params.shadowMatrices[c], gpuParams.planes[ShadowPass + c]);
+    }
+    for (uint32_t pass = 0; pass < 1 + cascadeCount; pass++) {
+        const LodSelection& selection = pass == MainPass ? params.mainSelection : params.shadowSelections[pass - ShadowPass];
+        gpuParams.viewer[pass] = glm::vec4(selection.viewerPosition, selection.orthographic ? 0.0f : 1.0f);
+        gpuParams.lod[pass] = glm::vec4(selection.projectionScale, selection.maxPixelError, params.lodEnabled ? 1.0f : 0.0f, 0.0f);
+    }
+    gpuParams.animationTime = params.animationTime;
+    gpuParams.objectCount = static_cast<uint32_t>(objectCount);
+    gpuParams.bucketCount = static_cast<uint32_t>(buckets.size());
+    gpuParams.compactCommands = drawIndexedIndirectCount != nullptr ? 1 : 0;
+    gpuParams.passCount = 1 + cascadeCount;
+
+    // --- 2. Számlálók nullázása ---
+    vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier resetBarrier{};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+    // --- 3. Culling: szálanként egy objektum, az összes aktív pass ---
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.cullDescriptorSet, 0, nullptr);
+    vkCmdDispatch(commandBuffer, static_cast<uint32_t>((objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+
+    // --- 4. A rajzolás a parancsokat, a számlálókat és a példány mátrixokat olvassa; a statisztika visszamásolása ---
+    VkMemoryBarrier drawBarrier{};
+    drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.size = sizeof(uint32_t) * PassCount * (buckets.size() + 2);
+    vkCmdCopyBuffer(commandBuffer, frame.countBuffer, frame.readbackBuffer, 1, &copyRegion);
+    frame.readbackWritten = true;
+}
+
+void GpuCuller::drawBucket(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t pass, uint32_t bucketIndex) const {
+    const FrameResources& frame = frames[frameIndex];
+    const Bucket& bucket = buckets[bucketIndex];
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize offset = VkDeviceSize(pass * objectCount + bucket.firstCommand) * stride;
+
+    if (drawIndexedIndirectCount != nullptr) {
+        VkDeviceSize countOffset = sizeof(uint32_t) * (pass * buckets.size() + bucketIndex);
+        drawIndexedIndirectCount(commandBuffer, frame.commandBuffer, offset, frame.countBuffer, countOffset, bucket.capacity, stride);
+        return;
+    }
+
+    // Draw count nélkül a csoport összes parancsa (a nem láthatóké 0 példány), az eszköz korlátja szerinti darabokban
+    for (uint32_t first = 0; first < bucket.capacity; first += maxDrawIndirectCount) {
+        uint32_t drawCount = std::min(maxDrawIndirectCount, bucket.capacity - first);
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.commandBuffer, offset + VkDeviceSize(first) * stride, drawCount, stride);
+    }
+}
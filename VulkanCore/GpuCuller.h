@@ -0,0 +1,214 @@
+/**
+ * @file GpuCuller.h
+ * @brief GPU-vezérelt rajzolás: a teljes objektum lista (transzformációs paraméterek, befoglaló térfogatok,
+ * mesh területek és LOD szintek, anyag csoport) storage bufferekben van, egy compute shader objektumonként
+ * elvégzi az animációt, a frustum cullingot és a LOD választást a fő pass-ra és minden árnyék kaszkádra,
+ * és VkDrawIndexedIndirectCommand-okat ír.
+ * A rajzolás csoportonként (vertex formátum, index típus, textúra) egy indirekt hívás, így a CPU munkája
+ * képkockánként nem függ az objektumok számától.
+ */
+#pragma once
+
+#include "VulkanContext.h"
+#include "MeshObject.h"
+#include "GeometryPool.h"
+#include "ShadowCascades.h"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class GpuCuller {
+public:
+    // A kimenetet használó pass-ok (a MeshletCuller sorrendjével azonos); az árnyék kaszkádok ShadowPass-tól sorban
+    enum Pass {
+        MainPass = 0,
+        ShadowPass = 1,
+        PassCount = 1 + ShadowCascades::MAX_CASCADES
+    };
+
+    // Egy rajzolási csoport: azonos pipeline, index puffer kötés és textúra, a parancsai összefüggő tartományt alkotnak
+    struct Bucket {
+        VertexFormat vertexFormat;
+        VkIndexType indexType;
+        VkDescriptorSet texture;
+        uint32_t firstCommand;  // A pass parancs tartományán belül
+        uint32_t capacity;      // A csoport objektumainak száma (a lehetséges rajzolások maximuma)
+    };
+
+    // Képkockánként a CPU által adott paraméterek (O(1) méretű, az objektumok számától független)
+    struct FrameParams {
+        glm::mat4 viewProjection;       // Kamera
+        glm::mat4 shadowMatrices[ShadowCascades::MAX_CASCADES]; // Kaszkádonként a fény mátrixa (ortografikus)
+        LodSelection mainSelection;
+        LodSelection shadowSelections[ShadowCascades::MAX_CASCADES];
+        uint32_t cascadeCount = 1;
+        bool lodEnabled = true;
+        float animationTime = 0.0f;
+    };
+
+    // Az utolsó kiolvasott (a fence alapján befejezett) képkocka eredménye; az árnyék számok a kaszkádok összegei
+    struct Stats {
+        uint32_t mainVisibleObjects = 0;
+        uint32_t shadowVisibleObjects = 0;
+        uint32_t mainTriangles = 0;
+        uint32_t shadowTriangles = 0;
+    };
+
+    /**
+     * @brief A compute pipeline, a descriptor layout-ok és a frame-enkénti paraméter pufferek létrehozása.
+     * @param instanceSetLayout A vertex shaderek példány puffer elrendezése (a renderer Set 2 / Set 0 layout-ja).
+     */
+    void create(VulkanContext* ctx, uint32_t framesInFlight, GeometryPool* geometryPool, VkDescriptorSetLayout instanceSetLayout);
+
+    void cleanup();
+
+    /**
+     * @brief Támogatja-e az eszköz a módot (multiDrawIndirect és drawIndirectFirstInstance szükséges).
+     */
+    bool isSupported() const { return supported; }
+
+    /**
+     * @brief Az objektum lista feltöltése, ha megváltozott (más tömb, más elemszám, vagy a geometria puffer újraépült).
+     * A változatlan jelenetnél O(1); feltöltéskor megvárja a GPU-t (a futó frame-ek a régi puffereket használják).
+     * Az objektumok helyének vagy forgási paramétereinek közvetlen módosítása után invalidate() hívandó.
+     * @param shadowCasterCount Az első ennyi objektum vet árnyékot.
+     */
+    void updateScene(const std::vector<MeshObject*>& objects, size_t shadowCasterCount);
+
+    void invalidate() { sceneObjects = nullptr; }
+
+    /**
+     * @brief Egy objektum helyének közvetlen módosítása után csak a leírójának transzformációs mezői töltődnek fel újra
+     * (a teljes jelenet újraépítése nélkül). Megvárja a GPU-t (a futó frame-ek culling pass-a olvassa a leírót).
+     * @param objectIndex Az objektum indexe az updateScene objects tömbjében; nincs teendő, ha nincs feltöltött jelenet.
+     */
+    void updateObject(uint32_t objectIndex);
+
+    /**
+     * @brief Minden feltöltéskor nő: a pufferekre hivatkozó rögzített parancsok (statikus visszajátszás) ehhez igazodnak.
+     */
+    uint64_t getSceneVersion() const { return sceneVersion; }
+
+    /**
+     * @brief Az előző használat (a fence már jelzett) eredményeinek kiolvasása a frame slotból.
+     */
+    void readStats(uint32_t frameIndex);
+
+    /**
+     * @brief Culling parancsok rögzítése a fő pass-hoz és a kaszkádokhoz, render pass-on kívül (a frame elején).
+     * A végén barrier biztosítja, hogy az indirekt rajzolás és a vertex shader az új adatokat lássa.
+     */
+    void recordCulling(VkCommandBuffer commandBuffer, uint32_t frameIndex, const FrameParams& params);
+
+    /**
+     * @brief Egy csoport indirekt rajzolása (a pipeline-t, a vertex / index puffert és a textúrát a hívó köti be).
+     * VK_KHR_draw_indirect_count esetén a GPU által írt számú parancs fut, különben a csoport összes parancsa
+     * (a nem látható objektumoké 0 példánnyal).
+     * @param pass MainPass, vagy ShadowPass + kaszkád index.
+     */
+    void drawBucket(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t pass, uint32_t bucket) const;
+
+    const std::vector<Bucket>& getBuckets() const { return buckets; }
+    VkDescriptorSet getInstanceDescriptorSet(uint32_t frameIndex) const { return frames[frameIndex].instanceDescriptorSet; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    // A compute shader objektum leírója (std430, lásd object_cull.comp)
+    struct GpuObject {
+        glm::vec4 positionSpeed;    // xyz: pozíció, w: forgási sebesség (fok / s)
+        glm::vec4 rotationAxis;     // xyz: forgástengely
+        glm::mat4 dequantization;   // Compact formátum visszaalakítása
+        glm::vec4 boundsCenter;     // Mesh terű AABB középpont, w: a befoglaló gömb sugara
+        glm::vec4 boundsExtent;     // Mesh terű AABB fél-kiterjedés
+        glm::vec4 sphereCenter;     // Mesh terű befoglaló gömb középpont
+        uint32_t firstLod;          // Az első LOD szint a LOD táblában
+        uint32_t lodCount;
+        int32_t vertexOffset;
+        uint32_t bucket;
+        uint32_t bucketFirst;       // A csoport első parancsa
+        uint32_t bucketRank;        // Az objektum helye a csoportban (draw count nélküli mód)
+        uint32_t shadowCaster;
+        uint32_t padding;
+    };
+
+    // LOD szint a shader számára (firstIndex a közös index pufferben)
+    struct GpuLod {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float error;
+        uint32_t padding;
+    };
+
+    // Frame-enkénti paraméterek (std140 uniform buffer)
+    struct GpuParams {
+        glm::vec4 planes[PassCount][6];
+        glm::vec4 viewer[PassCount];    // xyz: nézőpont, w: 1 perspektív / 0 ortografikus
+        glm::vec4 lod[PassCount];       // x: vetítési skála, y: megengedett pixel hiba, z: LOD be/ki
+        float animationTime;
+        uint32_t objectCount;
+        uint32_t bucketCount;
+        uint32_t compactCommands;       // 1: draw count mód (tömörített parancsok)
+        uint32_t passCount;             // A fő pass és az aktív kaszkádok száma
+        uint32_t padding[3];
+    };
+
+    // Frame-enként a paraméterek és a kimenetek (a kimenet pass-onként objectCount hosszú)
+    struct FrameResources {
+        VkBuffer paramsBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory paramsMemory = VK_NULL_HANDLE;
+        GpuParams* mappedParams = nullptr;
+        VkBuffer commandBuffer = VK_NULL_HANDLE;   // PassCount * objectCount parancs
+        VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;  // PassCount * objectCount model mátrix (firstInstance = parancs index)
+        VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+        VkBuffer countBuffer = VK_NULL_HANDLE;     // PassCount * bucketCount rajzolás szám, utána pass-onként látható objektum és háromszög szám
+        VkDeviceMemory countMemory = VK_NULL_HANDLE;
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;  // A statisztika host-visible másolata
+        VkDeviceMemory readbackMemory = VK_NULL_HANDLE;
+        uint32_t* mappedReadback = nullptr;
+        bool readbackWritten = false;
+        VkDescriptorSet cullDescriptorSet = VK_NULL_HANDLE;
+        VkDescriptorSet instanceDescriptorSet = VK_NULL_HANDLE;
+    };
+
+    VulkanContext* context = nullptr;
+    GeometryPool* geometryPool = nullptr;
+    uint32_t framesInFlight = 0;
+    bool supported = false;
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+    uint32_t maxDrawIndirectCount = 1;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout instanceSetLayout = VK_NULL_HANDLE; // A rendereré, nem itt szabadul fel
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    // A feltöltött jelenet és a felismeréséhez használt állapot
+    const MeshObject* const* sceneObjects = nullptr;
+    size_t objectCount = 0;
+    size_t casterCount = 0;
+    VkBuffer sourceIndexBuffer = VK_NULL_HANDLE;
+    VkBuffer sourcePositionBuffers[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    uint64_t sceneVersion = 0;
+
+    std::vector<Bucket> buckets;
+    VkBuffer objectBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory objectMemory = VK_NULL_HANDLE;
+    VkBuffer lodBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory lodMemory = VK_NULL_HANDLE;
+    std::vector<FrameResources> frames;
+    Stats stats;
+
+    /**
+     * @brief Device-local storage buffer létrehozása és feltöltése staging pufferen keresztül.
+     */
+    void uploadBuffer(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory);
+
+    // A leíró transzformációs mezői (positionSpeed, rotationAxis, dequantization): a leíró elején, együtt frissíthetők
+    static void writeTransform(const MeshObject* obj, GpuObject& gpuObject);
+
+    // A jelenet méretétől függő pufferek (újra)létrehozása és a descriptor set-ek írása
+    void createSceneResources();
+    void destroySceneResources();
+};
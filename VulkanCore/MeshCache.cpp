@@ -0,0 +1,233 @@
+/**
+ * @file MeshCache.cpp
+ * @brief Bináris mesh cache: FNV-1a kulcs, fájl leképezés (mmap / MapViewOfFile), ellenőrzött olvasás és atomikus írás.
+ */
+#include "MeshCache.h"
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <type_traits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::is_trivially_copyable<MeshCacheHeader>::value, "MeshCacheHeader is written to disk as raw bytes");
+static_assert(std::is_trivially_copyable<MeshObject::LodLevel>::value, "LodLevel is written to disk as raw bytes");
+
+namespace {
+    const char CACHE_MAGIC[4] = {'V', 'K', 'M', 'C'};
+    const uint64_t SECTION_ALIGNMENT = 16;
+
+    uint64_t alignSection(uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+}
+
+// --- MappedFile ---
+
+MeshCache::MappedFile::~MappedFile() {
+    close();
+}
+
+bool MeshCache::MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mapped = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    // A teljes fájl azonnal kell (staging másolás): előolvasás kérése a kerneltől
+    madvise(view, static_cast<size_t>(fileStat.st_size), MADV_WILLNEED);
+
+    fileDescriptor = fd;
+    mapped = static_cast<const uint8_t*>(view);
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+#endif
+    return true;
+}
+
+void MeshCache::MappedFile::close() {
+    if (mapped == nullptr) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mapped);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(mapped), mappedSize);
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+// --- MeshCache ---
+
+uint64_t MeshCache::hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull; // FNV-1a 64 prím
+    }
+    return h;
+}
+
+std::string MeshCache::pathFor(const std::string& directory, uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vkmesh", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool MeshCache::open(MappedFile& file, const std::string& path, uint64_t key, View& view) {
+    if (!file.open(path)) return false;
+
+    // Fejléc ellenőrzése: a leképezett memória lap-igazított, így a szakaszok közvetlenül olvashatók
+    if (file.size() < sizeof(MeshCacheHeader)) return false;
+    const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(file.data());
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) return false;
+    if (header->version != VERSION || header->key != key || header->fileSize != file.size()) return false;
+
+    // Formátum: a feltöltés a vertex formátum szerinti lépésközzel és index mérettel olvas
+    if (header->vertexFormat > static_cast<uint32_t>(VertexFormat::Compact)) return false;
+    VertexFormat format = static_cast<VertexFormat>(header->vertexFormat);
+    if (header->vertexStride != VertexLayout::getStride(format)) return false;
+    if (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t)) return false;
+    if (header->lodCount == 0 || header->baseIndexCount > header->indexCount) return false;
+
+    // A szakaszok a fájlon belül legyenek (sérült vagy csonka fájl ellen); a táblázatok igazítva, közvetlenül olvashatók
+    auto fits = [&](uint64_t offset, uint64_t bytes) {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    };
+    uint64_t vertexBytes = uint64_t(header->vertexCount) * header->vertexStride;
+    uint64_t indexBytes = uint64_t(header->indexCount) * header->indexSize;
+    if (!fits(header->vertexDataOffset, vertexBytes) || !fits(header->indexDataOffset, indexBytes) ||
+        !fits(header->lodOffset, uint64_t(header->lodCount) * sizeof(MeshObject::LodLevel)) ||
+        !fits(header->meshletOffset, uint64_t(header->meshletCount) * sizeof(Meshlet)) ||
+        header->lodOffset % SECTION_ALIGNMENT != 0 || header->meshletOffset % SECTION_ALIGNMENT != 0) {
+        return false;
+    }
+
+    // A LOD szintek és a meshletek tartományai az index, illetve a meshlet szakaszon belül legyenek (a feltöltés és a
+    // meshlet culling ezek szerint olvas)
+    const MeshObject::LodLevel* lods = reinterpret_cast<const MeshObject::LodLevel*>(file.data() + header->lodOffset);
+    const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(file.data() + header->meshletOffset);
+    for (uint32_t i = 0; i < header->lodCount; i++) {
+        if (uint64_t(lods[i].firstIndex) + lods[i].indexCount > header->indexCount ||
+            uint64_t(lods[i].firstMeshlet) + lods[i].meshletCount > header->meshletCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->meshletCount; i++) {
+        if (uint64_t(meshlets[i].indexOffset) + uint64_t(meshlets[i].triangleCount) * 3 > header->indexCount) {
+            return false;
+        }
+    }
+
+    view.header = header;
+    view.vertexData = file.data() + header->vertexDataOffset;
+    view.indexData = file.data() + header->indexDataOffset;
+    view.lods = lods;
+    view.meshlets = meshlets;
+    return true;
+}
+
+bool MeshCache::write(const std::string& path, MeshCacheHeader header, const void* vertexData, const void* indexData,
+                      const MeshObject::LodLevel* lods, const Meshlet* meshlets) {
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+
+    uint64_t vertexBytes = uint64_t(header.vertexCount) * header.vertexStride;
+    uint64_t indexBytes = uint64_t(header.indexCount) * header.indexSize;
+    uint64_t lodBytes = uint64_t(header.lodCount) * sizeof(MeshObject::LodLevel);
+    uint64_t meshletBytes = uint64_t(header.meshletCount) * sizeof(Meshlet);
+
+    header.vertexDataOffset = alignSection(sizeof(MeshCacheHeader));
+    header.indexDataOffset = alignSection(header.vertexDataOffset + vertexBytes);
+    header.lodOffset = alignSection(header.indexDataOffset + indexBytes);
+    header.meshletOffset = alignSection(header.lodOffset + lodBytes);
+    header.fileSize = header.meshletOffset + meshletBytes;
+
+    std::error_code error;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        // Szakaszonként, a köztes igazítási hézagokat nullákkal kitöltve
+        const char padding[SECTION_ALIGNMENT] = {};
+        auto writeSection = [&](uint64_t offset, const void* data, uint64_t size) {
+            uint64_t position = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(offset - position));
+            if (size > 0) out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeSection(header.vertexDataOffset, vertexData, vertexBytes);
+        writeSection(header.indexDataOffset, indexData, indexBytes);
+        writeSection(header.lodOffset, lods, lodBytes);
+        writeSection(header.meshletOffset, meshlets, meshletBytes);
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(temporaryPath, target, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
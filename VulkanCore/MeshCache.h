@@ -0,0 +1,118 @@
+/**
+ * @file MeshCache.h
+ * @brief Verziózott bináris mesh cache: a feldolgozott (optimalizált, tangensekkel kódolt, LOD-olt) geometria
+ * fájlba mentése, és memóriába leképezve (mmap) betöltése, hogy a következő indításkor ne kelljen újraszámolni.
+ *
+ * Fájl felépítése (minden szakasz 16 byte-ra igazítva, little-endian):
+ *   MeshCacheHeader | vertex adatok (pozíció folyam, majd attribútum folyam) | index adatok | LOD táblázat | meshletek
+ */
+#pragma once
+
+#include "MeshObject.h"
+#include "Meshlet.h"
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief A cache fájl fejléce. A kulcs a forrás adatok és a generátor paraméterek hash-e.
+ */
+struct MeshCacheHeader {
+    char magic[4];              // "VKMC"
+    uint32_t version;           // MeshCache::VERSION; eltérés esetén a fájl érvénytelen
+    uint64_t key;               // Forrás hash (lásd MeshCache::hash)
+
+    uint32_t vertexFormat;      // VertexFormat
+    uint32_t vertexStride;      // Egy vertex mérete byte-ban (a két folyam együtt)
+    uint32_t vertexCount;
+    uint32_t indexSize;         // 2 vagy 4 byte
+    uint32_t indexCount;        // Az összes LOD szint indexeinek száma
+    uint32_t baseIndexCount;    // A LOD 0 indexeinek száma
+    uint32_t lodCount;
+    uint32_t meshletCount;
+
+    glm::vec4 boundingSphere;   // Mesh térben
+    glm::vec4 boundsMin;        // Befoglaló doboz (mesh térben, W nem használt)
+    glm::vec4 boundsMax;
+    glm::mat4 dequantization;   // Compact formátum visszaalakító mátrixa
+
+    // Szakaszok helye a fájlban (byte)
+    uint64_t vertexDataOffset;
+    uint64_t indexDataOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t fileSize;
+};
+
+class MeshCache {
+public:
+    static const uint32_t VERSION = 2;
+    static const uint64_t HASH_SEED = 0xcbf29ce484222325ull; // FNV-1a 64 kezdőérték
+
+    /**
+     * @brief Csak olvasható fájl leképezés (POSIX mmap, Windowson MapViewOfFile). A destruktor felszabadítja.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        const uint8_t* data() const { return mapped; }
+        size_t size() const { return mappedSize; }
+
+    private:
+        const uint8_t* mapped = nullptr;
+        size_t mappedSize = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#else
+        int fileDescriptor = -1;
+#endif
+    };
+
+    /**
+     * @brief Egy érvényes cache fájl szakaszai (a leképezett memóriába mutatnak, másolás nélkül).
+     */
+    struct View {
+        const MeshCacheHeader* header = nullptr;
+        const uint8_t* vertexData = nullptr;
+        const uint8_t* indexData = nullptr;
+        const MeshObject::LodLevel* lods = nullptr;
+        const Meshlet* meshlets = nullptr;
+    };
+
+    /**
+     * @brief FNV-1a 64 bites hash; a seed-del több adat láncolható (pl. generátor neve, majd paraméterei).
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = HASH_SEED);
+
+    template <typename T>
+    static uint64_t hashValue(const T& value, uint64_t seed = HASH_SEED) {
+        return hash(&value, sizeof(T), seed);
+    }
+
+    /**
+     * @brief A kulcshoz tartozó fájl elérési útja a cache könyvtárban (<könyvtár>/<kulcs hex>.vkmesh).
+     */
+    static std::string pathFor(const std::string& directory, uint64_t key);
+
+    /**
+     * @brief A cache fájl leképezése és ellenőrzése (magic, verzió, kulcs, méretek).
+     * @return Hamis, ha a fájl nem létezik, elavult vagy sérült; ekkor a mesh-t újra kell építeni.
+     */
+    static bool open(MappedFile& file, const std::string& path, uint64_t key, View& view);
+
+    /**
+     * @brief Cache fájl írása. A fejléc szakasz eltolásait és a fájlméretet ez tölti ki.
+     * Ideiglenes fájlba ír, majd átnevezi, így félbeszakadt írás nem hagy érvénytelen fájlt a helyén.
+     */
+    static bool write(const std::string& path, MeshCacheHeader header, const void* vertexData, const void* indexData,
+                      const MeshObject::LodLevel* lods, const Meshlet* meshlets);
+};
@@ -0,0 +1,1045 @@
+/**
+ * @file MeshImporter.cpp
+ * @brief OBJ (két menetes, darabolt párhuzamos parzolás) és GLB (minimális JSON + accessor másolás) betöltés.
+ */
+#include "MeshImporter.h"
+#include "MeshCache.h"
+#include "ParallelFor.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+    // --- OBJ szöveg feldolgozás ---
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+    inline bool isLineEnd(char c) { return c == '\n' || c == '\r'; }
+    inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    inline const char* skipSpaces(const char* s, const char* end) {
+        while (s < end && isSpace(*s)) s++;
+        return s;
+    }
+
+    inline const char* nextLine(const char* s, const char* end) {
+        const char* newline = static_cast<const char*>(std::memchr(s, '\n', static_cast<size_t>(end - s)));
+        return newline ? newline + 1 : end;
+    }
+
+    inline const char* skipToken(const char* s, const char* end) {
+        while (s < end && !isSpace(*s) && !isLineEnd(*s)) s++;
+        return s;
+    }
+
+    const double POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    /**
+     * @brief Locale-független float olvasás (előjel, egész és tört rész, exponens).
+     * A legfeljebb 19 értékes jegyű mantissza és a 10 hatvány pontosan ábrázolható double-ként,
+     * így az eredmény float pontosságban helyes (strtof-nál jóval gyorsabb).
+     */
+    const char* parseFloat(const char* s, const char* end, float& out) {
+        s = skipSpaces(s, end);
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+')) {
+            negative = (*s == '-');
+            s++;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; s < end && isDigit(*s); s++) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + uint64_t(*s - '0');
+                if (mantissa != 0) digits++;
+            } else {
+                exponent++;
+            }
+        }
+        if (s < end && *s == '.') {
+            for (s++; s < end && isDigit(*s); s++) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + uint64_t(*s - '0');
+                    if (mantissa != 0) digits++;
+                    exponent--;
+                }
+            }
+        }
+        if (s < end && (*s == 'e' || *s == 'E')) {
+            s++;
+            bool negativeExponent = false;
+            if (s < end && (*s == '-' || *s == '+')) {
+                negativeExponent = (*s == '-');
+                s++;
+            }
+            int value = 0;
+            for (; s < end && isDigit(*s); s++) value = std::min(value * 10 + (*s - '0'), 100000);
+            exponent += negativeExponent ? -value : value;
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (mantissa != 0 && exponent != 0) {
+            if (exponent < 0 && exponent >= -22) {
+                result /= POWERS_OF_TEN[-exponent];
+            } else if (exponent > 0 && exponent <= 22) {
+                result *= POWERS_OF_TEN[exponent];
+            } else {
+                result *= std::pow(10.0, exponent);
+            }
+        }
+        out = static_cast<float>(negative ? -result : result);
+        return s;
+    }
+
+    // Egy OBJ index (1-alapú, negatív: relatív a már beolvasott elemekhez) 0-alapúra alakítva
+    const char* parseIndex(const char* s, const char* end, size_t countSoFar, uint32_t& out) {
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+')) {
+            negative = (*s == '-');
+            s++;
+        }
+        int64_t value = 0;
+        bool present = false;
+        for (; s < end && isDigit(*s); s++) {
+            value = std::min<int64_t>(value * 10 + (*s - '0'), int64_t(1) << 40);
+            present = true;
+        }
+
+        if (!present) {
+            out = MeshImporter::MISSING_INDEX;
+        } else if (!negative && value > 0) {
+            out = static_cast<uint32_t>(std::min<int64_t>(value - 1, MeshImporter::INVALID_INDEX));
+        } else if (negative && value > 0 && value <= int64_t(countSoFar)) {
+            out = static_cast<uint32_t>(int64_t(countSoFar) - value);
+        } else {
+            out = MeshImporter::INVALID_INDEX; // 0 vagy a fájl elejénél korábbra mutató relatív index
+        }
+        return s;
+    }
+
+    enum class ObjLine { Other, Position, TexCoord, Normal, Face };
+
+    // A sor típusa; s a kulcsszó utánra lép
+    ObjLine classifyLine(const char*& s, const char* end) {
+        s = skipSpaces(s, end);
+        if (end - s < 2) return ObjLine::Other;
+        if (s[0] == 'v') {
+            if (isSpace(s[1])) {
+                s += 2;
+                return ObjLine::Position;
+            }
+            if (end - s >= 3 && isSpace(s[2])) {
+                if (s[1] == 't') {
+                    s += 3;
+                    return ObjLine::TexCoord;
+                }
+                if (s[1] == 'n') {
+                    s += 3;
+                    return ObjLine::Normal;
+                }
+            }
+        } else if (s[0] == 'f' && isSpace(s[1])) {
+            s += 2;
+            return ObjLine::Face;
+        }
+        return ObjLine::Other;
+    }
+
+    // A sor hátralévő (szóközzel elválasztott) elemeinek száma
+    size_t countTokens(const char* s, const char* end) {
+        size_t count = 0;
+        for (;;) {
+            s = skipSpaces(s, end);
+            if (s >= end || isLineEnd(*s)) return count;
+            count++;
+            s = skipToken(s, end);
+        }
+    }
+
+    /**
+     * @brief A fájl egy sorhatáron kezdődő és végződő darabja.
+     * Az első menet a darabban lévő elemeket számolja, a prefix összegek után a first* mezők
+     * adják, hogy a darab a közös tömbök melyik helyére ír.
+     */
+    struct ObjChunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        size_t positions = 0;
+        size_t texcoords = 0;
+        size_t normals = 0;
+        size_t triangles = 0;
+        size_t firstPosition = 0;
+        size_t firstTexcoord = 0;
+        size_t firstNormal = 0;
+        size_t firstTriangle = 0;
+    };
+
+    void countObjChunk(ObjChunk& chunk) {
+        const char* end = chunk.end;
+        for (const char* line = chunk.begin; line < end; line = nextLine(line, end)) {
+            const char* s = line;
+            switch (classifyLine(s, end)) {
+                case ObjLine::Position: chunk.positions++; break;
+                case ObjLine::TexCoord: chunk.texcoords++; break;
+                case ObjLine::Normal: chunk.normals++; break;
+                case ObjLine::Face: {
+                    // Legyező háromszögelés: k csúcsú sokszög -> k - 2 háromszög
+                    size_t cornerCount = countTokens(s, end);
+                    if (cornerCount >= 3) chunk.triangles += cornerCount - 2;
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+
+    void parseObjChunk(const ObjChunk& chunk, float* positions, float* texcoords, float* normals, uint32_t* corners) {
+        float* position = positions + chunk.firstPosition * 3;
+        float* texcoord = texcoords + chunk.firstTexcoord * 2;
+        float* normal = normals + chunk.firstNormal * 3;
+        uint32_t* corner = corners + chunk.firstTriangle * 9;
+
+        // A relatív indexekhez: a fájl elejétől eddig beolvasott elemek száma
+        size_t positionCount = chunk.firstPosition;
+        size_t texcoordCount = chunk.firstTexcoord;
+        size_t normalCount = chunk.firstNormal;
+
+        const char* end = chunk.end;
+        for (const char* line = chunk.begin; line < end; line = nextLine(line, end)) {
+            const char* s = line;
+            switch (classifyLine(s, end)) {
+                case ObjLine::Position:
+                    s = parseFloat(s, end, position[0]);
+                    s = parseFloat(s, end, position[1]);
+                    parseFloat(s, end, position[2]);
+                    position += 3;
+                    positionCount++;
+                    break;
+                case ObjLine::TexCoord: {
+                    // Az OBJ V tengelye felfelé mutat, a Vulkan textúráké lefelé
+                    float v = 0.0f;
+                    s = parseFloat(s, end, texcoord[0]);
+                    parseFloat(s, end, v);
+                    texcoord[1] = 1.0f - v;
+                    texcoord += 2;
+                    texcoordCount++;
+                    break;
+                }
+                case ObjLine::Normal:
+                    s = parseFloat(s, end, normal[0]);
+                    s = parseFloat(s, end, normal[1]);
+                    parseFloat(s, end, normal[2]);
+                    normal += 3;
+                    normalCount++;
+                    break;
+                case ObjLine::Face: {
+                    // Csúcsok: "p", "p/t", "p//n" vagy "p/t/n"; a sokszög legyezőként háromszögelve
+                    uint32_t first[3], previous[3], current[3];
+                    size_t cornerIndex = 0;
+                    for (;;) {
+                        s = skipSpaces(s, end);
+                        if (s >= end || isLineEnd(*s)) break;
+
+                        s = parseIndex(s, end, positionCount, current[0]);
+                        current[1] = current[2] = MeshImporter::MISSING_INDEX;
+                        if (s < end && *s == '/') {
+                            s = parseIndex(s + 1, end, texcoordCount, current[1]);
+                            if (s < end && *s == '/') s = parseIndex(s + 1, end, normalCount, current[2]);
+                        }
+                        if (current[0] == MeshImporter::MISSING_INDEX) current[0] = MeshImporter::INVALID_INDEX;
+                        s = skipToken(s, end);
+
+                        if (cornerIndex == 0) {
+                            std::copy(current, current + 3, first);
+                        } else if (cornerIndex >= 2) {
+                            std::copy(first, first + 3, corner);
+                            std::copy(previous, previous + 3, corner + 3);
+                            std::copy(current, current + 3, corner + 6);
+                            corner += 9;
+                        }
+                        std::copy(current, current + 3, previous);
+                        cornerIndex++;
+                    }
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+
+    // --- Minimális JSON (a glTF leíróhoz) ---
+
+    struct JsonValue {
+        enum class Type { Null, Boolean, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        const JsonValue* find(const char* key) const {
+            if (type != Type::Object) return nullptr;
+            for (const auto& member : members) {
+                if (member.first == key) return &member.second;
+            }
+            return nullptr;
+        }
+
+        // Tömb elem; hiányzó / hibás index esetén nullptr
+        const JsonValue* at(size_t index) const {
+            return (type == Type::Array && index < items.size()) ? &items[index] : nullptr;
+        }
+
+        double numberOr(const char* key, double fallback) const {
+            const JsonValue* value = find(key);
+            return (value && value->type == Type::Number) ? value->number : fallback;
+        }
+
+        bool has(const char* key) const { return find(key) != nullptr; }
+    };
+
+    class JsonParser {
+    public:
+        JsonParser(const char* text, size_t size) : s(text), end(text + size) {}
+
+        JsonValue parse() {
+            JsonValue value = parseValue(0);
+            return value;
+        }
+
+    private:
+        static const int MAX_DEPTH = 128;
+
+        const char* s;
+        const char* end;
+
+        [[noreturn]] void fail() const {
+            throw std::runtime_error("failed to import glTF: invalid JSON chunk!");
+        }
+
+        void skipWhitespace() {
+            while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r')) s++;
+        }
+
+        bool consume(char c) {
+            skipWhitespace();
+            if (s < end && *s == c) {
+                s++;
+                return true;
+            }
+            return false;
+        }
+
+        void expectLiteral(const char* literal) {
+            size_t length = std::strlen(literal);
+            if (size_t(end - s) < length || std::memcmp(s, literal, length) != 0) fail();
+            s += length;
+        }
+
+        JsonValue parseValue(int depth) {
+            if (depth > MAX_DEPTH) fail();
+            skipWhitespace();
+            if (s >= end) fail();
+
+            JsonValue value;
+            switch (*s) {
+                case '{':
+                    s++;
+                    value.type = JsonValue::Type::Object;
+                    if (consume('}')) break;
+                    do {
+                        skipWhitespace();
+                        std::string key = parseString();
+                        if (!consume(':')) fail();
+                        value.members.emplace_back(std::move(key), parseValue(depth + 1));
+                    } while (consume(','));
+                    if (!consume('}')) fail();
+                    break;
+                case '[':
+                    s++;
+                    value.type = JsonValue::Type::Array;
+                    if (consume(']')) break;
+                    do {
+                        value.items.push_back(parseValue(depth + 1));
+                    } while (consume(','));
+                    if (!consume(']')) fail();
+                    break;
+                case '"':
+                    value.type = JsonValue::Type::String;
+                    value.string = parseString();
+                    break;
+                case 't':
+                    expectLiteral("true");
+                    value.type = JsonValue::Type::Boolean;
+                    value.boolean = true;
+                    break;
+                case 'f':
+                    expectLiteral("false");
+                    value.type = JsonValue::Type::Boolean;
+                    break;
+                case 'n':
+                    expectLiteral("null");
+                    break;
+                default:
+                    value.type = JsonValue::Type::Number;
+                    value.number = parseNumber();
+                    break;
+            }
+            return value;
+        }
+
+        std::string parseString() {
+            if (s >= end || *s != '"') fail();
+            s++;
+            std::string out;
+            while (s < end && *s != '"') {
+                if (*s != '\\') {
+                    out += *s++;
+                    continue;
+                }
+                if (++s >= end) fail();
+                char c = *s++;
+                switch (c) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u':
+                        // A glTF kulcsok ASCII-k; a nem ASCII karakterek csak nevekben fordulnak elő
+                        if (end - s < 4) fail();
+                        s += 4;
+                        out += '?';
+                        break;
+                    default: out += c; break;
+                }
+            }
+            if (s >= end) fail();
+            s++;
+            return out;
+        }
+
+        double parseNumber() {
+            // A JSON chunk nincs lezárva, ezért a számot strtod előtt kimásoljuk
+            char buffer[64];
+            size_t length = 0;
+            while (s < end && length + 1 < sizeof(buffer) &&
+                   (isDigit(*s) || *s == '-' || *s == '+' || *s == '.' || *s == 'e' || *s == 'E')) {
+                buffer[length++] = *s++;
+            }
+            if (length == 0) fail();
+            buffer[length] = '\0';
+            char* parsedEnd = nullptr;
+            double value = std::strtod(buffer, &parsedEnd);
+            if (parsedEnd != buffer + length) fail();
+            return value;
+        }
+    };
+
+    // --- glTF accessorok ---
+
+    const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+    const int GLTF_MODE_TRIANGLES = 4;
+
+    enum GltfComponentType : uint32_t {
+        GLTF_BYTE = 5120,
+        GLTF_UNSIGNED_BYTE = 5121,
+        GLTF_SHORT = 5122,
+        GLTF_UNSIGNED_SHORT = 5123,
+        GLTF_UNSIGNED_INT = 5125,
+        GLTF_FLOAT = 5126
+    };
+
+    uint32_t readU32(const uint8_t* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Egy accessor elemei a bináris chunk-ban (ellenőrzött határokkal, másolás nélkül).
+     */
+    struct Accessor {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        uint32_t componentType = 0;
+        uint32_t components = 0;
+        bool normalized = false;
+
+        // Komponens float-ként (normalizált egész típusoknál a glTF szerinti [0, 1] / [-1, 1] leképezéssel)
+        float read(size_t element, uint32_t component) const {
+            const uint8_t* p = data + element * stride;
+            switch (componentType) {
+                case GLTF_FLOAT: {
+                    float value;
+                    std::memcpy(&value, p + component * sizeof(float), sizeof(float));
+                    return value;
+                }
+                case GLTF_UNSIGNED_BYTE: {
+                    float value = p[component];
+                    return normalized ? value / 255.0f : value;
+                }
+                case GLTF_BYTE: {
+                    float value = static_cast<int8_t>(p[component]);
+                    return normalized ? std::max(value / 127.0f, -1.0f) : value;
+                }
+                case GLTF_UNSIGNED_SHORT: {
+                    uint16_t raw;
+                    std::memcpy(&raw, p + component * sizeof(uint16_t), sizeof(raw));
+                    return normalized ? raw / 65535.0f : float(raw);
+                }
+                case GLTF_SHORT: {
+                    int16_t raw;
+                    std::memcpy(&raw, p + component * sizeof(int16_t), sizeof(raw));
+                    return normalized ? std::max(raw / 32767.0f, -1.0f) : float(raw);
+                }
+                default: {
+                    uint32_t raw;
+                    std::memcpy(&raw, p + component * sizeof(uint32_t), sizeof(raw));
+                    return float(raw);
+                }
+            }
+        }
+
+        uint32_t readIndex(size_t element) const {
+            const uint8_t* p = data + element * stride;
+            switch (componentType) {
+                case GLTF_UNSIGNED_BYTE: return p[0];
+                case GLTF_UNSIGNED_SHORT: {
+                    uint16_t value;
+                    std::memcpy(&value, p, sizeof(value));
+                    return value;
+                }
+                default: return readU32(p);
+            }
+        }
+    };
+
+    uint32_t componentSize(uint32_t componentType) {
+        switch (componentType) {
+            case GLTF_BYTE:
+            case GLTF_UNSIGNED_BYTE: return 1;
+            case GLTF_SHORT:
+            case GLTF_UNSIGNED_SHORT: return 2;
+            case GLTF_UNSIGNED_INT:
+            case GLTF_FLOAT: return 4;
+            default: return 0;
+        }
+    }
+
+    uint32_t componentCount(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    Accessor getAccessor(const JsonValue& gltf, size_t index, const uint8_t* bin, size_t binSize, uint32_t minComponents) {
+        const JsonValue* accessors = gltf.find("accessors");
+        const JsonValue* accessor = accessors ? accessors->at(index) : nullptr;
+        if (!accessor) throw std::runtime_error("failed to import glTF: missing accessor!");
+        if (accessor->has("sparse")) throw std::runtime_error("failed to import glTF: sparse accessors are not supported!");
+
+        Accessor result;
+        result.count = static_cast<size_t>(accessor->numberOr("count", 0));
+        result.componentType = static_cast<uint32_t>(accessor->numberOr("componentType", 0));
+        const JsonValue* normalized = accessor->find("normalized");
+        result.normalized = normalized && normalized->boolean;
+        const JsonValue* type = accessor->find("type");
+        result.components = type ? componentCount(type->string) : 0;
+        uint32_t size = componentSize(result.componentType);
+        if (size == 0 || result.components < minComponents) {
+            throw std::runtime_error("failed to import glTF: unsupported accessor format!");
+        }
+
+        const JsonValue* bufferViews = gltf.find("bufferViews");
+        const JsonValue* bufferViewIndex = accessor->find("bufferView");
+        const JsonValue* bufferView = (bufferViews && bufferViewIndex) ? bufferViews->at(static_cast<size_t>(bufferViewIndex->number)) : nullptr;
+        if (!bufferView || bufferView->numberOr("buffer", 0) != 0) {
+            throw std::runtime_error("failed to import glTF: only the embedded GLB buffer is supported!");
+        }
+
+        size_t elementSize = size_t(size) * result.components;
+        size_t offset = static_cast<size_t>(bufferView->numberOr("byteOffset", 0) + accessor->numberOr("byteOffset", 0));
+        size_t viewLength = static_cast<size_t>(bufferView->numberOr("byteLength", 0));
+        result.stride = static_cast<size_t>(bufferView->numberOr("byteStride", 0));
+        if (result.stride == 0) result.stride = elementSize;
+
+        size_t accessorBytes = result.count == 0 ? 0 : (result.count - 1) * result.stride + elementSize;
+        size_t viewOffset = static_cast<size_t>(bufferView->numberOr("byteOffset", 0));
+        if (offset + accessorBytes > binSize || offset - viewOffset + accessorBytes > viewLength) {
+            throw std::runtime_error("failed to import glTF: accessor out of buffer bounds!");
+        }
+        result.data = bin + offset;
+        return result;
+    }
+
+    // Node lokális transzformációja: "matrix" (oszlopfolytonos), vagy TRS (translation, rotation, scale)
+    glm::mat4 nodeTransform(const JsonValue& node) {
+        const JsonValue* matrix = node.find("matrix");
+        if (matrix && matrix->items.size() == 16) {
+            glm::mat4 result;
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 4; row++) result[column][row] = static_cast<float>(matrix->items[column * 4 + row].number);
+            }
+            return result;
+        }
+
+        auto vector = [&](const char* key, size_t count, const float* fallback, float* out) {
+            const JsonValue* value = node.find(key);
+            for (size_t i = 0; i < count; i++) {
+                out[i] = (value && value->items.size() == count) ? static_cast<float>(value->items[i].number) : fallback[i];
+            }
+        };
+        const float zero[3] = {0.0f, 0.0f, 0.0f};
+        const float one[3] = {1.0f, 1.0f, 1.0f};
+        const float identityRotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        float t[3], r[4], s[3];
+        vector("translation", 3, zero, t);
+        vector("rotation", 4, identityRotation, r);
+        vector("scale", 3, one, s);
+
+        glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(t[0], t[1], t[2]));
+        glm::mat4 rotation = glm::mat4_cast(glm::quat(r[3], r[0], r[1], r[2])); // glTF: (x, y, z, w)
+        glm::mat4 scale = glm::scale(glm::mat4(1.0f), glm::vec3(s[0], s[1], s[2]));
+        return translation * rotation * scale;
+    }
+
+    /**
+     * @brief Egy kirajzolandó primitív (mesh primitív + a node világ transzformációja) és helye a kimenetben.
+     */
+    struct GltfPrimitive {
+        const JsonValue* primitive = nullptr;
+        glm::mat4 transform = glm::mat4(1.0f);
+        size_t firstVertex = 0;
+        size_t vertexCount = 0;
+        size_t firstIndex = 0;
+        size_t indexCount = 0;
+    };
+
+    void collectMesh(const JsonValue& gltf, size_t meshIndex, const glm::mat4& transform, std::vector<GltfPrimitive>& out) {
+        const JsonValue* meshes = gltf.find("meshes");
+        const JsonValue* mesh = meshes ? meshes->at(meshIndex) : nullptr;
+        const JsonValue* primitives = mesh ? mesh->find("primitives") : nullptr;
+        if (!primitives) return;
+        for (const JsonValue& primitive : primitives->items) {
+            // Csak háromszög listák (a strip / fan / vonal / pont primitívek kimaradnak)
+            if (static_cast<int>(primitive.numberOr("mode", GLTF_MODE_TRIANGLES)) != GLTF_MODE_TRIANGLES) continue;
+            const JsonValue* attributes = primitive.find("attributes");
+            if (!attributes || !attributes->has("POSITION")) continue;
+            GltfPrimitive entry;
+            entry.primitive = &primitive;
+            entry.transform = transform;
+            out.push_back(entry);
+        }
+    }
+
+    void collectNode(const JsonValue& gltf, size_t nodeIndex, const glm::mat4& parent, int depth, std::vector<GltfPrimitive>& out) {
+        const JsonValue* nodes = gltf.find("nodes");
+        const JsonValue* node = nodes ? nodes->at(nodeIndex) : nullptr;
+        if (!node || depth > 64) return; // Hibás (körkörös) hierarchia ellen
+
+        glm::mat4 transform = parent * nodeTransform(*node);
+        const JsonValue* mesh = node->find("mesh");
+        if (mesh) collectMesh(gltf, static_cast<size_t>(mesh->number), transform, out);
+
+        const JsonValue* children = node->find("children");
+        if (children) {
+            for (const JsonValue& child : children->items) collectNode(gltf, static_cast<size_t>(child.number), transform, depth + 1, out);
+        }
+    }
+}
+
+// --- MeshImporter ---
+
+ImportedMesh MeshImporter::load(const std::string& path, unsigned threadCount) {
+    MeshCache::MappedFile file;
+    if (!file.open(path)) {
+        throw std::runtime_error("failed to open mesh file: " + path);
+    }
+
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".obj") return loadObj(reinterpret_cast<const char*>(file.data()), file.size(), threadCount);
+    if (extension == ".glb") return loadGlb(file.data(), file.size(), threadCount);
+    throw std::runtime_error("failed to import mesh: unsupported file format: " + path);
+}
+
+ImportedMesh MeshImporter::loadObj(const char* text, size_t size, unsigned threadCount) {
+    unsigned threads = resolveThreadCount(threadCount);
+    const char* end = text + size;
+
+    // --- 1. Darabolás sorhatáron: szálanként egy darab (kis fájlnál kevesebb) ---
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads, size / MIN_CHUNK_BYTES));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* cursor = text;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char* split = (i + 1 == chunkCount) ? end : std::max(cursor, text + size / chunkCount * (i + 1));
+        if (split < end && split > text && split[-1] != '\n') split = nextLine(split, end);
+        chunks[i].begin = cursor;
+        chunks[i].end = split;
+        cursor = split;
+    }
+
+    // --- 2. Első menet: elemek számlálása darabonként, majd prefix összegek ---
+    parallelFor(chunkCount, threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) countObjChunk(chunks[i]);
+    });
+
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0, triangleCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.firstPosition = positionCount;
+        chunk.firstTexcoord = texcoordCount;
+        chunk.firstNormal = normalCount;
+        chunk.firstTriangle = triangleCount;
+        positionCount += chunk.positions;
+        texcoordCount += chunk.texcoords;
+        normalCount += chunk.normals;
+        triangleCount += chunk.triangles;
+    }
+    if (positionCount == 0 || triangleCount == 0) {
+        throw std::runtime_error("failed to import OBJ: no triangles!");
+    }
+    if (positionCount >= INVALID_INDEX || triangleCount * 3 >= INVALID_INDEX) {
+        throw std::runtime_error("failed to import OBJ: mesh too large for 32 bit indices!");
+    }
+
+    // --- 3. Második menet: párhuzamos parzolás a végleges helyre (egyszer foglalt attribútum tömbök) ---
+    std::unique_ptr<float[]> positions(new float[positionCount * 3]);
+    std::unique_ptr<float[]> texcoords(new float[texcoordCount * 2 + 1]);
+    std::unique_ptr<float[]> normals(new float[normalCount * 3 + 1]);
+    std::vector<uint32_t> corners(triangleCount * 9);
+
+    parallelFor(chunkCount, threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) parseObjChunk(chunks[i], positions.get(), texcoords.get(), normals.get(), corners.data());
+    });
+
+    // --- 4. Egyedi vertexek a (pozíció, UV, normál) hármasokból ---
+    ImportedMesh mesh;
+    buildVertices(positions.get(), positionCount, texcoords.get(), texcoordCount, normals.get(), normalCount,
+                  corners, mesh, threads);
+    return mesh;
+}
+
+void MeshImporter::buildVertices(const float* positions, size_t positionCount, const float* texcoords, size_t texcoordCount,
+                                 const float* normals, size_t normalCount, const std::vector<uint32_t>& corners,
+                                 ImportedMesh& mesh, unsigned threads) {
+    size_t cornerCount = corners.size() / 3;
+
+    // --- 1. Csúcsok száma pozíciónként (és az indexek ellenőrzése) ---
+    std::unique_ptr<std::atomic<uint32_t>[]> cursor(new std::atomic<uint32_t>[positionCount]());
+    std::atomic<bool> invalid{false};
+    parallelFor(cornerCount, threads, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            uint32_t p = corners[c * 3 + 0], t = corners[c * 3 + 1], n = corners[c * 3 + 2];
+            if (p >= positionCount || (t != MISSING_INDEX && t >= texcoordCount) || (n != MISSING_INDEX && n >= normalCount)) {
+                invalid.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            cursor[p].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    if (invalid.load()) {
+        throw std::runtime_error("failed to import mesh: face index out of range!");
+    }
+
+    // --- 2. Pozíciónkénti csoportok (counting sort): kezdőhelyek, majd a csúcsok szétszórása ---
+    std::vector<uint32_t> groupStart(positionCount + 1);
+    uint32_t total = 0;
+    for (size_t p = 0; p < positionCount; p++) {
+        groupStart[p] = total;
+        total += cursor[p].load(std::memory_order_relaxed);
+        cursor[p].store(groupStart[p], std::memory_order_relaxed);
+    }
+    groupStart[positionCount] = total;
+
+    std::vector<uint32_t> groups(cornerCount);
+    parallelFor(cornerCount, threads, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            groups[cursor[corners[c * 3]].fetch_add(1, std::memory_order_relaxed)] = static_cast<uint32_t>(c);
+        }
+    });
+    cursor.reset();
+
+    // --- 3. Csoportonként az azonos (UV, normál) párok összevonása; szálanként egy pozíció tartomány ---
+    // Az indices tömb először a tartományon belüli vertex sorszámot kapja, a tartomány eltolása a 4. lépésben adódik hozzá.
+    mesh.stride = 8;
+    mesh.indices.resize(cornerCount);
+    size_t rangeCount = threads;
+    size_t rangeSize = (positionCount + rangeCount - 1) / rangeCount;
+    std::vector<std::vector<uint32_t>> representatives(rangeCount); // Tartományonként az egyedi vertexek egy-egy csúcsa
+
+    parallelFor(rangeCount, threads, [&](size_t firstRange, size_t lastRange) {
+        for (size_t range = firstRange; range < lastRange; range++) {
+            std::vector<uint32_t>& unique = representatives[range];
+            size_t firstPosition = std::min(positionCount, range * rangeSize);
+            size_t lastPosition = std::min(positionCount, firstPosition + rangeSize);
+            for (size_t p = firstPosition; p < lastPosition; p++) {
+                // A szétszórás sorrendje szálfüggő: rendezés a determinisztikus kimenetért
+                uint32_t* group = groups.data() + groupStart[p];
+                uint32_t* groupEnd = groups.data() + groupStart[p + 1];
+                std::sort(group, groupEnd);
+
+                size_t firstUnique = unique.size();
+                for (uint32_t* it = group; it != groupEnd; ++it) {
+                    uint32_t c = *it;
+                    size_t match = firstUnique;
+                    while (match < unique.size() &&
+                           (corners[unique[match] * 3 + 1] != corners[c * 3 + 1] || corners[unique[match] * 3 + 2] != corners[c * 3 + 2])) {
+                        match++;
+                    }
+                    if (match == unique.size()) unique.push_back(c);
+                    mesh.indices[c] = static_cast<uint32_t>(match);
+                }
+            }
+        }
+    });
+
+    // --- 4. Vertexek kiírása a motor elrendezésében, indexek eltolása ---
+    std::vector<size_t> rangeBase(rangeCount + 1, 0);
+    for (size_t range = 0; range < rangeCount; range++) rangeBase[range + 1] = rangeBase[range] + representatives[range].size();
+    size_t vertexCount = rangeBase[rangeCount];
+
+    mesh.vertices.resize(vertexCount * 8);
+    std::vector<uint8_t> missingNormals(vertexCount, 0);
+    std::atomic<bool> anyMissingNormal{false};
+
+    parallelFor(rangeCount, threads, [&](size_t firstRange, size_t lastRange) {
+        for (size_t range = firstRange; range < lastRange; range++) {
+            const std::vector<uint32_t>& unique = representatives[range];
+            size_t base = rangeBase[range];
+            for (size_t i = 0; i < unique.size(); i++) {
+                uint32_t c = unique[i];
+                uint32_t p = corners[c * 3 + 0], t = corners[c * 3 + 1], n = corners[c * 3 + 2];
+                float* v = &mesh.vertices[(base + i) * 8];
+                std::memcpy(v, positions + size_t(p) * 3, 3 * sizeof(float));
+                if (n != MISSING_INDEX) {
+                    std::memcpy(v + 3, normals + size_t(n) * 3, 3 * sizeof(float));
+                } else {
+                    v[3] = v[4] = v[5] = 0.0f;
+                    missingNormals[base + i] = 1;
+                    anyMissingNormal.store(true, std::memory_order_relaxed);
+                }
+                if (t != MISSING_INDEX) {
+                    v[6] = texcoords[size_t(t) * 2 + 0];
+                    v[7] = texcoords[size_t(t) * 2 + 1];
+                } else {
+                    v[6] = v[7] = 0.0f;
+                }
+            }
+
+            size_t firstPosition = std::min(positionCount, range * rangeSize);
+            size_t lastPosition = std::min(positionCount, firstPosition + rangeSize);
+            for (size_t g = groupStart[firstPosition]; g < groupStart[lastPosition]; g++) {
+                mesh.indices[groups[g]] += static_cast<uint32_t>(base);
+            }
+        }
+    });
+
+    if (anyMissingNormal.load()) computeMissingNormals(mesh, missingNormals);
+}
+
+void MeshImporter::computeMissingNormals(ImportedMesh& mesh, const std::vector<uint8_t>& missing) {
+    const uint32_t stride = mesh.stride;
+    auto position = [&](uint32_t v) {
+        return glm::vec3(mesh.vertices[size_t(v) * stride + 0], mesh.vertices[size_t(v) * stride + 1], mesh.vertices[size_t(v) * stride + 2]);
+    };
+
+    // Háromszög normál (a keresztszorzat hossza a terület kétszerese, így súlyoz is)
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        uint32_t a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+        if (!missing[a] && !missing[b] && !missing[c]) continue;
+        glm::vec3 faceNormal = glm::cross(position(b) - position(a), position(c) - position(a));
+        for (uint32_t v : {a, b, c}) {
+            if (!missing[v]) continue;
+            float* normal = &mesh.vertices[size_t(v) * stride + 3];
+            normal[0] += faceNormal.x;
+            normal[1] += faceNormal.y;
+            normal[2] += faceNormal.z;
+        }
+    }
+
+    size_t vertexCount = mesh.vertexCount();
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (!missing[v]) continue;
+        float* normal = &mesh.vertices[v * stride + 3];
+        glm::vec3 n(normal[0], normal[1], normal[2]);
+        float length = glm::length(n);
+        n = (length > 0.0f) ? n / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        normal[0] = n.x;
+        normal[1] = n.y;
+        normal[2] = n.z;
+    }
+}
+
+ImportedMesh MeshImporter::loadGlb(const uint8_t* data, size_t size, unsigned threadCount) {
+    unsigned threads = resolveThreadCount(threadCount);
+
+    // --- 1. GLB fejléc és chunk-ok: 12 byte fejléc, JSON chunk, opcionális BIN chunk ---
+    if (size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2) {
+        throw std::runtime_error("failed to import glTF: not a binary glTF 2.0 file!");
+    }
+    size_t length = std::min<size_t>(readU32(data + 8), size);
+    size_t jsonLength = readU32(data + 12);
+    if (readU32(data + 16) != GLB_CHUNK_JSON || 20 + jsonLength > length) {
+        throw std::runtime_error("failed to import glTF: missing JSON chunk!");
+    }
+
+    const uint8_t* bin = nullptr;
+    size_t binSize = 0;
+    size_t binHeader = 20 + ((jsonLength + 3) & ~size_t(3));
+    if (binHeader + 8 <= length && readU32(data + binHeader + 4) == GLB_CHUNK_BIN) {
+        binSize = std::min<size_t>(readU32(data + binHeader), length - binHeader - 8);
+        bin = data + binHeader + 8;
+    }
+
+    JsonValue gltf = JsonParser(reinterpret_cast<const char*>(data + 20), jsonLength).parse();
+
+    // --- 2. A jelenet primitívjei a node hierarchia transzformációival ---
+    std::vector<GltfPrimitive> primitives;
+    const JsonValue* scenes = gltf.find("scenes");
+    const JsonValue* scene = scenes ? scenes->at(static_cast<size_t>(gltf.numberOr("scene", 0))) : nullptr;
+    if (scene && scene->find("nodes")) {
+        for (const JsonValue& node : scene->find("nodes")->items) {
+            collectNode(gltf, static_cast<size_t>(node.number), glm::mat4(1.0f), 0, primitives);
+        }
+    } else if (const JsonValue* meshes = gltf.find("meshes")) {
+        // Scene nélküli fájl: minden mesh egyszer, transzformáció nélkül
+        for (size_t i = 0; i < meshes->items.size(); i++) collectMesh(gltf, i, glm::mat4(1.0f), primitives);
+    }
+    if (primitives.empty()) {
+        throw std::runtime_error("failed to import glTF: no triangle primitives!");
+    }
+
+    // --- 3. Méretek és kimeneti helyek; tangensek csak akkor, ha minden primitív tartalmazza őket ---
+    bool allTangents = true;
+    size_t vertexTotal = 0, indexTotal = 0;
+    for (GltfPrimitive& entry : primitives) {
+        const JsonValue& attributes = *entry.primitive->find("attributes");
+        entry.vertexCount = getAccessor(gltf, static_cast<size_t>(attributes.find("POSITION")->number), bin, binSize, 3).count;
+        const JsonValue* indices = entry.primitive->find("indices");
+        entry.indexCount = indices ? getAccessor(gltf, static_cast<size_t>(indices->number), bin, binSize, 1).count : entry.vertexCount;
+        entry.indexCount -= entry.indexCount % 3;
+        entry.firstVertex = vertexTotal;
+        entry.firstIndex = indexTotal;
+        vertexTotal += entry.vertexCount;
+        indexTotal += entry.indexCount;
+        allTangents = allTangents && attributes.has("NORMAL") && attributes.has("TANGENT");
+    }
+    if (vertexTotal >= INVALID_INDEX || indexTotal >= INVALID_INDEX) {
+        throw std::runtime_error("failed to import glTF: mesh too large for 32 bit indices!");
+    }
+
+    ImportedMesh mesh;
+    mesh.stride = allTangents ? 12 : 8;
+    mesh.vertices.resize(vertexTotal * mesh.stride);
+    mesh.indices.resize(indexTotal);
+    std::vector<uint8_t> missingNormals(vertexTotal, 0);
+    bool anyMissingNormal = false;
+    std::atomic<bool> invalid{false};
+
+    // --- 4. Accessorok másolása közvetlenül a végleges (összefésült) helyre, nagy primitíveknél több szálon ---
+    const uint32_t stride = mesh.stride;
+    for (const GltfPrimitive& entry : primitives) {
+        const JsonValue& attributes = *entry.primitive->find("attributes");
+        auto attribute = [&](const char* name, uint32_t minComponents) {
+            const JsonValue* index = attributes.find(name);
+            Accessor accessor;
+            if (index) accessor = getAccessor(gltf, static_cast<size_t>(index->number), bin, binSize, minComponents);
+            if (index && accessor.count < entry.vertexCount) {
+                throw std::runtime_error("failed to import glTF: attribute count mismatch!");
+            }
+            return accessor;
+        };
+        Accessor position = attribute("POSITION", 3);
+        Accessor normal = attribute("NORMAL", 3);
+        Accessor texcoord = attribute("TEXCOORD_0", 2);
+        Accessor tangent = allTangents ? attribute("TANGENT", 4) : Accessor{};
+
+        // Normálok az inverz transzponálttal; tükrözés esetén a körüljárás és a kezesség is fordul
+        glm::mat3 linear(entry.transform);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        bool mirrored = glm::determinant(linear) < 0.0f;
+        if (!normal.data) {
+            std::fill(missingNormals.begin() + entry.firstVertex, missingNormals.begin() + entry.firstVertex + entry.vertexCount, 1);
+            anyMissingNormal = true;
+        }
+
+        unsigned vertexThreads = entry.vertexCount >= PARALLEL_THRESHOLD ? threads : 1;
+        parallelFor(entry.vertexCount, vertexThreads, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                float* v = &mesh.vertices[(entry.firstVertex + i) * stride];
+                glm::vec3 p = glm::vec3(entry.transform * glm::vec4(position.read(i, 0), position.read(i, 1), position.read(i, 2), 1.0f));
+                v[0] = p.x; v[1] = p.y; v[2] = p.z;
+
+                glm::vec3 n(0.0f);
+                if (normal.data) {
+                    n = normalMatrix * glm::vec3(normal.read(i, 0), normal.read(i, 1), normal.read(i, 2));
+                    float nLength = glm::length(n);
+                    n = nLength > 0.0f ? n / nLength : glm::vec3(0.0f, 1.0f, 0.0f);
+                }
+                v[3] = n.x; v[4] = n.y; v[5] = n.z;
+
+                v[6] = texcoord.data ? texcoord.read(i, 0) : 0.0f;
+                v[7] = texcoord.data ? texcoord.read(i, 1) : 0.0f;
+
+                if (stride == 12) {
+                    glm::vec3 t = linear * glm::vec3(tangent.read(i, 0), tangent.read(i, 1), tangent.read(i, 2));
+                    float tLength = glm::length(t);
+                    t = tLength > 0.0f ? t / tLength : glm::vec3(1.0f, 0.0f, 0.0f);
+                    float handedness = tangent.read(i, 3) < 0.0f ? -1.0f : 1.0f;
+                    v[8] = t.x; v[9] = t.y; v[10] = t.z;
+                    v[11] = mirrored ? -handedness : handedness;
+                }
+            }
+        });
+
+        const JsonValue* indicesIndex = entry.primitive->find("indices");
+        Accessor indices = indicesIndex ? getAccessor(gltf, static_cast<size_t>(indicesIndex->number), bin, binSize, 1) : Accessor{};
+        unsigned indexThreads = entry.indexCount >= PARALLEL_THRESHOLD ? threads : 1;
+        parallelFor(entry.indexCount / 3, indexThreads, [&](size_t first, size_t last) {
+            for (size_t triangle = first; triangle < last; triangle++) {
+                uint32_t* out = &mesh.indices[entry.firstIndex + triangle * 3];
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    size_t element = triangle * 3 + (mirrored && corner > 0 ? 3 - corner : corner);
+                    uint32_t index = indices.data ? indices.readIndex(element) : static_cast<uint32_t>(element);
+                    if (index >= entry.vertexCount) {
+                        invalid.store(true, std::memory_order_relaxed);
+                        index = 0;
+                    }
+                    out[corner] = static_cast<uint32_t>(entry.firstVertex) + index;
+                }
+            }
+        });
+    }
+    if (invalid.load()) {
+        throw std::runtime_error("failed to import mesh: face index out of range!");
+    }
+
+    if (anyMissingNormal) computeMissingNormals(mesh, missingNormals);
+    return mesh;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file MeshImporter.h
+ * @brief Többszálú mesh betöltő Wavefront OBJ és bináris glTF 2.0 (.glb) fájlokhoz.
+ * A kimenet közvetlenül a MeshObject által várt vertex elrendezés (Pos(3), Norm(3), UV(2) [, Tangent(4)]),
+ * egyszer lefoglalt tömbökbe írva: nincs köztes, soronként növekvő float lista.
+ *
+ * OBJ: a fájl (memóriába képezve) sorhatáron vágott darabokra oszlik; az első menet darabonként megszámolja
+ * a v / vt / vn sorokat és a háromszögeket, a prefix összegekből minden darab tudja, hova ír,
+ * így a második menet párhuzamosan, a végleges helyükre parzolja az adatokat.
+ * A pozíció/UV/normál index hármasokból pozíciónkénti csoportosítással (szintén párhuzamosan) lesznek egyedi vertexek.
+ *
+ * glTF: a JSON leíró alapján a scene node-jainak primitívjei (TRIANGLES) összefűzve, node transzformációval,
+ * accessoronként közvetlenül a bináris chunk-ból olvasva. Ha minden primitív tartalmaz TANGENT attribútumot,
+ * a kimenet 12 float/vertex, és a MeshObject ezeket használja a tangens számítás helyett.
+ */
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief A betöltött geometria a motor vertex elrendezésében.
+ */
+struct ImportedMesh {
+    std::vector<float> vertices;    // stride float/vertex: Pos(3), Norm(3), UV(2) [, Tangent XYZ + kezesség W]
+    std::vector<uint32_t> indices;  // Háromszög indexek
+    uint32_t stride = 8;            // 8, vagy 12, ha a fájl tangenseket is tartalmaz
+
+    bool hasTangents() const { return stride == 12; }
+    size_t vertexCount() const { return vertices.size() / stride; }
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+class MeshImporter {
+public:
+    // Egy szálra jutó minimális OBJ szövegméret (ennél kisebb fájlt kevesebb szál dolgoz fel)
+    static const size_t MIN_CHUNK_BYTES = 1u << 20;
+
+    // Ennyi vertex / index alatt egy glTF accessor másolásához nem éri meg szálakat indítani
+    static const size_t PARALLEL_THRESHOLD = 65536;
+
+    /**
+     * @brief Fájl betöltése a kiterjesztés alapján (.obj vagy .glb).
+     * @param path A fájl elérési útja.
+     * @param threadCount Szálak száma (0: automatikus, a hardver szálak száma alapján)
+     */
+    static ImportedMesh load(const std::string& path, unsigned threadCount = 0);
+
+    /**
+     * @brief Wavefront OBJ szöveg feldolgozása (v, vt, vn, f sorok; a sokszögek legyező háromszögeléssel).
+     * Negatív (relatív) indexek támogatottak; az UV V koordinátája a Vulkan textúra konvencióra fordul (1 - v).
+     * Hiányzó normálok esetén területtel súlyozott simított normálok, hiányzó UV esetén (0, 0).
+     */
+    static ImportedMesh loadObj(const char* text, size_t size, unsigned threadCount = 0);
+
+    /**
+     * @brief Bináris glTF 2.0 (.glb) feldolgozása: POSITION, NORMAL, TEXCOORD_0, TANGENT és indexek.
+     * A külső (URI-s) és a sparse accessorok nem támogatottak.
+     */
+    static ImportedMesh loadGlb(const uint8_t* data, size_t size, unsigned threadCount = 0);
+
+    // OBJ index hármasban: hiányzó UV / normál, illetve érvénytelen (0 vagy tartományon kívüli relatív) index
+    static const uint32_t MISSING_INDEX = 0xFFFFFFFFu;
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFEu;
+
+private:
+    /**
+     * @brief Pozíció, UV és normál index hármasokból (csúcsonként 3 uint32) egyedi vertexek és háromszög indexek.
+     * A csúcsokat pozíció szerint csoportosítja (counting sort), majd csoporton belül keresi az azonos UV / normál párokat;
+     * a számlálás, a szétszórás és az összevonás is párhuzamos (a kimenet a szálak számától független).
+     */
+    static void buildVertices(const float* positions, size_t positionCount, const float* texcoords, size_t texcoordCount,
+                              const float* normals, size_t normalCount, const std::vector<uint32_t>& corners,
+                              ImportedMesh& mesh, unsigned threads);
+
+    /**
+     * @brief Simított normálok a megjelölt vertexekhez (a szomszédos háromszögek területtel súlyozott normáljaiból).
+     */
+    static void computeMissingNormals(ImportedMesh& mesh, const std::vector<uint8_t>& missing);
+};
@@ -1,69 +1,412 @@
 /**
  * @file MeshObject.cpp
- * @brief 3D objektum kezelése: Tangens számítás és 11 float/vertex (Pos+Norm+UV+Tan) struktúra.
+ * @brief 3D objektum kezelése: Vertex Welding, indexelt geometria, tangens számítás és 11 float/vertex (Pos+Norm+UV+Tan) struktúra.
  */
 #include "MeshObject.h"
 #include <stdexcept>
 #include <cstring>
 #include "vertex_tools.h"
+#include "TangentKernel.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "MeshSimplifier.h"
+#include "MeshCache.h"
+#include "MeshImporter.h"
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <utility>
 
 MeshObject::MeshObject() = default;
 MeshObject::~MeshObject() = default;
 
-void MeshObject::create(VulkanContext* ctx, const std::vector<float>& vertices) {
-    // Kontextus mentése a későbbi buffer műveletekhez
+void MeshObject::create(VulkanContext* ctx, GeometryPool* pool, const std::vector<float>& vertices, VertexFormat format, bool buildMeshlets) {
+    // Vertex Welding: a háromszöglistában többször szereplő azonos vertexek összevonása
+    std::vector<float> uniqueVertices;
+    std::vector<uint32_t> indices;
+    weldVertices(vertices, 8, uniqueVertices, indices);
+
+    create(ctx, pool, std::move(uniqueVertices), std::move(indices), format, buildMeshlets);
+}
+
+void MeshObject::create(VulkanContext* ctx, GeometryPool* pool, std::vector<float> inputVertices, std::vector<uint32_t> inputIndices,
+                        VertexFormat format, bool buildMeshlets, uint32_t inputStride) {
+    // Kontextus és a közös geometria puffer mentése a későbbi buffer műveletekhez
+    this->context = ctx;
+    this->geometryPool = pool;
+
+    GeometryData geometry = buildGeometry(std::move(inputVertices), std::move(inputIndices), format, buildMeshlets, inputStride);
+    uploadGeometry(geometry.vertices.data(), geometry.indices.data(), geometry.meshlets.data(),
+                   static_cast<uint32_t>(geometry.meshlets.size()));
+}
+
+void MeshObject::createCached(VulkanContext* ctx, GeometryPool* pool, const std::string& cacheDirectory, uint64_t sourceKey,
+                              const std::function<void(std::vector<float>&, std::vector<uint32_t>&)>& generator,
+                              VertexFormat format, bool buildMeshlets) {
     this->context = ctx;
+    this->geometryPool = pool;
+
+    // A kulcs a forrás (generátor + paraméterek) mellett a feldolgozás beállításait is tartalmazza
+    uint64_t key = MeshCache::hashValue(static_cast<uint32_t>(format), sourceKey);
+    key = MeshCache::hashValue(buildMeshlets, key);
+    std::string path = MeshCache::pathFor(cacheDirectory, key);
+
+    // --- Meleg indítás: a leképezett fájlból közvetlenül a staging pufferbe (generálás és tangens számítás nélkül) ---
+    if (loadCached(path, key)) return;
+
+    // --- Hideg indítás: generálás, teljes feldolgozás, majd a cache fájl megírása ---
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    generator(vertices, indices);
+    if (indices.empty()) {
+        // Nem indexelt háromszöglista: Vertex Welding
+        std::vector<float> uniqueVertices;
+        weldVertices(vertices, 8, uniqueVertices, indices);
+        vertices = std::move(uniqueVertices);
+    }
+
+    buildCached(path, key, std::move(vertices), std::move(indices), format, buildMeshlets, 8);
+}
+
+void MeshObject::createImported(VulkanContext* ctx, GeometryPool* pool, const std::string& cacheDirectory, const std::string& filePath,
+                                VertexFormat format, bool buildMeshlets) {
+    this->context = ctx;
+    this->geometryPool = pool;
+
+    // A forrás azonosítása: elérési út, méret és módosítási idő (a tartalom hash-elése nagy fájlnál drága lenne)
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(filePath, error);
+    int64_t modified = error ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(filePath, error).time_since_epoch().count());
+    uint64_t key = MeshCache::hash(filePath.data(), filePath.size());
+    key = MeshCache::hashValue(fileSize, key);
+    key = MeshCache::hashValue(modified, key);
+    key = MeshCache::hashValue(static_cast<uint32_t>(format), key);
+    key = MeshCache::hashValue(buildMeshlets, key);
+    std::string path = MeshCache::pathFor(cacheDirectory, key);
+
+    if (!cacheDirectory.empty() && loadCached(path, key)) return;
+
+    ImportedMesh imported = MeshImporter::load(filePath);
+
+    if (cacheDirectory.empty()) {
+        // Az importált vektorok átadódnak (a feldolgozás helyben dolgozik rajtuk), nem másolódnak
+        GeometryData geometry = buildGeometry(std::move(imported.vertices), std::move(imported.indices), format, buildMeshlets,
+                                              imported.stride);
+        uploadGeometry(geometry.vertices.data(), geometry.indices.data(), geometry.meshlets.data(),
+                       static_cast<uint32_t>(geometry.meshlets.size()));
+        return;
+    }
+    buildCached(path, key, std::move(imported.vertices), std::move(imported.indices), format, buildMeshlets, imported.stride);
+}
+
+GeometryPool::Upload MeshObject::beginProcedural(VulkanContext* ctx, GeometryPool* pool, ProceduralGeometry::Size size,
+                                                 const glm::vec3& boundsMin, const glm::vec3& boundsMax, VertexFormat format,
+                                                 glm::vec3& bias, float& scale) {
+    this->context = ctx;
+    this->geometryPool = pool;
+    this->vertexFormat = format;
+
+    vertexCount = size.vertexCount;
+    indexCount = size.indexCount;
+    indexType = (vertexCount > 0xFFFF) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+    lods.assign(1, {0, indexCount, 0.0f, 0, 0});
+
+    // Befoglaló doboz és gömb a generátor analitikus határai alapján, a vertexek bejárása nélkül
+    this->boundsMin = boundsMin;
+    this->boundsMax = boundsMax;
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    boundingSphere = glm::vec4(center, glm::length(boundsMax - center));
+
+    VertexLayout::computeQuantization(boundsMin, boundsMax, bias, scale);
+    if (format == VertexFormat::Compact) {
+        dequantization = glm::scale(glm::translate(glm::mat4(1.0f), bias), glm::vec3(scale));
+    } else {
+        dequantization = glm::mat4(1.0f);
+    }
+
+    uint32_t indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    GeometryPool::Upload upload = pool->reserveUpload(format, vertexCount, VkDeviceSize(indexCount) * indexSize, indexSize);
+    vertexAllocation = upload.vertexAllocation;
+    indexAllocation = upload.indexAllocation;
+    return upload;
+}
+
+bool MeshObject::loadCached(const std::string& path, uint64_t key) {
+    MeshCache::MappedFile file;
+    MeshCache::View view;
+    if (!MeshCache::open(file, path, key, view)) return false;
+
+    const MeshCacheHeader& header = *view.header;
+    vertexFormat = static_cast<VertexFormat>(header.vertexFormat);
+    vertexCount = header.vertexCount;
+    indexCount = header.baseIndexCount;
+    indexType = (header.indexSize == sizeof(uint16_t)) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    boundingSphere = header.boundingSphere;
+    boundsMin = glm::vec3(header.boundsMin);
+    boundsMax = glm::vec3(header.boundsMax);
+    dequantization = header.dequantization;
+    lods.assign(view.lods, view.lods + header.lodCount);
+
+    uploadGeometry(view.vertexData, view.indexData, view.meshlets, header.meshletCount);
+    return true;
+}
+
+void MeshObject::buildCached(const std::string& path, uint64_t key, std::vector<float> vertices,
+                             std::vector<uint32_t> indices, VertexFormat format, bool buildMeshlets, uint32_t inputStride) {
+    GeometryData geometry = buildGeometry(std::move(vertices), std::move(indices), format, buildMeshlets, inputStride);
+
+    MeshCacheHeader header{};
+    header.key = key;
+    header.vertexFormat = static_cast<uint32_t>(vertexFormat);
+    header.vertexStride = geometry.vertexStride;
+    header.vertexCount = vertexCount;
+    header.indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    header.indexCount = static_cast<uint32_t>(geometry.indices.size() / header.indexSize);
+    header.baseIndexCount = indexCount;
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    header.meshletCount = static_cast<uint32_t>(geometry.meshlets.size());
+    header.boundingSphere = boundingSphere;
+    header.boundsMin = glm::vec4(geometry.boundsMin, 0.0f);
+    header.boundsMax = glm::vec4(geometry.boundsMax, 0.0f);
+    header.dequantization = dequantization;
+
+    // Sikertelen írás (pl. írásvédett könyvtár) nem hiba: a következő indítás újra előállítja
+    MeshCache::write(path, header, geometry.vertices.data(), geometry.indices.data(), lods.data(), geometry.meshlets.data());
+
+    uploadGeometry(geometry.vertices.data(), geometry.indices.data(), geometry.meshlets.data(),
+                   static_cast<uint32_t>(geometry.meshlets.size()));
+}
+
+MeshObject::GeometryData MeshObject::buildGeometry(std::vector<float> vertices, std::vector<uint32_t> indices,
+                                                   VertexFormat format, bool buildMeshlets, uint32_t inputStride) {
+    this->vertexFormat = format;
+    GeometryData geometry;
+
+    // --- 0. Lépés: Háromszög és vertex sorrend optimalizálása ---
+    // Vertex cache (Tipsify) -> overdraw (kifelé néző klaszterek előre) -> vertex fetch (első használat sorrendje)
+    MeshOptimizer::optimize(vertices, inputStride, indices);
 
     // --- 1. Lépés: Tangensek kiszámítása és adatstruktúra konverzió ---
     // Az eredeti bemenet 8 float/vertex: Position(3), Normal(3), TexCoord(2)
     // A cél 11 float/vertex: Position(3), Normal(3), TexCoord(2), Tangent(3)
-    std::vector<float> newVertices;
-
-    if (!vertices.empty()) {
-        // Memória előfoglalása a teljesítmény érdekében: (eredeti elemszám / 8) * 11
-        newVertices.reserve((vertices.size() / 8) * 11);
+    // Indexelt geometriánál egy vertexen több háromszög osztozik, ezért a tangenseket vertexenként átlagoljuk.
+    // A számítás SIMD kernellel, nagy mesh-eknél több szálon fut (lásd TangentKernel).
+    // Importált modellnél (12 float/vertex) a fájl tangenseit használjuk, és a vertexeket 8 floatra szűkítjük.
+    std::vector<glm::vec4> tangents;
+    if (inputStride >= 12) {
+        size_t count = vertices.size() / inputStride;
+        tangents.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            const float* v = &vertices[i * inputStride];
+            tangents[i] = glm::vec4(v[8], v[9], v[10], v[11]);
+            std::copy(v, v + 8, &vertices[i * 8]);
+        }
+        vertices.resize(count * 8);
+    } else {
+        tangents = TangentKernel::computeVertexTangents(vertices, 8, indices);
     }
 
-    // Vertexek száma az eredeti tömb alapján
-    int vertexCountInput = static_cast<int>(vertices.size() / 8);
+    size_t vertexCountInput = vertices.size() / 8;
+
+    // --- 1/b. Lépés: LOD lánc (QEM egyszerűsítés) ugyanazon a vertex pufferen ---
+    // A szintek index listái egymás után kerülnek az index pufferbe; a LOD 0 a teljes részletesség.
+    computeBoundingSphere(vertices);
+    std::vector<uint32_t> lodIndices = buildLodChain(vertices, indices);
 
-    // Háromszögenként iterálunk (3 vertex alkot egy primitívet) a tangens számításához
-    for (int i = 0; i < vertexCountInput; i += 3) {
-        // Vertex 1 adatok (Pozíció és UV koordináta a tangenshez elengedhetetlen)
-        glm::vec3 v1(vertices[(i+0)*8 + 0], vertices[(i+0)*8 + 1], vertices[(i+0)*8 + 2]);
-        glm::vec2 uv1(vertices[(i+0)*8 + 6], vertices[(i+0)*8 + 7]);
+    geometry.boundsMin = geometry.boundsMax = glm::vec3(0.0f);
+    for (size_t i = 0; i < vertexCountInput; i++) {
+        glm::vec3 p(vertices[i * 8 + 0], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+        geometry.boundsMin = (i == 0) ? p : glm::min(geometry.boundsMin, p);
+        geometry.boundsMax = (i == 0) ? p : glm::max(geometry.boundsMax, p);
+    }
+    boundsMin = geometry.boundsMin;
+    boundsMax = geometry.boundsMax;
 
-        // Vertex 2 adatok
-        glm::vec3 v2(vertices[(i+1)*8 + 0], vertices[(i+1)*8 + 1], vertices[(i+1)*8 + 2]);
-        glm::vec2 uv2(vertices[(i+1)*8 + 6], vertices[(i+1)*8 + 7]);
+    // A GPU felé küldendő vertexek és indexek száma
+    this->vertexCount = static_cast<uint32_t>(vertexCountInput);
+    this->indexCount = static_cast<uint32_t>(indices.size());
 
-        // Vertex 3 adatok
-        glm::vec3 v3(vertices[(i+2)*8 + 0], vertices[(i+2)*8 + 1], vertices[(i+2)*8 + 2]);
-        glm::vec2 uv3(vertices[(i+2)*8 + 6], vertices[(i+2)*8 + 7]);
+    // --- 2. Lépés: Végleges (GPU) vertex formátum, két folyamban (pozíciók, majd a többi attribútum) ---
+    geometry.vertices = encodeVertices(vertices, tangents, format);
+    geometry.vertexStride = VertexLayout::getStride(format);
 
-        // Tangens vektor kiszámítása a háromszög síkja és az UV tér eltolódása alapján
-        glm::vec3 tangent = calculateTangent(v1, v2, v3, uv1, uv2, uv3);
+    // Index adatok: 16 bites indexek, ha a vertexek száma belefér (fele akkora terület).
+    // Meshletes mesh-nél mindig 32 bites, mert a culling compute shader storage pufferként olvassa.
+    if (buildMeshlets || vertexCount > 0xFFFF) {
+        indexType = VK_INDEX_TYPE_UINT32;
+        geometry.indices.resize(lodIndices.size() * sizeof(uint32_t));
+        memcpy(geometry.indices.data(), lodIndices.data(), geometry.indices.size());
+    } else {
+        indexType = VK_INDEX_TYPE_UINT16;
+        std::vector<uint16_t> shortIndices(lodIndices.begin(), lodIndices.end());
+        geometry.indices.resize(shortIndices.size() * sizeof(uint16_t));
+        memcpy(geometry.indices.data(), shortIndices.data(), geometry.indices.size());
+    }
 
-        // Az új, bővített vertex puffer feltöltése
-        for (int k = 0; k < 3; k++) {
-            // Első 8 float (Pos, Norm, UV) másolása változtatás nélkül
-            for (int j = 0; j < 8; j++) {
-                newVertices.push_back(vertices[(i+k)*8 + j]);
+    // --- 3. Lépés: Meshletek (opcionális) a GPU-s klaszter cullinghoz ---
+    // LOD szintenként külön meshletek; az indexOffset a mesh (összefűzött) index listájára mutat
+    if (buildMeshlets) {
+        std::vector<Meshlet>& meshlets = geometry.meshlets;
+        for (LodLevel& lod : lods) {
+            std::vector<uint32_t> levelIndices(lodIndices.begin() + lod.firstIndex,
+                                               lodIndices.begin() + lod.firstIndex + lod.indexCount);
+            std::vector<Meshlet> levelMeshlets = MeshletBuilder::build(vertices, 8, levelIndices);
+            lod.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+            lod.meshletCount = static_cast<uint32_t>(levelMeshlets.size());
+            for (Meshlet& meshlet : levelMeshlets) {
+                meshlet.indexOffset += lod.firstIndex;
+                meshlets.push_back(meshlet);
             }
-            // A frissen számított tangens (X, Y, Z) hozzáadása minden vertexhez a háromszögben
-            newVertices.push_back(tangent.x);
-            newVertices.push_back(tangent.y);
-            newVertices.push_back(tangent.z);
+        }
+
+        // A culling a vertex puffer terében történik (a model mátrix ezt képezi a világba),
+        // ezért Compact formátumnál a határoló gömböket is a kvantált térbe visszük.
+        // A kúpokat az egységes skála nem változtatja meg.
+        glm::mat4 toBufferSpace = glm::inverse(dequantization);
+        float radiusScale = 1.0f / dequantization[0][0];
+        float quantizationError = (format == VertexFormat::Compact) ? std::sqrt(3.0f) / 32767.0f : 0.0f;
+        for (Meshlet& meshlet : meshlets) {
+            glm::vec4 center = toBufferSpace * glm::vec4(glm::vec3(meshlet.sphere), 1.0f);
+            meshlet.sphere = glm::vec4(glm::vec3(center), meshlet.sphere.w * radiusScale + quantizationError);
         }
     }
 
-    // A GPU felé küldendő vertexek száma (már a 11-es stride-dal számolva)
-    this->vertexCount = static_cast<uint32_t>(newVertices.size() / 11);
-    VkDeviceSize bufferSize = newVertices.size() * sizeof(float);
+    return geometry;
+}
 
-    // --- 2. Lépés: Vulkan erőforrások kezelése ---
+void MeshObject::uploadGeometry(const void* vertexData, const void* indexData, const Meshlet* meshlets, uint32_t meshletTotal) {
+    // Feltöltés a közös geometria pufferbe (saját VkBuffer / VkDeviceMemory nélkül)
+    uint32_t indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    uint32_t totalIndexCount = lods.back().firstIndex + lods.back().indexCount;
+
+    // A pozíció folyam után közvetlenül az attribútum folyam következik
+    const uint8_t* positionData = static_cast<const uint8_t*>(vertexData);
+    const uint8_t* attributeData = positionData + VkDeviceSize(vertexCount) * VertexLayout::getPositionStride(vertexFormat);
+    vertexAllocation = geometryPool->allocateVertices(vertexFormat, positionData, attributeData, vertexCount);
+    indexAllocation = geometryPool->allocateIndices(indexData, VkDeviceSize(totalIndexCount) * indexSize, indexSize);
+
+    if (meshletTotal > 0) {
+        meshletCount = meshletTotal;
+        uploadBuffer(meshlets, meshletTotal * sizeof(Meshlet), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, meshletBuffer, meshletBufferMemory);
+    }
+}
+
+void MeshObject::computeBoundingSphere(const std::vector<float>& vertices) {
+    size_t count = vertices.size() / 8;
+    if (count == 0) {
+        boundingSphere = glm::vec4(0.0f);
+        return;
+    }
+
+    // Befoglaló doboz középpontja, sugár a legtávolabbi vertexig
+    glm::vec3 minPos(vertices[0], vertices[1], vertices[2]);
+    glm::vec3 maxPos = minPos;
+    for (size_t i = 1; i < count; i++) {
+        glm::vec3 p(vertices[i * 8 + 0], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+        minPos = glm::min(minPos, p);
+        maxPos = glm::max(maxPos, p);
+    }
+    glm::vec3 center = (minPos + maxPos) * 0.5f;
+    float radius = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        radius = std::max(radius, glm::length(glm::vec3(vertices[i * 8 + 0], vertices[i * 8 + 1], vertices[i * 8 + 2]) - center));
+    }
+    boundingSphere = glm::vec4(center, radius);
+}
+
+std::vector<uint32_t> MeshObject::buildLodChain(const std::vector<float>& vertices, const std::vector<uint32_t>& indices) {
+    lods.clear();
+    lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f, 0, 0});
+
+    std::vector<uint32_t> allIndices = indices;
+    std::vector<uint32_t> previous = indices;
+    float accumulatedError = 0.0f;
+
+    // Minden szint az előző felére egyszerűsít; az egy lépésben megengedett hiba a mesh méretéhez arányos
+    float maxStepError = boundingSphere.w * LOD_MAX_ERROR_RATIO;
+
+    while (lods.size() < MAX_LOD_LEVELS && previous.size() / 3 >= LOD_MIN_TRIANGLES * 2) {
+        float stepError = 0.0f;
+        std::vector<uint32_t> simplified = MeshSimplifier::simplify(vertices, 8, previous, previous.size() / 2, maxStepError, &stepError);
+
+        // Ha alig sikerült csökkenteni (rögzített varratok, hibahatár), nincs értelme újabb szintnek
+        if (simplified.size() > previous.size() * 3 / 4) break;
+
+        simplified = MeshOptimizer::optimizeVertexCache(simplified, vertices.size() / 8);
+
+        // Az egyes lépések hibái összeadódnak (felső becslés az eredeti felülettől való eltérésre)
+        accumulatedError += stepError;
+        lods.push_back({static_cast<uint32_t>(allIndices.size()), static_cast<uint32_t>(simplified.size()), accumulatedError, 0, 0});
+        allIndices.insert(allIndices.end(), simplified.begin(), simplified.end());
+        previous = std::move(simplified);
+    }
+
+    return allIndices;
+}
+
+uint32_t MeshObject::selectLod(const LodSelection& selection, float animationTime) const {
+    if (lods.size() <= 1) return 0;
+
+    // Világbeli hiba -> pixel: a világ mátrix egységes skálájú (forgatás + eltolás), így a mesh hiba világbeli hiba
+    float pixelsPerUnit = selection.projectionScale;
+    if (!selection.orthographic) {
+        glm::vec3 center = glm::vec3(getWorldMatrix(animationTime) * glm::vec4(glm::vec3(boundingSphere), 1.0f));
+        float distance = glm::length(center - selection.viewerPosition) - boundingSphere.w;
+        pixelsPerUnit /= std::max(distance, 1e-3f);
+    }
+
+    // A legdurvább szint, amelynek vetített hibája még a küszöb alatt van
+    for (uint32_t lod = static_cast<uint32_t>(lods.size()) - 1; lod > 0; lod--) {
+        if (lods[lod].error * pixelsPerUnit <= selection.maxPixelError) return lod;
+    }
+    return 0;
+}
+
+std::vector<uint8_t> MeshObject::encodeVertices(const std::vector<float>& vertices, const std::vector<glm::vec4>& tangents,
+                                                VertexFormat format) {
+    size_t count = vertices.size() / 8;
+    std::vector<uint8_t> result(count * VertexLayout::getStride(format));
+    uint8_t* positionData = result.data();
+    uint8_t* attributeData = result.data() + count * VertexLayout::getPositionStride(format);
+
+    if (format == VertexFormat::Full) {
+        dequantization = glm::mat4(1.0f);
+        float* positions = reinterpret_cast<float*>(positionData);
+        float* attributes = reinterpret_cast<float*>(attributeData);
+        for (size_t i = 0; i < count; i++) {
+            const float* v = &vertices[i * 8];
+            VertexLayout::encodeFull(glm::vec3(v[0], v[1], v[2]), glm::vec3(v[3], v[4], v[5]), glm::vec2(v[6], v[7]), tangents[i],
+                                     positions + i * 3, attributes + i * 8);
+        }
+        return result;
+    }
+
+    // Befoglaló doboz: a középpontja lesz az eltolás, a legnagyobb fél-kiterjedése az egységes skála
+    glm::vec3 minPos(0.0f), maxPos(0.0f);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 p(vertices[i * 8 + 0], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+        minPos = (i == 0) ? p : glm::min(minPos, p);
+        maxPos = (i == 0) ? p : glm::max(maxPos, p);
+    }
+    glm::vec3 bias;
+    float scale;
+    VertexLayout::computeQuantization(minPos, maxPos, bias, scale);
+
+    dequantization = glm::scale(glm::translate(glm::mat4(1.0f), bias), glm::vec3(scale));
+
+    CompactPosition* positions = reinterpret_cast<CompactPosition*>(positionData);
+    CompactAttributes* attributes = reinterpret_cast<CompactAttributes*>(attributeData);
+    for (size_t i = 0; i < count; i++) {
+        const float* v = &vertices[i * 8];
+        VertexLayout::encodeCompact(glm::vec3(v[0], v[1], v[2]), glm::normalize(glm::vec3(v[3], v[4], v[5])),
+                                    glm::vec2(v[6], v[7]), tangents[i], bias, scale, positions[i], attributes[i]);
+    }
+
+    return result;
+}
+
+void MeshObject::uploadBuffer(const void* sourceData, VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& memory) {
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
 
@@ -79,33 +422,66 @@ void MeshObject::create(VulkanContext* ctx, const std::vector<float>& vertices)
     // Adatok feltöltése a staging bufferbe
     void* data;
     vkMapMemory(context->getDevice(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, newVertices.data(), (size_t)bufferSize);
+    memcpy(data, sourceData, (size_t)bufferSize);
     vkUnmapMemory(context->getDevice(), stagingBufferMemory);
 
-    // Végleges Vertex Buffer létrehozása: Csak a GPU számára elérhető (gyors) memória
+    // Végleges buffer létrehozása: Csak a GPU számára elérhető (gyors) memória
     context->createBuffer(
         bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        vertexBuffer,
-        vertexBufferMemory
+        buffer,
+        memory
     );
 
-    // Adatátvitel: Staging Buffer -> Végleges Vertex Buffer
-    context->copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+    // Adatátvitel: Staging Buffer -> Végleges Buffer
+    context->copyBuffer(stagingBuffer, buffer, bufferSize);
 
     // Staging buffer felszabadítása (már nincs rá szükség a másolás után)
     vkDestroyBuffer(context->getDevice(), stagingBuffer, nullptr);
     vkFreeMemory(context->getDevice(), stagingBufferMemory, nullptr);
 }
 
+void MeshObject::createInstanceOf(const MeshObject& source) {
+    context = source.context;
+    geometryPool = source.geometryPool;
+    vertexAllocation = source.vertexAllocation;
+    indexAllocation = source.indexAllocation;
+    sharedGeometry = true;
+
+    vertexCount = source.vertexCount;
+    indexCount = source.indexCount;
+    indexType = source.indexType;
+    vertexFormat = source.vertexFormat;
+    lods = source.lods;
+    boundingSphere = source.boundingSphere;
+    boundsMin = source.boundsMin;
+    boundsMax = source.boundsMax;
+    dequantization = source.dequantization;
+    textureDescriptorSet = source.textureDescriptorSet;
+
+    // A meshlet culling kimenetei objektumonkéntiek, így a példányok a teljes LOD szintet rajzolják
+    meshletBuffer = VK_NULL_HANDLE;
+    meshletCount = 0;
+}
+
 void MeshObject::cleanup(VkDevice device) {
+    if (sharedGeometry) return;
+
+    // A közös pufferben foglalt terület visszaadása (a szomszédos szabad blokkokkal összevonódik)
+    if (geometryPool != nullptr) {
+        geometryPool->freeVertices(vertexFormat, vertexAllocation);
+        geometryPool->freeIndices(indexAllocation);
+        vertexAllocation = GeometryPool::INVALID_HANDLE;
+        indexAllocation = GeometryPool::INVALID_HANDLE;
+    }
+
     // GPU erőforrások biztonságos törlése
-    if (vertexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
+    if (meshletBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, meshletBuffer, nullptr);
     }
-    if (vertexBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
+    if (meshletBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, meshletBufferMemory, nullptr);
     }
 }
 
@@ -113,21 +489,7 @@ void MeshObject::setTexture(VkDescriptorSet descSet) {
     this->textureDescriptorSet = descSet;
 }
 
-// Push Constant struktúra: Illeszkednie kell a shaderben definiált layout-hoz (128 byte)
-struct ObjectPushConstants {
-    glm::mat4 model; // Model-világ mátrix (64 byte)
-    glm::mat4 mvp;   // Model-View-Projection mátrix (64 byte)
-};
-
-void MeshObject::draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, glm::mat4 viewProjection, float animationTime) const {
-    if (vertexCount == 0) return;
-
-    // Vertex puffer bekötése a pipeline-ba
-    VkBuffer vertexBuffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-
-    // --- 1. Transzformációs mátrixok összeállítása ---
+glm::mat4 MeshObject::getWorldMatrix(float animationTime) const {
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, position);
 
@@ -135,37 +497,46 @@ void MeshObject::draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLa
     if (rotationSpeed != 0.0f) {
         model = glm::rotate(model, glm::radians(rotationSpeed * animationTime), rotationAxis);
     }
+    return model;
+}
 
-    // Teljes MVP mátrix kiszámítása
-    glm::mat4 mvp = viewProjection * model;
+void MeshObject::getWorldBounds(float animationTime, glm::vec3& center, glm::vec3& extent) const {
+    glm::mat4 world = getWorldMatrix(animationTime);
 
-    // --- 2. Push Constants küldése a GPU-nak ---
-    ObjectPushConstants pushs{};
-    pushs.model = model;
-    pushs.mvp = mvp;
+    // Elforgatott doboz befoglalója: a fél-kiterjedés a forgatás abszolút értékével szorozva
+    glm::mat3 absRotation = glm::mat3(glm::abs(glm::vec3(world[0])), glm::abs(glm::vec3(world[1])), glm::abs(glm::vec3(world[2])));
+    center = glm::vec3(world * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+    extent = absRotation * ((boundsMax - boundsMin) * 0.5f);
+}
 
-    vkCmdPushConstants(
-        commandBuffer,
-        pipelineLayout,
-        VK_SHADER_STAGE_VERTEX_BIT,
-        0,
-        sizeof(ObjectPushConstants),
-        &pushs
-    );
+glm::mat4 MeshObject::getModelMatrix(float animationTime) const {
+    // Kvantált pozíciók visszaalakítása (Full formátumnál egységmátrix)
+    return getWorldMatrix(animationTime) * dequantization;
+}
 
-    // --- 3. Textúra (Descriptor Set) bekötése ---
-    if (textureDescriptorSet != VK_NULL_HANDLE) {
-        vkCmdBindDescriptorSets(
-            commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            pipelineLayout,
-            0, // Descriptor set index (Set 0)
-            1,
-            &textureDescriptorSet,
-            0, nullptr
-        );
-    }
-
-    // --- 4. Rajzolási parancs kiadása ---
-    vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+int32_t MeshObject::getVertexOffset() const {
+    return geometryPool->getVertexOffset(vertexFormat, vertexAllocation);
+}
+
+uint32_t MeshObject::getFirstIndex() const {
+    return geometryPool->getFirstIndex(indexAllocation);
+}
+
+void MeshObject::draw(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t firstInstance,
+                      uint32_t instanceCount, VkBuffer indirectCommandBuffer) const {
+    if (indexCount == 0 || instanceCount == 0) return;
+
+    // A vertex és index puffert és a textúrát a hívó köti be (a renderer állapot követése csak változáskor),
+    // a model mátrixok a példány pufferben vannak (gl_InstanceIndex = firstInstance + példány)
+
+    // Rajzolási parancs kiadása (indexelt, a post-transform cache kihasználásával)
+    // Meshlet culling esetén az index számot és a firstInstance-t a culling pass írta az indirekt parancsba
+    if (indirectCommandBuffer != VK_NULL_HANDLE) {
+        vkCmdDrawIndexedIndirect(commandBuffer, indirectCommandBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        // A mesh helye a közös pufferben: firstIndex az index területre, vertexOffset a vertex területre mutat
+        const LodLevel& level = lods[std::min<size_t>(lod, lods.size() - 1)];
+        vkCmdDrawIndexed(commandBuffer, level.indexCount, instanceCount, getFirstIndex() + level.firstIndex, getVertexOffset(),
+                         firstInstance);
+    }
 }
\ No newline at end of file
@@ -1,17 +1,49 @@
 /**
  * @file MeshObject.h
  * @brief Egyedi 3D objektum reprezentációja Vulkan alatt.
- * Tartalmazza a transzformációs adatokat és a GPU-oldali vertex buffer referenciákat.
+ * Tartalmazza a transzformációs adatokat és a GPU-oldali vertex/index buffer referenciákat.
  */
 #pragma once
 
 #include "VulkanContext.h"
+#include "VertexFormat.h"
+#include "GeometryPool.h"
+#include "Meshlet.h"
+#include "ProceduralGeometry.h"
 #include <vector>
+#include <string>
+#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+/**
+ * @brief A LOD választás paraméterei egy nézőponthoz (kamera vagy fény).
+ */
+struct LodSelection {
+    glm::vec3 viewerPosition = glm::vec3(0.0f); // Perspektív vetítésnél a nézőpont (világtér)
+    float projectionScale = 1.0f;   // Perspektív: viewportHeight / (2 * tan(fovY / 2)); ortografikus: pixel / világ egység
+    bool orthographic = false;      // Ortografikus vetítésnél a vetített hiba nem függ a távolságtól
+    float maxPixelError = 1.0f;     // A megengedett vetített hiba pixelben
+};
+
 class MeshObject {
 public:
+    // LOD szintek: a teljes részletesség + legfeljebb 4 egyszerűsített szint
+    static const uint32_t MAX_LOD_LEVELS = 5;
+    static const uint32_t LOD_MIN_TRIANGLES = 32;          // Ennél kevesebb háromszögre nem egyszerűsítünk
+    static constexpr float LOD_MAX_ERROR_RATIO = 0.05f;    // Egy lépés max. hibája a befoglaló gömb sugarához képest
+
+    /**
+     * @brief Egy LOD szint helye az index pufferben (és a meshlet pufferben).
+     */
+    struct LodLevel {
+        uint32_t firstIndex;    // Az első index helye a mesh index területén belül
+        uint32_t indexCount;
+        float error;            // Geometriai hiba a teljes részletességhez képest (mesh egységben)
+        uint32_t firstMeshlet;  // Meshlet culling esetén a szint meshletjei
+        uint32_t meshletCount;
+    };
+
     MeshObject();
     ~MeshObject();
 
@@ -22,27 +54,149 @@ public:
     void setTexture(VkDescriptorSet descSet);
 
     /**
-     * @brief Inicializálja a vertex puffert.
-     * Kiszámítja a tangenseket, így a bemeneti 8 float/vertex adatot 11 float/vertexre bővíti.
+     * @brief Inicializálja a vertex és index adatokat nem indexelt (háromszöglista) bemenetből.
+     * Az azonos vertexeket összevonja (Vertex Welding), majd az indexelt változatot hívja.
+     * @param context A Vulkan környezet (buffer létrehozáshoz és másoláshoz).
+     * @param geometryPool A közös vertex/index puffer, amelyből a mesh területet foglal.
+     * @param vertices Eredeti vertex adatok (Pos, Norm, UV), 3 vertex háromszögenként.
+     * @param format A GPU-ra feltöltött vertex formátum (Full vagy Compact).
+     * @param buildMeshlets Meshletekre bontás a GPU-s klaszter cullinghoz (lásd MeshletCuller).
+     */
+    void create(VulkanContext* context, GeometryPool* geometryPool, const std::vector<float>& vertices,
+                VertexFormat format = VertexFormat::Full, bool buildMeshlets = false);
+
+    /**
+     * @brief Inicializálja a vertex és index adatokat indexelt bemenetből (a közös geometria pufferben).
+     * A háromszögeket és vertexeket először átrendezi (MeshOptimizer: vertex cache, overdraw, vertex fetch),
+     * és kiírja az ACMR/ATVR értékeket előtte és utána.
+     * Ezután kiszámítja a vertexenkénti tangenseket, majd a kért formátumba kódolja a vertexeket
+     * (Full: 11 float/vertex, Compact: 20 byte/vertex kvantált pozícióval és oktaéder normállal).
+     * Az indexek 16 bitesek, ha a vertexek száma belefér, különben 32 bitesek.
      * @param context A Vulkan környezet (buffer létrehozáshoz és másoláshoz).
-     * @param vertices Eredeti vertex adatok (Pos, Norm, UV).
+     * @param geometryPool A közös vertex/index puffer, amelyből a mesh területet foglal.
+     * @param vertices Egyedi vertex adatok (Pos, Norm, UV). Érték szerint, mert a feldolgozás helyben átrendezi:
+     * std::move-val átadva nincs másolás.
+     * @param indices Háromszög indexek (3 index háromszögenként), ugyanígy.
+     * @param format A GPU-ra feltöltött vertex formátum (Full vagy Compact).
+     * @param buildMeshlets Meshletekre bontás (max. 64 vertex / 124 háromszög, befoglaló gömb és normálkúp).
+     * Ekkor az indexek mindig 32 bitesek, mert a culling compute shader is olvassa.
+     * @param inputStride A bemenet float/vertex értéke: 8, vagy 12, ha a vertexek már tartalmaznak tangenst
+     * (XYZ + kezesség, pl. MeshImporter glTF). Ekkor a tangens számítás kimarad.
+     */
+    void create(VulkanContext* context, GeometryPool* geometryPool, std::vector<float> vertices,
+                std::vector<uint32_t> indices, VertexFormat format = VertexFormat::Full, bool buildMeshlets = false,
+                uint32_t inputStride = 8);
+
+    /**
+     * @brief Mint a create, de a feldolgozott geometriát a bináris mesh cache-ből tölti, ha van érvényes fájl.
+     * Találat esetén a generátor, az optimalizálás és a tangens számítás nem fut: a fájl memóriába képezve
+     * (mmap) közvetlenül a staging pufferbe másolódik. Hiány esetén generál, feldolgoz, és megírja a fájlt.
+     * @param cacheDirectory A cache fájlok könyvtára (szükség esetén létrejön).
+     * @param sourceKey A forrás hash-e (generátor neve és paraméterei, vagy a forrás fájl tartalma; lásd MeshCache::hash).
+     * A vertex formátum és a meshlet beállítás automatikusan a kulcs része.
+     * @param generator A forrás adatok előállítása (8 float/vertex); üres index lista esetén háromszöglistaként kezeli.
+     */
+    void createCached(VulkanContext* context, GeometryPool* geometryPool, const std::string& cacheDirectory, uint64_t sourceKey,
+                      const std::function<void(std::vector<float>& vertices, std::vector<uint32_t>& indices)>& generator,
+                      VertexFormat format = VertexFormat::Full, bool buildMeshlets = false);
+
+    /**
+     * @brief Modell fájl (.obj / .glb) betöltése MeshImporter-rel, a feldolgozott eredmény a mesh cache-be kerül.
+     * A cache kulcs a fájl elérési útja, mérete és módosítási ideje; a fájl változásakor újra importál.
+     * Ha a fájl tangenseket is tartalmaz (glTF TANGENT), azokat használja a tangens számítás helyett.
+     * @param cacheDirectory A cache fájlok könyvtára; üres esetén nincs cache (minden indításkor importál).
+     * @param filePath A modell fájl.
+     */
+    void createImported(VulkanContext* context, GeometryPool* geometryPool, const std::string& cacheDirectory,
+                        const std::string& filePath, VertexFormat format = VertexFormat::Full, bool buildMeshlets = false);
+
+    /**
+     * @brief Paraméteres primitív létrehozása generátorból (lásd ProceduralGeometry.h), köztes másolatok nélkül.
+     * A generátor a pontos méreteket és a befoglaló dobozt előre megadja, így a terület a GeometryPool-ban
+     * lefoglalható, és a vertexek / indexek közvetlenül a leképezett staging memóriába íródnak a végleges formátumban.
+     * Nincs optimalizálás, LOD lánc és meshlet (a generátor kimenete eleve rendezett); ezekhez a create / createCached kell.
+     * A feltöltést a hívó indítja el a geometryPool->flushUploads() hívással (sok primitív után egyszer), a rajzolás előtt.
+     * @param generator Pl. TorusGenerator, BoxGenerator, PyramidGenerator, PlaneGenerator.
+     */
+    template <typename Generator>
+    void createProcedural(VulkanContext* context, GeometryPool* geometryPool, const Generator& generator,
+                          VertexFormat format = VertexFormat::Full) {
+        ProceduralGeometry::Size size = generator.size();
+        glm::vec3 boundsMin, boundsMax, bias;
+        float scale;
+        generator.bounds(boundsMin, boundsMax);
+        GeometryPool::Upload upload = beginProcedural(context, geometryPool, size, boundsMin, boundsMax, format, bias, scale);
+        ProceduralGeometry::write(generator, format, bias, scale, upload.positionData, upload.attributeData, indexType, upload.indexData);
+    }
+
+    /**
+     * @brief Újabb példány egy már létrehozott mesh geometriájából és textúrájából (nincs új foglalás a GeometryPool-ban).
+     * Az azonos geometriájú és textúrájú objektumokat a renderer egyetlen instanced rajzolással küldi el.
+     * A példány nem használ meshlet cullingot (a meshlet kimenetek objektumonkéntiek), a LOD láncot viszont igen.
+     * A forrásnak a példány teljes élettartama alatt élnie kell; a példány cleanup-ja nem szabadít fel semmit.
+     * @param source A geometriát birtokló objektum.
      */
-    void create(VulkanContext* context, const std::vector<float>& vertices);
+    void createInstanceOf(const MeshObject& source);
 
     /**
-     * @brief Felszabadítja a GPU memóriát (Vertex Buffer és Memory).
+     * @brief Visszaadja a közös pufferben foglalt területet és felszabadítja a saját GPU erőforrásokat (meshletek).
      * @param device A logikai eszköz, amihez az erőforrások tartoznak.
      */
     void cleanup(VkDevice device);
 
     /**
      * @brief Rögzíti a rajzolási parancsokat a parancspufferbe.
+     * A vertex és index puffert és a textúrát (Set 0, getTexture) a hívó köti be, hogy az azonos állapotú rajzolások
+     * között ne ismétlődjön: a közös geometria puffert (indexType típussal), meshlet culling esetén a culling kimenetét (32 bit).
+     * A model mátrixokat a renderer írja a példány pufferbe, a shader a gl_InstanceIndex alapján olvassa;
+     * a View * Projection push constant a pass elején kerül be.
      * @param commandBuffer Aktuális Vulkan Command Buffer.
-     * @param pipelineLayout A használt pipeline elrendezése (Push Constants és Descriptor kérésekhez).
-     * @param viewProjection A kamera View * Projection mátrixa.
+     * @param lod A rajzolandó LOD szint (lásd selectLod); meshlet culling esetén a culling pass már ezt használta.
+     * @param firstInstance Az első példány helye a példány pufferben.
+     * @param instanceCount Az azonos geometriájú és textúrájú példányok száma.
+     * @param indirectCommandBuffer Meshlet culling esetén az indirekt rajzolási parancs (a firstInstance-t a MeshletCuller írja bele);
+     * ha VK_NULL_HANDLE, a teljes mesh rajzolódik.
+     */
+    void draw(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t firstInstance,
+              uint32_t instanceCount = 1, VkBuffer indirectCommandBuffer = VK_NULL_HANDLE) const;
+
+    // A textúra (Set 0), a renderer ez alapján is csoportosítja a példányokat
+    VkDescriptorSet getTexture() const { return textureDescriptorSet; }
+
+    // A geometria azonosítója: a közös geometriájú példányoknál (createInstanceOf) azonos
+    uint32_t getGeometryId() const { return indexAllocation; }
+
+    // A mesh helye a közös geometria pufferben (vkCmdDrawIndexed vertexOffset és firstIndex paramétere)
+    int32_t getVertexOffset() const;
+    uint32_t getFirstIndex() const;
+
+    /**
+     * @brief LOD szint választása a vetített (képernyő térbeli) hiba alapján.
+     * A legdurvább szintet adja, amelynek geometriai hibája a nézőpontból legfeljebb maxPixelError pixelnek látszik.
+     * @param selection A nézőpont és a vetítés paraméterei.
      * @param animationTime Időbélyeg a forgatási animációhoz.
      */
-    void draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, glm::mat4 viewProjection, float animationTime) const;
+    uint32_t selectLod(const LodSelection& selection, float animationTime) const;
+
+    /**
+     * @brief Az objektum model mátrixa az adott időpillanatban.
+     * Compact formátumnál tartalmazza a kvantált pozíciók visszaalakítását (skála + eltolás) is,
+     * ezért minden pass (fő és árnyék) ezt használja a vertexek transzformálásához.
+     * @param animationTime Időbélyeg a forgatási animációhoz.
+     */
+    glm::mat4 getModelMatrix(float animationTime) const;
+
+    /**
+     * @brief Az objektum világ mátrixa (eltolás + forgatás) a kvantálás visszaalakítása nélkül.
+     * A mesh térben megadott adatokat (befoglaló gömb, LOD hibák) ez viszi a világba.
+     */
+    glm::mat4 getWorldMatrix(float animationTime) const;
+
+    /**
+     * @brief A befoglaló doboz világtérben: az elforgatott mesh terű AABB befoglalója (középpont és fél-kiterjedés).
+     * A frustum culling és a jelenet BVH is ezt használja.
+     */
+    void getWorldBounds(float animationTime, glm::vec3& center, glm::vec3& extent) const;
 
     // --- Publikus változók (Közvetlen elérés az egyszerűség és teljesítmény érdekében) ---
 
@@ -51,13 +205,100 @@ public:
     glm::vec3 rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
     float rotationSpeed = 0.0f;
 
-    // Vulkan Erőforrások: Csak a publikus handle-ök a rajzoláshoz
-    VkBuffer vertexBuffer = VK_NULL_HANDLE;
-    uint32_t vertexCount = 0; // Az indexek nélküli rajzoláshoz szükséges vertex szám
+    // Geometria: a vertexek és indexek a közös GeometryPool pufferekben vannak
+    uint32_t vertexCount = 0; // Egyedi vertexek száma
+    uint32_t indexCount = 0;  // A teljes részletességű (LOD 0) index szám
+    VkIndexType indexType = VK_INDEX_TYPE_UINT16; // 16 vagy 32 bites indexek a vertex számtól függően
+    VertexFormat vertexFormat = VertexFormat::Full; // A vertex pufferben tárolt formátum (pipeline választáshoz)
+    VkBuffer meshletBuffer = VK_NULL_HANDLE; // Meshlet leírók (Storage Buffer), csak buildMeshlets esetén
+    uint32_t meshletCount = 0;               // 0: nincs meshlet culling, a teljes index puffer rajzolódik
+
+    std::vector<LodLevel> lods;                // LOD szintek (0: teljes részletesség), közös vertex és index pufferben
+    glm::vec4 boundingSphere = glm::vec4(0.0f); // Befoglaló gömb a mesh terében (XYZ: középpont, W: sugár)
+    glm::vec3 boundsMin = glm::vec3(0.0f);      // Befoglaló doboz (AABB) a mesh terében, a frustum cullinghoz
+    glm::vec3 boundsMax = glm::vec3(0.0f);
 
 private:
     // Belső erőforrás-kezelés: A memóriát csak ez az osztály kezelheti
-    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+    GeometryPool* geometryPool = nullptr;
+    GeometryPool::Handle vertexAllocation = GeometryPool::INVALID_HANDLE;
+    GeometryPool::Handle indexAllocation = GeometryPool::INVALID_HANDLE;
+    VkDeviceMemory meshletBufferMemory = VK_NULL_HANDLE;
     VkDescriptorSet textureDescriptorSet = VK_NULL_HANDLE;
     VulkanContext* context = nullptr;
+    bool sharedGeometry = false; // createInstanceOf: a geometria egy másik objektumé, a cleanup nem szabadítja fel
+
+    // Compact formátumnál a [-1, 1] kvantált pozíciókat a mesh terébe visszaalakító mátrix (egységes skála + eltolás)
+    glm::mat4 dequantization = glm::mat4(1.0f);
+
+    /**
+     * @brief A feldolgozott, GPU-ra kész geometria (ez kerül a mesh cache fájlba is).
+     */
+    struct GeometryData {
+        std::vector<uint8_t> vertices;  // Végleges vertex formátum (Full vagy Compact): az összes pozíció, utána az attribútumok
+        uint32_t vertexStride = 0;      // A két folyam együtt (VertexLayout::getStride)
+        std::vector<uint8_t> indices;   // Az összes LOD szint indexei (16 vagy 32 bit, lásd indexType)
+        std::vector<Meshlet> meshlets;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+    };
+
+    /**
+     * @brief Optimalizálás, tangensek, LOD lánc, vertex kódolás és meshletek (a GPU-ra töltés nélkül).
+     * Kitölti a leíró mezőket (vertexCount, indexCount, indexType, lods, boundingSphere, boundsMin/Max, dequantization).
+     * @param vertices, indices A bemenet, helyben átrendezve (a hívók std::move-val adják át).
+     * @param inputStride 8, vagy 12, ha a bemenet tangenst is tartalmaz (lásd create).
+     */
+    GeometryData buildGeometry(std::vector<float> vertices, std::vector<uint32_t> indices,
+                               VertexFormat format, bool buildMeshlets, uint32_t inputStride);
+
+    /**
+     * @brief A createProcedural nem sablonos része: leíró mezők (egy LOD szint, befoglaló doboz és gömb, kvantálás) és a
+     * terület foglalása a GeometryPool staging memóriájában.
+     * @param bias, scale A Compact kódolás paraméterei a befoglaló dobozból.
+     */
+    GeometryPool::Upload beginProcedural(VulkanContext* context, GeometryPool* geometryPool, ProceduralGeometry::Size size,
+                                         const glm::vec3& boundsMin, const glm::vec3& boundsMax, VertexFormat format,
+                                         glm::vec3& bias, float& scale);
+
+    /**
+     * @brief Érvényes cache fájl esetén a geometria feltöltése közvetlenül a leképezett fájlból.
+     * @return Hamis, ha nincs (érvényes) cache fájl.
+     */
+    bool loadCached(const std::string& path, uint64_t key);
+
+    /**
+     * @brief Teljes feldolgozás (buildGeometry), a cache fájl megírása és a feltöltés.
+     */
+    void buildCached(const std::string& path, uint64_t key, std::vector<float> vertices,
+                     std::vector<uint32_t> indices, VertexFormat format, bool buildMeshlets, uint32_t inputStride);
+
+    /**
+     * @brief A kész geometria feltöltése: vertexek és indexek a közös pufferbe, meshletek saját storage pufferbe.
+     * A forrás lehet memóriában lévő vektor vagy a leképezett cache fájl.
+     * @param vertexData A vertexCount pozíció, majd közvetlenül utána a vertexCount attribútum (vertexFormat szerint).
+     */
+    void uploadGeometry(const void* vertexData, const void* indexData, const Meshlet* meshlets, uint32_t meshletCount);
+
+    /**
+     * @brief Adatok feltöltése egy csak GPU által elérhető pufferbe staging bufferen keresztül.
+     */
+    void uploadBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& memory);
+
+    /**
+     * @brief A befoglaló gömb kiszámítása a mesh terében (8 float/vertex bemenet).
+     */
+    void computeBoundingSphere(const std::vector<float>& vertices);
+
+    /**
+     * @brief LOD szintek előállítása QEM egyszerűsítéssel; kitölti a lods tömböt.
+     * @return Az összes szint összefűzött index listája (a LOD 0 az első).
+     */
+    std::vector<uint32_t> buildLodChain(const std::vector<float>& vertices, const std::vector<uint32_t>& indices);
+
+    /**
+     * @brief A 8 float/vertex bemenet és a tangensek kódolása a végleges formátumba, a két folyamba (pozíciók, attribútumok).
+     * Compact formátumnál beállítja a dequantization mátrixot a mesh befoglaló dobozából, Full esetén egységmátrix.
+     */
+    std::vector<uint8_t> encodeVertices(const std::vector<float>& vertices, const std::vector<glm::vec4>& tangents, VertexFormat format);
 };
\ No newline at end of file
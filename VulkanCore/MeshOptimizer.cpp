@@ -0,0 +1,226 @@
+/**
+ * @file MeshOptimizer.cpp
+ * @brief Tipsify vertex cache optimalizálás, klaszter alapú overdraw rendezés és vertex fetch átrendezés.
+ */
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                                            uint32_t cacheSize) {
+    CacheStats stats;
+    if (indices.empty()) return stats;
+
+    // FIFO cache: a vertex akkor van bent, ha az utolsó betöltése óta kevesebb, mint cacheSize tévesztés történt
+    std::vector<uint32_t> loadTime(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    uint32_t misses = 0;
+    size_t usedCount = 0;
+
+    for (uint32_t index : indices) {
+        if (!used[index]) {
+            used[index] = true;
+            usedCount++;
+        }
+        if (loadTime[index] == 0 || misses - loadTime[index] >= cacheSize) {
+            misses++;
+            loadTime[index] = misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+    return stats;
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                                         std::vector<uint32_t>* clusters, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    if (clusters) clusters->clear();
+    if (triangleCount == 0) return result;
+
+    // Vertex -> háromszög szomszédsági lista (CSR)
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+    // Vertexenként a még ki nem adott háromszögek száma
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) liveTriangles[v] = offsets[v + 1] - offsets[v];
+
+    // Cache időbélyegek: a vertex akkor van a cache-ben, ha timeStamp - cacheTime[v] < cacheSize
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t timeStamp = cacheSize + 1;
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;       // Nemrég használt vertexek, ha a szomszédok elfogynak
+    std::vector<uint32_t> candidates;
+    size_t scanCursor = 0;               // Lineáris keresés a még élő vertexekre, ha a deadEnd is kiürült
+
+    // Első legyező vertex: az első háromszög első vertexe
+    int64_t fanVertex = indices[0];
+    bool clusterStart = true;
+
+    while (fanVertex >= 0) {
+        if (clusterStart && clusters) clusters->push_back(static_cast<uint32_t>(result.size() / 3));
+
+        // A legyező vertex összes még ki nem adott háromszögének kiadása
+        candidates.clear();
+        for (uint32_t k = offsets[fanVertex]; k < offsets[fanVertex + 1]; k++) {
+            uint32_t triangle = adjacency[k];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+
+            for (int c = 0; c < 3; c++) {
+                uint32_t v = indices[triangle * 3 + c];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                // Ha nincs a cache-ben, most betöltődik
+                if (timeStamp - cacheTime[v] > cacheSize) cacheTime[v] = timeStamp++;
+            }
+        }
+
+        // Következő legyező vertex: a cache-ben legrégebb óta lévő jelölt, amely a kiadás után is bent marad
+        int64_t best = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+            int64_t priority = 0;
+            if (timeStamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                priority = timeStamp - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+
+        // Zsákutca: a verem tetején lévő még élő vertex, végső esetben lineáris keresés
+        clusterStart = false;
+        if (best < 0) {
+            while (!deadEnd.empty()) {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0) {
+                    best = v;
+                    break;
+                }
+            }
+            if (best < 0) {
+                while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0) scanCursor++;
+                if (scanCursor < vertexCount) best = static_cast<int64_t>(scanCursor);
+            }
+            // Ha az új legyező vertex már nincs a cache-ben, a folytonosság megszakad: új klaszter kezdődik
+            clusterStart = best >= 0 && timeStamp - cacheTime[best] > cacheSize;
+        }
+        fanVertex = best;
+    }
+
+    return result;
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters,
+                                                      const std::vector<float>& vertices, size_t stride, float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (clusters.size() <= 1) return indices;
+
+    auto position = [&](uint32_t i) { return glm::vec3(vertices[i * stride + 0], vertices[i * stride + 1], vertices[i * stride + 2]); };
+
+    // A mesh (területtel súlyozott) középpontja
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCenter(clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormal(clusters.size(), glm::vec3(0.0f));
+    std::vector<float> clusterArea(clusters.size(), 0.0f);
+
+    for (size_t c = 0; c < clusters.size(); c++) {
+        size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+        for (size_t t = clusters[c]; t < end; t++) {
+            glm::vec3 p0 = position(indices[t * 3 + 0]);
+            glm::vec3 p1 = position(indices[t * 3 + 1]);
+            glm::vec3 p2 = position(indices[t * 3 + 2]);
+            // A vektoriális szorzat hossza a terület kétszerese, iránya a háromszög normálja
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+            clusterCenter[c] += center * area;
+            clusterNormal[c] += normal;
+            clusterArea[c] += area;
+        }
+        meshCenter += clusterCenter[c];
+        meshArea += clusterArea[c];
+        if (clusterArea[c] > 0.0f) clusterCenter[c] /= clusterArea[c];
+    }
+    if (meshArea > 0.0f) meshCenter /= meshArea;
+
+    // Rendezési kulcs: mennyire néz kifelé a klaszter (nagyobb = előbb rajzoljuk)
+    std::vector<float> sortKey(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++) {
+        float normalLength = glm::length(clusterNormal[c]);
+        sortKey[c] = normalLength > 0.0f ? glm::dot(clusterCenter[c] - meshCenter, clusterNormal[c] / normalLength) : 0.0f;
+    }
+
+    std::vector<uint32_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order) {
+        size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+
+    // A klaszterhatárokon a cache kiürül, így az ACMR alig változhat; ha mégis túl sokat romlik, nem rendezünk
+    size_t vertexCount = vertices.size() / stride;
+    float before = analyzeVertexCache(indices, vertexCount).acmr;
+    float after = analyzeVertexCache(result, vertexCount).acmr;
+    return after <= before * threshold ? result : indices;
+}
+
+std::vector<float> MeshOptimizer::optimizeVertexFetch(const std::vector<float>& vertices, size_t stride,
+                                                      std::vector<uint32_t>& indices) {
+    const size_t vertexCount = vertices.size() / stride;
+    const uint32_t unassigned = ~0u;
+    std::vector<uint32_t> remap(vertexCount, unassigned);
+
+    std::vector<float> result;
+    result.reserve(vertices.size());
+    uint32_t nextIndex = 0;
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == unassigned) {
+            remap[index] = nextIndex++;
+            result.insert(result.end(), vertices.begin() + index * stride, vertices.begin() + (index + 1) * stride);
+        }
+        index = remap[index];
+    }
+
+    return result;
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(std::vector<float>& vertices, size_t stride, std::vector<uint32_t>& indices) {
+    Report report;
+    const size_t vertexCount = vertices.size() / stride;
+    report.before = analyzeVertexCache(indices, vertexCount);
+
+    std::vector<uint32_t> clusters;
+    indices = optimizeVertexCache(indices, vertexCount, &clusters);
+    indices = optimizeOverdraw(indices, clusters, vertices, stride);
+    report.clusterCount = static_cast<uint32_t>(clusters.size());
+
+    vertices = optimizeVertexFetch(vertices, stride, indices);
+    report.after = analyzeVertexCache(indices, vertices.size() / stride);
+    return report;
+}
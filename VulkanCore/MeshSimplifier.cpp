@@ -0,0 +1,233 @@
+/**
+ * @file MeshSimplifier.cpp
+ * @brief QEM egyszerűsítés: kvadrikus hibák, él összevonási körök, varrat- és átfordulás-védelem.
+ */
+#include "MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cmath>
+
+namespace {
+
+    /**
+     * @brief Síkok távolság-négyzet összegét leíró szimmetrikus 4x4 mátrix (Garland-Heckbert) és a súlyok összege.
+     * Q(p) / weight a p pont súlyozott átlagos távolság-négyzete a gyűjtött síkoktól.
+     */
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+        double weight = 0;
+
+        static Quadric fromPlane(const glm::dvec3& n, double d, double w) {
+            Quadric q;
+            q.a2 = w * n.x * n.x; q.ab = w * n.x * n.y; q.ac = w * n.x * n.z; q.ad = w * n.x * d;
+            q.b2 = w * n.y * n.y; q.bc = w * n.y * n.z; q.bd = w * n.y * d;
+            q.c2 = w * n.z * n.z; q.cd = w * n.z * d;
+            q.d2 = w * d * d;
+            q.weight = w;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o) {
+            a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+            b2 += o.b2; bc += o.bc; bd += o.bd;
+            c2 += o.c2; cd += o.cd;
+            d2 += o.d2;
+            weight += o.weight;
+            return *this;
+        }
+
+        // Súlyozott átlagos távolság-négyzet a p pontban
+        double error(const glm::dvec3& p) const {
+            double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+                     + b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+                     + c2 * p.z * p.z + 2 * cd * p.z
+                     + d2;
+            return weight > 0 ? std::max(0.0, e / weight) : 0.0;
+        }
+    };
+
+    struct Collapse {
+        uint32_t from;  // A megszűnő vertex
+        uint32_t to;    // Ebbe olvad bele
+        double error;   // Négyzetes hiba
+    };
+
+    // Irányítatlan él kulcsa
+    uint64_t edgeKey(uint32_t a, uint32_t b) {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<float>& vertices, size_t stride,
+                                               const std::vector<uint32_t>& inputIndices, size_t targetIndexCount,
+                                               float maxError, float* resultError) {
+    const size_t vertexCount = vertices.size() / stride;
+    std::vector<uint32_t> indices = inputIndices;
+    double maxErrorSquared = double(maxError) * double(maxError);
+    double achievedError = 0.0;
+
+    auto position = [&](uint32_t i) {
+        return glm::dvec3(vertices[i * stride + 0], vertices[i * stride + 1], vertices[i * stride + 2]);
+    };
+
+    // --- 1. Azonos pozíciójú vertexek csoportosítása (textúra varratok felismerése) ---
+    std::vector<uint32_t> positionId(vertexCount);
+    std::vector<uint32_t> positionUses;
+    {
+        struct PositionHash {
+            size_t operator()(const glm::vec3& p) const {
+                uint32_t bits[3];
+                std::memcpy(bits, &p, sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> positionMap;
+        positionMap.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            glm::vec3 p(vertices[v * stride + 0], vertices[v * stride + 1], vertices[v * stride + 2]);
+            auto inserted = positionMap.emplace(p, static_cast<uint32_t>(positionUses.size()));
+            if (inserted.second) positionUses.push_back(0);
+            positionId[v] = inserted.first->second;
+            positionUses[positionId[v]]++;
+        }
+    }
+
+    // --- 2. Rögzített vertexek: varrat (több vertex egy pozíción) és szél (csak egy háromszögben szereplő él) ---
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                edgeUses[edgeKey(positionId[indices[i + e]], positionId[indices[i + (e + 1) % 3]])]++;
+            }
+        }
+        std::vector<bool> boundaryPosition(positionUses.size(), false);
+        for (const auto& edge : edgeUses) {
+            if (edge.second == 1) {
+                boundaryPosition[edge.first >> 32] = true;
+                boundaryPosition[edge.first & 0xFFFFFFFFu] = true;
+            }
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            locked[v] = positionUses[positionId[v]] > 1 || boundaryPosition[positionId[v]];
+        }
+    }
+
+    // --- 3. Vertexenkénti kvadrikák a háromszögek síkjaiból (területtel súlyozva) ---
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        glm::dvec3 p0 = position(indices[i]), p1 = position(indices[i + 1]), p2 = position(indices[i + 2]);
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double length = glm::length(normal);
+        if (length <= 0.0) continue;
+        normal /= length;
+        Quadric q = Quadric::fromPlane(normal, -glm::dot(normal, p0), length * 0.5);
+        for (int c = 0; c < 3; c++) quadrics[indices[i + c]] += q;
+    }
+
+    // --- 4. Összevonási körök: a legolcsóbb élektől, körönként egy vertex legfeljebb egyszer változik ---
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    while (indices.size() > targetIndexCount) {
+        const size_t triangleCount = indices.size() / 3;
+
+        // Jelölt élek mindkét irányban (a rögzített vertex nem mozdulhat)
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint32_t a = indices[i + e];
+                uint32_t b = indices[i + (e + 1) % 3];
+                Quadric combined = quadrics[a];
+                combined += quadrics[b];
+                if (!locked[a]) collapses.push_back({a, b, combined.error(position(b))});
+                if (!locked[b]) collapses.push_back({b, a, combined.error(position(a))});
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        // Vertex -> háromszög szomszédság az átfordulás ellenőrzéséhez
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : indices) adjacencyOffsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        adjacency.resize(indices.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        for (size_t v = 0; v < vertexCount; v++) remap[v] = static_cast<uint32_t>(v);
+        std::fill(touched.begin(), touched.end(), false);
+
+        size_t removedTriangles = 0;
+        size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+
+        for (const Collapse& collapse : collapses) {
+            if (collapse.error > maxErrorSquared) break;
+            if (removedTriangles >= trianglesToRemove) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // Átfordulás ellenőrzése: a megszűnő vertex minden megmaradó háromszögének normálja
+            // nagyjából ugyanabba az irányba kell nézzen az összevonás után is
+            glm::dvec3 target = position(collapse.to);
+            bool flips = false;
+            size_t collapsedTriangles = 0;
+            for (uint32_t k = adjacencyOffsets[collapse.from]; k < adjacencyOffsets[collapse.from + 1] && !flips; k++) {
+                const uint32_t* tri = &indices[adjacency[k] * size_t(3)];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+                    collapsedTriangles++; // Ez a háromszög elfajul és eltűnik
+                    continue;
+                }
+                glm::dvec3 p[3], q[3];
+                for (int c = 0; c < 3; c++) {
+                    p[c] = position(tri[c]);
+                    q[c] = tri[c] == collapse.from ? target : p[c];
+                }
+                glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                // Legfeljebb ~75 fokos elfordulás engedett, és a háromszög nem zsugorodhat el
+                flips = glm::dot(before, after) <= 0.25 * glm::length(before) * glm::length(after);
+            }
+            if (flips) continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            achievedError = std::max(achievedError, collapse.error);
+            removedTriangles += collapsedTriangles;
+
+            // A szomszédos háromszögek összes vertexe is változatlan marad ebben a körben,
+            // hogy a fenti átfordulás ellenőrzés érvényes maradjon
+            for (uint32_t k = adjacencyOffsets[collapse.from]; k < adjacencyOffsets[collapse.from + 1]; k++) {
+                const uint32_t* tri = &indices[adjacency[k] * size_t(3)];
+                for (int c = 0; c < 3; c++) touched[tri[c]] = true;
+            }
+        }
+
+        if (removedTriangles == 0) break;
+
+        // Az összevonások alkalmazása és az elfajult háromszögek törlése
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            uint32_t a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = b;
+            indices[writeIndex++] = c;
+        }
+        indices.resize(writeIndex);
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(achievedError));
+    return indices;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file MeshSimplifier.h
+ * @brief Quadric Error Metric (QEM) alapú mesh egyszerűsítés a LOD szintek előállításához.
+ * Az egyszerűsítés fél-él összevonással (half-edge collapse) dolgozik: a megszűnő vertex egy meglévő szomszédjába
+ * olvad, így minden LOD szint ugyanazt a vertex puffert használja, csak az index lista különbözik.
+ */
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class MeshSimplifier {
+public:
+    /**
+     * @brief Az index lista egyszerűsítése a cél index számig (vagy amíg a hiba a korláton belül marad).
+     * A textúra varratokon (azonos pozíció, eltérő attribútumok) és a mesh szélén lévő vertexek rögzítettek,
+     * hogy a UV és a kontúr ne szakadjon szét. Összevonás után nem fordulhat át háromszög.
+     * @param vertices Vertex adatok (Pos(3), ... vertexenként stride darab float)
+     * @param stride Egy vertex float komponenseinek száma
+     * @param indices A kiinduló háromszög indexek
+     * @param targetIndexCount A kívánt index szám (háromszögek száma * 3)
+     * @param maxError A megengedett legnagyobb geometriai hiba (mesh egységben)
+     * @param resultError Ha nem nullptr, ide kerül a ténylegesen elkövetett legnagyobb hiba (mesh egységben)
+     * @return Az egyszerűsített index lista (ugyanarra a vertex tömbre hivatkozik).
+     */
+    static std::vector<uint32_t> simplify(const std::vector<float>& vertices, size_t stride,
+                                          const std::vector<uint32_t>& indices, size_t targetIndexCount,
+                                          float maxError, float* resultError = nullptr);
+};
@@ -0,0 +1,111 @@
+/**
+ * @file Meshlet.cpp
+ * @brief Mohó meshlet felosztás, befoglaló gömb és normálkúp számítás.
+ */
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<Meshlet> MeshletBuilder::build(const std::vector<float>& vertices, size_t stride, const std::vector<uint32_t>& indices) {
+    const size_t vertexCount = vertices.size() / stride;
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<Meshlet> meshlets;
+
+    // Vertexenként annak a meshletnek a sorszáma (+1), amelyikben utoljára szerepelt
+    std::vector<uint32_t> vertexOwner(vertexCount, 0);
+    uint32_t currentId = 1;
+    uint32_t currentVertices = 0;
+
+    Meshlet current{};
+    current.indexOffset = 0;
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        // Hány új vertexet hozna a háromszög az aktuális meshletbe
+        uint32_t newVertices = 0;
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            bool seenInTriangle = (c > 0 && indices[t * 3] == v) || (c > 1 && indices[t * 3 + 1] == v);
+            if (vertexOwner[v] != currentId && !seenInTriangle) newVertices++;
+        }
+
+        // Ha nem fér bele, lezárjuk a meshletet, és újat kezdünk
+        if (current.triangleCount == MAX_TRIANGLES || currentVertices + newVertices > MAX_VERTICES) {
+            computeBounds(current, vertices, stride, indices);
+            meshlets.push_back(current);
+
+            current = Meshlet{};
+            current.indexOffset = static_cast<uint32_t>(t * 3);
+            currentId++;
+            currentVertices = 0;
+        }
+
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            if (vertexOwner[v] != currentId) {
+                vertexOwner[v] = currentId;
+                currentVertices++;
+            }
+        }
+        current.triangleCount++;
+    }
+
+    if (current.triangleCount > 0) {
+        computeBounds(current, vertices, stride, indices);
+        meshlets.push_back(current);
+    }
+
+    return meshlets;
+}
+
+void MeshletBuilder::computeBounds(Meshlet& meshlet, const std::vector<float>& vertices, size_t stride,
+                                   const std::vector<uint32_t>& indices) {
+    auto position = [&](uint32_t i) { return glm::vec3(vertices[i * stride + 0], vertices[i * stride + 1], vertices[i * stride + 2]); };
+    const uint32_t first = meshlet.indexOffset;
+    const uint32_t last = meshlet.indexOffset + meshlet.triangleCount * 3;
+
+    // --- Befoglaló gömb: a befoglaló doboz középpontja, sugara a legtávolabbi vertexig ---
+    glm::vec3 minPos = position(indices[first]);
+    glm::vec3 maxPos = minPos;
+    for (uint32_t i = first; i < last; i++) {
+        minPos = glm::min(minPos, position(indices[i]));
+        maxPos = glm::max(maxPos, position(indices[i]));
+    }
+    glm::vec3 center = (minPos + maxPos) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = first; i < last; i++) {
+        radius = std::max(radius, glm::length(position(indices[i]) - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    // --- Normálkúp: a háromszög normálok átlaga és a tőle való legnagyobb eltérés ---
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.triangleCount);
+    glm::vec3 axis(0.0f);
+    for (uint32_t i = first; i < last; i += 3) {
+        glm::vec3 p0 = position(indices[i]);
+        glm::vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f) continue; // Elfajult háromszög: nem befolyásolja a kúpot
+        normals.push_back(normal / length);
+        axis += normals.back();
+    }
+
+    // Alapértelmezés: a kúp nem használható (a levágási teszt soha nem teljesül)
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f) return;
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+
+    // Ha a normálok 90 foknál jobban szétszórnak, nincs olyan nézőpont, ahonnan mind hátlap lenne
+    if (minDot <= 0.0f) return;
+
+    // A klaszter akkor hátlap, ha a nézési irány és a tengely szöge kisebb, mint 90° - (kúp félszöge),
+    // azaz dot(irány, tengely) > cos(90° - félszög) = sin(félszög)
+    meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+}
@@ -0,0 +1,47 @@
+/**
+ * @file Meshlet.h
+ * @brief Meshlet (klaszter) felosztás: kis, összefüggő háromszögcsoportok befoglaló gömbbel és normálkúppal.
+ * A GPU-s klaszter culling (MeshletCuller) ezek alapján dobja el a kamerától elforduló vagy képen kívüli részeket.
+ */
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Egy meshlet, pontosan úgy, ahogy a meshlet_cull.comp shader SSBO-jában van (std430, 48 byte).
+ * A meshlet háromszögei az index puffer egy összefüggő tartományát foglalják el.
+ */
+struct Meshlet {
+    glm::vec4 sphere;        // XYZ: befoglaló gömb középpontja, W: sugara (mesh térben)
+    glm::vec4 cone;          // XYZ: normálkúp tengelye, W: levágási érték (1.0: a kúp nem használható cullingra)
+    uint32_t indexOffset;    // Az első index helye az index pufferben
+    uint32_t triangleCount;  // Háromszögek száma (legfeljebb MAX_TRIANGLES)
+    uint32_t padding[2];
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match the std430 layout in meshlet_cull.comp");
+
+class MeshletBuilder {
+public:
+    // Egy meshlet korlátai (a compute shader munkacsoportja MAX_TRIANGLES háromszöget dolgoz fel egyszerre)
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    /**
+     * @brief Az index puffer felosztása meshletekre a háromszögek sorrendjében.
+     * A vertex cache optimalizált sorrendben az egymást követő háromszögek térben is közel vannak,
+     * így a mohó felosztás kompakt klasztereket ad, és az index puffert nem kell átrendezni.
+     * A normálkúp a háromszögek körüljárásából (CCW = kifelé) számolt geometriai normálokon alapul,
+     * ugyanazon, amit a raszterizáló a hátlap eldobásához használ.
+     * @param vertices Vertex adatok (Pos(3), ... vertexenként stride darab float)
+     * @param stride Egy vertex float komponenseinek száma
+     * @param indices Háromszög indexek
+     */
+    static std::vector<Meshlet> build(const std::vector<float>& vertices, size_t stride, const std::vector<uint32_t>& indices);
+
+private:
+    static void computeBounds(Meshlet& meshlet, const std::vector<float>& vertices, size_t stride,
+                              const std::vector<uint32_t>& indices);
+};
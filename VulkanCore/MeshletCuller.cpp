@@ -0,0 +1,310 @@
+/**
+ * @file MeshletCuller.cpp
+ * @brief Meshlet culling compute pipeline, kimeneti pufferek és a culling parancsok rögzítése.
+ */
+#include "MeshletCuller.h"
+#include <array>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief Bináris shader fájlok (SPIR-V) beolvasása a lemezről.
+ */
+static std::vector<char> readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
+
+// Push Constant struktúra: Illeszkednie kell a meshlet_cull.comp layout-jához
+struct CullPushConstants {
+    glm::vec4 planes[6];   // Frustum síkok a mesh terében (96 byte)
+    glm::vec4 viewer;      // Nézőpont (W = 1) vagy nézési irány (W = 0) a mesh terében
+    uint32_t firstMeshlet; // A kiválasztott LOD szint meshletjei
+    uint32_t meshletCount;
+    uint32_t indexBase;    // A mesh első indexe a közös geometria pufferben
+    uint32_t coneCulling;  // 1: normálkúp teszt is (fő pass), 0: csak frustum (árnyék pass)
+};
+static_assert(sizeof(CullPushConstants) <= 128, "Push constants must fit the guaranteed 128 bytes");
+
+void MeshletCuller::create(VulkanContext* ctx, uint32_t frames, GeometryPool* pool) {
+    this->context = ctx;
+    this->framesInFlight = frames;
+    this->geometryPool = pool;
+    VkDevice device = context->getDevice();
+
+    // --- Descriptor Set Layout: meshletek, forrás indexek, kimeneti indexek, indirekt parancs ---
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet cull descriptor set layout!");
+    }
+
+    // --- Descriptor Pool: objektumonként frame-enként és pass-onként egy set ---
+    uint32_t maxSets = MAX_OBJECTS * framesInFlight * PassCount;
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = maxSets * static_cast<uint32_t>(bindings.size());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = maxSets;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet cull descriptor pool!");
+    }
+
+    // --- Pipeline Layout és Compute Pipeline ---
+    VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants)};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet cull pipeline layout!");
+    }
+
+    auto shaderCode = readFile("shaders/meshlet_cull_comp.spv");
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = shaderCode.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet cull shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet cull pipeline!");
+    }
+
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+}
+
+void MeshletCuller::cleanup() {
+    VkDevice device = context->getDevice();
+
+    for (auto& entry : outputs) {
+        for (Output& output : entry.second) {
+            vkDestroyBuffer(device, output.indexBuffer, nullptr);
+            vkFreeMemory(device, output.indexMemory, nullptr);
+            vkDestroyBuffer(device, output.commandBuffer, nullptr);
+            vkFreeMemory(device, output.commandMemory, nullptr);
+        }
+    }
+    outputs.clear();
+
+    // A descriptor set-ek a pool-lal együtt szabadulnak fel
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+}
+
+std::vector<MeshletCuller::Output>& MeshletCuller::getOrCreateOutputs(const MeshObject* object) {
+    auto found = outputs.find(object);
+    if (found != outputs.end()) return found->second;
+
+    if (outputs.size() >= MAX_OBJECTS) {
+        throw std::runtime_error("failed to register meshlet object: too many objects!");
+    }
+
+    std::vector<Output>& objectOutputs = outputs[object];
+    objectOutputs.resize(framesInFlight * PassCount);
+
+    std::vector<VkDescriptorSetLayout> layouts(objectOutputs.size(), descriptorSetLayout);
+    std::vector<VkDescriptorSet> sets(objectOutputs.size());
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(sets.size());
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(context->getDevice(), &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate meshlet cull descriptor sets!");
+    }
+
+    VkDeviceSize indexBufferSize = sizeof(uint32_t) * object->indexCount;
+
+    for (size_t i = 0; i < objectOutputs.size(); i++) {
+        Output& output = objectOutputs[i];
+        output.descriptorSet = sets[i];
+
+        // A compute shader írja (Storage), a rajzolás olvassa (Index / Indirect)
+        context->createBuffer(indexBufferSize,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, output.indexBuffer, output.indexMemory);
+        context->createBuffer(sizeof(VkDrawIndexedIndirectCommand),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, output.commandBuffer, output.commandMemory);
+
+        writeDescriptorSet(object, output);
+    }
+
+    return objectOutputs;
+}
+
+void MeshletCuller::writeDescriptorSet(const MeshObject* object, Output& output) {
+    // A forrás indexek a közös geometria pufferből jönnek (a mesh helyét az indexBase push constant adja)
+    output.sourceIndexBuffer = geometryPool->getIndexBuffer();
+
+    std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+    bufferInfos[0] = {object->meshletBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {output.sourceIndexBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {output.indexBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[3] = {output.commandBuffer, 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 4> writes{};
+    for (uint32_t b = 0; b < writes.size(); b++) {
+        writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[b].dstSet = output.descriptorSet;
+        writes[b].dstBinding = b;
+        writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[b].descriptorCount = 1;
+        writes[b].pBufferInfo = &bufferInfos[b];
+    }
+    vkUpdateDescriptorSets(context->getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+const MeshletCuller::Output& MeshletCuller::getOutput(const MeshObject* object, uint32_t frameIndex, Pass pass) const {
+    return outputs.at(object)[frameIndex * PassCount + pass];
+}
+
+void MeshletCuller::recordCulling(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::vector<MeshObject*>& objects,
+                                  float animationTime, const glm::mat4& viewProjection, glm::vec3 cameraPos,
+                                  const glm::mat4& lightSpaceMatrix, glm::vec3 lightDirection,
+                                  const std::vector<uint32_t>& mainLods, const std::vector<uint32_t>& shadowLods,
+                                  const std::vector<uint32_t>& mainInstances, const std::vector<uint32_t>& shadowInstances) {
+    // Csak a meshletekkel rendelkező objektumok (a többit a renderer a teljes index pufferrel rajzolja)
+    std::vector<const MeshObject*> culled;
+    std::vector<size_t> objectIndices;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (objects[i]->meshletCount > 0) {
+            culled.push_back(objects[i]);
+            objectIndices.push_back(i);
+        }
+    }
+    if (culled.empty()) return;
+
+    // --- 1. Indirekt parancsok nullázása (a frame kimeneteit az előző használat fence-e már felszabadította) ---
+    // 0 index, 1 példány; a vertexOffset a mesh helye a közös vertex pufferben,
+    // a firstInstance az objektum model mátrixa a renderer példány pufferében
+    for (size_t c = 0; c < culled.size(); c++) {
+        const MeshObject* obj = culled[c];
+        std::vector<Output>& objectOutputs = getOrCreateOutputs(obj);
+        for (uint32_t pass = 0; pass < PassCount; pass++) {
+            Output& output = objectOutputs[frameIndex * PassCount + pass];
+            uint32_t firstInstance = (pass == MainPass ? mainInstances : shadowInstances)[objectIndices[c]];
+            VkDrawIndexedIndirectCommand emptyCommand = {0, 1, 0, obj->getVertexOffset(), firstInstance};
+
+            // A geometria puffer növelés / tömörítés után új handle-t kap
+            if (output.sourceIndexBuffer != geometryPool->getIndexBuffer()) {
+                writeDescriptorSet(obj, output);
+            }
+            vkCmdUpdateBuffer(commandBuffer, output.commandBuffer, 0, sizeof(emptyCommand), &emptyCommand);
+        }
+    }
+
+    VkMemoryBarrier resetBarrier{};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+    // --- 2. Culling: munkacsoportonként egy meshlet ---
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    for (size_t c = 0; c < culled.size(); c++) {
+        const MeshObject* obj = culled[c];
+        const MeshObject::LodLevel& mainLod = obj->lods[mainLods[objectIndices[c]]];
+        const MeshObject::LodLevel& shadowLod = obj->lods[shadowLods[objectIndices[c]]];
+        glm::mat4 model = obj->getModelMatrix(animationTime);
+        glm::mat4 inverseModel = glm::inverse(model);
+        const std::vector<Output>& objectOutputs = outputs.at(obj);
+
+        // Fő pass: perspektív kamera, a hátlap teszt a kamera pozíciójából
+        glm::vec4 cameraInMesh = inverseModel * glm::vec4(cameraPos, 1.0f);
+        dispatch(commandBuffer, mainLod, obj->getFirstIndex(), objectOutputs[frameIndex * PassCount + MainPass], model, viewProjection,
+                 glm::vec4(glm::vec3(cameraInMesh), 1.0f), true);
+
+        // Árnyék pass: ortografikus fény, csak frustum teszt. Az árnyék pipeline a fény felé néző lapokat dobja el
+        // (front-face culling), tehát éppen a fénytől elforduló klasztereket rajzolja: a hátlap teszt az árnyékot vinné el.
+        glm::vec3 lightInMesh = glm::normalize(glm::mat3(inverseModel) * lightDirection);
+        dispatch(commandBuffer, shadowLod, obj->getFirstIndex(), objectOutputs[frameIndex * PassCount + ShadowPass], model, lightSpaceMatrix,
+                 glm::vec4(lightInMesh, 0.0f), false);
+    }
+
+    // --- 3. A rajzolás csak a culling után olvashatja az indexeket és a parancsot ---
+    VkMemoryBarrier drawBarrier{};
+    drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+}
+
+void MeshletCuller::dispatch(VkCommandBuffer commandBuffer, const MeshObject::LodLevel& lod, uint32_t indexBase, const Output& output,
+                             const glm::mat4& model, const glm::mat4& viewProjection, glm::vec4 viewer, bool coneCulling) {
+    // Frustum síkok kinyerése a (View * Projection * Model) mátrixból (Gribb-Hartmann),
+    // így a síkok közvetlenül a mesh terében adódnak. Vulkan mélység: 0 <= z <= w.
+    glm::mat4 m = viewProjection * model;
+    auto row = [&](int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); };
+
+    CullPushConstants pushs{};
+    pushs.planes[0] = row(3) + row(0); // Bal
+    pushs.planes[1] = row(3) - row(0); // Jobb
+    pushs.planes[2] = row(3) + row(1); // Alsó
+    pushs.planes[3] = row(3) - row(1); // Felső
+    pushs.planes[4] = row(2);          // Közeli
+    pushs.planes[5] = row(3) - row(2); // Távoli
+    for (glm::vec4& plane : pushs.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    pushs.viewer = viewer;
+    pushs.firstMeshlet = lod.firstMeshlet;
+    pushs.meshletCount = lod.meshletCount;
+    pushs.indexBase = indexBase;
+    pushs.coneCulling = coneCulling ? 1u : 0u;
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &output.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &pushs);
+    vkCmdDispatch(commandBuffer, lod.meshletCount, 1, 1);
+}
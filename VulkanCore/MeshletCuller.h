@@ -0,0 +1,105 @@
+/**
+ * @file MeshletCuller.h
+ * @brief GPU-s meshlet culling compute shaderrel a fő és az árnyék pass számára.
+ * Frame-enként és pass-onként a látható meshletek háromszögeiből tömörített index puffert és
+ * indirekt rajzolási parancsot állít elő, amit a rajzolás vkCmdDrawIndexedIndirect-tel használ.
+ */
+#pragma once
+
+#include "VulkanContext.h"
+#include "MeshObject.h"
+#include "GeometryPool.h"
+
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+class MeshletCuller {
+public:
+    // A culling eredményét használó pass-ok
+    enum Pass {
+        MainPass = 0,   // Kamera: perspektív frustum, hátlap teszt a kamera pozíciójából
+        ShadowPass = 1, // Fény: ortografikus frustum, hátlap teszt nélkül (az árnyék pipeline front-face cullingot használ)
+        PassCount = 2
+    };
+
+    // Egy objektum culling kimenete egy adott frame-ben és pass-ban
+    struct Output {
+        VkBuffer indexBuffer = VK_NULL_HANDLE;       // Látható háromszögek indexei (32 bit)
+        VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+        VkBuffer commandBuffer = VK_NULL_HANDLE;     // VkDrawIndexedIndirectCommand
+        VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkBuffer sourceIndexBuffer = VK_NULL_HANDLE; // A descriptor set-be írt geometria index puffer
+    };
+
+    // Legfeljebb ennyi meshletes objektum (a descriptor pool méretezéséhez)
+    static const uint32_t MAX_OBJECTS = 64;
+
+    /**
+     * @brief A compute pipeline, a descriptor layout és a pool létrehozása.
+     * @param framesInFlight Egyszerre feldolgozás alatt álló frame-ek száma (frame-enként külön kimenet).
+     * @param geometryPool A közös geometria puffer, amelynek index pufferéből a culling olvas.
+     */
+    void create(VulkanContext* ctx, uint32_t framesInFlight, GeometryPool* geometryPool);
+
+    void cleanup();
+
+    /**
+     * @brief Culling parancsok rögzítése mindkét pass-hoz, render pass-on kívül (a frame elején).
+     * A meshlet nélküli objektumokat kihagyja. A végén barrier biztosítja, hogy a rajzolás az új adatokat lássa.
+     * @param objects A jelenet objektumai.
+     * @param animationTime Időbélyeg a model mátrixokhoz.
+     * @param viewProjection A kamera View * Projection mátrixa.
+     * @param cameraPos A kamera pozíciója (világtér).
+     * @param lightSpaceMatrix A fény View * Projection mátrixa (ortografikus).
+     * @param lightDirection A fény nézési iránya (világtér, a fénytől a jelenet felé).
+     * @param mainLods Objektumonként (az objects tömbbel párhuzamosan) a fő pass LOD szintje.
+     * @param shadowLods Objektumonként az árnyék pass LOD szintje.
+     * @param mainInstances Objektumonként a fő pass példány helye (az indirekt parancs firstInstance mezője).
+     * @param shadowInstances Objektumonként az árnyék pass példány helye.
+     */
+    void recordCulling(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::vector<MeshObject*>& objects,
+                       float animationTime, const glm::mat4& viewProjection, glm::vec3 cameraPos,
+                       const glm::mat4& lightSpaceMatrix, glm::vec3 lightDirection,
+                       const std::vector<uint32_t>& mainLods, const std::vector<uint32_t>& shadowLods,
+                       const std::vector<uint32_t>& mainInstances, const std::vector<uint32_t>& shadowInstances);
+
+    /**
+     * @brief Az objektum culling kimenete (az objektumnak már szerepelnie kellett egy recordCulling hívásban).
+     */
+    const Output& getOutput(const MeshObject* object, uint32_t frameIndex, Pass pass) const;
+
+private:
+    VulkanContext* context = nullptr;
+    uint32_t framesInFlight = 0;
+    GeometryPool* geometryPool = nullptr;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    // Objektumonként framesInFlight * PassCount kimenet
+    std::unordered_map<const MeshObject*, std::vector<Output>> outputs;
+
+    /**
+     * @brief Az objektum kimeneti puffereinek és descriptor set-jeinek létrehozása az első használatkor.
+     */
+    std::vector<Output>& getOrCreateOutputs(const MeshObject* object);
+
+    /**
+     * @brief A kimenet descriptor set-jének (újra)írása; a geometria puffer cseréje után is hívódik.
+     */
+    void writeDescriptorSet(const MeshObject* object, Output& output);
+
+    /**
+     * @brief Egy objektum egy pass-ának culling dispatch-e a kiválasztott LOD szint meshletjein.
+     * A frustum síkokat és a nézőpontot a mesh terébe transzformálja (push constant).
+     * @param indexBase A mesh első indexe a közös geometria index pufferben.
+     * @param coneCulling Hamis: csak frustum teszt (az árnyék pass a front-face culling miatt a fénytől elforduló
+     * háromszögeket rajzolja, így a normálkúp teszt éppen ezeket dobná el).
+     */
+    void dispatch(VkCommandBuffer commandBuffer, const MeshObject::LodLevel& lod, uint32_t indexBase, const Output& output,
+                  const glm::mat4& model, const glm::mat4& viewProjection, glm::vec4 viewer, bool coneCulling);
+};
@@ -0,0 +1,41 @@
+/**
+ * @file ParallelFor.h
+ * @brief Egyszerű párhuzamos ciklus: egy index tartomány szétosztása szálak között, összefüggő darabokban.
+ */
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief A [0, count) tartomány feldolgozása legfeljebb threadCount szálon, összefüggő darabokban.
+ * A func(begin, end) a hívó szálon is fut; kis tartományoknál (vagy 1 szálnál) csak ott.
+ */
+template <typename Func>
+inline void parallelFor(size_t count, unsigned threadCount, Func func) {
+    if (threadCount <= 1 || count == 0) {
+        func(size_t(0), count);
+        return;
+    }
+
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (unsigned t = 1; t < threadCount; t++) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        if (begin < end) workers.emplace_back(func, begin, end);
+    }
+    func(size_t(0), std::min(count, chunk));
+    for (auto& worker : workers) worker.join();
+}
+
+/**
+ * @brief Szálak száma: 0 esetén a hardver szálak száma, de legalább 1.
+ */
+inline unsigned resolveThreadCount(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    return std::max(1u, threadCount);
+}
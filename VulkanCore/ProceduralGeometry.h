@@ -0,0 +1,354 @@
+/**
+ * @file ProceduralGeometry.h
+ * @brief Paraméteres primitívek (tórusz, doboz, piramis, sík) sablonos generátorai.
+ *
+ * Egy generátor előre megadja a pontos méreteket (size) és a befoglaló dobozt (bounds), és tetszőleges
+ * sorrendben lekérdezhető vertexenként (vertex) és háromszögenként (triangle). Így a ProceduralGeometry::write
+ * párhuzamosan, közvetlenül a végleges GPU formátumban (Full / Compact, 16 / 32 bites indexek) írhatja
+ * a leképezett staging memóriába: nincs push_back-kel növelt lista, köztes másolat és tangens számítás
+ * (a tangensek analitikusak).
+ *
+ * Generátor interfész:
+ *   ProceduralGeometry::Size size() const;
+ *   void bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+ *   ProceduralVertex vertex(uint32_t index) const;
+ *   void triangle(uint32_t index, uint32_t out[3]) const;
+ */
+#pragma once
+
+#include "VertexFormat.h"
+#include "ParallelFor.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+/**
+ * @brief Egy generált vertex minden attribútuma (a GPU formátumba kódolás előtt).
+ */
+struct ProceduralVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+    glm::vec4 tangent; // XYZ: egység tangens, W: kezesség (+1 / -1)
+};
+
+namespace ProceduralGeometry {
+
+    // Pontos méretek a foglaláshoz
+    struct Size {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+    };
+
+    // Ennyi vertex / háromszög alatt nem éri meg szálakat indítani
+    const size_t PARALLEL_THRESHOLD = 16384;
+
+    /**
+     * @brief Egy sík háromszög tangense a pozíciókból és UV-kből (Gram-Schmidt a normálra, kezesség a bitangensből).
+     */
+    inline glm::vec4 triangleTangent(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+                                     const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2, const glm::vec3& normal) {
+        glm::vec3 edge1 = p1 - p0;
+        glm::vec3 edge2 = p2 - p0;
+        glm::vec2 deltaUv1 = uv1 - uv0;
+        glm::vec2 deltaUv2 = uv2 - uv0;
+        float r = 1.0f / (deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y);
+        glm::vec3 tangent = (edge1 * deltaUv2.y - edge2 * deltaUv1.y) * r;
+        glm::vec3 bitangent = (edge2 * deltaUv1.x - edge1 * deltaUv2.x) * r;
+
+        tangent = glm::normalize(tangent - normal * glm::dot(normal, tangent));
+        float handedness = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+        return glm::vec4(tangent, handedness);
+    }
+
+    /**
+     * @brief A [first, last) vertexek kódolása a végleges formátumba, a két vertex folyamba (lásd VertexFormat.h).
+     * @param bias, scale Compact formátum kvantálása (lásd VertexLayout::computeQuantization); Full esetén nem használt.
+     */
+    template <typename Generator>
+    void writeVertices(const Generator& generator, VertexFormat format, const glm::vec3& bias, float scale,
+                       void* positionData, void* attributeData, size_t first, size_t last) {
+        if (format == VertexFormat::Compact) {
+            CompactPosition* positions = static_cast<CompactPosition*>(positionData);
+            CompactAttributes* attributes = static_cast<CompactAttributes*>(attributeData);
+            for (size_t i = first; i < last; i++) {
+                ProceduralVertex v = generator.vertex(static_cast<uint32_t>(i));
+                VertexLayout::encodeCompact(v.position, v.normal, v.texCoord, v.tangent, bias, scale, positions[i], attributes[i]);
+            }
+        } else {
+            // Full: Pos(3) | Norm(3), UV(2), Tangent(3)
+            float* positions = static_cast<float*>(positionData);
+            float* attributes = static_cast<float*>(attributeData);
+            for (size_t i = first; i < last; i++) {
+                ProceduralVertex v = generator.vertex(static_cast<uint32_t>(i));
+                VertexLayout::encodeFull(v.position, v.normal, v.texCoord, v.tangent, positions + i * 3, attributes + i * 8);
+            }
+        }
+    }
+
+    template <typename Generator, typename Index>
+    void writeIndices(const Generator& generator, Index* out, size_t firstTriangle, size_t lastTriangle) {
+        uint32_t triangle[3];
+        for (size_t t = firstTriangle; t < lastTriangle; t++) {
+            generator.triangle(static_cast<uint32_t>(t), triangle);
+            out[t * 3 + 0] = static_cast<Index>(triangle[0]);
+            out[t * 3 + 1] = static_cast<Index>(triangle[1]);
+            out[t * 3 + 2] = static_cast<Index>(triangle[2]);
+        }
+    }
+
+    /**
+     * @brief A teljes geometria kiírása a végleges GPU formátumban (pl. GeometryPool::reserveUpload memóriájába).
+     * A vertexek és a háromszögek egymástól függetlenek, ezért nagy primitíveknél több szálon íródnak.
+     * @param indexType VK_INDEX_TYPE_UINT16 vagy VK_INDEX_TYPE_UINT32.
+     * @param threadCount Szálak száma (0: automatikus; kis primitíveknél mindig 1).
+     */
+    template <typename Generator>
+    void write(const Generator& generator, VertexFormat format, const glm::vec3& bias, float scale,
+               void* positionData, void* attributeData, VkIndexType indexType, void* indexData, unsigned threadCount = 0) {
+        Size size = generator.size();
+        size_t triangleCount = size.indexCount / 3;
+        unsigned threads = (size.vertexCount + triangleCount >= PARALLEL_THRESHOLD) ? resolveThreadCount(threadCount) : 1u;
+
+        parallelFor(size.vertexCount, threads, [&](size_t first, size_t last) {
+            writeVertices(generator, format, bias, scale, positionData, attributeData, first, last);
+        });
+        parallelFor(triangleCount, threads, [&](size_t first, size_t last) {
+            if (indexType == VK_INDEX_TYPE_UINT16) {
+                writeIndices(generator, static_cast<uint16_t*>(indexData), first, last);
+            } else {
+                writeIndices(generator, static_cast<uint32_t*>(indexData), first, last);
+            }
+        });
+    }
+
+    /**
+     * @brief A geometria a feldolgozó (MeshObject::create) bemeneti formátumában: 8 float/vertex és 32 bites indexek.
+     * A LOD-ot és meshleteket igénylő mesh-ekhez; a tömbök egyszer, pontos méretre foglalódnak.
+     */
+    template <typename Generator>
+    std::vector<float> toVertexArray(const Generator& generator, std::vector<uint32_t>& indices, unsigned threadCount = 0) {
+        Size size = generator.size();
+        std::vector<float> vertices(size_t(size.vertexCount) * 8);
+        indices.resize(size.indexCount);
+        unsigned threads = (size.vertexCount >= PARALLEL_THRESHOLD) ? resolveThreadCount(threadCount) : 1u;
+
+        parallelFor(size.vertexCount, threads, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                ProceduralVertex v = generator.vertex(static_cast<uint32_t>(i));
+                float* o = &vertices[i * 8];
+                o[0] = v.position.x; o[1] = v.position.y; o[2] = v.position.z;
+                o[3] = v.normal.x;   o[4] = v.normal.y;   o[5] = v.normal.z;
+                o[6] = v.texCoord.x; o[7] = v.texCoord.y;
+            }
+        });
+        parallelFor(size.indexCount / 3, threads, [&](size_t first, size_t last) {
+            writeIndices(generator, indices.data(), first, last);
+        });
+        return vertices;
+    }
+}
+
+// --- GENERÁTOROK ---
+
+/**
+ * @brief Tórusz (fánk) a Z tengely körül: (mainSegments + 1) x (tubeSegments + 1) vertex rács
+ * (a varratnál duplikált oszlop / sor a folytonos UV miatt), négyszögenként két háromszög.
+ */
+struct TorusGenerator {
+    float mainRadius = 1.0f;
+    float tubeRadius = 0.4f;
+    uint32_t mainSegments = 32;
+    uint32_t tubeSegments = 16;
+    float textureRepeat = 4.0f; // UV ismétlődés a fő kör mentén
+
+    ProceduralGeometry::Size size() const {
+        return {(mainSegments + 1) * (tubeSegments + 1), mainSegments * tubeSegments * 6};
+    }
+
+    void bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        float outer = mainRadius + tubeRadius;
+        boundsMin = glm::vec3(-outer, -outer, -tubeRadius);
+        boundsMax = glm::vec3(outer, outer, tubeRadius);
+    }
+
+    ProceduralVertex vertex(uint32_t index) const {
+        uint32_t i = index / (tubeSegments + 1);
+        uint32_t j = index % (tubeSegments + 1);
+        float u = (float)i / mainSegments * glm::two_pi<float>();
+        float v = (float)j / tubeSegments * glm::two_pi<float>();
+        float cosU = std::cos(u), sinU = std::sin(u);
+        float cosV = std::cos(v), sinV = std::sin(v);
+
+        ProceduralVertex result;
+        result.position = glm::vec3((mainRadius + tubeRadius * cosV) * cosU, (mainRadius + tubeRadius * cosV) * sinU, tubeRadius * sinV);
+        result.normal = glm::vec3(cosV * cosU, cosV * sinU, sinV);
+        result.texCoord = glm::vec2((float)i / mainSegments * textureRepeat, (float)j / tubeSegments);
+        // dP/du iránya; a bitangens (dP/dv) = cross(N, T), ezért a kezesség +1
+        result.tangent = glm::vec4(-sinU, cosU, 0.0f, 1.0f);
+        return result;
+    }
+
+    void triangle(uint32_t index, uint32_t out[3]) const {
+        uint32_t quad = index / 2;
+        uint32_t i = quad / tubeSegments;
+        uint32_t j = quad % tubeSegments;
+        uint32_t p1 = i * (tubeSegments + 1) + j;
+        uint32_t p2 = (i + 1) * (tubeSegments + 1) + j;
+        uint32_t p3 = p1 + 1;
+        uint32_t p4 = p2 + 1;
+        if (index % 2 == 0) {
+            out[0] = p1; out[1] = p2; out[2] = p3;
+        } else {
+            out[0] = p2; out[1] = p4; out[2] = p3;
+        }
+    }
+};
+
+/**
+ * @brief Tengelyekkel párhuzamos kocka: lapanként 4 vertex (éles élek, lapanként teljes UV négyzet).
+ */
+struct BoxGenerator {
+    float sideLength = 1.0f;
+
+    // Lapok sarkai (a, b, c, d) előjelekkel; UV: a(0,0), b(1,0), c(1,1), d(0,1); háromszögek: (a, b, c), (c, d, a)
+    static constexpr float FACE_CORNERS[6][4][3] = {
+        {{-1, -1,  1}, { 1, -1,  1}, { 1,  1,  1}, {-1,  1,  1}}, // +Z
+        {{ 1, -1, -1}, {-1, -1, -1}, {-1,  1, -1}, { 1,  1, -1}}, // -Z
+        {{-1, -1, -1}, {-1, -1,  1}, {-1,  1,  1}, {-1,  1, -1}}, // -X
+        {{ 1, -1,  1}, { 1, -1, -1}, { 1,  1, -1}, { 1,  1,  1}}, // +X
+        {{-1,  1,  1}, { 1,  1,  1}, { 1,  1, -1}, {-1,  1, -1}}, // +Y
+        {{-1, -1, -1}, { 1, -1, -1}, { 1, -1,  1}, {-1, -1,  1}}  // -Y
+    };
+    static constexpr float FACE_NORMALS[6][3] = {{0, 0, 1}, {0, 0, -1}, {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
+
+    ProceduralGeometry::Size size() const { return {24, 36}; }
+
+    void bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        boundsMin = glm::vec3(-sideLength * 0.5f);
+        boundsMax = glm::vec3(sideLength * 0.5f);
+    }
+
+    ProceduralVertex vertex(uint32_t index) const {
+        uint32_t face = index / 4;
+        uint32_t corner = index % 4;
+        const float h = sideLength * 0.5f;
+        auto cornerPosition = [&](uint32_t c) {
+            return glm::vec3(FACE_CORNERS[face][c][0], FACE_CORNERS[face][c][1], FACE_CORNERS[face][c][2]) * h;
+        };
+
+        ProceduralVertex result;
+        result.position = cornerPosition(corner);
+        result.normal = glm::vec3(FACE_NORMALS[face][0], FACE_NORMALS[face][1], FACE_NORMALS[face][2]);
+        result.texCoord = glm::vec2((corner == 1 || corner == 2) ? 1.0f : 0.0f, (corner >= 2) ? 1.0f : 0.0f);
+        // A lap U iránya a -> b, V iránya a -> d
+        result.tangent = ProceduralGeometry::triangleTangent(cornerPosition(0), cornerPosition(1), cornerPosition(3),
+                                                             glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 1.0f),
+                                                             result.normal);
+        return result;
+    }
+
+    void triangle(uint32_t index, uint32_t out[3]) const {
+        static const uint32_t QUAD[2][3] = {{0, 1, 2}, {2, 3, 0}};
+        uint32_t base = (index / 2) * 4;
+        for (int k = 0; k < 3; k++) out[k] = base + QUAD[index % 2][k];
+    }
+};
+
+/**
+ * @brief Négyzet alapú gúla: 4 oldallap (lapos árnyalás, pontos lapnormálokkal) és 2 háromszögből álló alap.
+ */
+struct PyramidGenerator {
+    float baseSize = 1.0f;
+    float height = 1.0f;
+
+    // Oldallapok alap élei (előjelek); az oldallap: (alap0 UV(0,0), alap1 UV(1,0), csúcs UV(0.5,1))
+    static constexpr float SIDE_EDGES[4][2][2] = {
+        {{-1,  1}, { 1,  1}},
+        {{ 1,  1}, { 1, -1}},
+        {{ 1, -1}, {-1, -1}},
+        {{-1, -1}, {-1,  1}}
+    };
+    // Alap négyszög (X, Z előjelek) és UV-k; háromszögek: (0, 1, 2), (2, 3, 0)
+    static constexpr float BASE_CORNERS[4][4] = {
+        {-1, -1, 0, 1}, {1, -1, 1, 1}, {1, 1, 1, 0}, {-1, 1, 0, 0}
+    };
+
+    ProceduralGeometry::Size size() const { return {16, 18}; }
+
+    void bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        boundsMin = glm::vec3(-baseSize * 0.5f, 0.0f, -baseSize * 0.5f);
+        boundsMax = glm::vec3(baseSize * 0.5f, height, baseSize * 0.5f);
+    }
+
+    ProceduralVertex vertex(uint32_t index) const {
+        const float h = baseSize * 0.5f;
+        ProceduralVertex result;
+        if (index < 12) {
+            uint32_t side = index / 3;
+            glm::vec3 p0(SIDE_EDGES[side][0][0] * h, 0.0f, SIDE_EDGES[side][0][1] * h);
+            glm::vec3 p1(SIDE_EDGES[side][1][0] * h, 0.0f, SIDE_EDGES[side][1][1] * h);
+            glm::vec3 apex(0.0f, height, 0.0f);
+            const glm::vec3 positions[3] = {p0, p1, apex};
+            const glm::vec2 texCoords[3] = {glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.5f, 1.0f)};
+
+            result.position = positions[index % 3];
+            result.texCoord = texCoords[index % 3];
+            result.normal = glm::normalize(glm::cross(p1 - p0, apex - p0));
+            result.tangent = ProceduralGeometry::triangleTangent(p0, p1, apex, texCoords[0], texCoords[1], texCoords[2], result.normal);
+        } else {
+            const float* corner = BASE_CORNERS[index - 12];
+            result.position = glm::vec3(corner[0] * h, 0.0f, corner[1] * h);
+            result.texCoord = glm::vec2(corner[2], corner[3]);
+            result.normal = glm::vec3(0.0f, -1.0f, 0.0f);
+            // Az alap U iránya +X, V iránya -Z: lefelé néző normállal cross(N, T) = +Z, ezért a kezesség -1
+            result.tangent = glm::vec4(1.0f, 0.0f, 0.0f, -1.0f);
+        }
+        return result;
+    }
+
+    void triangle(uint32_t index, uint32_t out[3]) const {
+        if (index < 4) {
+            for (uint32_t k = 0; k < 3; k++) out[k] = index * 3 + k;
+        } else {
+            static const uint32_t QUAD[2][3] = {{0, 1, 2}, {2, 3, 0}};
+            for (int k = 0; k < 3; k++) out[k] = 12 + QUAD[index - 4][k];
+        }
+    }
+};
+
+/**
+ * @brief Vízszintes (XZ) négyzet alakú sík felfelé néző normállal, ismétlődő textúrával.
+ */
+struct PlaneGenerator {
+    float sideLength = 1.0f;
+    float textureRepeat = 1.0f;
+
+    ProceduralGeometry::Size size() const { return {4, 6}; }
+
+    void bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        boundsMin = glm::vec3(-sideLength * 0.5f, 0.0f, -sideLength * 0.5f);
+        boundsMax = glm::vec3(sideLength * 0.5f, 0.0f, sideLength * 0.5f);
+    }
+
+    ProceduralVertex vertex(uint32_t index) const {
+        // Sarkok: (-,+), (+,+), (+,-), (-,-); az U a +X, a V a -Z mentén nő
+        static const float CORNERS[4][2] = {{-1, 1}, {1, 1}, {1, -1}, {-1, -1}};
+        const float h = sideLength * 0.5f;
+        ProceduralVertex result;
+        result.position = glm::vec3(CORNERS[index][0] * h, 0.0f, CORNERS[index][1] * h);
+        result.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        result.texCoord = glm::vec2(CORNERS[index][0] > 0.0f ? textureRepeat : 0.0f, CORNERS[index][1] < 0.0f ? textureRepeat : 0.0f);
+        result.tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+        return result;
+    }
+
+    void triangle(uint32_t index, uint32_t out[3]) const {
+        static const uint32_t QUAD[2][3] = {{0, 1, 2}, {2, 3, 0}};
+        for (int k = 0; k < 3; k++) out[k] = QUAD[index][k];
+    }
+};
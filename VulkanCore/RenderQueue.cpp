@@ -0,0 +1,67 @@
+/**
+ * @file RenderQueue.cpp
+ * @brief A rendezési kulcsok összeállítása és a radix rendezés.
+ */
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+
+uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) {
+    auto field = [](uint32_t value, uint32_t bits) { return uint64_t(value) & ((uint64_t(1) << bits) - 1); };
+
+    uint64_t key = field(pass, PASS_BITS);
+    key = (key << PIPELINE_BITS) | field(pipeline, PIPELINE_BITS);
+    key = (key << MATERIAL_BITS) | field(material, MATERIAL_BITS);
+    key = (key << MESH_BITS) | field(mesh, MESH_BITS);
+    key = (key << DEPTH_BITS) | field(depth, DEPTH_BITS);
+    return key;
+}
+
+uint32_t RenderQueue::quantizeDepth(float depth, float maxDepth) {
+    const float maxValue = float((1u << DEPTH_BITS) - 1);
+    float normalized = std::min(std::max(depth / maxDepth, 0.0f), 1.0f);
+    return static_cast<uint32_t>(normalized * maxValue);
+}
+
+uint32_t RenderQueue::hashHandle(uint64_t handle, uint32_t bits) {
+    // 64 bites keverés (splitmix64 befejező lépése), a felső bitek a legjobban kevertek
+    handle ^= handle >> 30;
+    handle *= 0xbf58476d1ce4e5b9ull;
+    handle ^= handle >> 27;
+    handle *= 0x94d049bb133111ebull;
+    handle ^= handle >> 31;
+    return static_cast<uint32_t>(handle >> (64 - bits));
+}
+
+void RenderQueue::sort() {
+    if (items.size() < 2) return;
+    scratch.resize(items.size());
+
+    // Számjegyenkénti hisztogramok egyetlen bejárással
+    std::array<std::array<uint32_t, 256>, 8> histograms{};
+    for (const Item& item : items) {
+        for (uint32_t digit = 0; digit < 8; digit++) {
+            histograms[digit][(item.key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    const uint32_t count = static_cast<uint32_t>(items.size());
+    for (uint32_t digit = 0; digit < 8; digit++) {
+        std::array<uint32_t, 256>& histogram = histograms[digit];
+
+        // Ha minden elemnek azonos ez a számjegye, a lépés nem változtat a sorrenden
+        if (histogram[(items[0].key >> (digit * 8)) & 0xFF] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+        for (const Item& item : items) {
+            scratch[histogram[(item.key >> (digit * 8)) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file RenderQueue.h
+ * @brief Rajzolási sor 64 bites rendezési kulcsokkal: képkockánként radix rendezés, hogy az azonos állapotú
+ * (pass, pipeline, anyag, mesh) rajzolások egymás mellé kerüljenek, azon belül elölről hátra haladva.
+ *
+ * Kulcs felépítése (a legnagyobb helyiértéktől):
+ *   pass (3 bit) | pipeline állapot (4 bit) | anyag (14 bit) | mesh és LOD (20 bit) | mélység (23 bit)
+ * A pass mező a fő pass és az árnyék kaszkádok (legfeljebb 4) sorrendje.
+ * A mezők csak a sorrendet adják: az anyag és a mesh azonosító ütközése legfeljebb fölösleges kötést okoz,
+ * a csoportosítás a tényleges állapotot hasonlítja össze.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RenderQueue {
+public:
+    struct Item {
+        uint64_t key;
+        uint32_t object;  // Az objektum indexe a renderer objects tömbjében
+    };
+
+    static const uint32_t PASS_BITS = 3;
+    static const uint32_t PIPELINE_BITS = 4;
+    static const uint32_t MATERIAL_BITS = 14;
+    static const uint32_t MESH_BITS = 20;
+    static const uint32_t DEPTH_BITS = 23;
+
+    /**
+     * @brief Kulcs összeállítása; a mezők a saját bitszélességükre vágódnak.
+     * @param pipeline A pipeline és az index puffer kötés állapota (vertex formátum, index típus, meshlet).
+     * @param depth Kvantált mélység (lásd quantizeDepth), kisebb érték: közelebb.
+     */
+    static uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth);
+
+    /**
+     * @brief Mélység [0, maxDepth] tartományból DEPTH_BITS bitre (a tartományon kívüli értékek a szélekre).
+     */
+    static uint32_t quantizeDepth(float depth, float maxDepth);
+
+    /**
+     * @brief Mutató (pl. descriptor set handle) szétszórása bits bitre, a kulcs anyag mezőjéhez.
+     */
+    static uint32_t hashHandle(uint64_t handle, uint32_t bits);
+
+    void clear() { items.clear(); }
+
+    /**
+     * @brief A sor hossza; az új elemeket a hívó tölti ki (akár több szálon, diszjunkt tartományokban).
+     */
+    void resize(size_t count) { items.resize(count); }
+
+    /**
+     * @brief Stabil LSD radix rendezés 8 bites számjegyekkel; a minden elemben azonos számjegyű lépések kimaradnak
+     * (pl. egyetlen pass vagy pipeline esetén), így a tipikus sor néhány lépésben rendeződik.
+     */
+    void sort();
+
+    std::vector<Item>& getItems() { return items; }
+    const std::vector<Item>& getItems() const { return items; }
+
+private:
+    std::vector<Item> items;
+    std::vector<Item> scratch;  // A radix lépések célpuffere (képkockák között megmarad)
+};
@@ -0,0 +1,379 @@
+/**
+ * @file SceneBvh.cpp
+ * @brief Binned SAH építés, refit és a frustum / gömb / sugár lekérdezések.
+ */
+#include "SceneBvh.h"
+#include "FrustumCuller.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+    // Ennyi objektum alatt a világbeli dobozok számítását nem osztjuk szálakra
+    constexpr size_t PARALLEL_THRESHOLD = 16384;
+
+    inline float surfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        glm::vec3 d = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    inline void grow(glm::vec3& boundsMin, glm::vec3& boundsMax, const glm::vec3& otherMin, const glm::vec3& otherMax) {
+        boundsMin = glm::min(boundsMin, otherMin);
+        boundsMax = glm::max(boundsMax, otherMax);
+    }
+
+    inline void emptyBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) {
+        boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    }
+
+    // Sugár-doboz metszés (slab teszt); a belépési távolság a [0, maxDistance] tartományban
+    inline bool intersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                             const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& entry) {
+        glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+        glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        entry = enter;
+        return enter <= exit;
+    }
+
+    // A dobozon belüli, a ponthoz legközelebbi pont távolságának négyzete
+    inline float distanceSquared(const glm::vec3& point, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        glm::vec3 d = point - glm::clamp(point, boundsMin, boundsMax);
+        return glm::dot(d, d);
+    }
+}
+
+// --- ÉPÍTÉS ---
+
+void SceneBvh::build(const std::vector<Aabb>& bounds) {
+    // A lekérdezések levél szinten az objektumok saját dobozát is tesztelik
+    if (&bounds != &objectBounds) objectBounds = bounds;
+
+    uint32_t count = static_cast<uint32_t>(bounds.size());
+    nodes.clear();
+    objectIndices.resize(count);
+    for (uint32_t i = 0; i < count; i++) objectIndices[i] = i;
+    updatesSinceBuild = 0;
+    rebuildCount++;
+    if (count == 0) {
+        buildCost = currentCost = 0.0f;
+        return;
+    }
+
+    std::vector<glm::vec3> centroids(count);
+    for (uint32_t i = 0; i < count; i++) {
+        centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+    }
+
+    // Legfeljebb 2n - 1 csomópont (a levelekben legalább egy objektum van)
+    nodes.reserve(size_t(count) * 2);
+    Node root{};
+    emptyBounds(root.boundsMin, root.boundsMax);
+    for (const Aabb& box : bounds) grow(root.boundsMin, root.boundsMax, box.min, box.max);
+    root.objectCount = count;
+    nodes.push_back(root);
+
+    // Mélységi felosztás explicit veremmel (1M objektumnál a rekurzió mélysége nem garantált)
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+        if (split(nodeIndex, bounds, centroids)) {
+            stack.push_back(nodes[nodeIndex].leftChild);
+            stack.push_back(nodes[nodeIndex].leftChild + 1);
+        }
+    }
+
+    buildCost = currentCost = computeCost();
+}
+
+bool SceneBvh::split(uint32_t nodeIndex, const std::vector<Aabb>& bounds, const std::vector<glm::vec3>& centroids) {
+    const Node node = nodes[nodeIndex];
+    if (node.objectCount <= MAX_LEAF_OBJECTS) return false;
+
+    uint32_t* first = objectIndices.data() + node.firstObject;
+    uint32_t* last = first + node.objectCount;
+
+    // A középpontok befoglalója: ezen a tengelyen osztunk vödrökbe
+    glm::vec3 centroidMin, centroidMax;
+    emptyBounds(centroidMin, centroidMax);
+    for (uint32_t* it = first; it != last; ++it) grow(centroidMin, centroidMax, centroids[*it], centroids[*it]);
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+
+    uint32_t* middle = first;
+    if (extent[axis] > 0.0f) {
+        // --- Binned SAH: objektumok vödrökbe a középpont szerint, majd a vödörhatárok kiértékelése ---
+        struct Bin {
+            glm::vec3 boundsMin, boundsMax;
+            uint32_t count = 0;
+        };
+        Bin bins[SAH_BINS];
+        for (Bin& bin : bins) emptyBounds(bin.boundsMin, bin.boundsMax);
+
+        float binScale = SAH_BINS / extent[axis];
+        auto binOf = [&](uint32_t object) {
+            int bin = static_cast<int>((centroids[object][axis] - centroidMin[axis]) * binScale);
+            return static_cast<uint32_t>(std::min(std::max(bin, 0), int(SAH_BINS) - 1));
+        };
+        for (uint32_t* it = first; it != last; ++it) {
+            Bin& bin = bins[binOf(*it)];
+            grow(bin.boundsMin, bin.boundsMax, bounds[*it].min, bounds[*it].max);
+            bin.count++;
+        }
+
+        // Jobbról balra összegzett felszín és darabszám, majd balról jobbra a költség: A_L * N_L + A_R * N_R
+        float rightArea[SAH_BINS];
+        uint32_t rightCount[SAH_BINS];
+        glm::vec3 accumulatedMin, accumulatedMax;
+        emptyBounds(accumulatedMin, accumulatedMax);
+        uint32_t accumulatedCount = 0;
+        for (uint32_t i = SAH_BINS - 1; i > 0; i--) {
+            grow(accumulatedMin, accumulatedMax, bins[i].boundsMin, bins[i].boundsMax);
+            accumulatedCount += bins[i].count;
+            rightArea[i] = accumulatedCount > 0 ? surfaceArea(accumulatedMin, accumulatedMax) : 0.0f;
+            rightCount[i] = accumulatedCount;
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        uint32_t bestSplit = 0;
+        emptyBounds(accumulatedMin, accumulatedMax);
+        accumulatedCount = 0;
+        for (uint32_t i = 1; i < SAH_BINS; i++) {
+            grow(accumulatedMin, accumulatedMax, bins[i - 1].boundsMin, bins[i - 1].boundsMax);
+            accumulatedCount += bins[i - 1].count;
+            if (accumulatedCount == 0 || rightCount[i] == 0) continue;
+            float cost = surfaceArea(accumulatedMin, accumulatedMax) * accumulatedCount + rightArea[i] * rightCount[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit > 0) {
+            middle = std::partition(first, last, [&](uint32_t object) { return binOf(object) < bestSplit; });
+        }
+    }
+
+    // Elfajult eset (azonos középpontok, vagy minden egy vödörben): felezés a tengely mentén
+    if (middle == first || middle == last) {
+        middle = first + node.objectCount / 2;
+        std::nth_element(first, middle, last, [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+    }
+
+    uint32_t leftCount = static_cast<uint32_t>(middle - first);
+    uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+    for (uint32_t side = 0; side < 2; side++) {
+        Node child{};
+        child.firstObject = node.firstObject + (side == 0 ? 0 : leftCount);
+        child.objectCount = (side == 0) ? leftCount : node.objectCount - leftCount;
+        emptyBounds(child.boundsMin, child.boundsMax);
+        for (uint32_t i = 0; i < child.objectCount; i++) {
+            const Aabb& box = bounds[objectIndices[child.firstObject + i]];
+            grow(child.boundsMin, child.boundsMax, box.min, box.max);
+        }
+        nodes.push_back(child);
+    }
+    nodes[nodeIndex].leftChild = leftIndex;
+    return true;
+}
+
+float SceneBvh::computeCost() const {
+    if (nodes.empty()) return 0.0f;
+    float rootArea = std::max(surfaceArea(nodes[0].boundsMin, nodes[0].boundsMax), 1e-12f);
+    float cost = 0.0f;
+    for (const Node& node : nodes) {
+        float area = surfaceArea(node.boundsMin, node.boundsMax);
+        cost += area * (node.leftChild == 0 ? float(node.objectCount) : 1.0f);
+    }
+    return cost / rootArea;
+}
+
+// --- FRISSÍTÉS ---
+
+float SceneBvh::refit(const std::vector<Aabb>& bounds) {
+    if (&bounds != &objectBounds) objectBounds = bounds;
+
+    // A gyermekek indexe mindig nagyobb a szülőénél, így fordított sorrendben a gyermekek már frissek
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        emptyBounds(node.boundsMin, node.boundsMax);
+        if (node.leftChild == 0) {
+            for (uint32_t j = 0; j < node.objectCount; j++) {
+                const Aabb& box = bounds[objectIndices[node.firstObject + j]];
+                grow(node.boundsMin, node.boundsMax, box.min, box.max);
+            }
+        } else {
+            const Node& left = nodes[node.leftChild];
+            const Node& right = nodes[node.leftChild + 1];
+            grow(node.boundsMin, node.boundsMax, left.boundsMin, left.boundsMax);
+            grow(node.boundsMin, node.boundsMax, right.boundsMin, right.boundsMax);
+        }
+    }
+    currentCost = computeCost();
+    return currentCost;
+}
+
+void SceneBvh::update(const std::vector<MeshObject*>& objects, float animationTime) {
+    objectBounds.resize(objects.size());
+    unsigned threads = objects.size() >= PARALLEL_THRESHOLD ? resolveThreadCount(0) : 1;
+    parallelFor(objects.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3 center, extent;
+            objects[i]->getWorldBounds(animationTime, center, extent);
+            objectBounds[i] = {center - extent, center + extent};
+        }
+    });
+
+    if (objects.size() != objectIndices.size() || (nodes.empty() && !objects.empty())) {
+        build(objectBounds);
+        return;
+    }
+
+    // A forgó objektumok dobozai helyben változnak: általában elég a refit
+    updatesSinceBuild++;
+    float cost = refit(objectBounds);
+    if (cost > buildCost * REBUILD_COST_RATIO || updatesSinceBuild >= REBUILD_INTERVAL) {
+        build(objectBounds);
+    }
+}
+
+// --- LEKÉRDEZÉSEK ---
+
+void SceneBvh::queryFrustum(const glm::mat4& viewProjection, std::vector<uint32_t>& result) const {
+    result.clear();
+    if (nodes.empty()) return;
+
+    glm::vec4 planes[6];
+    FrustumCuller::extractPlanes(viewProjection, planes);
+    glm::vec3 absNormals[6];
+    for (int p = 0; p < 6; p++) absNormals[p] = glm::abs(glm::vec3(planes[p]));
+
+    // Doboz a sík melyik oldalán van: -1 teljesen kívül, 1 teljesen belül, 0 metszi
+    auto classify = [&](const glm::vec3& boundsMin, const glm::vec3& boundsMax, uint32_t& planeMask) {
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+        for (int p = 0; p < 6; p++) {
+            if ((planeMask & (1u << p)) == 0) continue;
+            float distance = glm::dot(glm::vec3(planes[p]), center) + planes[p].w;
+            float radius = glm::dot(absNormals[p], extent);
+            if (distance + radius < 0.0f) return false;
+            if (distance - radius >= 0.0f) planeMask &= ~(1u << p);
+        }
+        return true;
+    };
+
+    struct Entry {
+        uint32_t node;
+        uint32_t planeMask; // A még tesztelendő síkok
+    };
+    std::vector<Entry> stack = {{0, 0x3F}};
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[entry.node];
+
+        uint32_t mask = entry.planeMask;
+        if (!classify(node.boundsMin, node.boundsMax, mask)) continue;
+
+        if (mask == 0) {
+            // A részfa teljesen a frustumon belül van
+            result.insert(result.end(), objectIndices.begin() + node.firstObject,
+                          objectIndices.begin() + node.firstObject + node.objectCount);
+        } else if (node.leftChild == 0) {
+            for (uint32_t i = 0; i < node.objectCount; i++) {
+                uint32_t object = objectIndices[node.firstObject + i];
+                uint32_t objectMask = mask;
+                if (classify(objectBounds[object].min, objectBounds[object].max, objectMask)) result.push_back(object);
+            }
+        } else {
+            stack.push_back({node.leftChild, mask});
+            stack.push_back({node.leftChild + 1, mask});
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+void SceneBvh::querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& result) const {
+    result.clear();
+    if (nodes.empty()) return;
+
+    float radiusSquared = radius * radius;
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (distanceSquared(center, node.boundsMin, node.boundsMax) > radiusSquared) continue;
+
+        if (node.leftChild == 0) {
+            for (uint32_t i = 0; i < node.objectCount; i++) {
+                uint32_t object = objectIndices[node.firstObject + i];
+                if (distanceSquared(center, objectBounds[object].min, objectBounds[object].max) <= radiusSquared) {
+                    result.push_back(object);
+                }
+            }
+        } else {
+            stack.push_back(node.leftChild);
+            stack.push_back(node.leftChild + 1);
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+bool SceneBvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                       uint32_t& hitObject, float& hitDistance) const {
+    if (nodes.empty()) return false;
+
+    // 0 irány komponensnél a végtelen inverz a slab tesztben helyesen viselkedik
+    glm::vec3 inverseDirection = 1.0f / direction;
+    float closest = maxDistance;
+    bool hit = false;
+
+    float entry;
+    if (!intersectRay(origin, inverseDirection, closest, nodes[0].boundsMin, nodes[0].boundsMax, entry)) return false;
+
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!intersectRay(origin, inverseDirection, closest, node.boundsMin, node.boundsMax, entry)) continue;
+
+        if (node.leftChild == 0) {
+            for (uint32_t i = 0; i < node.objectCount; i++) {
+                uint32_t object = objectIndices[node.firstObject + i];
+                if (intersectRay(origin, inverseDirection, closest, objectBounds[object].min, objectBounds[object].max, entry)) {
+                    closest = entry;
+                    hitObject = object;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        // A közelebbi gyermek kerül a verem tetejére, így a távolabbit gyakran már a closest kizárja
+        float leftEntry, rightEntry;
+        const Node& left = nodes[node.leftChild];
+        const Node& right = nodes[node.leftChild + 1];
+        bool hitLeft = intersectRay(origin, inverseDirection, closest, left.boundsMin, left.boundsMax, leftEntry);
+        bool hitRight = intersectRay(origin, inverseDirection, closest, right.boundsMin, right.boundsMax, rightEntry);
+        if (hitLeft && hitRight) {
+            bool leftFirst = leftEntry <= rightEntry;
+            stack.push_back(leftFirst ? node.leftChild + 1 : node.leftChild);
+            stack.push_back(leftFirst ? node.leftChild : node.leftChild + 1);
+        } else if (hitLeft) {
+            stack.push_back(node.leftChild);
+        } else if (hitRight) {
+            stack.push_back(node.leftChild + 1);
+        }
+    }
+
+    hitDistance = closest;
+    return hit;
+}
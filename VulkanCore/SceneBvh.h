@@ -0,0 +1,111 @@
+/**
+ * @file SceneBvh.h
+ * @brief Jelenet szintű befoglaló térfogat hierarchia (BVH) a MeshObject-ek világbeli AABB-i felett.
+ * SAH (Surface Area Heuristic) alapú építés, képkockánkénti refit a mozgó (forgó) objektumokhoz, és újraépítés,
+ * ha a fa minősége túlságosan leromlott. Frustum, gömb és sugár lekérdezéseket szolgál ki
+ * (culling, árnyékvető választás, kijelölés).
+ */
+#pragma once
+
+#include "MeshObject.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+class SceneBvh {
+public:
+    // Egy objektum világbeli befoglaló doboza
+    struct Aabb {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    /**
+     * @brief A fa egy csomópontja. A csomópont részfájának objektumai az objectIndices tömbben
+     * összefüggő tartományt alkotnak [firstObject, firstObject + objectCount), így a teljesen látható
+     * részfák tesztelés nélkül kigyűjthetők.
+     */
+    struct Node {
+        glm::vec3 boundsMin;
+        uint32_t leftChild;   // 0: levél (a gyökér a 0. csomópont, így gyermek nem lehet); a jobb gyermek leftChild + 1
+        glm::vec3 boundsMax;
+        uint32_t firstObject;
+        uint32_t objectCount;
+    };
+
+    // Ennyi objektum alatt a csomópont levél marad
+    static const uint32_t MAX_LEAF_OBJECTS = 4;
+    // SAH vödrök száma tengelyenként
+    static const uint32_t SAH_BINS = 16;
+    // Újraépítés, ha a refit utáni SAH költség ennyiszerese az építés utáninak
+    static constexpr float REBUILD_COST_RATIO = 1.3f;
+    // Újraépítés legfeljebb ennyi update hívásonként (akkor is, ha a költség nem romlott)
+    static const uint32_t REBUILD_INTERVAL = 600;
+
+    /**
+     * @brief Teljes SAH építés a megadott dobozokból (az index az objektum indexe).
+     */
+    void build(const std::vector<Aabb>& bounds);
+
+    /**
+     * @brief A topológia megtartása mellett a csomópont dobozok frissítése alulról felfelé (O(n)).
+     * @return A refit utáni SAH költség.
+     */
+    float refit(const std::vector<Aabb>& bounds);
+
+    /**
+     * @brief Képkockánkénti frissítés: világbeli dobozok számítása, refit, és szükség esetén újraépítés
+     * (változott objektumszám, REBUILD_COST_RATIO feletti költség vagy REBUILD_INTERVAL).
+     * @param animationTime Időbélyeg a forgatási animációhoz.
+     */
+    void update(const std::vector<MeshObject*>& objects, float animationTime);
+
+    /**
+     * @brief A frustumot metsző objektumok indexei (növekvő sorrendben).
+     * A bejárás síkonkénti maszkot visz: amelyik sík előtt teljesen a csomópont van, azt a részfában már nem teszteli,
+     * a teljesen belül lévő részfák objektumai tesztelés nélkül kerülnek a kimenetbe.
+     * @param viewProjection A nézőpont (kamera vagy fény) View * Projection mátrixa.
+     */
+    void queryFrustum(const glm::mat4& viewProjection, std::vector<uint32_t>& result) const;
+
+    /**
+     * @brief A gömböt metsző dobozú objektumok indexei (növekvő sorrendben), pl. pontfény hatótávolsága.
+     */
+    void querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& result) const;
+
+    /**
+     * @brief A sugár által elsőként eltalált objektum doboza (kijelöléshez).
+     * @param direction Normalizált irány.
+     * @param maxDistance A vizsgált szakasz hossza.
+     * @param hitObject Kimenet: az objektum indexe.
+     * @param hitDistance Kimenet: a doboz belépési pontjának távolsága (0, ha az origó a dobozban van).
+     * @return Hamis, ha a sugár egyetlen dobozt sem talál el.
+     */
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                 uint32_t& hitObject, float& hitDistance) const;
+
+    size_t getObjectCount() const { return objectIndices.size(); }
+    size_t getNodeCount() const { return nodes.size(); }
+    float getCost() const { return currentCost; }
+    uint32_t getRebuildCount() const { return rebuildCount; }
+
+private:
+    std::vector<Node> nodes;              // A gyökér a 0.; a gyermekek mindig a szülő után következnek
+    std::vector<uint32_t> objectIndices;  // Az objektumok indexei a levelek sorrendjében
+    std::vector<Aabb> objectBounds;       // Az update által számolt világbeli dobozok
+    float buildCost = 0.0f;               // SAH költség közvetlenül az építés után
+    float currentCost = 0.0f;
+    uint32_t updatesSinceBuild = 0;
+    uint32_t rebuildCount = 0;
+
+    /**
+     * @brief Egy csomópont felosztása a legjobb SAH vágással (binned SAH a középpontok leghosszabb tengelyén).
+     * @return Hamis, ha a csomópont levél marad.
+     */
+    bool split(uint32_t nodeIndex, const std::vector<Aabb>& bounds, const std::vector<glm::vec3>& centroids);
+
+    // A fa SAH költsége: csomópontonként (felszín / gyökér felszín) * (bejárás vagy objektum tesztek)
+    float computeCost() const;
+};
@@ -0,0 +1,94 @@
+/**
+ * @file ShadowAtlas.cpp
+ * @brief A négyfa szerinti csempe foglalás: negyedelés foglaláskor, a testvérek összeolvasztása felszabadításkor.
+ */
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+
+void ShadowAtlas::init(uint32_t size, uint32_t minTile) {
+    atlasSize = size;
+    minTileSize = std::min(std::max(minTile, 1u), size);
+    levelCount = 1;
+    while ((atlasSize >> levelCount) >= minTileSize) levelCount++;
+    reset();
+}
+
+void ShadowAtlas::reset() {
+    freeNodes.assign(levelCount, std::vector<Node>());
+    freeNodes[0].push_back({0, 0});
+    usedTexels = 0;
+}
+
+size_t ShadowAtlas::findFree(uint32_t level, uint32_t x, uint32_t y) const {
+    const std::vector<Node>& nodes = freeNodes[level];
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].x == x && nodes[i].y == y) return i;
+    }
+    return nodes.size();
+}
+
+bool ShadowAtlas::allocate(uint32_t size, Tile& tile) {
+    if (levelCount == 0) return false;
+
+    // A kért méretet befoglaló szint (a legkisebb csempénél kisebb kérés is egy legkisebb csempét kap)
+    uint32_t target = 0;
+    while (target + 1 < levelCount && levelSize(target + 1) >= size) target++;
+
+    // A legkisebb elég nagy szabad csomópont; ha a célszinten nincs, egy nagyobbat negyedelünk
+    int32_t level = static_cast<int32_t>(target);
+    while (level >= 0 && freeNodes[level].empty()) level--;
+    if (level < 0) return false;
+
+    Node node = freeNodes[level].back();
+    freeNodes[level].pop_back();
+    for (uint32_t l = static_cast<uint32_t>(level); l < target; l++) {
+        // A bal felső negyed megy tovább, a másik három szabad marad a következő szinten
+        uint32_t half = levelSize(l + 1);
+        freeNodes[l + 1].push_back({node.x + half, node.y});
+        freeNodes[l + 1].push_back({node.x, node.y + half});
+        freeNodes[l + 1].push_back({node.x + half, node.y + half});
+    }
+
+    tile.x = node.x;
+    tile.y = node.y;
+    tile.size = levelSize(target);
+    tile.level = target;
+    usedTexels += uint64_t(tile.size) * tile.size;
+    return true;
+}
+
+void ShadowAtlas::release(const Tile& tile) {
+    usedTexels -= uint64_t(tile.size) * tile.size;
+
+    Node node = {tile.x, tile.y};
+    uint32_t level = tile.level;
+    while (level > 0) {
+        // A szülő bal felső sarka és a három testvér; ha mind szabad, a szülő lesz szabad
+        uint32_t size = levelSize(level);
+        uint32_t parentX = node.x - node.x % (2 * size);
+        uint32_t parentY = node.y - node.y % (2 * size);
+        Node siblings[4] = {{parentX, parentY}, {parentX + size, parentY}, {parentX, parentY + size},
+                            {parentX + size, parentY + size}};
+
+        bool allFree = true;
+        for (const Node& sibling : siblings) {
+            bool self = sibling.x == node.x && sibling.y == node.y;
+            if (!self && findFree(level, sibling.x, sibling.y) == freeNodes[level].size()) {
+                allFree = false;
+                break;
+            }
+        }
+        if (!allFree) break;
+
+        for (const Node& sibling : siblings) {
+            size_t index = findFree(level, sibling.x, sibling.y);
+            if (index == freeNodes[level].size()) continue; // A felszabadított csomópont maga
+            freeNodes[level][index] = freeNodes[level].back();
+            freeNodes[level].pop_back();
+        }
+        node = {parentX, parentY};
+        level--;
+    }
+    freeNodes[level].push_back(node);
+}
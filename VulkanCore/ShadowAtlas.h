@@ -0,0 +1,67 @@
+/**
+ * @file ShadowAtlas.h
+ * @brief Árnyék atlasz foglaló: egy nagy, négyzetes mélységkép négyfa (quadtree) szerinti felosztása változó méretű,
+ * kettő hatvány oldalú csempékre, fényenként egy csempével. A foglalás a legkisebb elég nagy szabad csomópontot
+ * negyedeli a kért méretig, a felszabadítás a négy szabad testvért visszaolvasztja a szülőbe, így a csempék
+ * képkockák között megmaradnak, és csak a méretük változásakor kell újrafoglalni (és újrarenderelni) őket.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ShadowAtlas {
+public:
+    // Egy csempe az atlaszban (texelben); a level a négyfa mélysége (0: a teljes atlasz)
+    struct Tile {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t size = 0;
+        uint32_t level = 0;
+    };
+
+    /**
+     * @brief Az atlasz mérete és a legkisebb csempe (mindkettő kettő hatvány, minTileSize <= atlasSize);
+     * minden korábbi foglalás elvész.
+     */
+    void init(uint32_t atlasSize, uint32_t minTileSize);
+
+    /**
+     * @brief Egy size oldalú csempe foglalása (a méret a [minTileSize, atlasSize] tartomány kettő hatványára kerekítve felfelé).
+     * @return Hamis, ha nincs elég nagy szabad terület.
+     */
+    bool allocate(uint32_t size, Tile& tile);
+
+    /**
+     * @brief Egy korábban foglalt csempe visszaadása (a szabad testvérekkel összeolvad).
+     */
+    void release(const Tile& tile);
+
+    /**
+     * @brief Minden csempe felszabadítása.
+     */
+    void reset();
+
+    uint32_t getSize() const { return atlasSize; }
+    uint32_t getMinTileSize() const { return minTileSize; }
+    uint64_t getUsedTexels() const { return usedTexels; }
+
+private:
+    uint32_t atlasSize = 0;
+    uint32_t minTileSize = 0;
+    uint32_t levelCount = 0;
+    uint64_t usedTexels = 0;
+
+    // Szintenként a szabad csomópontok bal felső sarka
+    struct Node {
+        uint32_t x;
+        uint32_t y;
+    };
+    std::vector<std::vector<Node>> freeNodes;
+
+    uint32_t levelSize(uint32_t level) const { return atlasSize >> level; }
+
+    // Egy szabad csomópont helye a szintje listájában (a lista mérete, ha nincs benne)
+    size_t findFree(uint32_t level, uint32_t x, uint32_t y) const;
+};
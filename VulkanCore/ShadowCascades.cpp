@@ -0,0 +1,128 @@
+/**
+ * @file ShadowCascades.cpp
+ * @brief A kaszkádok felosztása (practical split scheme) és a szeletekre illesztett, texelre igazított fény mátrixok;
+ * a kaszkád csak akkor illeszkedik újra, ha a szelete kilóg az előző illesztésből.
+ */
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+float ShadowCascades::splitDistance(uint32_t i, uint32_t count, float nearPlane, float farPlane, float lambda) {
+    // Logaritmikus felosztás: a texel sűrűség a távolsággal arányosan csökken (ideális perspektív aliasing);
+    // egyenletes felosztás: a közeli szeletek nem lesznek túl vékonyak. A lambda a kettő között keveri.
+    float p = static_cast<float>(i) / static_cast<float>(count);
+    float logarithmic = nearPlane * std::pow(farPlane / nearPlane, p);
+    float uniform = nearPlane + (farPlane - nearPlane) * p;
+    return lambda * logarithmic + (1.0f - lambda) * uniform;
+}
+
+// Az illesztést befolyásoló beállítások egyezése
+static bool sameSettings(const ShadowCascades::Settings& a, const ShadowCascades::Settings& b) {
+    return a.cascadeCount == b.cascadeCount && a.fovY == b.fovY && a.aspect == b.aspect && a.nearPlane == b.nearPlane &&
+           a.shadowDistance == b.shadowDistance && a.splitLambda == b.splitLambda && a.casterMargin == b.casterMargin &&
+           a.resolution == b.resolution && a.fitSlack == b.fitSlack;
+}
+
+void ShadowCascades::update(const glm::mat4& view, const glm::vec3& lightDirection, const Settings& settings) {
+    // Más fény irány vagy felosztás mellett a korábbi illesztések nem használhatók
+    bool refitAll = !fitted || lightDirection != fittedLightDirection || !sameSettings(settings, fittedSettings);
+    cascadeCount = std::min(std::max(settings.cascadeCount, 1u), MAX_CASCADES);
+    glm::mat4 inverseView = glm::inverse(view);
+
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        float splitNear = splitDistance(c, cascadeCount, settings.nearPlane, settings.shadowDistance, settings.splitLambda);
+        float splitFar = splitDistance(c + 1, cascadeCount, settings.nearPlane, settings.shadowDistance, settings.splitLambda);
+        glm::vec3 center;
+        float radius;
+        sliceSphere(inverseView, settings, splitNear, splitFar, center, radius);
+
+        // Amíg a szelet gömbje az előző illesztés gömbjén belül van, a kaszkád (és a texel rácsa) változatlan marad
+        const Cascade& previous = cascades[c];
+        if (refitAll || glm::length(center - previous.center) + radius > previous.radius) {
+            cascades[c] = fitSphere(center, radius * (1.0f + settings.fitSlack), lightDirection, settings);
+            cascades[c].revision = nextRevision++;
+        }
+        cascades[c].splitNear = splitNear;
+        cascades[c].splitFar = splitFar;
+    }
+
+    coverMatrix = fitFrustum(view, lightDirection, settings).viewProjection;
+
+    fittedSettings = settings;
+    fittedLightDirection = lightDirection;
+    fitted = true;
+}
+
+ShadowCascades::Cascade ShadowCascades::fitFrustum(const glm::mat4& view, const glm::vec3& lightDirection, const Settings& settings) {
+    glm::vec3 center;
+    float radius;
+    sliceSphere(glm::inverse(view), settings, settings.nearPlane, settings.shadowDistance, center, radius);
+    Cascade cascade = fitSphere(center, radius, lightDirection, settings);
+    cascade.splitNear = settings.nearPlane;
+    cascade.splitFar = settings.shadowDistance;
+    return cascade;
+}
+
+void ShadowCascades::sliceSphere(const glm::mat4& inverseView, const Settings& settings, float splitNear, float splitFar,
+                                 glm::vec3& center, float& radius) {
+    // A szelet 8 sarokpontja világ térben (a kamera a -Z irányba néz)
+    float tanHalfY = std::tan(settings.fovY * 0.5f);
+    float tanHalfX = tanHalfY * settings.aspect;
+    glm::vec3 corners[8];
+    uint32_t corner = 0;
+    for (float depth : {splitNear, splitFar}) {
+        for (float x : {-1.0f, 1.0f}) {
+            for (float y : {-1.0f, 1.0f}) {
+                corners[corner++] = glm::vec3(inverseView * glm::vec4(x * depth * tanHalfX, y * depth * tanHalfY, -depth, 1.0f));
+            }
+        }
+    }
+
+    // Befoglaló gömb: a sugár nem függ a kamera forgásától, így a vetítés mérete (és a texel méret) állandó
+    center = glm::vec3(0.0f);
+    for (const glm::vec3& p : corners) center += p;
+    center /= 8.0f;
+    radius = 0.0f;
+    for (const glm::vec3& p : corners) radius = std::max(radius, glm::length(p - center));
+}
+
+ShadowCascades::Cascade ShadowCascades::fitSphere(const glm::vec3& center, float radius, const glm::vec3& lightDirection,
+                                                  const Settings& settings) {
+    // A sugár felfelé kerekítve, hogy a lebegőpontos zaj se változtassa képkockáról képkockára
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+
+    // A fény nézőpontja a gömb mögött, a margóval a szeleten kívüli (a fény felé eső) árnyékvetőket is lefedi
+    glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    float eyeDistance = radius + settings.casterMargin;
+    glm::mat4 lightView = glm::lookAt(center - lightDirection * eyeDistance, center, up);
+
+    // Ortografikus vetítés: X, Y: [-radius, radius], mélység: [0, eyeDistance + radius] -> [0, 1] (Vulkan)
+    float depthRange = eyeDistance + radius;
+    glm::mat4 lightProjection(1.0f);
+    lightProjection[0][0] = 1.0f / radius;
+    lightProjection[1][1] = 1.0f / radius;
+    lightProjection[2][2] = -1.0f / depthRange;
+    lightProjection[3][2] = 0.0f;
+
+    // Texel igazítás: a világ origója egész texelre essen, így a kamera mozgásakor a vetítés csak egész
+    // texelekkel tolódik el, és az árnyék széle nem vibrál
+    float halfResolution = settings.resolution * 0.5f;
+    glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    float texelX = origin.x * halfResolution;
+    float texelY = origin.y * halfResolution;
+    lightProjection[3][0] += (std::round(texelX) - texelX) / halfResolution;
+    lightProjection[3][1] += (std::round(texelY) - texelY) / halfResolution;
+
+    Cascade cascade;
+    cascade.viewProjection = lightProjection * lightView;
+    cascade.splitNear = 0.0f;
+    cascade.splitFar = 0.0f;
+    cascade.radius = radius;
+    cascade.depthRange = depthRange;
+    cascade.texelWorldSize = 2.0f * radius / settings.resolution;
+    cascade.center = center;
+    cascade.revision = 0;
+    return cascade;
+}
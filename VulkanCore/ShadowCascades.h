@@ -0,0 +1,88 @@
+/**
+ * @file ShadowCascades.h
+ * @brief Kaszkádolt árnyéktérképek (CSM) felosztása és illesztése: a kamera frustumát mélység szerint szeletekre
+ * bontja (practical split scheme: a logaritmikus és az egyenletes felosztás keveréke), és minden szelethez egy
+ * ortografikus fény mátrixot illeszt. Az illesztés a szelet befoglaló gömbjére történik (a kamera forgásától független
+ * méret), a vetítés eltolása pedig egész texelre kerekített, így mozgó kameránál sem "úszik" az árnyék széle.
+ * Tartalékkal (fitSlack) illesztve egy kaszkád addig változatlan marad, amíg a szelete belefér, így a gyorsítótárazott
+ * árnyéktérkép a kamera kis mozgásainál is érvényes.
+ */
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class ShadowCascades {
+public:
+    static const uint32_t MAX_CASCADES = 4;
+
+    struct Cascade {
+        glm::mat4 viewProjection;  // A fény View * Projection mátrixa (Vulkan mélység: [0, 1])
+        float splitNear;           // A szelet nézeti mélység tartománya (a kamerától mért távolság)
+        float splitFar;
+        float radius;              // A szelet befoglaló gömbjének sugara (az ortografikus doboz fél-szélessége)
+        float depthRange;          // Az ortografikus vetítés mélység tartománya világ egységben
+        float texelWorldSize;      // Egy árnyéktérkép texel mérete világ egységben
+        glm::vec3 center;          // Az illesztett gömb középpontja világ térben
+        uint64_t revision;         // Minden újraillesztéskor új érték (a kaszkádok között is egyedi)
+    };
+
+    // A kamera vetítése és a felosztás paraméterei
+    struct Settings {
+        uint32_t cascadeCount = MAX_CASCADES;
+        float fovY = glm::radians(45.0f);
+        float aspect = 1.0f;
+        float nearPlane = 0.1f;
+        float shadowDistance = 60.0f;  // Eddig a nézeti mélységig készül árnyék (a kamera far síkja helyett)
+        float splitLambda = 0.75f;     // 0: egyenletes, 1: logaritmikus felosztás
+        float casterMargin = 40.0f;    // A szeleten kívüli, a fény felé eső árnyékvetők távolsága
+        uint32_t resolution = 2048;    // Egy kaszkád árnyéktérképének felbontása
+        float fitSlack = 0.0f;         // > 0: a gömb sugara ennyivel nagyobb a szeleténél, és csak kilógáskor illeszkedik újra
+    };
+
+    /**
+     * @brief A kaszkádok újraszámolása a kamera nézeti mátrixából és a fény irányából.
+     * @param lightDirection A fény haladási iránya (normalizált, a fényforrástól a jelenet felé).
+     */
+    void update(const glm::mat4& view, const glm::vec3& lightDirection, const Settings& settings);
+
+    /**
+     * @brief A practical split scheme i-edik határa a [nearPlane, farPlane] tartományban, count szelet esetén.
+     */
+    static float splitDistance(uint32_t i, uint32_t count, float nearPlane, float farPlane, float lambda);
+
+    uint32_t getCascadeCount() const { return cascadeCount; }
+    const Cascade& getCascade(uint32_t index) const { return cascades[index]; }
+
+    /**
+     * @brief Az összes kaszkádot lefedő fény mátrix (a teljes árnyék tartomány egy szeletként illesztve);
+     * a kaszkádoktól független, pass-onként egyszer futó lépésekhez (pl. meshlet culling).
+     */
+    const glm::mat4& getCoverMatrix() const { return coverMatrix; }
+
+    /**
+     * @brief A teljes árnyék tartományra ([nearPlane, shadowDistance]) illesztett egyetlen ortografikus fény mátrix,
+     * a settings.resolution texel rácsára igazítva (pl. az árnyék atlasz irányfényeinek csempéjéhez).
+     * Állapot nélküli: a revision 0, a fit tartalék nem számít.
+     */
+    static Cascade fitFrustum(const glm::mat4& view, const glm::vec3& lightDirection, const Settings& settings);
+
+private:
+    Cascade cascades[MAX_CASCADES] = {};
+    uint32_t cascadeCount = 0;
+    glm::mat4 coverMatrix = glm::mat4(1.0f);
+    uint64_t nextRevision = 1;
+
+    // Az előző illesztés bemenetei: eltérés esetén minden kaszkád újraillesztődik
+    Settings fittedSettings;
+    glm::vec3 fittedLightDirection = glm::vec3(0.0f);
+    bool fitted = false;
+
+    // Egy [splitNear, splitFar] szelet befoglaló gömbje világ térben
+    static void sliceSphere(const glm::mat4& inverseView, const Settings& settings, float splitNear, float splitFar,
+                            glm::vec3& center, float& radius);
+
+    // Ortografikus fény mátrix illesztése egy gömbre (a sugár felfelé kerekítve, a vetítés texelre igazítva);
+    // a revision-t a hívó adja
+    static Cascade fitSphere(const glm::vec3& center, float radius, const glm::vec3& lightDirection, const Settings& settings);
+};
@@ -0,0 +1,71 @@
+/**
+ * @file ShadowMoments.h
+ * @brief Előszűrhető árnyék (EVSM, exponential variance shadow map) a kaszkádolt árnyéktérképből. Egy compute pass a
+ * mélységből csökkentett felbontáson négy momentumot számol (a pozitív és a negatív exponenssel torzított mélység és a
+ * négyzetük, DOWNSAMPLE x DOWNSAMPLE texel átlaga), és a munkacsoport osztott memóriájában szeparálható Gauss szűrővel
+ * elmossa őket; a mip lánc utána blittel készül. A fő shader egyetlen anizotróp, trilineáris mintából a Csebisev
+ * egyenlőtlenséggel becsüli a megvilágítást, így a széles, lágy félárnyék ára nem nő a kernel méretével.
+ */
+#pragma once
+
+#include "VulkanContext.h"
+
+class ShadowMoments {
+public:
+    static const uint32_t DOWNSAMPLE = 2;   // A momentumok felbontása a mélységhez képest (shadow_moments.comp)
+    static const uint32_t TILE_SIZE = 16;   // A munkacsoport által írt csempe (shadow_moments.comp)
+    static const VkFormat FORMAT = VK_FORMAT_R32G32B32A32_SFLOAT; // A pozitív exponens négyzete fél pontosságon túlcsordulna
+
+    /**
+     * @brief A támogatás ellenőrzése, a mintavételezők, a descriptor layout és a compute pipeline létrehozása.
+     * A kép még nem jön létre (lásd createImage).
+     */
+    void create(VulkanContext* ctx);
+
+    void cleanup();
+
+    /**
+     * @brief Támogatja-e az eszköz (az RGBA32F formátum lineáris szűrése nem kötelező); ha nem, a PCF marad.
+     */
+    bool isSupported() const { return supported; }
+    bool hasImage() const { return image != VK_NULL_HANDLE; }
+
+    /**
+     * @brief A rétegzett momentum kép (teljes mip lánccal), nézetei és a compute descriptor set-je, az első EVSM fény
+     * beállításakor (a kép a mipekkel nagy, csak EVSM fénnyel kell). Minden réteg és szint olvasható layout-ba kerül.
+     * @param depthView A kaszkádok rétegzett mélységének nézete (olvasható layout-ban, a compute pass forrása).
+     */
+    void createImage(uint32_t depthWidth, uint32_t depthHeight, uint32_t layerCount, VkImageView depthView);
+
+    /**
+     * @brief A momentumok újraszámolása az első layerCount rétegre, render pass-on kívül, a kaszkádok render pass-ai után:
+     * a mélység írása után a compute olvas, a végén a teljes mip lánc a fő pass fragment shaderének olvasható.
+     */
+    void record(VkCommandBuffer commandBuffer, uint32_t layerCount);
+
+    // A fő shader nézete (az összes réteg és szint) és mintavételezője (trilineáris, anizotróp)
+    VkImageView getImageView() const { return sampledView; }
+    VkSampler getSampler() const { return sampler; }
+
+private:
+    VulkanContext* context = nullptr;
+    bool supported = false;
+
+    VkSampler sampler = VK_NULL_HANDLE;        // A fő shaderé
+    VkSampler depthSampler = VK_NULL_HANDLE;   // A compute pass mélység olvasása (texelFetch, szűrés nélkül)
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+    VkImageView sampledView = VK_NULL_HANDLE;  // Minden réteg és szint
+    VkImageView storageView = VK_NULL_HANDLE;  // Minden réteg, a 0. szint (a compute pass célja)
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t layers = 0;
+    uint32_t mipLevels = 0;
+};
@@ -0,0 +1,295 @@
+/**
+ * @file TangentKernel.cpp
+ * @brief SoA tangens kernel: skalár, SSE és AVX2 változat, futásidejű kiválasztással és szálakra bontással.
+ */
+#include "TangentKernel.h"
+#include "vertex_tools.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <thread>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TANGENT_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TANGENT_TARGET_AVX2
+#else
+#define TANGENT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define TANGENT_KERNEL_X86 0
+#endif
+
+namespace {
+
+    // Egyszerre feldolgozott háromszögek száma (a blokk elfér az L1 cache-ben)
+    constexpr size_t BLOCK_SIZE = 256;
+
+    /**
+     * @brief Háromszög blokk Structure-of-Arrays alakban: minden komponens külön, igazított tömbben,
+     * hogy a SIMD kernel egymás melletti háromszögeket egyetlen utasítással dolgozhasson fel.
+     */
+    struct TriangleBlock {
+        // Bemenet: élvektorok és UV különbségek
+        alignas(32) float e1x[BLOCK_SIZE], e1y[BLOCK_SIZE], e1z[BLOCK_SIZE];
+        alignas(32) float e2x[BLOCK_SIZE], e2y[BLOCK_SIZE], e2z[BLOCK_SIZE];
+        alignas(32) float du1x[BLOCK_SIZE], du1y[BLOCK_SIZE], du2x[BLOCK_SIZE], du2y[BLOCK_SIZE];
+        // Kimenet: normalizált tangens és (nem normalizált) bitangens; érvénytelen háromszögnél nulla
+        alignas(32) float tx[BLOCK_SIZE], ty[BLOCK_SIZE], tz[BLOCK_SIZE];
+        alignas(32) float bx[BLOCK_SIZE], by[BLOCK_SIZE], bz[BLOCK_SIZE];
+    };
+
+    // --- KERNELEK ---
+    // Mindhárom változat ugyanazt a képletet számolja, mint calculateTangent() és calculateBitangent().
+
+    void kernelScalar(TriangleBlock& b, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            float f = 1.0f / (b.du1x[i] * b.du2y[i] - b.du2x[i] * b.du1y[i]);
+            float tx = f * (b.du2y[i] * b.e1x[i] - b.du1y[i] * b.e2x[i]);
+            float ty = f * (b.du2y[i] * b.e1y[i] - b.du1y[i] * b.e2y[i]);
+            float tz = f * (b.du2y[i] * b.e1z[i] - b.du1y[i] * b.e2z[i]);
+
+            float len2 = tx * tx + ty * ty + tz * tz;
+            // NaN esetén mindkét összehasonlítás hamis, így az elfajult háromszög kimarad
+            bool valid = len2 > 0.0f && len2 < std::numeric_limits<float>::infinity();
+            if (!valid) {
+                b.tx[i] = b.ty[i] = b.tz[i] = 0.0f;
+                b.bx[i] = b.by[i] = b.bz[i] = 0.0f;
+                continue;
+            }
+
+            float inv = 1.0f / std::sqrt(len2);
+            b.tx[i] = tx * inv;
+            b.ty[i] = ty * inv;
+            b.tz[i] = tz * inv;
+            b.bx[i] = f * (b.du1x[i] * b.e2x[i] - b.du2x[i] * b.e1x[i]);
+            b.by[i] = f * (b.du1x[i] * b.e2y[i] - b.du2x[i] * b.e1y[i]);
+            b.bz[i] = f * (b.du1x[i] * b.e2z[i] - b.du2x[i] * b.e1z[i]);
+        }
+    }
+
+#if TANGENT_KERNEL_X86
+    // 4 háromszög egyszerre; a count a hívónál 8-ra van kerekítve (a kitöltő sávok érvénytelenek)
+    void kernelSSE(TriangleBlock& b, size_t count) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+
+        for (size_t i = 0; i < count; i += 4) {
+            __m128 e1x = _mm_load_ps(b.e1x + i), e1y = _mm_load_ps(b.e1y + i), e1z = _mm_load_ps(b.e1z + i);
+            __m128 e2x = _mm_load_ps(b.e2x + i), e2y = _mm_load_ps(b.e2y + i), e2z = _mm_load_ps(b.e2z + i);
+            __m128 du1x = _mm_load_ps(b.du1x + i), du1y = _mm_load_ps(b.du1y + i);
+            __m128 du2x = _mm_load_ps(b.du2x + i), du2y = _mm_load_ps(b.du2y + i);
+
+            __m128 f = _mm_div_ps(one, _mm_sub_ps(_mm_mul_ps(du1x, du2y), _mm_mul_ps(du2x, du1y)));
+
+            __m128 tx = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du2y, e1x), _mm_mul_ps(du1y, e2x)));
+            __m128 ty = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du2y, e1y), _mm_mul_ps(du1y, e2y)));
+            __m128 tz = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du2y, e1z), _mm_mul_ps(du1y, e2z)));
+
+            __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+            __m128 valid = _mm_and_ps(_mm_cmpgt_ps(len2, zero), _mm_cmplt_ps(len2, inf));
+            __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+
+            _mm_store_ps(b.tx + i, _mm_and_ps(_mm_mul_ps(tx, inv), valid));
+            _mm_store_ps(b.ty + i, _mm_and_ps(_mm_mul_ps(ty, inv), valid));
+            _mm_store_ps(b.tz + i, _mm_and_ps(_mm_mul_ps(tz, inv), valid));
+
+            __m128 bx = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1x, e2x), _mm_mul_ps(du2x, e1x)));
+            __m128 by = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1x, e2y), _mm_mul_ps(du2x, e1y)));
+            __m128 bz = _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1x, e2z), _mm_mul_ps(du2x, e1z)));
+            _mm_store_ps(b.bx + i, _mm_and_ps(bx, valid));
+            _mm_store_ps(b.by + i, _mm_and_ps(by, valid));
+            _mm_store_ps(b.bz + i, _mm_and_ps(bz, valid));
+        }
+    }
+
+    // 8 háromszög egyszerre; csak akkor hívjuk, ha a CPU támogatja az AVX2-t
+    TANGENT_TARGET_AVX2 void kernelAVX2(TriangleBlock& b, size_t count) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+        for (size_t i = 0; i < count; i += 8) {
+            __m256 e1x = _mm256_load_ps(b.e1x + i), e1y = _mm256_load_ps(b.e1y + i), e1z = _mm256_load_ps(b.e1z + i);
+            __m256 e2x = _mm256_load_ps(b.e2x + i), e2y = _mm256_load_ps(b.e2y + i), e2z = _mm256_load_ps(b.e2z + i);
+            __m256 du1x = _mm256_load_ps(b.du1x + i), du1y = _mm256_load_ps(b.du1y + i);
+            __m256 du2x = _mm256_load_ps(b.du2x + i), du2y = _mm256_load_ps(b.du2y + i);
+
+            __m256 f = _mm256_div_ps(one, _mm256_sub_ps(_mm256_mul_ps(du1x, du2y), _mm256_mul_ps(du2x, du1y)));
+
+            __m256 tx = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du2y, e1x), _mm256_mul_ps(du1y, e2x)));
+            __m256 ty = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du2y, e1y), _mm256_mul_ps(du1y, e2y)));
+            __m256 tz = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du2y, e1z), _mm256_mul_ps(du1y, e2z)));
+
+            __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, tx), _mm256_mul_ps(ty, ty)), _mm256_mul_ps(tz, tz));
+            __m256 valid = _mm256_and_ps(_mm256_cmp_ps(len2, zero, _CMP_GT_OQ), _mm256_cmp_ps(len2, inf, _CMP_LT_OQ));
+            __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+
+            _mm256_store_ps(b.tx + i, _mm256_and_ps(_mm256_mul_ps(tx, inv), valid));
+            _mm256_store_ps(b.ty + i, _mm256_and_ps(_mm256_mul_ps(ty, inv), valid));
+            _mm256_store_ps(b.tz + i, _mm256_and_ps(_mm256_mul_ps(tz, inv), valid));
+
+            __m256 bx = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du1x, e2x), _mm256_mul_ps(du2x, e1x)));
+            __m256 by = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du1x, e2y), _mm256_mul_ps(du2x, e1y)));
+            __m256 bz = _mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(du1x, e2z), _mm256_mul_ps(du2x, e1z)));
+            _mm256_store_ps(b.bx + i, _mm256_and_ps(bx, valid));
+            _mm256_store_ps(b.by + i, _mm256_and_ps(by, valid));
+            _mm256_store_ps(b.bz + i, _mm256_and_ps(bz, valid));
+        }
+    }
+#endif
+}
+
+TangentKernel::Isa TangentKernel::detectIsa() {
+#if TANGENT_KERNEL_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        // Az operációs rendszernek is mentenie kell az YMM regisztereket
+        bool ymmEnabled = osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        if (ymmEnabled && (info[1] & (1 << 5)) != 0) return Isa::AVX2;
+    }
+    return Isa::SSE;
+#else
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    return Isa::SSE;
+#endif
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char* TangentKernel::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE:  return "SSE";
+        case Isa::AVX2: return "AVX2";
+        default:        return "Scalar";
+    }
+}
+
+std::vector<glm::vec4> TangentKernel::computeVertexTangents(const std::vector<float>& vertices, size_t stride,
+                                                            const std::vector<uint32_t>& indices,
+                                                            Isa isa, unsigned threadCount) {
+    const size_t vertexCount = vertices.size() / stride;
+    const size_t triangleCount = indices.size() / 3;
+
+#if !TANGENT_KERNEL_X86
+    isa = Isa::Scalar;
+#endif
+
+    if (threadCount == 0) {
+        threadCount = triangleCount >= PARALLEL_THRESHOLD ? std::max(1u, std::thread::hardware_concurrency()) : 1u;
+    }
+
+    // Vertexenkénti összegek: T(3) és B(3), vertexenként 6 float
+    std::vector<float> sums(vertexCount * 6, 0.0f);
+    const bool parallel = threadCount > 1;
+
+    // --- 1. Háromszögenkénti tangens és bitangens (SoA blokkok, SIMD) ---
+    // Egy szálon az eredményt azonnal a vertexekhez adjuk (háromszög sorrendben, mint a referencia).
+    // Több szálon háromszögenként eltároljuk (T(3), B(3)), és a 2. lépés gyűjti össze.
+    std::vector<float> triangleFrames(parallel ? triangleCount * 6 : 0);
+    const size_t blockCount = (triangleCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    parallelFor(blockCount, threadCount, [&](size_t firstBlock, size_t lastBlock) {
+        TriangleBlock block;
+        for (size_t blockIndex = firstBlock; blockIndex < lastBlock; blockIndex++) {
+            size_t base = blockIndex * BLOCK_SIZE;
+            size_t count = std::min(BLOCK_SIZE, triangleCount - base);
+            const uint32_t* tri = &indices[base * 3];
+            // A SIMD kernelek teljes sávokkal dolgoznak: a kitöltő háromszögek nulla UV-val érvénytelenek lesznek
+            size_t paddedCount = (count + 7) & ~size_t(7);
+
+            // Gyűjtés (Gather): AoS vertexek -> SoA háromszög komponensek
+            for (size_t i = 0; i < count; i++) {
+                const float* v1 = &vertices[tri[i * 3 + 0] * stride];
+                const float* v2 = &vertices[tri[i * 3 + 1] * stride];
+                const float* v3 = &vertices[tri[i * 3 + 2] * stride];
+
+                block.e1x[i] = v2[0] - v1[0]; block.e1y[i] = v2[1] - v1[1]; block.e1z[i] = v2[2] - v1[2];
+                block.e2x[i] = v3[0] - v1[0]; block.e2y[i] = v3[1] - v1[1]; block.e2z[i] = v3[2] - v1[2];
+                block.du1x[i] = v2[6] - v1[6]; block.du1y[i] = v2[7] - v1[7];
+                block.du2x[i] = v3[6] - v1[6]; block.du2y[i] = v3[7] - v1[7];
+            }
+            for (size_t i = count; i < paddedCount; i++) {
+                block.e1x[i] = block.e1y[i] = block.e1z[i] = 0.0f;
+                block.e2x[i] = block.e2y[i] = block.e2z[i] = 0.0f;
+                block.du1x[i] = block.du1y[i] = block.du2x[i] = block.du2y[i] = 0.0f;
+            }
+
+            switch (isa) {
+#if TANGENT_KERNEL_X86
+                case Isa::AVX2: kernelAVX2(block, paddedCount); break;
+                case Isa::SSE:  kernelSSE(block, paddedCount); break;
+#endif
+                default:        kernelScalar(block, count); break;
+            }
+
+            // Szórás (Scatter): SoA eredmény -> vertex összegek vagy háromszögenkénti AoS tömb
+            for (size_t i = 0; i < count; i++) {
+                if (parallel) {
+                    float* frame = &triangleFrames[(base + i) * 6];
+                    frame[0] = block.tx[i]; frame[1] = block.ty[i]; frame[2] = block.tz[i];
+                    frame[3] = block.bx[i]; frame[4] = block.by[i]; frame[5] = block.bz[i];
+                    continue;
+                }
+                for (size_t k = 0; k < 3; k++) {
+                    float* sum = &sums[tri[i * 3 + k] * size_t(6)];
+                    sum[0] += block.tx[i]; sum[1] += block.ty[i]; sum[2] += block.tz[i];
+                    sum[3] += block.bx[i]; sum[4] += block.by[i]; sum[5] += block.bz[i];
+                }
+            }
+        }
+    });
+
+    // --- 2. Párhuzamos összegzés vertex -> háromszög szomszédsági listával (CSR) ---
+    // A háromszögeket növekvő sorrendben soroljuk fel, így az összegzés sorrendje megegyezik a referenciáéval,
+    // és a vertexenkénti összegzés versenyhelyzet nélkül párhuzamosítható.
+    if (parallel) {
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        parallelFor(vertexCount, threadCount, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; v++) {
+                float* sum = &sums[v * 6];
+                for (uint32_t k = adjacencyOffsets[v]; k < adjacencyOffsets[v + 1]; k++) {
+                    const float* frame = &triangleFrames[adjacency[k] * size_t(6)];
+                    for (int c = 0; c < 6; c++) sum[c] += frame[c];
+                }
+            }
+        });
+    }
+
+    // --- 3. Gram-Schmidt és kezesség vertexenként ---
+    std::vector<glm::vec4> tangents(vertexCount);
+    parallelFor(vertexCount, threadCount, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            const float* sum = &sums[v * 6];
+            const float* vertex = &vertices[v * stride];
+            tangents[v] = finalizeVertexTangent(glm::vec3(vertex[3], vertex[4], vertex[5]),
+                                                glm::vec3(sum[0], sum[1], sum[2]),
+                                                glm::vec3(sum[3], sum[4], sum[5]));
+        }
+    });
+
+    return tangents;
+}
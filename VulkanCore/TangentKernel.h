@@ -0,0 +1,55 @@
+/**
+ * @file TangentKernel.h
+ * @brief Vertexenkénti tangens számítás SIMD (SSE/AVX2) és többszálú feldolgozással.
+ * Az eredmény a vertex_tools.h calculateVertexTangents() skalár referenciájával egyezik MATCH_EPSILON pontossággal.
+ */
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class TangentKernel {
+public:
+    // A háromszögenkénti számításhoz használt utasításkészlet
+    enum class Isa {
+        Scalar, // Hordozható C++ (bármely CPU)
+        SSE,    // 4 háromszög egyszerre (x86 alap)
+        AVX2    // 8 háromszög egyszerre (futásidőben ellenőrizve)
+    };
+
+    // Megengedett eltérés komponensenként a skalár referenciától
+    static constexpr float MATCH_EPSILON = 1e-4f;
+
+    // Ennyi háromszög alatt nem éri meg szálakat indítani
+    static constexpr size_t PARALLEL_THRESHOLD = 32768;
+
+    /**
+     * @brief A futtató CPU által támogatott legjobb utasításkészlet.
+     */
+    static Isa detectIsa();
+
+    static const char* isaName(Isa isa);
+
+    /**
+     * @brief Vertexenkénti tangensek (XYZ) és kezesség (W) számítása indexelt geometriához.
+     * 1. A háromszögeket blokkonként Structure-of-Arrays alakba gyűjtjük, és SIMD kernellel számoljuk a tangenst/bitangenst.
+     * 2. Vertexenként összegezzük a szomszédos háromszögek eredményét (háromszög sorrendben, mint a referencia).
+     * 3. Gram-Schmidt ortogonalizálás és kezesség (finalizeVertexTangent).
+     * Nagy mesh-eknél mindhárom lépést több szálra osztjuk.
+     * @param vertices Vertex adatok (Pos(3), Norm(3), UV(2), ... vertexenként stride darab float)
+     * @param stride Egy vertex float komponenseinek száma
+     * @param indices Háromszög indexek
+     * @param isa A használt utasításkészlet (alapértelmezés: a legjobb elérhető)
+     * @param threadCount Szálak száma (0: automatikus, a hardver szálak száma alapján)
+     */
+    static std::vector<glm::vec4> computeVertexTangents(const std::vector<float>& vertices, size_t stride,
+                                                        const std::vector<uint32_t>& indices,
+                                                        Isa isa, unsigned threadCount = 0);
+
+    static std::vector<glm::vec4> computeVertexTangents(const std::vector<float>& vertices, size_t stride,
+                                                        const std::vector<uint32_t>& indices) {
+        return computeVertexTangents(vertices, stride, indices, detectIsa());
+    }
+};
@@ -0,0 +1,182 @@
+/**
+ * @file VertexFormat.h
+ * @brief A GPU-ra feltöltött vertex elrendezések (Full: 44 byte, Compact: 20 byte) leírása.
+ * Itt található a pipeline-ok vertex input konfigurációja és a tömörítéshez használt kódoló függvények.
+ */
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * @brief A választható vertex formátumok.
+ * Full:    Pos(3) + Norm(3) + UV(2) + Tan(3) float = 44 byte.
+ * Compact: snorm16 pozíció (+ tangens előjel a W-ben), oktaéder kódolt snorm16 normál és tangens,
+ *          half-float UV = 20 byte. A pozíciót a mesh befoglaló dobozára kvantáljuk, a visszaalakítás
+ *          (skála + eltolás) a MeshObject model mátrixába van beolvasztva.
+ *
+ * Mindkét formátum két külön folyamban (binding) tárolódik: a szorosan pakolt pozíciók (binding 0) és a többi
+ * attribútum (binding 1). A csak mélységet író pass-ok (árnyék, depth prepass) csak a pozíció folyamot kötik be,
+ * így vertexenként 12 (Full) vagy 8 (Compact) byte-ot olvasnak a teljes 44 / 20 helyett.
+ * Egy mesh vertex adatai memóriában (staging, mesh cache) folyamonként egymás után: előbb az összes pozíció,
+ * utána az összes attribútum.
+ */
+enum class VertexFormat {
+    Full,
+    Compact
+};
+
+/**
+ * @brief A Compact formátum egy vertexének pozíció része (pozíció folyam).
+ */
+struct CompactPosition {
+    int16_t position[4]; // XYZ: kvantált pozíció [-1, 1], W: tangens kezesség (+1 / -1)
+};
+
+/**
+ * @brief A Compact formátum egy vertexének többi attribútuma (attribútum folyam).
+ */
+struct CompactAttributes {
+    int16_t normal[2];    // Oktaéder kódolt normálvektor
+    uint16_t texCoord[2]; // Half-float UV
+    int16_t tangent[2];   // Oktaéder kódolt tangens
+};
+static_assert(sizeof(CompactPosition) + sizeof(CompactAttributes) == 20, "Compact vertices must stay 20 bytes");
+
+namespace VertexLayout {
+
+    // A két vertex folyam binding indexe
+    const uint32_t POSITION_BINDING = 0;
+    const uint32_t ATTRIBUTE_BINDING = 1;
+
+    // Egy vertex pozíciójának mérete a pozíció folyamban (byte)
+    inline uint32_t getPositionStride(VertexFormat format) {
+        return format == VertexFormat::Compact ? sizeof(CompactPosition) : sizeof(float) * 3;
+    }
+
+    // Egy vertex többi attribútumának mérete az attribútum folyamban (byte): Norm(3) + UV(2) + Tan(3) float Full esetén
+    inline uint32_t getAttributeStride(VertexFormat format) {
+        return format == VertexFormat::Compact ? sizeof(CompactAttributes) : sizeof(float) * 8;
+    }
+
+    // Egy vertex teljes mérete byte-ban (a két folyam együtt)
+    inline uint32_t getStride(VertexFormat format) {
+        return getPositionStride(format) + getAttributeStride(format);
+    }
+
+    // Binding leírások (Binding 0: pozíciók, Binding 1: attribútumok; vertexenkénti léptetés)
+    inline std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions(VertexFormat format) {
+        return {{
+            { POSITION_BINDING, getPositionStride(format), VK_VERTEX_INPUT_RATE_VERTEX },
+            { ATTRIBUTE_BINDING, getAttributeStride(format), VK_VERTEX_INPUT_RATE_VERTEX }
+        }};
+    }
+
+    /**
+     * @brief A 4 attribútum leírása (Location 0..3: Pozíció, Normál, UV, Tangens).
+     * A shader mindkét formátumnál ugyanazokat a bemeneteket látja; a hiányzó komponenseket a hardver tölti ki
+     * (Full formátumnál a pozíció W = 1.0, ami egyben a tangens +1 kezessége).
+     */
+    inline std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions(VertexFormat format) {
+        std::array<VkVertexInputAttributeDescription, 4> attributes{};
+        if (format == VertexFormat::Compact) {
+            attributes[0] = {0, POSITION_BINDING,  VK_FORMAT_R16G16B16A16_SNORM, offsetof(CompactPosition, position)};
+            attributes[1] = {1, ATTRIBUTE_BINDING, VK_FORMAT_R16G16_SNORM,       offsetof(CompactAttributes, normal)};
+            attributes[2] = {2, ATTRIBUTE_BINDING, VK_FORMAT_R16G16_SFLOAT,      offsetof(CompactAttributes, texCoord)};
+            attributes[3] = {3, ATTRIBUTE_BINDING, VK_FORMAT_R16G16_SNORM,       offsetof(CompactAttributes, tangent)};
+        } else {
+            attributes[0] = {0, POSITION_BINDING,  VK_FORMAT_R32G32B32_SFLOAT, 0};
+            attributes[1] = {1, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, 0};
+            attributes[2] = {2, ATTRIBUTE_BINDING, VK_FORMAT_R32G32_SFLOAT,    3 * sizeof(float)};
+            attributes[3] = {3, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, 5 * sizeof(float)};
+        }
+        return attributes;
+    }
+
+    // Csak mélységet író pipeline-okhoz: egyetlen binding, a pozíció folyam
+    inline VkVertexInputBindingDescription getPositionBindingDescription(VertexFormat format) {
+        return getBindingDescriptions(format)[POSITION_BINDING];
+    }
+
+    inline VkVertexInputAttributeDescription getPositionAttributeDescription(VertexFormat format) {
+        return getAttributeDescriptions(format)[0];
+    }
+
+    // [-1, 1] tartományú érték snorm16 kódolása (kerekítéssel)
+    inline int16_t packSnorm16(float value) {
+        float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+    }
+
+    /**
+     * @brief Egységvektor oktaéder kódolása két snorm16 értékbe.
+     * A vektort az |x|+|y|+|z| = 1 oktaéderre vetítjük, az alsó félteret pedig ráhajtjuk a felsőre.
+     * A dekódolás a shader.vert octDecode() függvényében történik.
+     */
+    inline void octEncode(const glm::vec3& v, int16_t out[2]) {
+        glm::vec3 n = v / (std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z));
+        float x = n.x;
+        float y = n.y;
+        if (n.z < 0.0f) {
+            x = (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            y = (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        out[0] = packSnorm16(x);
+        out[1] = packSnorm16(y);
+    }
+
+    // Float -> half-float (IEEE 754 binary16) konverzió
+    inline uint16_t packHalf(float value) {
+        return glm::packHalf1x16(value);
+    }
+
+    /**
+     * @brief A Compact pozíció kvantálás paraméterei a befoglaló dobozból.
+     * A doboz középpontja az eltolás, a legnagyobb fél-kiterjedése az egységes skála
+     * (egységes skála, hogy a model mátrix mat3 része továbbra is helyesen forgassa a normálokat).
+     */
+    inline void computeQuantization(const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& bias, float& scale) {
+        bias = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 halfExtent = (boundsMax - boundsMin) * 0.5f;
+        scale = std::fmax(halfExtent.x, std::fmax(halfExtent.y, halfExtent.z));
+        if (scale <= 0.0f) scale = 1.0f;
+    }
+
+    /**
+     * @brief Egy vertex Compact kódolása a két folyamba (lásd CompactPosition, CompactAttributes).
+     * @param tangent XYZ: egység tangens, W: kezesség (+1 / -1)
+     */
+    inline void encodeCompact(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& texCoord, const glm::vec4& tangent,
+                              const glm::vec3& bias, float scale, CompactPosition& outPosition, CompactAttributes& outAttributes) {
+        // Pozíció: [-1, 1] tartományba normalizálva, snorm16; W = tangens kezesség
+        glm::vec3 p = (position - bias) / scale;
+        outPosition.position[0] = packSnorm16(p.x);
+        outPosition.position[1] = packSnorm16(p.y);
+        outPosition.position[2] = packSnorm16(p.z);
+        outPosition.position[3] = packSnorm16(tangent.w);
+
+        // Normál és tangens: oktaéder kódolás (2 x snorm16)
+        octEncode(normal, outAttributes.normal);
+        octEncode(glm::vec3(tangent), outAttributes.tangent);
+
+        // UV: half-float
+        outAttributes.texCoord[0] = packHalf(texCoord.x);
+        outAttributes.texCoord[1] = packHalf(texCoord.y);
+    }
+
+    /**
+     * @brief Egy vertex Full kódolása a két folyamba: 3 float pozíció és 8 float attribútum (Norm, UV, Tangens XYZ).
+     */
+    inline void encodeFull(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& texCoord, const glm::vec4& tangent,
+                           float* outPosition, float* outAttributes) {
+        outPosition[0] = position.x; outPosition[1] = position.y; outPosition[2] = position.z;
+        outAttributes[0] = normal.x;   outAttributes[1] = normal.y;   outAttributes[2] = normal.z;
+        outAttributes[3] = texCoord.x; outAttributes[4] = texCoord.y;
+        outAttributes[5] = tangent.x;  outAttributes[6] = tangent.y;  outAttributes[7] = tangent.z;
+    }
+}
@@ -184,15 +184,53 @@ void VulkanContext::createLogicalDevice(VkSurfaceKHR surface) {
         featuresToEnable.samplerAnisotropy = VK_TRUE;
     }
 
+    // 3. GPU-vezérelt rajzoláshoz (opcionális): több parancs egy indirekt hívásban és nem nulla firstInstance
+    if (supportedFeatures.multiDrawIndirect) {
+        featuresToEnable.multiDrawIndirect = VK_TRUE;
+    }
+    if (supportedFeatures.drawIndirectFirstInstance) {
+        featuresToEnable.drawIndirectFirstInstance = VK_TRUE;
+    }
+
+    // 4. Pontfény árnyékok (opcionális): a kocka árnyéktérképek egyetlen kocka tömbként olvashatók (samplerCubeArrayShadow)
+    if (supportedFeatures.imageCubeArray) {
+        featuresToEnable.imageCubeArray = VK_TRUE;
+    }
+
     enabledDeviceFeatures = featuresToEnable;
 
+    // Opcionális kiterjesztés: a rajzolások számát a GPU írja (vkCmdDrawIndexedIndirectCountKHR)
+    vector<const char*> enabledExtensions = deviceExtensions;
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+    bool drawIndirectCountSupported = false;
+    for (const auto& extension : availableExtensions) {
+        if (strcmp(extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0) {
+            drawIndirectCountSupported = true;
+            enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+        // Opcionális kiterjesztés: egy render pass több nézetbe (rétegbe) rajzol egyszerre (a pontfény kocka árnyékai);
+        // a kiterjesztés támogatása a multiview funkciót is jelenti, de az instance kiterjesztése is kell hozzá
+        if (strcmp(extension.extensionName, VK_KHR_MULTIVIEW_EXTENSION_NAME) == 0 && physicalDeviceProperties2Enabled) {
+            multiviewSupported = true;
+            enabledExtensions.push_back(VK_KHR_MULTIVIEW_EXTENSION_NAME);
+        }
+    }
+
+    VkPhysicalDeviceMultiviewFeatures multiviewFeatures{};
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+    multiviewFeatures.multiview = VK_TRUE;
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = multiviewSupported ? &multiviewFeatures : nullptr;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &enabledDeviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -206,6 +244,11 @@ void VulkanContext::createLogicalDevice(VkSurfaceKHR surface) {
         throw runtime_error("failed to create logical device!");
     }
 
+    if (drawIndirectCountSupported) {
+        cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+
     // Handle-ök lekérése a létrehozott sorokhoz
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
@@ -241,7 +284,7 @@ bool VulkanContext::isDeviceSuitable(VkPhysicalDevice dev, VkSurfaceKHR surface)
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(dev, &supportedFeatures);
 
-    // Kifejezetten ellenőrizzük a wireframe és anizotróp szűrés támogatását
+    // Kifejezetten ellenőrizzük a wireframe és az anizotróp szűrés támogatását
     bool featuresAdequate = supportedFeatures.fillModeNonSolid && supportedFeatures.samplerAnisotropy;
 
     return indices.isComplete() && extensionsSupported && swapChainAdequate && featuresAdequate;
@@ -339,6 +382,18 @@ std::vector<const char*> VulkanContext::getRequiredExtensions() {
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
+
+    // Opcionális: a VK_KHR_multiview eszköz kiterjesztés (Vulkan 1.0 alatt) ezt az instance kiterjesztést igényli
+    uint32_t availableCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr);
+    vector<VkExtensionProperties> available(availableCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, available.data());
+    for (const auto& extension : available) {
+        if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+            physicalDeviceProperties2Enabled = true;
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+    }
     return extensions;
 }
 
@@ -433,14 +488,16 @@ void VulkanContext::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceS
     });
 }
 
-void VulkanContext::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+void VulkanContext::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+                                uint32_t arrayLayers, VkImageCreateFlags flags, uint32_t mipLevels) {
     // 2D kép objektum létrehozása (textúráknak vagy árnyéktérképeknek)
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent = {width, height, 1};
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = arrayLayers;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -466,18 +523,20 @@ void VulkanContext::createImage(uint32_t width, uint32_t height, VkFormat format
     vkBindImageMemory(device, image, imageMemory, 0);
 }
 
-VkImageView VulkanContext::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+VkImageView VulkanContext::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+                                          VkImageViewType viewType, uint32_t baseArrayLayer, uint32_t layerCount,
+                                          uint32_t levelCount) {
     // Képnézet létrehozása, ami meghatározza, hogyan férünk hozzá a kép adataihoz
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = viewType;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.levelCount = levelCount;
+    viewInfo.subresourceRange.baseArrayLayer = baseArrayLayer;
+    viewInfo.subresourceRange.layerCount = layerCount;
 
     VkImageView imageView;
     if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
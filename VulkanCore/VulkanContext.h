@@ -63,6 +63,13 @@ public:
     VkQueue getPresentQueue() const { return presentQueue; }
     VkCommandPool getCommandPool() const { return commandPool; }
     QueueFamilyIndices getQueueFamilies() const { return queueIndices; }
+    const VkPhysicalDeviceFeatures& getEnabledFeatures() const { return enabledDeviceFeatures; }
+    // A VK_KHR_draw_indirect_count parancsa (nullptr, ha az eszköz nem támogatja)
+    PFN_vkCmdDrawIndexedIndirectCountKHR getCmdDrawIndexedIndirectCount() const { return cmdDrawIndexedIndirectCount; }
+    // VK_KHR_multiview: egy render pass egyszerre több rétegbe rajzol (gl_ViewIndex)
+    bool isMultiviewSupported() const { return multiviewSupported; }
+    // imageCubeArray: kocka tömb nézetek és samplerCubeArray a shaderben (a pontfény kocka árnyékai)
+    bool isImageCubeArraySupported() const { return enabledDeviceFeatures.imageCubeArray == VK_TRUE; }
 
     // --- Segédfüggvények a rendereléshez és memóriakezeléshez ---
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice dev, VkSurfaceKHR surf);
@@ -72,11 +79,16 @@ public:
     // Általános célú GPU puffer (Vertex, Index, Uniform) létrehozása
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 
-    // Nyers képobjektum létrehozása a GPU-n
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+    // Nyers képobjektum létrehozása a GPU-n (arrayLayers > 1: rétegzett kép, pl. kaszkádolt árnyéktérkép;
+    // flags: pl. VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT a kocka nézetekhez; mipLevels: a mip szintek száma)
+    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+                     uint32_t arrayLayers = 1, VkImageCreateFlags flags = 0, uint32_t mipLevels = 1);
 
     // Képnézet (ImageView) létrehozása, ami meghatározza a kép értelmezését a shaderben
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    // (rétegzett képnél a nézet típusa és a látott rétegek tartománya, mipes képnél a látott szintek száma is megadható)
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+                                VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1,
+                                uint32_t levelCount = 1);
 
     // Azonnali parancsvégrehajtás (pl. adatátvitel staging pufferből végleges helyre)
     void executeSingleTimeCommands(std::function<void(VkCommandBuffer)> commandFunction);
@@ -111,6 +123,9 @@ private:
     VkDevice device;                                 // A szoftveres interfész a kártyához
     VkCommandPool commandPool;                       // A parancspufferek gyűjtőhelye
     VkPhysicalDeviceFeatures enabledDeviceFeatures = {}; // Engedélyezett hardveres funkciók
+    PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr; // Opcionális kiterjesztés
+    bool physicalDeviceProperties2Enabled = false;   // VK_KHR_get_physical_device_properties2 (instance)
+    bool multiviewSupported = false;                 // VK_KHR_multiview engedélyezve
 
     VkQueue graphicsQueue;                           // Grafikai műveletek sora
     VkQueue presentQueue;                            // Megjelenítési műveletek sora
@@ -1,6 +1,6 @@
 /**
  * @file VulkanPipeline.cpp
- * @brief Grafikai pipeline megvalósítása: 11 float/vertex (Tangent támogatás) és 3 textúra binding (Normal Map).
+ * @brief Grafikai pipeline megvalósítása: Full (11 float) és Compact (20 byte) vertex formátum, 3 textúra binding (Normal Map).
  */
 #include "VulkanPipeline.h"
 
@@ -15,8 +15,9 @@ using namespace std;
 
 VulkanPipeline::VulkanPipeline() : context(nullptr), renderPass(VK_NULL_HANDLE),
                                    pipelineLayout(VK_NULL_HANDLE), graphicsPipeline(VK_NULL_HANDLE),
-                                   wireframePipeline(VK_NULL_HANDLE), descriptorSetLayout(VK_NULL_HANDLE),
-                                   shadowSetLayout(VK_NULL_HANDLE) {
+                                   compactGraphicsPipeline(VK_NULL_HANDLE), wireframePipeline(VK_NULL_HANDLE), descriptorSetLayout(VK_NULL_HANDLE),
+                                   shadowSetLayout(VK_NULL_HANDLE), instanceSetLayout(VK_NULL_HANDLE),
+                                   frameSetLayout(VK_NULL_HANDLE) {
 }
 
 VulkanPipeline::~VulkanPipeline() {
@@ -38,11 +39,14 @@ void VulkanPipeline::cleanup() {
     }
     vkDestroyPipeline(context->getDevice(), wireframePipeline, nullptr);
     vkDestroyPipeline(context->getDevice(), graphicsPipeline, nullptr);
+    vkDestroyPipeline(context->getDevice(), compactGraphicsPipeline, nullptr);
     vkDestroyPipelineLayout(context->getDevice(), pipelineLayout, nullptr);
     vkDestroyRenderPass(context->getDevice(), renderPass, nullptr);
 
     vkDestroyDescriptorSetLayout(context->getDevice(), descriptorSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(context->getDevice(), shadowSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(context->getDevice(), instanceSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(context->getDevice(), frameSetLayout, nullptr);
 }
 
 void VulkanPipeline::createRenderPass(VkFormat swapchainFormat, VkFormat depthFormat) {
@@ -100,7 +104,9 @@ void VulkanPipeline::createRenderPass(VkFormat swapchainFormat, VkFormat depthFo
 void VulkanPipeline::createGraphicsPipeline() {
     // Sharderek betöltése és modulok létrehozása
     auto vertShaderCode = readFile("shaders/vert.spv");
-    auto fragShaderCode = readFile("shaders/frag.spv");
+    // Kocka tömb nélkül a pontfény árnyékok nélküli változat (a samplerCubeArray a funkciót igényli)
+    auto fragShaderCode = readFile(context->isImageCubeArraySupported() ? "shaders/frag.spv"
+                                                                        : "shaders/frag_no_cube_array.spv");
 
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
     VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -116,26 +122,25 @@ void VulkanPipeline::createGraphicsPipeline() {
     fragShaderStageInfo.module = fragShaderModule;
     fragShaderStageInfo.pName = "main";
 
+    // Specialization Constant (constant_id = 0): a vertex shader a Compact formátumot dekódolja-e
+    VkSpecializationMapEntry specializationEntry{0, 0, sizeof(VkBool32)};
+    VkBool32 compactVertices = VK_FALSE;
+    VkSpecializationInfo specializationInfo{1, &specializationEntry, sizeof(VkBool32), &compactVertices};
+    vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    // --- VERTEX INPUT KONFIGURÁCIÓ (11 float stride) ---
-    // Adatszerkezet: Pozíció(3) + Normál(3) + UV(2) + Tangens(3)
-    VkVertexInputBindingDescription bindingInfo = { 0, sizeof(float) * 11, VK_VERTEX_INPUT_RATE_VERTEX };
-
-    // 4 attribútum leírása a shader bemenetekhez (layout locations)
-    std::array<VkVertexInputAttributeDescription, 4> attributeInfos;
-    // 0: Pozíció (vec3)
-    attributeInfos[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};
-    // 1: Normál (vec3)
-    attributeInfos[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float)};
-    // 2: UV koordináta (vec2)
-    attributeInfos[2] = {2, 0, VK_FORMAT_R32G32_SFLOAT,    6 * sizeof(float)};
-    // 3: Tangens (vec3) - Normal Mapping-hez kritikus
-    attributeInfos[3] = {3, 0, VK_FORMAT_R32G32B32_SFLOAT, 8 * sizeof(float)};
+    // --- VERTEX INPUT KONFIGURÁCIÓ ---
+    // Két binding: 0 = pozíció folyam, 1 = attribútum folyam (normál, UV, tangens)
+    // Full:    Pozíció(3) | Normál(3) + UV(2) + Tangens(3) float, 12 + 32 byte stride
+    // Compact: snorm16 pozíció | oktaéder normál/tangens + half UV, 8 + 12 byte stride
+    // (a tényleges leírást a pipeline-onkénti ciklus tölti ki, lásd VertexFormat.h)
+    std::array<VkVertexInputBindingDescription, 2> bindingInfos{};
+    std::array<VkVertexInputAttributeDescription, 4> attributeInfos{};
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingInfo;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingInfos.size());
+    vertexInputInfo.pVertexBindingDescriptions = bindingInfos.data();
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeInfos.size());
     vertexInputInfo.pVertexAttributeDescriptions = attributeInfos.data();
 
@@ -202,17 +207,31 @@ void VulkanPipeline::createGraphicsPipeline() {
 
     vkCreateDescriptorSetLayout(context->getDevice(), &shadowLayoutInfo, nullptr, &shadowSetLayout);
 
-    // Pipeline Layout: Meghatározza, hogyan férnek hozzá a shaderek az adatokhoz
-    std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, shadowSetLayout};
+    // Set 2: Példány adatok (model mátrixok storage bufferben, a renderer azonos elrendezésű set-jével kompatibilis)
+    std::vector<VkDescriptorSetLayoutBinding> instanceBindings = { {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr} };
+    VkDescriptorSetLayoutCreateInfo instanceLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    instanceLayoutInfo.bindingCount = 1;
+    instanceLayoutInfo.pBindings = instanceBindings.data();
+
+    vkCreateDescriptorSetLayout(context->getDevice(), &instanceLayoutInfo, nullptr, &instanceSetLayout);
+
+    // Set 3: Frame adatok (kamera és fény mátrixok, kamera pozíció, fénylista uniform pufferben, a renderer frame
+    // set-jével kompatibilis). Push constant helyett, hogy a rögzített secondary bufferek a következő képkockákban is
+    // visszajátszhatók legyenek.
+    std::vector<VkDescriptorSetLayoutBinding> frameBindings = {
+        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} };
+    VkDescriptorSetLayoutCreateInfo frameLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    frameLayoutInfo.bindingCount = 1;
+    frameLayoutInfo.pBindings = frameBindings.data();
 
-    // Push Constants: Gyors adatátvitel mátrixokhoz (128 byte: Model + MVP)
-    VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof(glm::mat4)};
+    vkCreateDescriptorSetLayout(context->getDevice(), &frameLayoutInfo, nullptr, &frameSetLayout);
+
+    // Pipeline Layout: Meghatározza, hogyan férnek hozzá a shaderek az adatokhoz
+    std::array<VkDescriptorSetLayout, 4> setLayouts = {descriptorSetLayout, shadowSetLayout, instanceSetLayout, frameSetLayout};
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
     pipelineLayoutInfo.pSetLayouts = setLayouts.data();
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     vkCreatePipelineLayout(context->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
 
@@ -231,8 +250,16 @@ void VulkanPipeline::createGraphicsPipeline() {
     pipelineInfo.layout = pipelineLayout;
     pipelineInfo.renderPass = renderPass;
 
-    if (vkCreateGraphicsPipelines(context->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
+    // Egy pipeline vertex formátumonként: csak a vertex input és a specialization constant tér el
+    for (VertexFormat format : {VertexFormat::Full, VertexFormat::Compact}) {
+        bindingInfos = VertexLayout::getBindingDescriptions(format);
+        attributeInfos = VertexLayout::getAttributeDescriptions(format);
+        compactVertices = (format == VertexFormat::Compact) ? VK_TRUE : VK_FALSE;
+
+        VkPipeline& target = (format == VertexFormat::Compact) ? compactGraphicsPipeline : graphicsPipeline;
+        if (vkCreateGraphicsPipelines(context->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &target) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create graphics pipeline!");
+        }
     }
 
     // A shader modulokra nincs szükség a pipeline létrejötte után
@@ -2,6 +2,7 @@
 
 #include "VulkanContext.h"
 #include "VulkanSwapchain.h"
+#include "VertexFormat.h"
 #include <string>
 #include <vector>
 
@@ -29,7 +30,10 @@ public:
     void cleanup();
 
     // --- Getter függvények a renderelés vezérléséhez ---
-    VkPipeline getGraphicsPipeline() { return graphicsPipeline; } // A tényleges csővezeték objektum
+    // A tényleges csővezeték objektum az adott vertex formátumhoz
+    VkPipeline getGraphicsPipeline(VertexFormat format = VertexFormat::Full) {
+        return format == VertexFormat::Compact ? compactGraphicsPipeline : graphicsPipeline;
+    }
     VkPipelineLayout getPipelineLayout() { return pipelineLayout; } // Uniform/Push constant elrendezés
     VkRenderPass getRenderPass() { return renderPass; }           // A renderelési szakasz leírása
     VkDescriptorSetLayout getDescriptorSetLayout() { return descriptorSetLayout; } // Textúra binding struktúra
@@ -47,8 +51,11 @@ private:
     VkRenderPass renderPass;                  // Meghatározza a szín/mélység csatolókat
     VkDescriptorSetLayout descriptorSetLayout; // Anyag textúrák elrendezése (Set 0)
     VkDescriptorSetLayout shadowSetLayout;     // Árnyéktérkép elrendezése (Set 1)
+    VkDescriptorSetLayout instanceSetLayout;   // Példány model mátrixok elrendezése (Set 2)
+    VkDescriptorSetLayout frameSetLayout;      // Frame adatok (kamera, fény mátrix, fénylista) elrendezése (Set 3)
     VkPipelineLayout pipelineLayout;           // Összefogja a descriptorokat és push constantokat
-    VkPipeline graphicsPipeline;               // A végleges grafikai állapotgép
+    VkPipeline graphicsPipeline;               // A végleges grafikai állapotgép (Full vertex formátum)
+    VkPipeline compactGraphicsPipeline;        // Ugyanaz Compact (kvantált) vertex formátumhoz
     VkPipeline wireframePipeline;              // Opcionális drótvázas megjelenítés
 
     // Framebufferek: a render pass és a swapchain képek összekapcsolása
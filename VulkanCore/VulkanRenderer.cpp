@@ -3,7 +3,12 @@
  * @brief Megvalósítja a VulkanRenderer osztályt (Javítva: Shadow Acne eltüntetése Front Face Cullinggal).
  */
 #include "VulkanRenderer.h"
+#include "ParallelFor.h"
 #include <array>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <cmath>
 #include <chrono>
 #include <iostream>
 #include <fstream>
@@ -25,6 +30,66 @@ static std::vector<char> readFile(const std::string& filename) {
     return buffer;
 }
 
+namespace {
+    // Egy command buffer kötési állapota: a pipeline-t, a puffereket és a textúrát csak akkor köti újra, ha eltérnek
+    // az előzőtől. A közös geometria pufferek formátumonként egyszer kötődnek; az index puffert csak típusváltáskor
+    // (16 / 32 bit) vagy a meshlet culling kimenete miatt kell újra kötni. A kiadott és a kihagyott kötéseket számolja.
+    class BindCache {
+    public:
+        BindCache(VkCommandBuffer commandBuffer, GeometryPool* geometryPool)
+            : commandBuffer(commandBuffer), geometryPool(geometryPool) {}
+
+        void bindPipeline(VkPipeline pipeline) {
+            if (pipeline == boundPipeline) { redundantBinds++; return; }
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            boundPipeline = pipeline;
+            bindCalls++;
+        }
+
+        void bindIndexBuffer(VkBuffer buffer, VkIndexType type) {
+            if (buffer == boundIndexBuffer && type == boundIndexType) { redundantBinds++; return; }
+            vkCmdBindIndexBuffer(commandBuffer, buffer, 0, type);
+            boundIndexBuffer = buffer;
+            boundIndexType = type;
+            bindCalls++;
+        }
+
+        // Textúra (Set 0); a két vertex formátum pipeline-ja azonos layout-ot használ, így a kötés pipeline csere után is érvényes
+        void bindTexture(VkPipelineLayout layout, VkDescriptorSet texture) {
+            if (texture == VK_NULL_HANDLE) return;
+            if (texture == boundTexture) { redundantBinds++; return; }
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &texture, 0, nullptr);
+            boundTexture = texture;
+            bindCalls++;
+        }
+
+        // Árnyék pass: csak a pozíció folyam (binding 0); fő pass: pozíció és attribútum folyam (binding 0 és 1)
+        void bindVertexStreams(VertexFormat format, bool attributes) {
+            VkBuffer buffers[] = {geometryPool->getPositionBuffer(format), geometryPool->getAttributeBuffer(format)};
+            VkDeviceSize offsets[] = {0, 0};
+            uint32_t bindingCount = attributes ? 2 : 1;
+            if (buffers[0] == boundPositionBuffer && (!attributes || buffers[1] == boundAttributeBuffer)) { redundantBinds++; return; }
+            vkCmdBindVertexBuffers(commandBuffer, VertexLayout::POSITION_BINDING, bindingCount, buffers, offsets);
+            boundPositionBuffer = buffers[0];
+            if (attributes) boundAttributeBuffer = buffers[1];
+            bindCalls++;
+        }
+
+        uint32_t bindCalls = 0;       // Kiadott vkCmdBind* hívások
+        uint32_t redundantBinds = 0;  // Kihagyott (a kötött állapottal azonos) kötések
+
+    private:
+        VkCommandBuffer commandBuffer;
+        GeometryPool* geometryPool;
+        VkPipeline boundPipeline = VK_NULL_HANDLE;
+        VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+        VkIndexType boundIndexType = VK_INDEX_TYPE_UINT16;
+        VkBuffer boundPositionBuffer = VK_NULL_HANDLE;
+        VkBuffer boundAttributeBuffer = VK_NULL_HANDLE;
+        VkDescriptorSet boundTexture = VK_NULL_HANDLE;
+    };
+}
+
 VulkanRenderer::VulkanRenderer() : currentFrame(0), context(nullptr) {
 }
 
@@ -34,17 +99,31 @@ VulkanRenderer::~VulkanRenderer() {
 /**
  * @brief A renderelő inicializálása: parancspufferek, szinkronizáció és árnyékolási erőforrások felépítése.
  */
-void VulkanRenderer::create(VulkanContext* ctx, VulkanSwapchain* swapchain) {
+void VulkanRenderer::create(VulkanContext* ctx, VulkanSwapchain* swapchain, GeometryPool* pool) {
     this->context = ctx;
+    this->geometryPool = pool;
     createCommandBuffers();
+    createRecordSlots();
     createSyncObjects(swapchain);
 
     // Shadow Mapping (Árnyéktérkép) specifikus erőforrások
-    createShadowResources();       // Kép, View és Sampler az árnyéktérképhez
+    createShadowResources();       // Rétegzett kép, View-k és Sampler a kaszkádolt árnyéktérképhez
+    shadowMoments.create(context); // EVSM: a momentumok compute pipeline-ja és mintavételezője (a kép az első EVSM fénnyel)
     createShadowRenderPass();      // Az árnyék-renderelési szakasz logikai leírása
-    createShadowFramebuffer();     // Az árnyéktérkép cél-puffere
-    createShadowDescriptorSet();   // Az árnyéktérkép bekötése a fő shaderbe (Set 1)
+    createShadowFramebuffers();    // Kaszkádonként az árnyéktérkép rétegének cél-puffere
+    createShadowAtlasResources();  // A további árnyékvető fények közös mélységképe
+    createPointShadowResources();  // A pontfények kocka árnyéktérképei
+    createShadowDescriptorSet();   // Az árnyéktérkép, az atlasz, a kockák és a momentumok bekötése a fő shaderbe (Set 1)
+    createInstanceResources();     // Példány model mátrixok (fő pass: Set 2, árnyék pass: Set 0)
+    createFrameResources();        // Kamera és fény mátrix (fő pass: Set 3, árnyék pass: Set 1)
     createShadowPipeline();        // Speciális pipeline csak mélység írásához
+    createTimestampQueries();      // Az árnyék pass GPU idejének mérése
+
+    // GPU-s meshlet culling (compute pipeline, frame-enkénti kimenetek)
+    meshletCuller.create(context, MAX_FRAMES_IN_FLIGHT, geometryPool);
+
+    // GPU-vezérelt mód: a példány mátrixokat ugyanazzal a layout-tal köti a két pass-hoz
+    gpuCuller.create(context, MAX_FRAMES_IN_FLIGHT, geometryPool, instanceDescriptorSetLayout);
 }
 
 /**
@@ -60,11 +139,111 @@ void VulkanRenderer::cleanup() {
         vkDestroyFence(device, inFlightFences[i], nullptr);
     }
 
+    meshletCuller.cleanup();
+    gpuCuller.cleanup();
+
+    // A secondary command buffer-ek a pool-jukkal együtt szabadulnak fel
+    for (std::vector<RecordSlot>& frameSlots : recordSlots) {
+        for (RecordSlot& slot : frameSlots) {
+            vkDestroyCommandPool(device, slot.commandPool, nullptr);
+        }
+    }
+    recordSlots.clear();
+    for (StaticRecording& recording : staticRecordings) {
+        for (RecordSlot& shadowSlot : recording.shadow) {
+            vkDestroyCommandPool(device, shadowSlot.commandPool, nullptr);
+        }
+        vkDestroyCommandPool(device, recording.main.commandPool, nullptr);
+    }
+    staticRecordings.clear();
+    recordWorkers.reset();
+
+    // Példány pufferek (tartósan leképezve; a statikus jelenet puffere csak visszajátszás esetén létezik)
+    auto destroyInstanceBuffer = [&](InstanceBuffer& instances) {
+        if (instances.buffer == VK_NULL_HANDLE) return;
+        vkUnmapMemory(device, instances.memory);
+        vkDestroyBuffer(device, instances.buffer, nullptr);
+        vkFreeMemory(device, instances.memory, nullptr);
+        instances.buffer = VK_NULL_HANDLE;
+    };
+    for (InstanceBuffer& instances : instanceBuffers) {
+        destroyInstanceBuffer(instances);
+    }
+    for (InstanceBuffer& instances : atlasInstanceBuffers) {
+        destroyInstanceBuffer(instances);
+    }
+    for (InstanceBuffer& instances : pointInstanceBuffers) {
+        destroyInstanceBuffer(instances);
+    }
+    for (FaceMaskBuffer& faceMasks : pointFaceMaskBuffers) {
+        if (faceMasks.buffer == VK_NULL_HANDLE) continue;
+        vkUnmapMemory(device, faceMasks.memory);
+        vkDestroyBuffer(device, faceMasks.buffer, nullptr);
+        vkFreeMemory(device, faceMasks.memory, nullptr);
+    }
+    destroyInstanceBuffer(staticScene.instances);
+    vkDestroyDescriptorPool(device, instanceDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, instanceDescriptorSetLayout, nullptr);
+
+    // Frame uniform és fény pufferek (tartósan leképezve)
+    for (FrameUniforms& uniforms : frameUniforms) {
+        vkUnmapMemory(device, uniforms.memory);
+        vkDestroyBuffer(device, uniforms.buffer, nullptr);
+        vkFreeMemory(device, uniforms.memory, nullptr);
+        vkUnmapMemory(device, uniforms.lightMemory);
+        vkDestroyBuffer(device, uniforms.lightBuffer, nullptr);
+        vkFreeMemory(device, uniforms.lightMemory, nullptr);
+    }
+    frameUniforms.clear();
+    vkDestroyDescriptorPool(device, frameDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, frameDescriptorSetLayout, nullptr);
+
+    if (timestampQueryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, timestampQueryPool, nullptr);
+    }
+
     // Shadow mapping objektumok törlése
     vkDestroyPipeline(device, shadowPipeline, nullptr);
+    vkDestroyPipeline(device, compactShadowPipeline, nullptr);
+    vkDestroyPipeline(device, pointShadowPipeline, nullptr);
+    vkDestroyPipeline(device, compactPointShadowPipeline, nullptr);
     vkDestroyPipelineLayout(device, shadowPipelineLayout, nullptr);
-    vkDestroyFramebuffer(device, shadowFramebuffer, nullptr);
+    vkDestroyPipelineLayout(device, pointShadowPipelineLayout, nullptr);
+    for (uint32_t c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        vkDestroyFramebuffer(device, shadowFramebuffers[c], nullptr);
+        vkDestroyImageView(device, shadowLayerViews[c], nullptr);
+    }
     vkDestroyRenderPass(device, shadowRenderPass, nullptr);
+    vkDestroyRenderPass(device, shadowLoadRenderPass, nullptr);
+
+    // Árnyék gyorsítótár (csak az első használat után létezik)
+    if (shadowCacheImage != VK_NULL_HANDLE) {
+        for (uint32_t c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+            vkDestroyFramebuffer(device, shadowCacheFramebuffers[c], nullptr);
+            vkDestroyImageView(device, shadowCacheLayerViews[c], nullptr);
+        }
+        vkDestroyImage(device, shadowCacheImage, nullptr);
+        vkFreeMemory(device, shadowCacheImageMemory, nullptr);
+    }
+    vkDestroyRenderPass(device, shadowCacheRenderPass, nullptr);
+
+    // Árnyék atlasz
+    vkDestroyFramebuffer(device, shadowAtlasFramebuffer, nullptr);
+    vkDestroyRenderPass(device, shadowAtlasRenderPass, nullptr);
+    vkDestroyImageView(device, shadowAtlasImageView, nullptr);
+    vkDestroyImage(device, shadowAtlasImage, nullptr);
+    vkFreeMemory(device, shadowAtlasImageMemory, nullptr);
+
+    // Pontfény kocka árnyéktérképek (a Framebuffer-ek és a render pass csak multiview támogatással léteznek)
+    for (uint32_t cube = 0; cube < MAX_POINT_SHADOWS; cube++) {
+        vkDestroyFramebuffer(device, pointShadowFramebuffers[cube], nullptr);
+        vkDestroyImageView(device, pointShadowFaceViews[cube], nullptr);
+    }
+    vkDestroyRenderPass(device, pointShadowRenderPass, nullptr);
+    vkDestroyImageView(device, pointShadowCubeView, nullptr);
+    vkDestroyImage(device, pointShadowImage, nullptr);
+    vkFreeMemory(device, pointShadowImageMemory, nullptr);
+    shadowMoments.cleanup();
     vkDestroyDescriptorPool(device, shadowDescriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(device, shadowDescriptorSetLayout, nullptr);
     vkDestroySampler(device, shadowSampler, nullptr);
@@ -90,6 +269,54 @@ void VulkanRenderer::createCommandBuffers() {
     }
 }
 
+/**
+ * @brief A párhuzamos rögzítés munkaszálai, és frame-enként rögzítési feladatonként egy command pool
+ * egy secondary command buffer-rel (egy pool-t egyszerre csak egy szál használhat).
+ */
+void VulkanRenderer::createRecordSlots() {
+    recordWorkers = std::make_unique<WorkerPool>();
+    recordTasksPerPass = recordWorkers->getThreadCount();
+
+    recordSlots.resize(MAX_FRAMES_IN_FLIGHT);
+    for (std::vector<RecordSlot>& frameSlots : recordSlots) {
+        frameSlots.resize(recordTasksPerPass * (ShadowCascades::MAX_CASCADES + 1));
+        for (RecordSlot& slot : frameSlots) {
+            createRecordSlot(slot, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT); // Képkockánként a pool egészben nullázódik
+        }
+    }
+
+    // A statikus rögzítések több képkockán át élnek, csak a jelenet változásakor nullázódnak
+    staticRecordings.resize(MAX_FRAMES_IN_FLIGHT);
+    for (StaticRecording& recording : staticRecordings) {
+        for (RecordSlot& shadowSlot : recording.shadow) {
+            createRecordSlot(shadowSlot, 0);
+        }
+        createRecordSlot(recording.main, 0);
+    }
+    std::cout << "Command recording: " << recordTasksPerPass << " threads, secondary command buffers per pass" << std::endl;
+}
+
+void VulkanRenderer::createRecordSlot(RecordSlot& slot, VkCommandPoolCreateFlags flags) {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = flags;
+    poolInfo.queueFamilyIndex = context->getQueueFamilies().graphicsFamily.value();
+
+    if (vkCreateCommandPool(context->getDevice(), &poolInfo, nullptr, &slot.commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create command pool!");
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = slot.commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(context->getDevice(), &allocInfo, &slot.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate secondary command buffers!");
+    }
+}
+
 /**
  * @brief Szemafórok és Fence-ek létrehozása a CPU-GPU szinkronizációhoz (párhuzamos feldolgozás támogatása).
  */
@@ -114,42 +341,559 @@ void VulkanRenderer::createSyncObjects(VulkanSwapchain* swapchain) {
     }
 }
 
+/**
+ * @brief Timestamp query pool (frame-enként TIMESTAMPS_PER_FRAME query: az árnyék és a fő pass eleje és vége),
+ * ha a grafikai sor támogatja.
+ */
+void VulkanRenderer::createTimestampQueries() {
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context->getPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(context->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    uint32_t validBits = queueFamilies[context->getQueueFamilies().graphicsFamily.value()].timestampValidBits;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context->getPhysicalDevice(), &properties);
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f) {
+        std::cout << "GPU timestamps are not supported on the graphics queue, pass timings disabled" << std::endl;
+        return;
+    }
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * TIMESTAMPS_PER_FRAME;
+
+    if (vkCreateQueryPool(context->getDevice(), &queryPoolInfo, nullptr, &timestampQueryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+    timestampsWritten.assign(MAX_FRAMES_IN_FLIGHT, false);
+}
+
+void VulkanRenderer::readTimestamps(uint32_t frame) {
+    if (timestampQueryPool == VK_NULL_HANDLE || !timestampsWritten[frame]) return;
+
+    // A frame fence-e már jelzett, így az eredmény várakozás nélkül elérhető
+    uint64_t timestamps[TIMESTAMPS_PER_FRAME];
+    if (vkGetQueryPoolResults(context->getDevice(), timestampQueryPool, frame * TIMESTAMPS_PER_FRAME, TIMESTAMPS_PER_FRAME,
+                              sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+        uint64_t shadowTicks = (timestamps[1] - timestamps[0]) & timestampMask;
+        uint64_t mainTicks = (timestamps[3] - timestamps[2]) & timestampMask;
+        lastShadowPassMs = static_cast<float>(shadowTicks * timestampPeriod / 1.0e6);
+        lastMainPassMs = static_cast<float>(mainTicks * timestampPeriod / 1.0e6);
+    }
+}
+
+/**
+ * @brief Példány pufferek frame-enként: storage buffer a model mátrixokhoz és a hozzá tartozó descriptor set.
+ * Egy további set a statikus jelenet pufferéé (a puffer csak az első statikus visszajátszáskor jön létre).
+ */
+void VulkanRenderer::createInstanceResources() {
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorCount = 1;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.pImmutableSamplers = nullptr;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(context->getDevice(), &layoutInfo, nullptr, &instanceDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create instance descriptor set layout!");
+    }
+
+    // Frame-enként a képkockánkénti, az atlasz és a pontfények példányai és a pontfények lap maszkjai, és egy a
+    // statikus jelenetnek
+    const uint32_t setCount = 4 * MAX_FRAMES_IN_FLIGHT + 1;
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = setCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = setCount;
+
+    if (vkCreateDescriptorPool(context->getDevice(), &poolInfo, nullptr, &instanceDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create instance descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(setCount, instanceDescriptorSetLayout);
+    std::vector<VkDescriptorSet> sets(setCount);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = instanceDescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(sets.size());
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(context->getDevice(), &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate instance descriptor sets!");
+    }
+
+    // Az atlasz és a pontfények pufferei csak az első használatnál jönnek létre
+    instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    atlasInstanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    pointInstanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    pointFaceMaskBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        instanceBuffers[frame].descriptorSet = sets[frame];
+        ensureInstanceCapacity(instanceBuffers[frame], INITIAL_INSTANCE_CAPACITY);
+        atlasInstanceBuffers[frame].descriptorSet = sets[MAX_FRAMES_IN_FLIGHT + frame];
+        pointInstanceBuffers[frame].descriptorSet = sets[2 * MAX_FRAMES_IN_FLIGHT + frame];
+        pointFaceMaskBuffers[frame].descriptorSet = sets[3 * MAX_FRAMES_IN_FLIGHT + frame];
+    }
+    staticScene.instances.descriptorSet = sets[4 * MAX_FRAMES_IN_FLIGHT];
+}
+
+/**
+ * @brief Frame uniform pufferek (kamera és kaszkád mátrixok) és fény pufferek, tartósan leképezve (a CPU képkockánként írja).
+ */
+void VulkanRenderer::createFrameResources() {
+    // Binding 0: frame adatok, Binding 1: fénylista. A vertex shaderek a mátrixokat (az árnyék pass az atlasz csempék
+    // fény mátrixait is a fénylistából), a fragment shader a fényeket olvassa.
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorCount = 1;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[0].pImmutableSamplers = nullptr;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorCount = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].pImmutableSamplers = nullptr;
+    bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(context->getDevice(), &layoutInfo, nullptr, &frameDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+
+    if (vkCreateDescriptorPool(context->getDevice(), &poolInfo, nullptr, &frameDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, frameDescriptorSetLayout);
+    std::vector<VkDescriptorSet> sets(MAX_FRAMES_IN_FLIGHT);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = frameDescriptorPool;
+    allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(context->getDevice(), &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate frame descriptor sets!");
+    }
+
+    frameUniforms.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        FrameUniforms& uniforms = frameUniforms[frame];
+        uniforms.descriptorSet = sets[frame];
+
+        context->createBuffer(sizeof(FrameData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              uniforms.buffer, uniforms.memory);
+        void* mapped = nullptr;
+        vkMapMemory(context->getDevice(), uniforms.memory, 0, sizeof(FrameData), 0, &mapped);
+        uniforms.mapped = static_cast<FrameData*>(mapped);
+
+        VkDeviceSize lightBufferSize = sizeof(GpuLight) * MAX_LIGHTS;
+        context->createBuffer(lightBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              uniforms.lightBuffer, uniforms.lightMemory);
+        vkMapMemory(context->getDevice(), uniforms.lightMemory, 0, lightBufferSize, 0, &mapped);
+        uniforms.lights = static_cast<GpuLight*>(mapped);
+
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = uniforms.buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = sizeof(FrameData);
+
+        VkDescriptorBufferInfo lightBufferInfo{};
+        lightBufferInfo.buffer = uniforms.lightBuffer;
+        lightBufferInfo.offset = 0;
+        lightBufferInfo.range = lightBufferSize;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = uniforms.descriptorSet;
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = uniforms.descriptorSet;
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &lightBufferInfo;
+
+        vkUpdateDescriptorSets(context->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
+}
+
+void VulkanRenderer::ensureInstanceCapacity(InstanceBuffer& instances, uint32_t count) {
+    if (instances.buffer != VK_NULL_HANDLE && count <= instances.capacity) return;
+
+    uint32_t capacity = std::max(instances.capacity, INITIAL_INSTANCE_CAPACITY);
+    while (capacity < count) capacity *= 2;
+
+    VkDevice device = context->getDevice();
+    if (instances.buffer != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, instances.memory);
+        vkDestroyBuffer(device, instances.buffer, nullptr);
+        vkFreeMemory(device, instances.memory, nullptr);
+    }
+
+    void* mapped = nullptr;
+    createMappedStorageBuffer(sizeof(glm::mat4) * capacity, instances.descriptorSet, instances.buffer, instances.memory, mapped);
+    instances.mapped = static_cast<glm::mat4*>(mapped);
+    instances.capacity = capacity;
+}
+
+void VulkanRenderer::ensureFaceMaskCapacity(FaceMaskBuffer& faceMasks, uint32_t count) {
+    if (faceMasks.buffer != VK_NULL_HANDLE && count <= faceMasks.capacity) return;
+
+    uint32_t capacity = std::max(faceMasks.capacity, INITIAL_INSTANCE_CAPACITY);
+    while (capacity < count) capacity *= 2;
+
+    VkDevice device = context->getDevice();
+    if (faceMasks.buffer != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, faceMasks.memory);
+        vkDestroyBuffer(device, faceMasks.buffer, nullptr);
+        vkFreeMemory(device, faceMasks.memory, nullptr);
+    }
+
+    void* mapped = nullptr;
+    createMappedStorageBuffer(sizeof(uint32_t) * capacity, faceMasks.descriptorSet, faceMasks.buffer, faceMasks.memory, mapped);
+    faceMasks.mapped = static_cast<uint32_t*>(mapped);
+    faceMasks.capacity = capacity;
+}
+
+void VulkanRenderer::createMappedStorageBuffer(VkDeviceSize size, VkDescriptorSet descriptorSet, VkBuffer& buffer,
+                                               VkDeviceMemory& memory, void*& mapped) {
+    // A CPU képkockánként írja, a vertex shader egyszer olvassa: host-visible memória, staging nélkül
+    VkDevice device = context->getDevice();
+    context->createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+    vkMapMemory(device, memory, 0, size, 0, &mapped);
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void VulkanRenderer::queueDraws(const std::vector<MeshObject*>& objects, const std::vector<uint32_t>& visible,
+                                const std::vector<uint32_t>& lods, uint32_t pass, bool byTexture, const glm::vec4& depthPlane,
+                                float maxDepth, RenderQueue::Item* items) const {
+    unsigned threads = visible.size() >= FrustumCuller::PARALLEL_THRESHOLD ? resolveThreadCount(0) : 1;
+    parallelFor(visible.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            uint32_t i = visible[v];
+            const MeshObject* obj = objects[i];
+            if (!drawSorting) {
+                // Rendezés nélkül a pass-on belül a látható lista (objektum index) sorrendje marad
+                items[v] = {RenderQueue::makeKey(pass, 0, 0, 0, 0), i};
+                continue;
+            }
+
+            // Pipeline állapot: vertex formátum, index típus, meshlet (a meshletes objektumok saját index puffert kötnek)
+            uint32_t pipelineState = (static_cast<uint32_t>(obj->vertexFormat) << 2) |
+                                     ((obj->indexType == VK_INDEX_TYPE_UINT32 ? 1u : 0u) << 1) |
+                                     (obj->meshletCount > 0 ? 1u : 0u);
+            uint32_t material = byTexture ? RenderQueue::hashHandle((uint64_t)obj->getTexture(), RenderQueue::MATERIAL_BITS) : 0;
+            uint32_t mesh = (obj->getGeometryId() << 4) | std::min(lods[i], 15u);
+            // Elölről hátra: a pass vetítésének mélysége az objektum origójában
+            float depth = glm::dot(depthPlane, glm::vec4(obj->position, 1.0f));
+            items[v] = {RenderQueue::makeKey(pass, pipelineState, material, mesh, RenderQueue::quantizeDepth(depth, maxDepth)), i};
+        }
+    });
+}
+
+uint32_t VulkanRenderer::buildBatches(const std::vector<MeshObject*>& objects, const RenderQueue::Item* items, size_t count,
+                                      const std::vector<uint32_t>& lods, bool byTexture, float animationTime, glm::mat4* instanceData,
+                                      uint32_t firstInstance, std::vector<DrawBatch>& batches, std::vector<uint32_t>& instanceSlots) {
+    batches.clear();
+
+    // A sor rendezett, így az azonos állapotú rajzolások egymás mellett vannak; a kulcs mezői csak a sorrendet adják,
+    // a csoportosítás a tényleges geometriát, LOD szintet és textúrát hasonlítja össze
+    auto sameBatch = [&](uint32_t a, uint32_t b) {
+        const MeshObject* objA = objects[a];
+        const MeshObject* objB = objects[b];
+        // A meshletes objektumok indirekt parancsa és index puffere objektumonkénti
+        return objA->meshletCount == 0 && objB->meshletCount == 0 && objA->getGeometryId() == objB->getGeometryId() &&
+               objA->vertexFormat == objB->vertexFormat && lods[a] == lods[b] &&
+               (!byTexture || objA->getTexture() == objB->getTexture());
+    };
+
+    uint32_t slot = firstInstance;
+    for (size_t k = 0; k < count; k++) {
+        uint32_t object = items[k].object;
+        if (k == 0 || !sameBatch(items[k - 1].object, object)) {
+            batches.push_back({objects[object], lods[object], slot, 0});
+        }
+        batches.back().instanceCount++;
+        instanceSlots[object] = slot++;
+    }
+
+    // Model mátrixok kiírása a sor sorrendjében (nagy jelenetnél szálakra bontva)
+    glm::mat4* instances = instanceData + firstInstance;
+    unsigned threads = count >= FrustumCuller::PARALLEL_THRESHOLD ? resolveThreadCount(0) : 1;
+    parallelFor(count, threads, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            instances[k] = objects[items[k].object]->getModelMatrix(animationTime);
+        }
+    });
+    return slot;
+}
+
+void VulkanRenderer::updateStaticScene(const std::vector<MeshObject*>& objects, size_t shadowCasterCount) {
+    // Változatlan jelenet: ugyanaz a tömb, és a geometria pufferek sem épültek újra (O(1) ellenőrzés)
+    if (objects.data() == staticScene.objects && objects.size() == staticScene.objectCount &&
+        shadowCasterCount == staticScene.casterCount && drawSorting == staticScene.sorted &&
+        geometryPool->getIndexBuffer() == staticScene.sourceIndexBuffer &&
+        geometryPool->getPositionBuffer(VertexFormat::Full) == staticScene.sourcePositionBuffers[0] &&
+        geometryPool->getPositionBuffer(VertexFormat::Compact) == staticScene.sourcePositionBuffers[1]) {
+        return;
+    }
+
+    // A futó frame-ek még a régi statikus példány puffert és rögzítéseket használják
+    vkDeviceWaitIdle(context->getDevice());
+
+    staticScene.objects = objects.data();
+    staticScene.objectCount = objects.size();
+    staticScene.casterCount = shadowCasterCount;
+    staticScene.sorted = drawSorting;
+    staticScene.sourceIndexBuffer = geometryPool->getIndexBuffer();
+    staticScene.sourcePositionBuffers[0] = geometryPool->getPositionBuffer(VertexFormat::Full);
+    staticScene.sourcePositionBuffers[1] = geometryPool->getPositionBuffer(VertexFormat::Compact);
+    staticScene.version++;
+
+    // Statikus: nem forog (a model mátrix az időtől független), és nincs képkockánkénti meshlet culling kimenete.
+    // A dinamikus lista elején az árnyékvetők, hogy a képkockánkénti út a szokásos módon vághassa le a többit.
+    std::vector<uint32_t> staticMain, staticShadow, dynamicReceivers;
+    staticScene.dynamicObjects.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+        const MeshObject* obj = objects[i];
+        uint32_t index = static_cast<uint32_t>(i);
+        if (obj->rotationSpeed == 0.0f && obj->meshletCount == 0) {
+            staticMain.push_back(index);
+            if (i < shadowCasterCount) staticShadow.push_back(index);
+        } else if (i < shadowCasterCount) {
+            staticScene.dynamicObjects.push_back(index);
+        } else {
+            dynamicReceivers.push_back(index);
+        }
+    }
+    staticScene.dynamicCasterCount = staticScene.dynamicObjects.size();
+    staticScene.dynamicObjects.insert(staticScene.dynamicObjects.end(), dynamicReceivers.begin(), dynamicReceivers.end());
+    staticScene.staticObjectCount = static_cast<uint32_t>(staticMain.size());
+    staticScene.staticCasterCount = static_cast<uint32_t>(staticShadow.size());
+
+    // Rendezés mélység nélkül (a nézőpont változhat), így csak az állapot szerinti sorrend számít; LOD 0 mindenhol
+    std::vector<uint32_t> lods(objects.size(), 0);
+    renderQueue.resize(staticMain.size() + staticShadow.size());
+    glm::vec4 noDepth(0.0f);
+    queueDraws(objects, staticMain, lods, 0, true, noDepth, 1.0f, renderQueue.getItems().data());
+    queueDraws(objects, staticShadow, lods, 1, false, noDepth, 1.0f, renderQueue.getItems().data() + staticMain.size());
+    renderQueue.sort();
+
+    // A példányok helye objektumonként megmarad, így egy statikus objektum mozgatása csak a mátrixait írja felül
+    ensureInstanceCapacity(staticScene.instances, static_cast<uint32_t>(staticMain.size() + staticShadow.size()));
+    staticScene.mainSlots.assign(objects.size(), UINT32_MAX);
+    staticScene.shadowSlots.assign(objects.size(), UINT32_MAX);
+    const RenderQueue::Item* items = renderQueue.getItems().data();
+    uint32_t shadowFirstInstance = buildBatches(objects, items, staticMain.size(), lods, true, 0.0f,
+                                                staticScene.instances.mapped, 0, staticScene.mainBatches, staticScene.mainSlots);
+    buildBatches(objects, items + staticMain.size(), staticShadow.size(), lods, false, 0.0f, staticScene.instances.mapped,
+                 shadowFirstInstance, staticScene.shadowBatches, staticScene.shadowSlots);
+
+    staticScene.casterCenters.assign(objects.size(), glm::vec3(0.0f));
+    staticScene.casterExtents.assign(objects.size(), glm::vec3(0.0f));
+    for (uint32_t i : staticShadow) {
+        objects[i]->getWorldBounds(0.0f, staticScene.casterCenters[i], staticScene.casterExtents[i]);
+    }
+
+    staticScene.mainTriangles = 0;
+    for (const DrawBatch& batch : staticScene.mainBatches) {
+        staticScene.mainTriangles += batch.mesh->lods[batch.lod].indexCount / 3 * batch.instanceCount;
+    }
+
+    std::cout << "Static scene: " << staticMain.size() << " static objects in " << staticScene.mainBatches.size()
+              << " main / " << staticScene.shadowBatches.size() << " shadow draws, "
+              << staticScene.dynamicObjects.size() << " dynamic objects" << std::endl;
+}
+
+void VulkanRenderer::invalidateStaticObject(uint32_t objectIndex) {
+    // GPU-vezérelt mód: a culling pass az objektum leírójából számolja a helyét
+    gpuCuller.updateObject(objectIndex);
+
+    if (staticScene.objects == nullptr || objectIndex >= staticScene.objectCount ||
+        staticScene.mainSlots[objectIndex] == UINT32_MAX) {
+        return;
+    }
+
+    // A statikus példány puffert a futó frame-ek is olvassák
+    vkDeviceWaitIdle(context->getDevice());
+
+    const MeshObject* obj = staticScene.objects[objectIndex];
+    glm::mat4 model = obj->getModelMatrix(0.0f);
+    staticScene.instances.mapped[staticScene.mainSlots[objectIndex]] = model;
+    if (staticScene.shadowSlots[objectIndex] == UINT32_MAX) {
+        return;
+    }
+    staticScene.instances.mapped[staticScene.shadowSlots[objectIndex]] = model;
+
+    // Az árnyék gyorsítótárban a régi hely (az ott vetett árnyék eltűnik) és az új hely renderelődik újra
+    glm::vec3& center = staticScene.casterCenters[objectIndex];
+    glm::vec3& extent = staticScene.casterExtents[objectIndex];
+    markShadowCacheDirty(center, extent);
+    obj->getWorldBounds(0.0f, center, extent);
+    markShadowCacheDirty(center, extent);
+}
+
+void VulkanRenderer::setLights(const std::vector<Light>& sceneLights) {
+    lights = sceneLights;
+    atlasLightsReset = true;
+
+    // A momentum kép az első EVSM fénnyel jön létre; a kötése a futó frame-ek descriptor set-jében van, ezért előtte
+    // megvárjuk a GPU-t
+    bool momentShadows = std::any_of(lights.begin(), lights.end(), [](const Light& light) {
+        return light.castsShadow && light.shadowTechnique == ShadowTechnique::Evsm;
+    });
+    if (momentShadows && shadowMoments.isSupported() && !shadowMoments.hasImage()) {
+        vkDeviceWaitIdle(context->getDevice());
+        shadowMoments.createImage(shadowMapWidth, shadowMapHeight, ShadowCascades::MAX_CASCADES, shadowImageView);
+        writeMomentShadowDescriptor();
+    }
+}
+
+bool VulkanRenderer::pickObject(glm::vec2 cursorNdc, uint32_t& objectIndex) {
+    // Ha a drawFrame nem frissítette a BVH-t (GPU-vezérelt mód, statikus visszajátszás, kis jelenet), a kijelöléshez
+    // itt, az utolsó képkocka állapotára
+    if (sceneBvhStale && lastObjects != nullptr) {
+        sceneBvh.update(*lastObjects, lastAnimationTime);
+        sceneBvhStale = false;
+    }
+
+    // A kurzor alatti pont a távoli síkon; a sugár a kamerából indul
+    glm::vec4 farPoint = glm::inverse(lastViewProjection) * glm::vec4(cursorNdc.x, cursorNdc.y, 1.0f, 1.0f);
+    glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - lastCameraPos);
+
+    float distance;
+    return sceneBvh.raycast(lastCameraPos, direction, 1000.0f, objectIndex, distance);
+}
+
 // --- SHADOW MAPPING (Árnyéktérkép kezelés) ---
 
 /**
- * @brief Árnyéktérkép textúra (Image) és mintavételező (Sampler) létrehozása.
+ * @brief Kaszkádolt árnyéktérkép: rétegzett textúra (Image), a nézetei és a mintavételező (Sampler) létrehozása.
  */
 void VulkanRenderer::createShadowResources() {
     VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
 
-    // Kép létrehozása: Mélységcsatolóként és Shader-ben olvasható textúraként használjuk
+    // Kép létrehozása: Mélységcsatolóként és Shader-ben olvasható textúraként használjuk, kaszkádonként egy réteg
+    // (másolás célja is: az árnyék gyorsítótár ide másolódik)
     context->createImage(
         shadowMapWidth, shadowMapHeight,
         depthFormat,
         VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         shadowImage,
-        shadowImageMemory
+        shadowImageMemory,
+        ShadowCascades::MAX_CASCADES
     );
 
-    shadowImageView = context->createImageView(shadowImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+    // A fő shader a teljes tömböt olvassa, az árnyék pass rétegenként ír
+    shadowImageView = context->createImageView(shadowImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                               VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0, ShadowCascades::MAX_CASCADES);
+    for (uint32_t c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        shadowLayerViews[c] = context->createImageView(shadowImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                                       VK_IMAGE_VIEW_TYPE_2D, c, 1);
+    }
+
+    // Minden réteg olvasható állapotba: a kevesebb aktív kaszkádnál ki nem rajzolt rétegek is a descriptor
+    // layout-jában legyenek (a shader ezeket nem mintavételezi, de a nézet lefedi őket)
+    context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = shadowImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = ShadowCascades::MAX_CASCADES;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+
+    // Sampler: összehasonlító mintavételezés (sampler2DArrayShadow): a hardver a mintavételi pont 2x2 texelét hasonlítja
+    // össze a referencia mélységgel, és lineáris szűrésnél az eredmények bilineáris keverékét adja (mintánként 2x2 PCF).
+    // A lineáris szűrés a formátumtól függ; ha nem támogatott, a minta egyetlen texel összehasonlítása.
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(context->getPhysicalDevice(), depthFormat, &formatProperties);
+    bool linearCompare = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
 
-    // Sampler: Meghatározza, hogyan olvassuk ki az árnyékadatokat (Linear filtering + Border color az élekhez)
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.magFilter = linearCompare ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+    samplerInfo.minFilter = linearCompare ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
     samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
     samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
     samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
     samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE; // A fény hatókörén kívül "fehér" (nincs árnyék)
     samplerInfo.anisotropyEnable = VK_FALSE;
     samplerInfo.maxAnisotropy = 1.0f;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.compareEnable = VK_TRUE;
+    samplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL; // 1, ha a referencia nincs a tárolt mélység mögött (megvilágított)
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 1.0f;
+    samplerInfo.maxLod = 0.0f;
 
     if (vkCreateSampler(context->getDevice(), &samplerInfo, nullptr, &shadowSampler) != VK_SUCCESS) {
         throw std::runtime_error("failed to create shadow sampler!");
@@ -157,18 +901,20 @@ void VulkanRenderer::createShadowResources() {
 }
 
 /**
- * @brief Árnyék Render Pass definiálása: Csak mélység írása, színek nélkül.
+ * @brief Egy mélység csatolós (szín nélküli) render pass a megadott betöltéssel, layout-okkal és külső függőségekkel.
  */
-void VulkanRenderer::createShadowRenderPass() {
+VkRenderPass VulkanRenderer::createDepthRenderPass(VkAttachmentLoadOp loadOp, VkImageLayout initialLayout, VkImageLayout finalLayout,
+                                                   const VkSubpassDependency& before, const VkSubpassDependency& after,
+                                                   uint32_t viewMask) {
     VkAttachmentDescription attachmentDescription{};
     attachmentDescription.format = VK_FORMAT_D32_SFLOAT;
     attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
-    attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;    // Keret elején töröljük a mélységet
+    attachmentDescription.loadOp = loadOp;
     attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;  // Mentjük, hogy a fő pass-ban használhassuk
     attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachmentDescription.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // Átmenet olvasási módba
+    attachmentDescription.initialLayout = initialLayout;
+    attachmentDescription.finalLayout = finalLayout;
 
     VkAttachmentReference depthReference{};
     depthReference.attachment = 0;
@@ -178,24 +924,7 @@ void VulkanRenderer::createShadowRenderPass() {
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.pDepthStencilAttachment = &depthReference;
 
-    // Szubpass függőségek az árnyéktérkép írásának és olvasásának szinkronizálásához
-    std::array<VkSubpassDependency, 2> dependencies{};
-
-    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[0].dstSubpass = 0;
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    dependencies[1].srcSubpass = 0;
-    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+    std::array<VkSubpassDependency, 2> dependencies = {before, after};
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -206,44 +935,509 @@ void VulkanRenderer::createShadowRenderPass() {
     renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
     renderPassInfo.pDependencies = dependencies.data();
 
-    if (vkCreateRenderPass(context->getDevice(), &renderPassInfo, nullptr, &shadowRenderPass) != VK_SUCCESS) {
+    // Multiview: az egyetlen szubpass a maszk minden rétegébe rajzol; a nézetek egy pontból néznek, így a korreláció
+    // maszkja is a teljes maszk (a külső függőségek az összes nézetre vonatkoznak)
+    VkRenderPassMultiviewCreateInfo multiviewInfo{};
+    multiviewInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+    multiviewInfo.subpassCount = 1;
+    multiviewInfo.pViewMasks = &viewMask;
+    multiviewInfo.correlationMaskCount = 1;
+    multiviewInfo.pCorrelationMasks = &viewMask;
+    if (viewMask != 0) {
+        renderPassInfo.pNext = &multiviewInfo;
+    }
+
+    VkRenderPass renderPass;
+    if (vkCreateRenderPass(context->getDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("failed to create shadow render pass!");
     }
+    return renderPass;
+}
+
+/**
+ * @brief Árnyék Render Pass-ok definiálása: Csak mélység írása, színek nélkül. A képkockánkénti pass törléssel indul,
+ * gyorsítótárral a bemásolt statikus mélységet tölti be; a gyorsítótár pass-a a saját képét tölti be és másolás
+ * forrásaként hagyja.
+ */
+void VulkanRenderer::createShadowRenderPass() {
+    // Szubpass függőségek az árnyéktérkép írásának és olvasásának szinkronizálásához
+    VkSubpassDependency afterRead{};
+    afterRead.srcSubpass = VK_SUBPASS_EXTERNAL;
+    afterRead.dstSubpass = 0;
+    afterRead.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    afterRead.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    afterRead.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    afterRead.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    afterRead.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    VkSubpassDependency beforeRead{};
+    beforeRead.srcSubpass = 0;
+    beforeRead.dstSubpass = VK_SUBPASS_EXTERNAL;
+    beforeRead.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    beforeRead.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    beforeRead.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    beforeRead.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    beforeRead.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // A kaszkádokat EVSM-nél az előző képkocka momentum compute pass-a is olvassa (ShadowMoments::record)
+    VkSubpassDependency afterCascadeRead = afterRead;
+    if (shadowMoments.isSupported()) {
+        afterCascadeRead.srcStageMask |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+
+    shadowRenderPass = createDepthRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED,
+                                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, afterCascadeRead, beforeRead);
+
+    // Gyorsítótárral a másolás írása után a mélység teszt olvassa és írja a tartalmat
+    VkSubpassDependency afterCopy{};
+    afterCopy.srcSubpass = VK_SUBPASS_EXTERNAL;
+    afterCopy.dstSubpass = 0;
+    afterCopy.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    afterCopy.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    afterCopy.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    afterCopy.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    shadowLoadRenderPass = createDepthRenderPass(VK_ATTACHMENT_LOAD_OP_LOAD, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, afterCopy, beforeRead);
+
+    // A gyorsítótár: az előző másolás olvasása után írható, a végén a másolás olvassa
+    VkSubpassDependency afterCopyRead{};
+    afterCopyRead.srcSubpass = VK_SUBPASS_EXTERNAL;
+    afterCopyRead.dstSubpass = 0;
+    afterCopyRead.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    afterCopyRead.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    afterCopyRead.srcAccessMask = 0;
+    afterCopyRead.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VkSubpassDependency beforeCopy{};
+    beforeCopy.srcSubpass = 0;
+    beforeCopy.dstSubpass = VK_SUBPASS_EXTERNAL;
+    beforeCopy.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    beforeCopy.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    beforeCopy.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    beforeCopy.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    shadowCacheRenderPass = createDepthRenderPass(VK_ATTACHMENT_LOAD_OP_LOAD, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, afterCopyRead, beforeCopy);
+
+    // Az atlasz: a nem esedékes csempék tartalma megmarad (betöltés), az előző fő pass olvasása után írható
+    VkSubpassDependency afterAtlasRead = afterRead;
+    afterAtlasRead.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    afterAtlasRead.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    shadowAtlasRenderPass = createDepthRenderPass(VK_ATTACHMENT_LOAD_OP_LOAD, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, afterAtlasRead, beforeRead);
+
+    // Pontfény kocka: törléssel, a hat lap egyszerre (multiview, csak a kiterjesztés és a kocka tömb támogatásával)
+    if (context->isMultiviewSupported() && context->isImageCubeArraySupported()) {
+        pointShadowRenderPass = createDepthRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, afterRead, beforeRead,
+                                                      (1u << CUBE_FACES) - 1);
+    }
+}
+
+/**
+ * @brief Az árnyék gyorsítótár: rétegzett mélységkép (a render pass célja és a másolás forrása), rétegenként egy nézet
+ * és Framebuffer. Minden réteg másolás forrás layout-ba kerül (a tartalma az első renderelésig nem számít).
+ */
+void VulkanRenderer::createShadowCacheResources() {
+    VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+    context->createImage(shadowMapWidth, shadowMapHeight, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowCacheImage, shadowCacheImageMemory,
+                         ShadowCascades::MAX_CASCADES);
+
+    for (uint32_t c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        shadowCacheLayerViews[c] = context->createImageView(shadowCacheImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                                            VK_IMAGE_VIEW_TYPE_2D, c, 1);
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = shadowCacheRenderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &shadowCacheLayerViews[c];
+        framebufferInfo.width = shadowMapWidth;
+        framebufferInfo.height = shadowMapHeight;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(context->getDevice(), &framebufferInfo, nullptr, &shadowCacheFramebuffers[c]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shadow cache framebuffer!");
+        }
+        shadowCacheLayers[c] = ShadowCacheLayer{};
+    }
+
+    context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = shadowCacheImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = ShadowCascades::MAX_CASCADES;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+}
+
+/**
+ * @brief A pontfények kocka tömbje: kockánként 6 réteg (+X, -X, +Y, -Y, +Z, -Z), a fő shadernek egyetlen kocka tömb
+ * nézet, a render pass-nak kockánként egy 6 rétegű tömb nézet és multiview Framebuffer. Minden réteg olvasható
+ * layout-ba kerül (a shader csak a renderelt kockákat olvassa).
+ */
+void VulkanRenderer::createPointShadowResources() {
+    VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+    const uint32_t layerCount = MAX_POINT_SHADOWS * CUBE_FACES;
+    // Kocka tömb nélkül a shader (frag_no_cube_array.spv) nem olvassa, csak a kötés kap egy tömb nézetet
+    bool cubeArray = context->isImageCubeArraySupported();
+    context->createImage(POINT_SHADOW_SIZE, POINT_SHADOW_SIZE, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pointShadowImage, pointShadowImageMemory,
+                         layerCount, cubeArray ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+    pointShadowCubeView = context->createImageView(pointShadowImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                                   cubeArray ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                                                   0, layerCount);
+
+    if (pointShadowRenderPass != VK_NULL_HANDLE) {
+        for (uint32_t cube = 0; cube < MAX_POINT_SHADOWS; cube++) {
+            pointShadowFaceViews[cube] = context->createImageView(pointShadowImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                                                  VK_IMAGE_VIEW_TYPE_2D_ARRAY, cube * CUBE_FACES, CUBE_FACES);
+
+            // Multiview Framebuffer: egy réteg, a nézetek a csatolás rétegeire képződnek
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = pointShadowRenderPass;
+            framebufferInfo.attachmentCount = 1;
+            framebufferInfo.pAttachments = &pointShadowFaceViews[cube];
+            framebufferInfo.width = POINT_SHADOW_SIZE;
+            framebufferInfo.height = POINT_SHADOW_SIZE;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(context->getDevice(), &framebufferInfo, nullptr, &pointShadowFramebuffers[cube]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create point shadow framebuffer!");
+            }
+        }
+    }
+
+    context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = pointShadowImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = layerCount;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+    pointShadowCubes.assign(MAX_LIGHTS, UINT32_MAX);
 }
 
 /**
- * @brief Shadow Framebuffer létrehozása: Összeköti a Shadow Image View-t a Shadow Render Pass-szal.
+ * @brief Az árnyék atlasz: egyetlen mélységkép (olvasható layout-ban, a csempék a render pass-ban íródnak), a nézete,
+ * a Framebuffer-e és a csempe foglaló.
  */
-void VulkanRenderer::createShadowFramebuffer() {
+void VulkanRenderer::createShadowAtlasResources() {
+    VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+    context->createImage(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowAtlasImage, shadowAtlasImageMemory);
+    shadowAtlasImageView = context->createImageView(shadowAtlasImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+
     VkFramebufferCreateInfo framebufferInfo{};
     framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferInfo.renderPass = shadowRenderPass;
+    framebufferInfo.renderPass = shadowAtlasRenderPass;
     framebufferInfo.attachmentCount = 1;
-    framebufferInfo.pAttachments = &shadowImageView;
-    framebufferInfo.width = shadowMapWidth;
-    framebufferInfo.height = shadowMapHeight;
+    framebufferInfo.pAttachments = &shadowAtlasImageView;
+    framebufferInfo.width = SHADOW_ATLAS_SIZE;
+    framebufferInfo.height = SHADOW_ATLAS_SIZE;
     framebufferInfo.layers = 1;
 
-    if (vkCreateFramebuffer(context->getDevice(), &framebufferInfo, nullptr, &shadowFramebuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shadow framebuffer!");
+    if (vkCreateFramebuffer(context->getDevice(), &framebufferInfo, nullptr, &shadowAtlasFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shadow atlas framebuffer!");
+    }
+
+    // A render pass olvasható layout-ból indul; a tartalom az első renderelésig nem számít (a shader csak a renderelt
+    // csempéket olvassa)
+    context->executeSingleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = shadowAtlasImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+
+    shadowAtlas.init(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_MIN_TILE);
+}
+
+void VulkanRenderer::markShadowCacheDirty(const glm::vec3& center, const glm::vec3& extent) {
+    for (ShadowCacheLayer& layer : shadowCacheLayers) {
+        if (layer.revision == 0) continue;
+
+        // Az AABB sarkainak vetülete a réteg texel rácsán (ortografikus vetítés: NDC [-1, 1] -> [0, felbontás])
+        float width = static_cast<float>(shadowMapWidth);
+        float height = static_cast<float>(shadowMapHeight);
+        float loX = width, loY = height, hiX = 0.0f, hiY = 0.0f;
+        for (uint32_t corner = 0; corner < 8; corner++) {
+            glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+            glm::vec4 clip = layer.viewProjection * glm::vec4(center + sign * extent, 1.0f);
+            float texelX = (clip.x * 0.5f + 0.5f) * width;
+            float texelY = (clip.y * 0.5f + 0.5f) * height;
+            loX = std::min(loX, texelX);
+            loY = std::min(loY, texelY);
+            hiX = std::max(hiX, texelX);
+            hiY = std::max(hiY, texelY);
+        }
+        if (loX >= width || loY >= height || hiX <= 0.0f || hiY <= 0.0f) continue; // A rétegen kívül
+
+        // Egy texel ráhagyás a raszterizálás kerekítése miatt, a réteg határaira vágva
+        int32_t x0 = static_cast<int32_t>(std::max(std::floor(loX) - 1.0f, 0.0f));
+        int32_t y0 = static_cast<int32_t>(std::max(std::floor(loY) - 1.0f, 0.0f));
+        int32_t x1 = static_cast<int32_t>(std::min(std::ceil(hiX) + 1.0f, width));
+        int32_t y1 = static_cast<int32_t>(std::min(std::ceil(hiY) + 1.0f, height));
+        if (x0 >= x1 || y0 >= y1) continue;
+
+        // Egyesítés a réteg eddigi téglalapjával
+        if (layer.dirty.extent.width > 0) {
+            x0 = std::min(x0, layer.dirty.offset.x);
+            y0 = std::min(y0, layer.dirty.offset.y);
+            x1 = std::max(x1, layer.dirty.offset.x + static_cast<int32_t>(layer.dirty.extent.width));
+            y1 = std::max(y1, layer.dirty.offset.y + static_cast<int32_t>(layer.dirty.extent.height));
+        }
+        layer.dirty.offset = {x0, y0};
+        layer.dirty.extent = {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)};
+    }
+}
+
+std::vector<uint32_t> VulkanRenderer::updateShadowAtlas(uint32_t lightCount, uint32_t cascadeLight, const glm::mat4& view,
+                                                        const glm::vec3& cameraPos, const glm::vec4 cameraPlanes[6],
+                                                        float projectionScale) {
+    // Új fénylista: a csempék más fényekhez tartoztak
+    if (atlasLightsReset) {
+        shadowAtlas.reset();
+        atlasLights.assign(MAX_LIGHTS, AtlasLight{});
+        atlasLightsReset = false;
+    }
+
+    // Fontosság: a fény hatókörének vetített mérete pixelben, a kívánt csempe méret ebből (kettő hatványra lefelé
+    // kerekítve, a [MIN_TILE, MAX_TILE] tartományban). Irányfény mindig a legnagyobb csempét kapja.
+    struct Request {
+        uint32_t light;
+        float texels;
+    };
+    std::vector<Request> requests;
+    const float minTile = static_cast<float>(SHADOW_ATLAS_MIN_TILE);
+    const float maxTile = static_cast<float>(SHADOW_ATLAS_MAX_TILE);
+    for (uint32_t i = 0; i < MAX_LIGHTS; i++) {
+        float texels = 0.0f;
+        if (i < lightCount && i != cascadeLight && lights[i].castsShadow && lights[i].type != LightType::Point) {
+            const Light& light = lights[i];
+            if (light.type == LightType::Directional) {
+                texels = maxTile;
+            } else {
+                // A spot hatóköre a csúcsa körüli gömbön belül van; ha a kamera frustumán kívül esik, nem kell árnyék
+                float range = light.range > 0.0f ? light.range : DEFAULT_SHADOW_RANGE;
+                bool visible = true;
+                for (uint32_t p = 0; p < 6; p++) {
+                    if (glm::dot(glm::vec3(cameraPlanes[p]), light.position) + cameraPlanes[p].w < -range) {
+                        visible = false;
+                        break;
+                    }
+                }
+                if (visible) {
+                    float distance = std::max(glm::length(light.position - cameraPos), range);
+                    texels = range / distance * projectionScale * SHADOW_ATLAS_TEXELS_PER_PIXEL;
+                    texels = std::min(std::max(texels, minTile), maxTile);
+                }
+            }
+        }
+
+        // Hiszterézis: a meglévő csempe marad, amíg a kívánt méret a kétszeres lépcsőnél jobban el nem tér tőle,
+        // így a fény mozgása nem foglalja újra (és rendereli újra) a csempét minden határ átlépésekor
+        AtlasLight& state = atlasLights[i];
+        if (state.allocated) {
+            float current = static_cast<float>(state.tile.size);
+            if (texels >= current * 0.75f && texels < current * 2.5f) continue;
+            shadowAtlas.release(state.tile);
+            state.allocated = false;
+            state.rendered = false;
+        }
+        if (texels > 0.0f) requests.push_back({i, texels});
+    }
+
+    // A felszabadítások után a fontosabb fények foglalnak előbb; ha nincs elég hely, kisebb csempével próbálkoznak
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.texels > b.texels; });
+    for (const Request& request : requests) {
+        uint32_t size = SHADOW_ATLAS_MIN_TILE;
+        while (size * 2 <= static_cast<uint32_t>(request.texels)) size *= 2;
+        AtlasLight& state = atlasLights[request.light];
+        for (; size >= SHADOW_ATLAS_MIN_TILE && !state.allocated; size /= 2) {
+            state.allocated = shadowAtlas.allocate(size, state.tile);
+        }
+    }
+
+    // Ritkítás: a nagy csempék minden képkockában, a kisebbek minden 2. / 4. képkockában renderelődnek újra (a fény
+    // indexével eltolva, hogy ne egyszerre); az új csempe azonnal
+    std::vector<uint32_t> due;
+    for (uint32_t i = 0; i < lightCount; i++) {
+        AtlasLight& state = atlasLights[i];
+        if (!state.allocated) continue;
+        frameStats.atlasShadowLights++;
+        uint32_t interval = state.tile.size >= 512 ? 1 : (state.tile.size >= 256 ? 2 : 4);
+        if (state.rendered && (frameNumber + i) % interval != 0) continue;
+
+        const Light& light = lights[i];
+        if (light.type == LightType::Directional) {
+            // A teljes árnyék tartományra illesztett ortografikus vetítés a csempe texel rácsára igazítva
+            ShadowCascades::Settings settings = shadowCascadeSettings;
+            settings.resolution = state.tile.size;
+            settings.fitSlack = 0.0f;
+            ShadowCascades::Cascade fit = ShadowCascades::fitFrustum(view, glm::normalize(light.direction), settings);
+            state.viewProjection = fit.viewProjection;
+            state.texelScale = fit.texelWorldSize;
+        } else {
+            // Perspektív vetítés a kúp tengelye mentén, a kúpot befoglaló négyzetes frustummal (Vulkan mélység: [0, 1])
+            glm::vec3 direction = glm::normalize(light.direction);
+            glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::mat4 lightView = glm::lookAt(light.position, light.position + direction, up);
+            float farPlane = light.range > 0.0f ? light.range : DEFAULT_SHADOW_RANGE;
+            float nearPlane = std::max(farPlane * 0.01f, 0.05f);
+            float tanHalf = std::tan(std::min(light.outerAngle, glm::radians(85.0f)));
+            glm::mat4 lightProjection(0.0f);
+            lightProjection[0][0] = 1.0f / tanHalf;
+            lightProjection[1][1] = 1.0f / tanHalf;
+            lightProjection[2][2] = farPlane / (nearPlane - farPlane);
+            lightProjection[2][3] = -1.0f;
+            lightProjection[3][2] = nearPlane * farPlane / (nearPlane - farPlane);
+            state.viewProjection = lightProjection * lightView;
+            state.texelScale = 2.0f * tanHalf / static_cast<float>(state.tile.size);
+        }
+        state.rendered = true;
+        due.push_back(i);
+    }
+    frameStats.atlasRenderedTiles = static_cast<uint32_t>(due.size());
+    return due;
+}
+
+std::vector<VulkanRenderer::PointShadowDraw> VulkanRenderer::updatePointShadows(uint32_t lightCount, uint32_t cascadeLight,
+                                                                                const glm::vec3& cameraPos,
+                                                                                const glm::vec4 cameraPlanes[6],
+                                                                                float projectionScale) {
+    // Fontosság: mint az atlasznál, a hatókör gömbjének vetített mérete; a kamera frustumán kívüli fény nem kap kockát
+    struct Request {
+        uint32_t light;
+        float importance;
+    };
+    std::vector<Request> requests;
+    for (uint32_t i = 0; i < lightCount && pointShadowRenderPass != VK_NULL_HANDLE; i++) {
+        const Light& light = lights[i];
+        if (i == cascadeLight || !light.castsShadow || light.type != LightType::Point) continue;
+        float range = light.range > 0.0f ? light.range : DEFAULT_SHADOW_RANGE;
+        bool visible = true;
+        for (uint32_t p = 0; p < 6; p++) {
+            if (glm::dot(glm::vec3(cameraPlanes[p]), light.position) + cameraPlanes[p].w < -range) {
+                visible = false;
+                break;
+            }
+        }
+        if (visible) {
+            float distance = std::max(glm::length(light.position - cameraPos), range);
+            requests.push_back({i, range / distance * projectionScale});
+        }
+    }
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.importance > b.importance; });
+    if (requests.size() > MAX_POINT_SHADOWS) requests.resize(MAX_POINT_SHADOWS);
+
+    // A kockák minden képkockában újrarenderelődnek (törléssel), így a kiosztásuk a sorrendet követi
+    std::fill(pointShadowCubes.begin(), pointShadowCubes.end(), UINT32_MAX);
+    std::vector<PointShadowDraw> draws(requests.size());
+    for (uint32_t cube = 0; cube < draws.size(); cube++) {
+        const Light& light = lights[requests[cube].light];
+        PointShadowDraw& draw = draws[cube];
+        draw.light = requests[cube].light;
+        draw.cube = cube;
+        draw.farPlane = light.range > 0.0f ? light.range : DEFAULT_SHADOW_RANGE;
+        draw.nearPlane = std::max(draw.farPlane * 0.01f, 0.05f);
+
+        // A hatókört befoglaló kocka: x, y -> [-1, 1], z -> [0, 1]
+        const glm::vec3& center = light.position;
+        float invRange = 1.0f / draw.farPlane;
+        draw.bounds = glm::mat4(1.0f);
+        draw.bounds[0][0] = invRange;
+        draw.bounds[1][1] = invRange;
+        draw.bounds[2][2] = 0.5f * invRange;
+        draw.bounds[3][0] = -center.x * invRange;
+        draw.bounds[3][1] = -center.y * invRange;
+        draw.bounds[3][2] = 0.5f - 0.5f * center.z * invRange;
+        pointShadowCubes[draw.light] = cube;
+    }
+    frameStats.pointShadowLights = static_cast<uint32_t>(draws.size());
+    return draws;
+}
+
+/**
+ * @brief Shadow Framebuffer-ek létrehozása: kaszkádonként összeköti a réteg nézetét a Shadow Render Pass-szal.
+ */
+void VulkanRenderer::createShadowFramebuffers() {
+    for (uint32_t c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = shadowRenderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &shadowLayerViews[c];
+        framebufferInfo.width = shadowMapWidth;
+        framebufferInfo.height = shadowMapHeight;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(context->getDevice(), &framebufferInfo, nullptr, &shadowFramebuffers[c]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shadow framebuffer!");
+        }
     }
 }
 
 /**
- * @brief Descriptor Set létrehozása az árnyéktérképhez, hogy elérhető legyen a shaderben (Binding 0, Set 1).
+ * @brief Descriptor Set létrehozása az árnyéktérképhez (Binding 0), az árnyék atlaszhoz (Binding 1) és a pontfények
+ * kocka tömbjéhez (Binding 2), hogy elérhetők legyenek a shaderben (Set 1). Mind ugyanazzal az összehasonlító
+ * mintavételezővel.
  */
 void VulkanRenderer::createShadowDescriptorSet() {
-    VkDescriptorSetLayoutBinding binding{};
-    binding.binding = 0;
-    binding.descriptorCount = 1;
-    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    binding.pImmutableSamplers = nullptr;
-    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    for (uint32_t b = 0; b < bindings.size(); b++) {
+        bindings[b].binding = b;
+        bindings[b].descriptorCount = 1;
+        bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[b].pImmutableSamplers = nullptr;
+        bindings[b].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &binding;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
 
     if (vkCreateDescriptorSetLayout(context->getDevice(), &layoutInfo, nullptr, &shadowDescriptorSetLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create shadow descriptor set layout!");
@@ -251,7 +1445,7 @@ void VulkanRenderer::createShadowDescriptorSet() {
 
     VkDescriptorPoolSize poolSize{};
     poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSize.descriptorCount = 1;
+    poolSize.descriptorCount = static_cast<uint32_t>(bindings.size());
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -273,15 +1467,46 @@ void VulkanRenderer::createShadowDescriptorSet() {
         throw std::runtime_error("failed to allocate shadow descriptor set!");
     }
 
+    std::array<VkDescriptorImageInfo, 3> imageInfos{};
+    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfos[0].imageView = shadowImageView;
+    imageInfos[0].sampler = shadowSampler;
+    imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfos[1].imageView = shadowAtlasImageView;
+    imageInfos[1].sampler = shadowSampler;
+    imageInfos[2].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfos[2].imageView = pointShadowCubeView;
+    imageInfos[2].sampler = shadowSampler;
+
+    std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+    for (uint32_t b = 0; b < descriptorWrites.size(); b++) {
+        descriptorWrites[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[b].dstSet = shadowDescriptorSet;
+        descriptorWrites[b].dstBinding = b;
+        descriptorWrites[b].dstArrayElement = 0;
+        descriptorWrites[b].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[b].descriptorCount = 1;
+        descriptorWrites[b].pImageInfo = &imageInfos[b];
+    }
+
+    vkUpdateDescriptorSets(context->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    writeMomentShadowDescriptor();
+}
+
+/**
+ * @brief Az EVSM momentumok kötése (Binding 3). A kép létrejöttéig a kaszkádok mélység tömbje áll a helyén (a kötésnek
+ * érvényesnek kell lennie, de a shader csak EVSM fénnyel olvassa); a kép létrehozása után a hívó már megvárta a GPU-t.
+ */
+void VulkanRenderer::writeMomentShadowDescriptor() {
     VkDescriptorImageInfo imageInfo{};
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageInfo.imageView = shadowImageView;
-    imageInfo.sampler = shadowSampler;
+    imageInfo.imageView = shadowMoments.hasImage() ? shadowMoments.getImageView() : shadowImageView;
+    imageInfo.sampler = shadowMoments.getSampler();
 
     VkWriteDescriptorSet descriptorWrite{};
     descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrite.dstSet = shadowDescriptorSet;
-    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstBinding = 3;
     descriptorWrite.dstArrayElement = 0;
     descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     descriptorWrite.descriptorCount = 1;
@@ -291,7 +1516,10 @@ void VulkanRenderer::createShadowDescriptorSet() {
 }
 
 /**
- * @brief Shadow Pipeline konfiguráció: 11-floatos vertex input kezelése és Front-Face Culling a "Shadow Acne" ellen.
+ * @brief Shadow Pipeline konfiguráció: vertex formátumonként egy pipeline (Full / Compact) és Front-Face Culling a "Shadow Acne" ellen.
+ * Csak a pozíció folyam (binding 0) van bekötve: a mélység íráshoz a normál, UV és tangens nem kell.
+ * Multiview támogatással a pontfény kockák pipeline-jai is (ugyanaz az állapot és layout, saját vertex shader és
+ * a multiview render pass).
  */
 void VulkanRenderer::createShadowPipeline() {
     auto vertShaderCode = readFile("shaders/shadow_vert.spv");
@@ -312,18 +1540,12 @@ void VulkanRenderer::createShadowPipeline() {
     vertShaderStageInfo.module = vertModule;
     vertShaderStageInfo.pName = "main";
 
-    // Vertex adatszerkezet leírása: Pos(3) + Norm(3) + UV(2) + Tan(3) = 11 float stride
+    // Vertex adatszerkezet leírása: csak a szorosan pakolt pozíció folyam (Full: 12 byte, Compact: 8 byte / vertex),
+    // a tényleges értékeket a pipeline-onkénti ciklus tölti ki
     VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = 11 * sizeof(float);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
     // Az árnyékhoz csak a pozíció (Location 0) szükséges
     VkVertexInputAttributeDescription attributeDescription{};
-    attributeDescription.binding = 0;
-    attributeDescription.location = 0;
-    attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescription.offset = 0;
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -356,6 +1578,13 @@ void VulkanRenderer::createShadowPipeline() {
     viewportState.scissorCount = 1;
     viewportState.pScissors = &scissor;
 
+    // A viewport és a scissor dinamikus: az árnyék gyorsítótár részleges frissítése csak az érvénytelen téglalapba,
+    // az atlasz csempénként a saját területére rajzol
+    std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
     VkPipelineRasterizationStateCreateInfo rasterizer{};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
@@ -392,15 +1621,20 @@ void VulkanRenderer::createShadowPipeline() {
     colorBlending.logicOpEnable = VK_FALSE;
     colorBlending.attachmentCount = 0; // Árnyéknál nincs színkeverés
 
-    // Push Constant a mátrixok (Model * LightSpace) gyors átadásához
+    // A model mátrixok a példány pufferből (Set 0), a kaszkádok fény mátrixai a frame uniform pufferből, az atlasz
+    // csempéké a fény pufferből (Set 1)
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {instanceDescriptorSetLayout, frameDescriptorSetLayout};
+
+    // A nézet indexe (kaszkád, vagy MAX_CASCADES + a fény indexe az atlasz csempéhez), secondary bufferenként egyszer beállítva
     VkPushConstantRange pushConstantRange{};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(glm::mat4);
+    pushConstantRange.size = sizeof(uint32_t);
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -419,55 +1653,116 @@ void VulkanRenderer::createShadowPipeline() {
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = shadowPipelineLayout;
     pipelineInfo.renderPass = shadowRenderPass;
     pipelineInfo.subpass = 0;
 
-    if (vkCreateGraphicsPipelines(context->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &shadowPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shadow pipeline!");
+    for (VertexFormat format : {VertexFormat::Full, VertexFormat::Compact}) {
+        bindingDescription = VertexLayout::getPositionBindingDescription(format);
+        attributeDescription = VertexLayout::getPositionAttributeDescription(format);
+
+        VkPipeline& target = (format == VertexFormat::Compact) ? compactShadowPipeline : shadowPipeline;
+        if (vkCreateGraphicsPipelines(context->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &target) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shadow pipeline!");
+        }
     }
 
     vkDestroyShaderModule(context->getDevice(), vertModule, nullptr);
-}
 
-/**
- * @brief Fény-tér mátrix generálása: A fény szemszögéből készít ortografikus vetítést (Z: 0..1 Vulkanhoz).
- */
-glm::mat4 VulkanRenderer::getLightSpaceMatrix(glm::vec3 lightPos) {
-    float near_plane = 1.0f;
-    float far_plane = 20.0f;
+    // Pontfény kockák: a vertex shader a gl_ViewIndex szerinti lapra vetít (a SPIR-V MultiView képessége miatt csak
+    // a kiterjesztés engedélyezésével tölthető be)
+    if (pointShadowRenderPass == VK_NULL_HANDLE) {
+        return;
+    }
+    auto pointShaderCode = readFile("shaders/point_shadow_vert.spv");
+    createInfo.codeSize = pointShaderCode.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(pointShaderCode.data());
 
-    // Manuális ortografikus mátrix: X, Y: -10..10 tartomány lefedése
-    float left = -10.0f;
-    float right = 10.0f;
-    float bottom = -10.0f;
-    float top = 10.0f;
+    VkShaderModule pointModule;
+    if (vkCreateShaderModule(context->getDevice(), &createInfo, nullptr, &pointModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create point shadow shader module!");
+    }
+    // A lap maszkok a Set 2-ben; a 0. és 1. set és a push constant azonos, így a kötéseik a két layout között közösek
+    std::array<VkDescriptorSetLayout, 3> pointSetLayouts = {instanceDescriptorSetLayout, frameDescriptorSetLayout,
+                                                            instanceDescriptorSetLayout};
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(pointSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = pointSetLayouts.data();
+    if (vkCreatePipelineLayout(context->getDevice(), &pipelineLayoutInfo, nullptr, &pointShadowPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create point shadow pipeline layout!");
+    }
 
-    glm::mat4 lightProjection = glm::mat4(1.0f);
-    lightProjection[0][0] = 2.0f / (right - left);
-    lightProjection[1][1] = 2.0f / (top - bottom);
-    lightProjection[2][2] = 1.0f / (near_plane - far_plane);        // Mélység mapping 0..1-re
-    lightProjection[3][2] = near_plane / (near_plane - far_plane);
-    lightProjection[3][3] = 1.0f;
+    vertShaderStageInfo.module = pointModule;
+    pipelineInfo.layout = pointShadowPipelineLayout;
+    pipelineInfo.renderPass = pointShadowRenderPass;
 
-    // Nézeti mátrix a fény szemszögéből (LookAt)
-    glm::mat4 lightView = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
+    for (VertexFormat format : {VertexFormat::Full, VertexFormat::Compact}) {
+        bindingDescription = VertexLayout::getPositionBindingDescription(format);
+        attributeDescription = VertexLayout::getPositionAttributeDescription(format);
 
-    return lightProjection * lightView;
-}
+        VkPipeline& target = (format == VertexFormat::Compact) ? compactPointShadowPipeline : pointShadowPipeline;
+        if (vkCreateGraphicsPipelines(context->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &target) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create point shadow pipeline!");
+        }
+    }
 
+    vkDestroyShaderModule(context->getDevice(), pointModule, nullptr);
+}
 /**
- * @brief Egy képkocka lerenderelése: Shadow Pass -> Main Pass -> Present.
+ * @brief Egy képkocka lerenderelése: culling és LOD -> csoportok -> parancsrögzítés -> Shadow Pass-ok -> Main Pass -> Present.
+ * A lépések a FrameContext-en keresztül adják át egymásnak a képkocka állapotát.
  */
 void VulkanRenderer::drawFrame(VulkanSwapchain* swapchain, VulkanPipeline* pipeline, glm::vec3 cameraPos, const std::vector<MeshObject*>& objects) {
+    FrameContext frame;
+    frame.pipeline = pipeline;
+    frame.cameraPos = cameraPos;
+    frame.objects = &objects;
+    if (!beginFrame(frame, swapchain)) {
+        return; // Ablakméretezés esetén újra kell építeni a swapchain-t
+    }
+
+    updateFrameData(frame);
+    updateLights(frame);
+    cullScene(frame);
+    if (!frame.gpuPath) {
+        buildDrawBatches(frame);
+    }
+    buildLightBatches(frame);
+    recordSecondaries(frame);
+
+    // --- 1. PASS: SHADOW MAP RENDERELÉS (kaszkádok, atlasz csempék, pontfény kockák) ---
+    writeTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+    recordCascadeShadowPass(frame);
+    recordAtlasShadowPass(frame);
+    recordPointShadowPass(frame);
+    writeTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
+
+    // --- 2. PASS: FŐ RENDERELÉS (Kamera szemszögéből) ---
+    writeTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2);
+    recordMainPass(frame);
+    writeTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 3);
+    if (timestampQueryPool != VK_NULL_HANDLE) {
+        timestampsWritten[currentFrame] = true;
+    }
+
+    submitFrame(frame, swapchain);
+}
+
+bool VulkanRenderer::beginFrame(FrameContext& frame, VulkanSwapchain* swapchain) {
     // Szinkronizáció: Megvárjuk az előző azonos frame végét a GPU-n
     vkWaitForFences(context->getDevice(), 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    readTimestamps(currentFrame);
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(context->getDevice(), swapchain->getSwapchain(), UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    // A GPU-vezérelt mód statisztikája a slot előző (már befejezett) képkockájából
+    frame.gpuPath = isGpuDriven();
+    if (frame.gpuPath) {
+        gpuCuller.readStats(currentFrame);
+    }
+
+    VkResult result = vkAcquireNextImageKHR(context->getDevice(), swapchain->getSwapchain(), UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &frame.imageIndex);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        return; // Ablakméretezés esetén újra kell építeni a swapchain-t
+        return false;
     } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
@@ -475,122 +1770,989 @@ void VulkanRenderer::drawFrame(VulkanSwapchain* swapchain, VulkanPipeline* pipel
     vkResetFences(context->getDevice(), 1, &inFlightFences[currentFrame]);
     vkResetCommandBuffer(commandBuffers[currentFrame], 0);
 
-    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    frame.commandBuffer = commandBuffers[currentFrame];
+    frame.extent = swapchain->getExtent();
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    // A frame slot timestamp query-jeit újra kell indítani, mielőtt újra írnánk őket
+    if (timestampQueryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(frame.commandBuffer, timestampQueryPool, currentFrame * TIMESTAMPS_PER_FRAME, TIMESTAMPS_PER_FRAME);
+    }
+    return true;
+}
+
+void VulkanRenderer::writeTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage, uint32_t query) {
+    if (timestampQueryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, stage, timestampQueryPool, currentFrame * TIMESTAMPS_PER_FRAME + query);
+    }
+}
+
+void VulkanRenderer::updateFrameData(FrameContext& frame) {
+    const std::vector<MeshObject*>& objects = *frame.objects;
+
     // Időmérés az animációkhoz
     static auto startTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    frame.time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+
+    // A kaszkádolt árnyéktérkép az első árnyékvető fény irányából készül (ha nincs ilyen, a shader nem olvassa):
+    // irányfénynél a direction, pont- és spotfénynél a pozíciójából a jelenet középpontja felé
+    frame.lightCount = static_cast<uint32_t>(std::min<size_t>(lights.size(), MAX_LIGHTS));
+    frame.lightDirection = glm::normalize(glm::vec3(-1.0f, -1.0f, -1.0f));
+    for (uint32_t i = 0; i < frame.lightCount; i++) {
+        if (!lights[i].castsShadow) continue;
+        frame.cascadeLight = i;
+        glm::vec3 toward = lights[i].type == LightType::Directional ? lights[i].direction : -lights[i].position;
+        if (glm::length(toward) > 0.0f) frame.lightDirection = glm::normalize(toward);
+        break;
+    }
 
-    // --- 1. PASS: SHADOW MAP RENDERELÉS ---
+    // EVSM a kaszkádok fényénél (a momentum kép a setLights-ban jött létre)
+    frame.momentShadows = frame.cascadeLight != UINT32_MAX &&
+                          lights[frame.cascadeLight].shadowTechnique == ShadowTechnique::Evsm && shadowMoments.hasImage();
 
-    VkRenderPassBeginInfo shadowRenderPassInfo{};
-    shadowRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    shadowRenderPassInfo.renderPass = shadowRenderPass;
-    shadowRenderPassInfo.framebuffer = shadowFramebuffer;
-    shadowRenderPassInfo.renderArea.offset = {0, 0};
-    shadowRenderPassInfo.renderArea.extent = {shadowMapWidth, shadowMapHeight};
+    // Kamera mátrixok kiszámítása
+    float aspect = frame.extent.width / (float)frame.extent.height;
+    frame.view = glm::lookAt(frame.cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+    proj[1][1] *= -1; // Vulkan Y-tengely korrekció
+    frame.viewProjection = proj * frame.view;
+
+    // --- KASZKÁDOK: a kamera frustum szeletei (practical split scheme), szeletenként illesztett fény mátrix ---
+    shadowCascadeSettings.fovY = glm::radians(45.0f);
+    shadowCascadeSettings.aspect = aspect;
+    shadowCascadeSettings.nearPlane = 0.1f;
+    shadowCascadeSettings.resolution = shadowMapWidth;
+
+    // Árnyék gyorsítótár (statikus visszajátszás, CPU út): tartalékkal illesztett kaszkádok, hogy a gyorsítótár rétegei
+    // a kamera kis mozgásainál is érvényesek maradjanak
+    frame.shadowCacheActive = shadowCacheEnabled && staticReplay && !frame.gpuPath;
+    shadowCascadeSettings.fitSlack = frame.shadowCacheActive ? SHADOW_CACHE_FIT_SLACK : 0.0f;
+    shadowCascades.update(frame.view, frame.lightDirection, shadowCascadeSettings);
+    frame.cascadeCount = shadowCascades.getCascadeCount();
+
+    // --- FRAME UNIFORM PUFFER: kamera, fény mátrix és fénylista, képkockánként egyszer ---
+    // A rögzített (és a statikus visszajátszásnál több képkockán át újrahasznált) parancsok innen olvasnak
+    FrameData& frameData = *frameUniforms[currentFrame].mapped;
+    frameData.view = frame.view;
+    frameData.proj = proj;
+    frameData.viewProjection = frame.viewProjection;
+    for (uint32_t c = 0; c < frame.cascadeCount; c++) {
+        const ShadowCascades::Cascade& cascade = shadowCascades.getCascade(c);
+        frameData.cascadeMatrices[c] = cascade.viewProjection;
+        frameData.cascadeSplits[c] = cascade.splitFar;
+        frameData.cascadeTexelSizes[c] = cascade.texelWorldSize;
+    }
+    frameData.cascadeCount = frame.cascadeCount;
+    frameData.shadowFilter = static_cast<uint32_t>(shadowFilter);
+    frameData.cameraPosition = glm::vec4(frame.cameraPos, 1.0f);
+    frameData.lightCount = frame.lightCount;
+
+    // --- LOD választás pass-onként a vetített hiba alapján ---
+    // Kamera: perspektív, a pixel/egység arány a távolsággal csökken (fovY = 45 fok)
+    frame.mainSelection.viewerPosition = frame.cameraPos;
+    frame.mainSelection.projectionScale = frame.extent.height / (2.0f * std::tan(glm::radians(45.0f) * 0.5f));
+    frame.mainSelection.maxPixelError = MAIN_LOD_PIXEL_ERROR;
+
+    // Fény: kaszkádonként ortografikus (2 * sugár széles) vetítés a réteg felbontására, a megengedett hiba nagyobb
+    for (uint32_t c = 0; c < frame.cascadeCount; c++) {
+        frame.shadowSelections[c].orthographic = true;
+        frame.shadowSelections[c].projectionScale = shadowMapWidth / (2.0f * shadowCascades.getCascade(c).radius);
+        frame.shadowSelections[c].maxPixelError = SHADOW_LOD_PIXEL_ERROR;
+    }
 
-    VkClearValue clearValue{};
-    clearValue.depthStencil = {1.0f, 0}; // Maximális mélységre törlés
-    shadowRenderPassInfo.clearValueCount = 1;
-    shadowRenderPassInfo.pClearValues = &clearValue;
+    // Csak az "árnyékot vető" tárgyak kerülnek az árnyék pass-ba (a padlót kihagyjuk, mert az csak árnyékot fogad)
+    frame.shadowCasterCount = objects.size() > 0 ? objects.size() - 1 : 0;
 
-    glm::vec3 lightPos = glm::vec3(5.0f, 5.0f, 5.0f);
-    glm::mat4 lightSpaceMatrix = getLightSpaceMatrix(lightPos);
+    lastViewProjection = frame.viewProjection;
+    lastCameraPos = frame.cameraPos;
+    lastObjects = &objects;
+    lastAnimationTime = frame.time;
 
-    vkCmdBeginRenderPass(commandBuffer, &shadowRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipeline);
+    frameStats = FrameStats{};
+    frameStats.shadowPassMs = lastShadowPassMs;
+    frameStats.mainPassMs = lastMainPassMs;
+    frameStats.objectCount = static_cast<uint32_t>(objects.size());
+}
 
-    // Csak az "árnyékot vető" tárgyak renderelése (a padlót kihagyjuk, mert az csak árnyékot fogad)
-    size_t shadowCasterCount = objects.size() > 0 ? objects.size() - 1 : 0;
+void VulkanRenderer::updateLights(FrameContext& frame) {
+    // --- ÁRNYÉK ATLASZ ÉS FÉNY PUFFER: csempék a további árnyékvető fényeknek, fényenként a shader leírója ---
+    glm::vec4 cameraPlanes[6];
+    FrustumCuller::extractPlanes(frame.viewProjection, cameraPlanes);
+    frame.atlasDue = updateShadowAtlas(frame.lightCount, frame.cascadeLight, frame.view, frame.cameraPos, cameraPlanes,
+                                       frame.mainSelection.projectionScale);
+    pointShadowDraws = updatePointShadows(frame.lightCount, frame.cascadeLight, frame.cameraPos, cameraPlanes,
+                                          frame.mainSelection.projectionScale);
+    GpuLight* gpuLights = frameUniforms[currentFrame].lights;
+    const float atlasSize = static_cast<float>(SHADOW_ATLAS_SIZE);
+    for (uint32_t i = 0; i < frame.lightCount; i++) {
+        const Light& light = lights[i];
+        const AtlasLight& atlasLight = atlasLights[i];
+        GpuLight& gpuLight = gpuLights[i];
+        glm::vec3 direction = glm::length(light.direction) > 0.0f ? glm::normalize(light.direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+        gpuLight.position = glm::vec4(light.position, light.range);
+        gpuLight.direction = glm::vec4(direction, std::cos(light.outerAngle));
+        gpuLight.color = glm::vec4(light.color, static_cast<float>(light.type));
+        gpuLight.shadowMatrix = atlasLight.viewProjection;
+        gpuLight.atlasRect = glm::vec4(atlasLight.tile.x / atlasSize, atlasLight.tile.y / atlasSize,
+                                       atlasLight.tile.size / atlasSize, atlasLight.tile.size / atlasSize);
+        gpuLight.shadowMode = i == frame.cascadeLight ? (frame.momentShadows ? 4u : 1u)
+                                                      : (atlasLight.allocated && atlasLight.rendered ? 2u : 0u);
+        gpuLight.shadowTexelScale = atlasLight.texelScale;
+        gpuLight.shadowNear = 0.0f;
+        gpuLight.shadowFar = 0.0f;
+        uint32_t cube = pointShadowCubes[i];
+        if (cube != UINT32_MAX) {
+            // Kocka árnyék: 90 fokos lapok, egy texel 2 / méret egységnyi távolságban
+            gpuLight.shadowMode = 3u;
+            gpuLight.atlasRect = glm::vec4(static_cast<float>(cube), 0.0f, 0.0f, 0.0f);
+            gpuLight.shadowTexelScale = 2.0f / static_cast<float>(POINT_SHADOW_SIZE);
+            gpuLight.shadowNear = pointShadowDraws[cube].nearPlane;
+            gpuLight.shadowFar = pointShadowDraws[cube].farPlane;
+        }
+    }
+}
 
-    for (size_t i = 0; i < shadowCasterCount; i++) {
-        MeshObject* obj = objects[i];
+void VulkanRenderer::cullScene(FrameContext& frame) {
+    const std::vector<MeshObject*>& objects = *frame.objects;
+    const uint32_t cascadeCount = frame.cascadeCount;
+
+    // Statikus visszajátszás CPU módban: a képkockánkénti út (culling, LOD, rendezés, példányok) csak a dinamikus
+    // objektumokat dolgozza fel, a statikusak rajzolásai a frame slot rögzített secondary buffereiből jönnek
+    frame.replayStatic = staticReplay && !frame.gpuPath;
+    if (frame.replayStatic) {
+        updateStaticScene(objects, frame.shadowCasterCount);
+        frame.dynamicObjects.reserve(staticScene.dynamicObjects.size());
+        for (uint32_t i : staticScene.dynamicObjects) frame.dynamicObjects.push_back(objects[i]);
+    }
+    frame.drawObjects = frame.replayStatic ? &frame.dynamicObjects : &objects;
+    frame.drawCasterCount = frame.replayStatic ? staticScene.dynamicCasterCount : frame.shadowCasterCount;
+    const std::vector<MeshObject*>& drawObjects = *frame.drawObjects;
+
+    if (frame.gpuPath) {
+        // --- GPU-VEZÉRELT MÓD: animáció, frustum culling, LOD és rajzolási parancsok a compute pass-ban ---
+        // A CPU csak O(1) méretű paramétereket ír; a jelenet pufferei csak változáskor töltődnek fel újra.
+        // A meshlet culling itt nem fut (a kiválasztott LOD teljes index tartománya rajzolódik),
+        // a BVH a kijelöléskor frissül.
+        auto cullStart = std::chrono::high_resolution_clock::now();
+        gpuCuller.updateScene(objects, frame.shadowCasterCount);
+
+        GpuCuller::FrameParams gpuParams;
+        gpuParams.viewProjection = frame.viewProjection;
+        for (uint32_t c = 0; c < cascadeCount; c++) {
+            gpuParams.shadowMatrices[c] = shadowCascades.getCascade(c).viewProjection;
+            gpuParams.shadowSelections[c] = frame.shadowSelections[c];
+        }
+        gpuParams.cascadeCount = cascadeCount;
+        gpuParams.mainSelection = frame.mainSelection;
+        gpuParams.lodEnabled = lodEnabled;
+        gpuParams.animationTime = frame.time;
+        gpuCuller.recordCulling(frame.commandBuffer, currentFrame, gpuParams);
+        auto cullEnd = std::chrono::high_resolution_clock::now();
+        sceneBvhStale = true;
+        mainBatches.clear();
+        for (std::vector<DrawBatch>& batches : shadowBatches) batches.clear();
+
+        // A láthatósági és háromszög számok MAX_FRAMES_IN_FLIGHT képkockával késnek (GPU visszaolvasás)
+        const GpuCuller::Stats& gpuStats = gpuCuller.getStats();
+        frameStats.mainVisibleObjects = gpuStats.mainVisibleObjects;
+        frameStats.shadowVisibleObjects = gpuStats.shadowVisibleObjects;
+        frameStats.mainTriangles = gpuStats.mainTriangles;
+        frameStats.shadowTriangles = gpuStats.shadowTriangles;
+        frameStats.mainDrawCalls = static_cast<uint32_t>(gpuCuller.getBuckets().size());
+        frameStats.shadowDrawCalls = static_cast<uint32_t>(gpuCuller.getBuckets().size()) * cascadeCount;
+        frameStats.cullMs = std::chrono::duration<float, std::milli>(cullEnd - cullStart).count();
+        return;
+    }
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, obj->position);
-        if (obj->rotationSpeed != 0.0f) {
-            model = glm::rotate(model, glm::radians(obj->rotationSpeed * time), obj->rotationAxis);
+    // --- FRUSTUM CULLING (CPU) ---
+    // BVH_CULL_THRESHOLD objektumtól a culling a jelenet BVH-ját kérdezi le, ezért az minden képkockában frissül
+    // (refit, ritkán újraépítés). Kis jelenetnél a lapos SIMD teszt (AABB + gömb) gyorsabb a fa bejárásánál, és a
+    // BVH csak a kijelöléskor frissül (pickObject).
+    // Az árnyékvetők kaszkádonként külön vágódnak: a közeli kaszkád kis területébe csak a közeli vetők kerülnek.
+    auto cullStart = std::chrono::high_resolution_clock::now();
+    // Statikus visszajátszásnál a BVH a teljes jelenetre épül, a dinamikus objektumok a lapos teszttel vágódnak
+    bool bvhCulling = !frame.replayStatic && objects.size() >= BVH_CULL_THRESHOLD;
+    sceneBvhStale = !bvhCulling;
+    if (bvhCulling) {
+        sceneBvh.update(objects, frame.time);
+        sceneBvh.queryFrustum(frame.viewProjection, mainVisible);
+        for (uint32_t c = 0; c < cascadeCount; c++) {
+            std::vector<uint32_t>& visible = shadowVisible[c];
+            sceneBvh.queryFrustum(shadowCascades.getCascade(c).viewProjection, visible);
+            // Az eredmény növekvő sorrendű: a nem árnyékvető padló (utolsó objektum) a végéről levágható
+            visible.erase(std::lower_bound(visible.begin(), visible.end(), uint32_t(frame.shadowCasterCount)), visible.end());
+        }
+    } else {
+        frustumCuller.update(drawObjects, frame.time);
+        frustumCuller.cull(frame.viewProjection, drawObjects.size(), mainVisible);
+        for (uint32_t c = 0; c < cascadeCount; c++) {
+            frustumCuller.cull(shadowCascades.getCascade(c).viewProjection, frame.drawCasterCount, shadowVisible[c]);
         }
+    }
+    auto cullEnd = std::chrono::high_resolution_clock::now();
+    size_t shadowVisibleCount = 0;
+    for (uint32_t c = 0; c < cascadeCount; c++) shadowVisibleCount += shadowVisible[c].size();
+    frameStats.mainVisibleObjects = static_cast<uint32_t>(mainVisible.size());
+    frameStats.shadowVisibleObjects = static_cast<uint32_t>(shadowVisibleCount);
+    if (frame.replayStatic) {
+        // A statikus objektumok culling nélkül, teljes részletességgel kerülnek a visszajátszott rajzolásokba
+        frameStats.mainVisibleObjects += staticScene.staticObjectCount;
+        frameStats.shadowVisibleObjects += staticScene.staticCasterCount * cascadeCount;
+        frameStats.mainTriangles += staticScene.mainTriangles;
+    }
+    frameStats.cullMs = std::chrono::duration<float, std::milli>(cullEnd - cullStart).count();
+
+    // LOD választás csak a látható objektumokra, kaszkádonként a saját texel sűrűségével
+    frame.mainLods.assign(drawObjects.size(), 0);
+    frame.shadowLods.assign(cascadeCount, std::vector<uint32_t>(drawObjects.size(), 0));
+    for (uint32_t i : mainVisible) {
+        if (lodEnabled) frame.mainLods[i] = drawObjects[i]->selectLod(frame.mainSelection, frame.time);
+        frameStats.mainTriangles += drawObjects[i]->lods[frame.mainLods[i]].indexCount / 3;
+    }
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        for (uint32_t i : shadowVisible[c]) {
+            if (lodEnabled) frame.shadowLods[c][i] = drawObjects[i]->selectLod(frame.shadowSelections[c], frame.time);
+        }
+    }
+}
+
+void VulkanRenderer::buildDrawBatches(FrameContext& frame) {
+    const std::vector<MeshObject*>& drawObjects = *frame.drawObjects;
+    const uint32_t cascadeCount = frame.cascadeCount;
+    const glm::mat4& viewProjection = frame.viewProjection;
+    size_t shadowVisibleCount = 0;
+    for (uint32_t c = 0; c < cascadeCount; c++) shadowVisibleCount += shadowVisible[c].size();
+
+    // --- RENDEZÉSI SOR: a fő pass és a kaszkádok rajzolásai 64 bites kulccsal (pass, pipeline, anyag, mesh, mélység) ---
+    // A pass a legfelső mező, így rendezés után előbb a fő pass, utána kaszkádonként az árnyék pass elemei következnek.
+    // Mélység: a kameránál a clip W (nézeti távolság, a far sík 100), a fénynél a clip Z ([0, 1]).
+    auto sortStart = std::chrono::high_resolution_clock::now();
+    renderQueue.resize(mainVisible.size() + shadowVisibleCount);
+    glm::vec4 cameraDepth(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+    queueDraws(drawObjects, mainVisible, frame.mainLods, 0, true, cameraDepth, 100.0f, renderQueue.getItems().data());
+    size_t queueOffset = mainVisible.size();
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        const glm::mat4& lightMatrix = shadowCascades.getCascade(c).viewProjection;
+        glm::vec4 lightDepth(lightMatrix[0][2], lightMatrix[1][2], lightMatrix[2][2], lightMatrix[3][2]);
+        queueDraws(drawObjects, shadowVisible[c], frame.shadowLods[c], 1 + c, false, lightDepth, 1.0f,
+                   renderQueue.getItems().data() + queueOffset);
+        queueOffset += shadowVisible[c].size();
+    }
+    renderQueue.sort();
+    frameStats.sortMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+
+    // --- INSTANCING: csoportosítás és model mátrixok a frame példány pufferébe ---
+    // Előbb a fő pass példányai, utánuk kaszkádonként az árnyék pass-éi (a slot előző használata a fence miatt
+    // már befejeződött). Egy objektum több kaszkádban is szerepelhet, mindegyikben ugyanazzal a mátrixszal.
+    InstanceBuffer& frameInstances = instanceBuffers[currentFrame];
+    ensureInstanceCapacity(frameInstances, static_cast<uint32_t>(mainVisible.size() + shadowVisibleCount));
+    std::vector<uint32_t> mainInstances(drawObjects.size(), 0);
+    std::vector<uint32_t> shadowInstances(drawObjects.size(), 0);
+    const RenderQueue::Item* queueItems = renderQueue.getItems().data();
+    uint32_t nextInstance = buildBatches(drawObjects, queueItems, mainVisible.size(), frame.mainLods, true, frame.time,
+                                         frameInstances.mapped, 0, mainBatches, mainInstances);
+    frameStats.mainDrawCalls = static_cast<uint32_t>(mainBatches.size());
+    queueOffset = mainVisible.size();
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        nextInstance = buildBatches(drawObjects, queueItems + queueOffset, shadowVisible[c].size(), frame.shadowLods[c], false,
+                                    frame.time, frameInstances.mapped, nextInstance, shadowBatches[c], shadowInstances);
+        queueOffset += shadowVisible[c].size();
+        frameStats.shadowDrawCalls += static_cast<uint32_t>(shadowBatches[c].size());
+    }
 
-        glm::mat4 mvp = lightSpaceMatrix * model; // Mátrix a fény szemszögéből
+    // --- 0. PASS: MESHLET CULLING (Compute) ---
+    // Csak a legalább az egyik pass-ban látható objektumokra (a kimenet objektumonként mindkét pass-hoz készül).
+    // Az árnyék kimenet egyszer készül, az összes kaszkádot lefedő fény mátrixszal és a legfinomabb kaszkád LOD-dal;
+    // a kaszkádok indirekt rajzolásai ugyanazt használják (a példány helyük mátrixa mindenhol azonos).
+    // Render pass-on kívül kell futnia; a fény a jelenet középpontja felé néz
+    std::vector<uint8_t> culledVisible(drawObjects.size(), 0);
+    std::vector<uint32_t> meshletShadowLod(drawObjects.size(), UINT32_MAX);
+    for (uint32_t i : mainVisible) culledVisible[i] = 1;
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        for (uint32_t i : shadowVisible[c]) {
+            culledVisible[i] = 1;
+            meshletShadowLod[i] = std::min(meshletShadowLod[i], frame.shadowLods[c][i]);
+        }
+    }
+    std::vector<MeshObject*> meshletObjects;
+    std::vector<uint32_t> meshletMainLods, meshletShadowLods, meshletMainInstances, meshletShadowInstances;
+    for (size_t i = 0; i < drawObjects.size(); i++) {
+        if (!culledVisible[i] || drawObjects[i]->meshletCount == 0) continue;
+        meshletObjects.push_back(drawObjects[i]);
+        meshletMainLods.push_back(frame.mainLods[i]);
+        meshletShadowLods.push_back(meshletShadowLod[i] == UINT32_MAX ? 0 : meshletShadowLod[i]);
+        meshletMainInstances.push_back(mainInstances[i]);
+        meshletShadowInstances.push_back(shadowInstances[i]);
+    }
+    meshletCuller.recordCulling(frame.commandBuffer, currentFrame, meshletObjects, frame.time, viewProjection, frame.cameraPos,
+                                shadowCascades.getCoverMatrix(), frame.lightDirection, meshletMainLods, meshletShadowLods,
+                                meshletMainInstances, meshletShadowInstances);
+}
 
-        vkCmdPushConstants(commandBuffer, shadowPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mvp), &mvp);
+void VulkanRenderer::buildLightBatches(FrameContext& frame) {
+    const std::vector<MeshObject*>& objects = *frame.objects;
+    const float time = frame.time;
+
+    // --- ÁRNYÉK ATLASZ: az esedékes csempék árnyékvetői a fény mátrixával vágva, csempénként rendezve és csoportosítva ---
+    // Minden módban a CPU-n (GPU-vezérelt módban és statikus visszajátszásnál is), csak az esedékes csempékre; a
+    // frustumCuller a teljes jelenetre frissül, ha a culling nem azzal és nem a teljes jelenettel futott.
+    // A meshletes objektumok a kiválasztott LOD teljes index tartományával rajzolódnak (a meshlet culling a kamerára és
+    // a kaszkádokra fut).
+    bool cullerHasScene = !frame.gpuPath && !frame.replayStatic && objects.size() < BVH_CULL_THRESHOLD;
+    if (!cullerHasScene && (!frame.atlasDue.empty() || !pointShadowDraws.empty())) {
+        frustumCuller.update(objects, time);
+    }
+    atlasDraws.resize(frame.atlasDue.size());
+    if (!frame.atlasDue.empty()) {
+        size_t atlasInstanceCount = 0;
+        for (size_t k = 0; k < frame.atlasDue.size(); k++) {
+            AtlasDraw& draw = atlasDraws[k];
+            draw.light = frame.atlasDue[k];
+            frustumCuller.cull(atlasLights[draw.light].viewProjection, frame.shadowCasterCount, draw.visible);
+            atlasInstanceCount += draw.visible.size();
+        }
 
-        VkBuffer vertexBuffers[] = {obj->vertexBuffer};
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdDraw(commandBuffer, obj->vertexCount, 1, 0, 0);
+        InstanceBuffer& atlasInstances = atlasInstanceBuffers[currentFrame];
+        ensureInstanceCapacity(atlasInstances, static_cast<uint32_t>(atlasInstanceCount));
+        std::vector<uint32_t> atlasLods(objects.size(), 0);
+        std::vector<uint32_t> atlasSlots(objects.size(), 0);
+        uint32_t nextAtlasInstance = 0;
+        for (AtlasDraw& draw : atlasDraws) {
+            const Light& light = lights[draw.light];
+            const AtlasLight& atlasLight = atlasLights[draw.light];
+
+            // LOD a csempe texel sűrűségével: spotnál perspektív a fény pozíciójából, irányfénynél ortografikus
+            LodSelection selection;
+            selection.orthographic = light.type == LightType::Directional;
+            selection.viewerPosition = light.position;
+            selection.projectionScale = 1.0f / atlasLight.texelScale;
+            selection.maxPixelError = SHADOW_LOD_PIXEL_ERROR;
+            for (uint32_t i : draw.visible) {
+                atlasLods[i] = lodEnabled ? objects[i]->selectLod(selection, time) : 0;
+            }
+
+            // Mélység: spotnál a clip W (távolság a fénytől), irányfénynél a clip Z ([0, 1])
+            const glm::mat4& lightMatrix = atlasLight.viewProjection;
+            int depthRow = selection.orthographic ? 2 : 3;
+            glm::vec4 lightDepth(lightMatrix[0][depthRow], lightMatrix[1][depthRow], lightMatrix[2][depthRow], lightMatrix[3][depthRow]);
+            float maxDepth = selection.orthographic ? 1.0f : (light.range > 0.0f ? light.range : DEFAULT_SHADOW_RANGE);
+            atlasQueue.resize(draw.visible.size());
+            queueDraws(objects, draw.visible, atlasLods, 0, false, lightDepth, maxDepth, atlasQueue.getItems().data());
+            atlasQueue.sort();
+            nextAtlasInstance = buildBatches(objects, atlasQueue.getItems().data(), draw.visible.size(), atlasLods, false, time,
+                                             atlasInstances.mapped, nextAtlasInstance, draw.batches, atlasSlots);
+            frameStats.shadowVisibleObjects += static_cast<uint32_t>(draw.visible.size());
+            frameStats.shadowDrawCalls += static_cast<uint32_t>(draw.batches.size());
+        }
     }
 
-    vkCmdEndRenderPass(commandBuffer);
+    // --- PONTFÉNY ÁRNYÉKOK: a hatókörben lévő árnyékvetők fényenként egyszer, példányonként a lapok maszkjával ---
+    // A FrustumCuller a hatókört befoglaló kockával vág; a lapok szerinti culling a fényhez képesti AABB-vel: a +X lap
+    // gúlája x >= |y|, x >= |z|, és az AABB akkor lóg bele, ha mind a négy oldalsík pozitív oldalára kinyúlik. Ami a
+    // hatókör gömbjét vagy minden lapot elkerül, kimarad.
+    if (!pointShadowDraws.empty()) {
+        size_t pointInstanceCount = 0;
+        for (PointShadowDraw& draw : pointShadowDraws) {
+            frustumCuller.cull(draw.bounds, frame.shadowCasterCount, draw.visible);
+            pointInstanceCount += draw.visible.size();
+        }
 
-    // --- 2. PASS: FŐ RENDERELÉS (Kamera szemszögéből) ---
+        InstanceBuffer& pointInstances = pointInstanceBuffers[currentFrame];
+        FaceMaskBuffer& pointFaceMasks = pointFaceMaskBuffers[currentFrame];
+        ensureInstanceCapacity(pointInstances, static_cast<uint32_t>(pointInstanceCount));
+        ensureFaceMaskCapacity(pointFaceMasks, static_cast<uint32_t>(pointInstanceCount));
+        std::vector<uint32_t> pointLods(objects.size(), 0);
+        std::vector<uint32_t> pointSlots(objects.size(), 0);
+        uint32_t nextPointInstance = 0;
+        for (PointShadowDraw& draw : pointShadowDraws) {
+            const Light& light = lights[draw.light];
+            size_t kept = 0;
+            draw.faceMasks.clear();
+            for (uint32_t i : draw.visible) {
+                glm::vec3 center, extent;
+                objects[i]->getWorldBounds(time, center, extent);
+                glm::vec3 toCenter = center - light.position;
+
+                // Az AABB legközelebbi pontja a hatókörön belül van-e
+                float gapSquared = 0.0f;
+                for (int axis = 0; axis < 3; axis++) {
+                    float gap = std::max(std::abs(toCenter[axis]) - extent[axis], 0.0f);
+                    gapSquared += gap * gap;
+                }
+                if (gapSquared > draw.farPlane * draw.farPlane) continue;
+
+                // Lapok: 2 * tengely + (negatív irány ? 1 : 0), a kocka réteg sorrendje
+                uint32_t mask = 0;
+                for (int face = 0; face < static_cast<int>(CUBE_FACES); face++) {
+                    int axis = face / 2;
+                    float major = (face % 2 == 0 ? 1.0f : -1.0f) * toCenter[axis] + extent[axis];
+                    bool inside = true;
+                    for (int other = 0; other < 3 && inside; other++) {
+                        if (other == axis) continue;
+                        inside = major + extent[other] - std::abs(toCenter[other]) >= 0.0f;
+                    }
+                    if (inside) {
+                        mask |= 1u << face;
+                        frameStats.pointShadowFaces++;
+                    }
+                }
+                if (mask == 0) continue;
+                draw.visible[kept++] = i;
+                draw.faceMasks.push_back(mask);
+            }
+            draw.visible.resize(kept);
+
+            // LOD a kocka lapjainak texel sűrűségével (90 fokos perspektív vetítés a fény pozíciójából)
+            LodSelection selection;
+            selection.viewerPosition = light.position;
+            selection.projectionScale = 0.5f * static_cast<float>(POINT_SHADOW_SIZE);
+            selection.maxPixelError = SHADOW_LOD_PIXEL_ERROR;
+            for (uint32_t i : draw.visible) {
+                pointLods[i] = lodEnabled ? objects[i]->selectLod(selection, time) : 0;
+            }
+
+            // A lapoknak nincs közös mélysége: csak az állapot szerinti rendezés
+            pointQueue.resize(draw.visible.size());
+            queueDraws(objects, draw.visible, pointLods, 0, false, glm::vec4(0.0f), 1.0f, pointQueue.getItems().data());
+            pointQueue.sort();
+            nextPointInstance = buildBatches(objects, pointQueue.getItems().data(), draw.visible.size(), pointLods, false, time,
+                                             pointInstances.mapped, nextPointInstance, draw.batches, pointSlots);
+
+            // A lap maszk a példány helyére (a pontfény vertex shadere a gl_InstanceIndex szerint olvassa)
+            for (size_t k = 0; k < draw.visible.size(); k++) {
+                pointFaceMasks.mapped[pointSlots[draw.visible[k]]] = draw.faceMasks[k];
+            }
+            frameStats.pointShadowCasters += static_cast<uint32_t>(draw.visible.size());
+            frameStats.shadowDrawCalls += static_cast<uint32_t>(draw.batches.size());
+        }
+    }
+}
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = pipeline->getRenderPass();
-    renderPassInfo.framebuffer = pipeline->getFramebuffers()[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapchain->getExtent();
+/**
+ * @brief Árnyék pass darab: csak a pozíció folyam (binding 0), a példány puffer (Set 0), a frame adatok (Set 1)
+ * és a nézet indexe (push constant: kaszkád, vagy MAX_CASCADES + fény index az atlasz csempéhez). A viewport a
+ * teljes réteg vagy az atlasz csempe, a scissor ezen belül a gyorsítótár frissítendő téglalapja is lehet.
+ * A kaszkádok a GPU-vezérelt mód és a meshlet culling kimenetéből rajzolnak; az atlasz csempéi és a pontfény kockák
+ * a saját csoportjaikat a kiválasztott LOD teljes index tartományával (a kockák a multiview pipeline-nal, ott a
+ * push constant a fény indexe).
+ */
+void VulkanRenderer::recordShadowDraws(const FrameContext& frame, VkCommandBuffer secondary, uint32_t shadowView,
+                                       const std::vector<DrawBatch>& batches, VkDescriptorSet instances, size_t begin,
+                                       size_t end, RecordSlot& slot, const VkRect2D& area, const VkRect2D& scissor,
+                                       ShadowTarget target) {
+    BindCache bindings(secondary, geometryPool);
+    VkViewport viewport{};
+    viewport.x = static_cast<float>(area.offset.x);
+    viewport.y = static_cast<float>(area.offset.y);
+    viewport.width = static_cast<float>(area.extent.width);
+    viewport.height = static_cast<float>(area.extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(secondary, 0, 1, &viewport);
+    vkCmdSetScissor(secondary, 0, 1, &scissor);
+    VkDescriptorSet shadowSets[] = {instances, frame.frameSet};
+    vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipelineLayout, 0, 2, shadowSets, 0, nullptr);
+    vkCmdPushConstants(secondary, shadowPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t), &shadowView);
+    if (target == ShadowTarget::Cube) {
+        VkDescriptorSet faceMaskSet = pointFaceMaskBuffers[currentFrame].descriptorSet;
+        vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pointShadowPipelineLayout, 2, 1, &faceMaskSet, 0, nullptr);
+    }
 
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}}; // Háttérszín (fekete)
-    clearValues[1].depthStencil = {1.0f, 0};
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+    // GPU-vezérelt mód: csoportonként egy indirekt hívás, a parancsok számát a culling pass adja
+    bool culled = target == ShadowTarget::Cascade;
+    if (frame.gpuPath && culled) {
+        const std::vector<GpuCuller::Bucket>& gpuBuckets = gpuCuller.getBuckets();
+        for (size_t b = begin; b < end; b++) {
+            const GpuCuller::Bucket& bucket = gpuBuckets[b];
+            bindings.bindPipeline(bucket.vertexFormat == VertexFormat::Compact ? compactShadowPipeline : shadowPipeline);
+            bindings.bindVertexStreams(bucket.vertexFormat, false);
+            bindings.bindIndexBuffer(geometryPool->getIndexBuffer(), bucket.indexType);
+            gpuCuller.drawBucket(secondary, currentFrame, GpuCuller::ShadowPass + shadowView, static_cast<uint32_t>(b));
+        }
+        slot.bindCalls = bindings.bindCalls;
+        slot.redundantBinds = bindings.redundantBinds;
+        return;
+    }
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getGraphicsPipeline());
+    // Csak a kaszkád frustumában lévő árnyékvetők renderelése, azonos geometriánként egy instanced hívással
+    bool cube = target == ShadowTarget::Cube;
+    for (size_t i = begin; i < end; i++) {
+        const DrawBatch& batch = batches[i];
+        const MeshObject* obj = batch.mesh;
+        if (obj->vertexFormat == VertexFormat::Compact) {
+            bindings.bindPipeline(cube ? compactPointShadowPipeline : compactShadowPipeline);
+        } else {
+            bindings.bindPipeline(cube ? pointShadowPipeline : shadowPipeline);
+        }
+        bindings.bindVertexStreams(obj->vertexFormat, false);
+
+        const MeshObject::LodLevel& lod = obj->lods[batch.lod];
+        if (obj->meshletCount > 0 && culled) {
+            // Csak a fény felől látható meshletek háromszögei (a compute pass állította elő)
+            const MeshletCuller::Output& output = meshletCuller.getOutput(obj, currentFrame, MeshletCuller::ShadowPass);
+            bindings.bindIndexBuffer(output.indexBuffer, VK_INDEX_TYPE_UINT32);
+            vkCmdDrawIndexedIndirect(secondary, output.commandBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+        } else {
+            bindings.bindIndexBuffer(geometryPool->getIndexBuffer(), obj->indexType);
+            vkCmdDrawIndexed(secondary, lod.indexCount, batch.instanceCount, obj->getFirstIndex() + lod.firstIndex,
+                             obj->getVertexOffset(), batch.firstInstance);
+        }
+        slot.triangles += lod.indexCount / 3 * batch.instanceCount;
+    }
+    slot.bindCalls = bindings.bindCalls;
+    slot.redundantBinds = bindings.redundantBinds;
+}
+
+/**
+ * @brief Fő pass darab: viewport, scissor, árnyéktérkép (Set 1), példány puffer (Set 2) és frame adatok (Set 3);
+ * a két vertex formátum pipeline-ja azonos layout-ot használ, így a set-ek a pipeline csere után is megmaradnak.
+ */
+void VulkanRenderer::recordMainDraws(const FrameContext& frame, VkCommandBuffer secondary, const std::vector<DrawBatch>& batches,
+                                     VkDescriptorSet instances, size_t begin, size_t end, RecordSlot& slot) {
+    BindCache bindings(secondary, geometryPool);
+    VkPipelineLayout layout = frame.pipeline->getPipelineLayout();
 
-    // Dinamikus állapotok beállítása (Viewport, Scissor)
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = (float)swapchain->getExtent().width;
-    viewport.height = (float)swapchain->getExtent().height;
+    viewport.width = (float)frame.extent.width;
+    viewport.height = (float)frame.extent.height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetViewport(secondary, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = swapchain->getExtent();
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    scissor.extent = frame.extent;
+    vkCmdSetScissor(secondary, 0, 1, &scissor);
+
+    VkDescriptorSet mainSets[] = {shadowDescriptorSet, instances, frame.frameSet};
+    vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 3, mainSets, 0, nullptr);
+
+    if (frame.gpuPath) {
+        const std::vector<GpuCuller::Bucket>& gpuBuckets = gpuCuller.getBuckets();
+        for (size_t b = begin; b < end; b++) {
+            const GpuCuller::Bucket& bucket = gpuBuckets[b];
+            bindings.bindPipeline(frame.pipeline->getGraphicsPipeline(bucket.vertexFormat));
+            bindings.bindVertexStreams(bucket.vertexFormat, true);
+            bindings.bindIndexBuffer(geometryPool->getIndexBuffer(), bucket.indexType);
+            bindings.bindTexture(layout, bucket.texture);
+            gpuCuller.drawBucket(secondary, currentFrame, GpuCuller::MainPass, static_cast<uint32_t>(b));
+        }
+        slot.bindCalls = bindings.bindCalls;
+        slot.redundantBinds = bindings.redundantBinds;
+        return;
+    }
 
-    // Kamera mátrixok kiszámítása
-    glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 proj = glm::perspective(glm::radians(45.0f), swapchain->getExtent().width / (float)swapchain->getExtent().height, 0.1f, 100.0f);
-    proj[1][1] *= -1; // Vulkan Y-tengely korrekció
-    glm::mat4 viewProjection = proj * view;
-
-    // Árnyéktérkép bekötése Set 1-re a fragment shader számára
-    vkCmdBindDescriptorSets(
-        commandBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        pipeline->getPipelineLayout(),
-        1,
-        1,
-        &shadowDescriptorSet,
-        0, nullptr
-    );
+    // A kamera frustumában lévő objektumok kirajzolása (ezúttal a padlót is beleértve), csoportonként egy hívással
+    for (size_t i = begin; i < end; i++) {
+        const DrawBatch& batch = batches[i];
+        const MeshObject* obj = batch.mesh;
+        bindings.bindPipeline(frame.pipeline->getGraphicsPipeline(obj->vertexFormat));
+        bindings.bindVertexStreams(obj->vertexFormat, true);
+        bindings.bindTexture(layout, obj->getTexture());
+        if (obj->meshletCount > 0) {
+            const MeshletCuller::Output& culled = meshletCuller.getOutput(obj, currentFrame, MeshletCuller::MainPass);
+            bindings.bindIndexBuffer(culled.indexBuffer, VK_INDEX_TYPE_UINT32);
+            obj->draw(secondary, batch.lod, batch.firstInstance, 1, culled.commandBuffer);
+        } else {
+            bindings.bindIndexBuffer(geometryPool->getIndexBuffer(), obj->indexType);
+            obj->draw(secondary, batch.lod, batch.firstInstance, batch.instanceCount);
+        }
+    }
+    slot.bindCalls = bindings.bindCalls;
+    slot.redundantBinds = bindings.redundantBinds;
+}
 
-    // Minden objektum kirajzolása (ezúttal a padlót is beleértve)
-    for (auto obj : objects) {
-        obj->draw(commandBuffer, pipeline->getPipelineLayout(), viewProjection, time);
+/**
+ * @brief Egy secondary buffer rögzítése a fő pass-hoz vagy egy kaszkád árnyék pass-ához. A képkockánkéntiek egyszer futnak
+ * (ONE_TIME_SUBMIT), a statikusak több képkockán át visszajátszódnak; a fő pass framebuffer-e képenként más, így
+ * azoknál nincs megadva. A munkaszálakon nem dobunk kivételt (std::terminate lenne), a hibát a hívó szál jelzi.
+ */
+bool VulkanRenderer::recordSecondary(const FrameContext& frame, RecordSlot& slot, bool shadow, uint32_t cascade, bool reusable,
+                                     const std::vector<DrawBatch>& batches, VkDescriptorSet instances, size_t begin, size_t end) {
+    vkResetCommandPool(context->getDevice(), slot.commandPool, 0);
+    slot.triangles = 0;
+    slot.bindCalls = 0;
+    slot.redundantBinds = 0;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = shadow ? shadowRenderPass : frame.pipeline->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = shadow ? shadowFramebuffers[cascade]
+                                         : (reusable ? VK_NULL_HANDLE : frame.pipeline->getFramebuffers()[frame.imageIndex]);
+
+    VkCommandBufferBeginInfo secondaryBeginInfo{};
+    secondaryBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    secondaryBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    if (!reusable) secondaryBeginInfo.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    secondaryBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(slot.commandBuffer, &secondaryBeginInfo) != VK_SUCCESS) {
+        return false;
+    }
+    if (shadow) {
+        const VkRect2D shadowArea = {{0, 0}, {shadowMapWidth, shadowMapHeight}};
+        recordShadowDraws(frame, slot.commandBuffer, cascade, batches, instances, begin, end, slot, shadowArea, shadowArea,
+                          ShadowTarget::Cascade);
+    } else {
+        recordMainDraws(frame, slot.commandBuffer, batches, instances, begin, end, slot);
+    }
+    return vkEndCommandBuffer(slot.commandBuffer) == VK_SUCCESS;
+}
+
+void VulkanRenderer::recordSecondaries(FrameContext& frame) {
+    // --- PÁRHUZAMOS PARANCSRÖGZÍTÉS (secondary command buffer-ek) ---
+    // Minden pass (kaszkádonként az árnyék pass, és a fő pass) rajzolásai összefüggő darabokra oszlanak (darabonként
+    // legalább MIN_DRAWS_PER_TASK), és minden darab a saját command pool-jából a saját secondary bufferébe rögzül a
+    // munkaszálakon; az összes pass darabjai egyszerre. A secondary bufferek nem öröklik a kötéseket, ezért mindegyik
+    // maga köti a pipeline-t és a set-eket; a mátrixok a frame uniform pufferből jönnek, így a rögzítés a kamera
+    // mozgásától független (a kaszkád indexe push constant).
+    // Statikus visszajátszásnál GPU-vezérelt módban minden rajzolás a rögzítésben van, CPU módban csak a dinamikusoké nincs.
+    const bool gpuPath = frame.gpuPath;
+    const uint32_t cascadeCount = frame.cascadeCount;
+    const std::vector<GpuCuller::Bucket>& gpuBuckets = gpuCuller.getBuckets();
+    auto taskCountFor = [&](size_t drawCount) {
+        return std::min<size_t>(recordTasksPerPass, (drawCount + MIN_DRAWS_PER_TASK - 1) / MIN_DRAWS_PER_TASK);
+    };
+
+    // GPU-vezérelt módban a culling pass írja a példány mátrixokat (firstInstance = parancs index)
+    frame.instanceSet = gpuPath ? gpuCuller.getInstanceDescriptorSet(currentFrame) : instanceBuffers[currentFrame].descriptorSet;
+    frame.frameSet = frameUniforms[currentFrame].descriptorSet;
+    const VkExtent2D extent = frame.extent;
+    std::atomic<bool> recordFailed{false};
+
+    // --- STATIKUS VISSZAJÁTSZÁS: a frame slot rögzítése csak a jelenet, a mód, a pipeline, a képméret vagy a kaszkád
+    // szám változásakor. A statikus árnyékvetők minden kaszkádba bekerülnek (culling nélkül, a vágást a GPU végzi),
+    // kivéve, ha az árnyék gyorsítótárból jönnek.
+    // A slot előző használata a fence miatt már befejeződött, így a pool-ja nullázható.
+    StaticRecording* staticRecording = nullptr;
+    auto recordStart = std::chrono::high_resolution_clock::now();
+    if (staticReplay) {
+        StaticRecording& recording = staticRecordings[currentFrame];
+        uint64_t sceneVersion = gpuPath ? gpuCuller.getSceneVersion() : staticScene.version;
+        VkPipeline mainPipelineHandle = frame.pipeline->getGraphicsPipeline(VertexFormat::Full);
+        if (!recording.recorded || recording.gpuPath != gpuPath || recording.sceneVersion != sceneVersion ||
+            recording.mainPipeline != mainPipelineHandle || recording.extent.width != extent.width ||
+            recording.extent.height != extent.height || recording.cascadeCount != cascadeCount ||
+            recording.shadowCached != frame.shadowCacheActive) {
+            // GPU-vezérelt módban a csoportok indirekt hívásai a frame slot culling kimenetére hivatkoznak
+            const std::vector<DrawBatch>& staticShadowBatches = staticScene.shadowBatches;
+            const std::vector<DrawBatch>& staticMainBatches = staticScene.mainBatches;
+            VkDescriptorSet staticInstances = gpuPath ? frame.instanceSet : staticScene.instances.descriptorSet;
+            recording.shadowDraws = static_cast<uint32_t>(gpuPath ? gpuBuckets.size() : staticShadowBatches.size());
+            recording.mainDraws = static_cast<uint32_t>(gpuPath ? gpuBuckets.size() : staticMainBatches.size());
+            recording.recorded = false;
+
+            // Feladatok: [0, cascadeCount) a kaszkádok (gyorsítótárral egy sem), utolsóként a fő pass
+            uint32_t shadowTasks = frame.shadowCacheActive ? 0 : cascadeCount;
+            recordWorkers->run(shadowTasks + 1, [&](size_t task) {
+                bool shadow = task < shadowTasks;
+                uint32_t cascade = shadow ? static_cast<uint32_t>(task) : 0;
+                if (!recordSecondary(frame, shadow ? recording.shadow[cascade] : recording.main, shadow, cascade, true,
+                                     shadow ? staticShadowBatches : staticMainBatches, staticInstances, 0,
+                                     shadow ? recording.shadowDraws : recording.mainDraws)) {
+                    recordFailed = true;
+                }
+            });
+            if (recordFailed) {
+                throw std::runtime_error("failed to record static secondary command buffer!");
+            }
+            recording.recorded = true;
+            recording.gpuPath = gpuPath;
+            recording.sceneVersion = sceneVersion;
+            recording.mainPipeline = mainPipelineHandle;
+            recording.extent = extent;
+            recording.cascadeCount = cascadeCount;
+            recording.shadowCached = frame.shadowCacheActive;
+            frameStats.staticRecorded = true;
+        }
+        staticRecording = &recording;
     }
 
+    // Feladatok pass-onként összefüggő darabokban: előbb a kaszkádoké, utánuk a fő pass-éi. A pass slot blokkja a
+    // kaszkád indexe (a fő pass-é MAX_CASCADES); a slot pool-ját csak a saját feladata használja, és a frame slot
+    // előző használata a fence miatt már befejeződött, így a pool nullázható.
+    struct RecordTask {
+        uint32_t block;    // Kaszkád index, vagy MAX_CASCADES a fő pass-hoz
+        size_t chunk;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<RecordTask> recordTasks;
+    size_t passTasks[ShadowCascades::MAX_CASCADES + 1] = {};
+    for (uint32_t block = 0; block <= ShadowCascades::MAX_CASCADES; block++) {
+        bool shadow = block < ShadowCascades::MAX_CASCADES;
+        if (shadow && block >= cascadeCount) continue;
+        size_t drawCount = gpuPath ? (staticReplay ? 0 : gpuBuckets.size()) : (shadow ? shadowBatches[block].size() : mainBatches.size());
+        size_t taskCount = taskCountFor(drawCount);
+        passTasks[block] = taskCount;
+        for (size_t chunk = 0; chunk < taskCount; chunk++) {
+            recordTasks.push_back({block, chunk, drawCount * chunk / taskCount, drawCount * (chunk + 1) / taskCount});
+        }
+    }
+
+    std::vector<RecordSlot>& slots = recordSlots[currentFrame];
+    recordWorkers->run(recordTasks.size(), [&](size_t task) {
+        const RecordTask& recordTask = recordTasks[task];
+        bool shadow = recordTask.block < ShadowCascades::MAX_CASCADES;
+        RecordSlot& slot = slots[recordTask.block * recordTasksPerPass + recordTask.chunk];
+        if (!recordSecondary(frame, slot, shadow, shadow ? recordTask.block : 0, false,
+                             shadow ? shadowBatches[recordTask.block] : mainBatches, frame.instanceSet, recordTask.begin,
+                             recordTask.end)) {
+            recordFailed = true;
+        }
+    });
+    frameStats.recordMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
+    if (recordFailed) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+
+    // A statikus rögzítés minden képkockában előbb fut, a dinamikus darabok utána (a mélységteszt miatt a sorrend
+    // csak a rejtett felületek eldobását befolyásolja)
+    if (staticRecording != nullptr) {
+        uint32_t replayedCascades = staticRecording->shadowCached ? 0 : cascadeCount;
+        for (uint32_t c = 0; c < replayedCascades; c++) {
+            const RecordSlot& shadowSlot = staticRecording->shadow[c];
+            frame.shadowSecondaries[c].push_back(shadowSlot.commandBuffer);
+            frameStats.shadowTriangles += shadowSlot.triangles;
+            frameStats.bindCalls += shadowSlot.bindCalls;
+            frameStats.redundantBinds += shadowSlot.redundantBinds;
+        }
+        frame.mainSecondaries.push_back(staticRecording->main.commandBuffer);
+        frameStats.bindCalls += staticRecording->main.bindCalls;
+        frameStats.redundantBinds += staticRecording->main.redundantBinds;
+        frameStats.replayedDraws = staticRecording->shadowDraws * replayedCascades + staticRecording->mainDraws;
+        if (!gpuPath) {
+            frameStats.mainDrawCalls += staticRecording->mainDraws;
+            frameStats.shadowDrawCalls += staticRecording->shadowDraws * replayedCascades;
+        }
+    }
+    for (uint32_t block = 0; block <= ShadowCascades::MAX_CASCADES; block++) {
+        bool shadow = block < ShadowCascades::MAX_CASCADES;
+        for (size_t t = 0; t < passTasks[block]; t++) {
+            const RecordSlot& slot = slots[block * recordTasksPerPass + t];
+            (shadow ? frame.shadowSecondaries[block] : frame.mainSecondaries).push_back(slot.commandBuffer);
+            if (shadow) frameStats.shadowTriangles += slot.triangles;
+            frameStats.bindCalls += slot.bindCalls;
+            frameStats.redundantBinds += slot.redundantBinds;
+        }
+    }
+}
+
+void VulkanRenderer::recordCascadeShadowPass(FrameContext& frame) {
+    VkCommandBuffer commandBuffer = frame.commandBuffer;
+    const uint32_t cascadeCount = frame.cascadeCount;
+    const VkRect2D shadowArea = {{0, 0}, {shadowMapWidth, shadowMapHeight}};
+
+    // Árnyék gyorsítótár: a statikus árnyékvetők csak az érvénytelen rétegekbe (a kaszkád újraillesztődött, vagy a statikus
+    // jelenet újraépült) vagy területekre (statikus objektum mozgott) renderelődnek, közvetlenül a primary bufferbe.
+    // Utána az aktív rétegek az árnyéktérképbe másolódnak, amelyre a kaszkádok render pass-ai már csak a dinamikus
+    // árnyékvetőket rajzolják.
+    if (frame.shadowCacheActive) {
+        if (shadowCacheImage == VK_NULL_HANDLE) {
+            createShadowCacheResources();
+        }
+
+        VkRenderPassBeginInfo cacheRenderPassInfo{};
+        cacheRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        cacheRenderPassInfo.renderPass = shadowCacheRenderPass;
+
+        for (uint32_t c = 0; c < cascadeCount; c++) {
+            ShadowCacheLayer& layer = shadowCacheLayers[c];
+            const ShadowCascades::Cascade& cascade = shadowCascades.getCascade(c);
+            if (layer.revision != cascade.revision || layer.sceneVersion != staticScene.version) {
+                layer.revision = cascade.revision;
+                layer.sceneVersion = staticScene.version;
+                layer.viewProjection = cascade.viewProjection;
+                layer.dirty = shadowArea;
+            }
+            if (layer.dirty.extent.width == 0 || layer.dirty.extent.height == 0) continue;
+
+            // Betöltéssel indul: a téglalapon kívüli tartalom megmarad, a téglalap törlődik és újrarajzolódik
+            cacheRenderPassInfo.framebuffer = shadowCacheFramebuffers[c];
+            cacheRenderPassInfo.renderArea = layer.dirty;
+            vkCmdBeginRenderPass(commandBuffer, &cacheRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            VkClearAttachment clearAttachment{};
+            clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            clearAttachment.clearValue.depthStencil = {1.0f, 0};
+            VkClearRect clearRect{};
+            clearRect.rect = layer.dirty;
+            clearRect.baseArrayLayer = 0;
+            clearRect.layerCount = 1;
+            vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+
+            RecordSlot cacheDraws;
+            recordShadowDraws(frame, commandBuffer, c, staticScene.shadowBatches, staticScene.instances.descriptorSet, 0,
+                              staticScene.shadowBatches.size(), cacheDraws, shadowArea, layer.dirty, ShadowTarget::Cascade);
+            vkCmdEndRenderPass(commandBuffer);
+
+            frameStats.shadowCacheTexels += layer.dirty.extent.width * layer.dirty.extent.height;
+            frameStats.shadowTriangles += cacheDraws.triangles;
+            frameStats.shadowDrawCalls += static_cast<uint32_t>(staticScene.shadowBatches.size());
+            frameStats.bindCalls += cacheDraws.bindCalls;
+            frameStats.redundantBinds += cacheDraws.redundantBinds;
+            layer.dirty = {{0, 0}, {0, 0}};
+        }
+
+        // Az árnyéktérkép rétegei az előző képkocka fő pass-ának (és EVSM-nél a momentum compute pass-ának) olvasása
+        // után írhatók
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = shadowImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = cascadeCount;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        VkPipelineStageFlags readStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        if (shadowMoments.isSupported()) readStages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        vkCmdPipelineBarrier(commandBuffer, readStages, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkImageCopy copyRegion{};
+        copyRegion.srcSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 0, cascadeCount};
+        copyRegion.dstSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 0, cascadeCount};
+        copyRegion.extent = {shadowMapWidth, shadowMapHeight, 1};
+        vkCmdCopyImage(commandBuffer, shadowCacheImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       shadowImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+    }
+
+    VkRenderPassBeginInfo shadowRenderPassInfo{};
+    shadowRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    shadowRenderPassInfo.renderPass = frame.shadowCacheActive ? shadowLoadRenderPass : shadowRenderPass;
+    shadowRenderPassInfo.renderArea.offset = {0, 0};
+    shadowRenderPassInfo.renderArea.extent = {shadowMapWidth, shadowMapHeight};
+
+    VkClearValue clearValue{};
+    clearValue.depthStencil = {1.0f, 0}; // Maximális mélységre törlés (gyorsítótárral betöltés, nem használt)
+    shadowRenderPassInfo.clearValueCount = 1;
+    shadowRenderPassInfo.pClearValues = &clearValue;
+
+    // A render pass tartalma kizárólag a secondary bufferekből jön (kaszkádonként egy render pass a réteg framebuffer-ébe)
+    for (uint32_t c = 0; c < cascadeCount; c++) {
+        shadowRenderPassInfo.framebuffer = shadowFramebuffers[c];
+        vkCmdBeginRenderPass(commandBuffer, &shadowRenderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        if (!frame.shadowSecondaries[c].empty()) {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(frame.shadowSecondaries[c].size()),
+                                 frame.shadowSecondaries[c].data());
+        }
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    // EVSM: az aktív kaszkádok momentumai, elmosva és a mip lánccal (a fő pass előtt, render pass-on kívül)
+    if (frame.momentShadows) {
+        shadowMoments.record(commandBuffer, cascadeCount);
+    }
+}
+
+void VulkanRenderer::recordAtlasShadowPass(FrameContext& frame) {
+    // Árnyék atlasz: egyetlen render pass, az esedékes csempék törlése és árnyékvetői közvetlenül a primary bufferbe
+    // (csempénként viewport és scissor); a többi csempe tartalma megmarad
+    if (atlasDraws.empty()) return;
+
+    VkCommandBuffer commandBuffer = frame.commandBuffer;
+    VkRenderPassBeginInfo atlasRenderPassInfo{};
+    atlasRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    atlasRenderPassInfo.renderPass = shadowAtlasRenderPass;
+    atlasRenderPassInfo.framebuffer = shadowAtlasFramebuffer;
+    atlasRenderPassInfo.renderArea.offset = {0, 0};
+    atlasRenderPassInfo.renderArea.extent = {SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE};
+    vkCmdBeginRenderPass(commandBuffer, &atlasRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkDescriptorSet atlasInstanceSet = atlasInstanceBuffers[currentFrame].descriptorSet;
+    for (const AtlasDraw& draw : atlasDraws) {
+        const ShadowAtlas::Tile& tile = atlasLights[draw.light].tile;
+        VkRect2D tileArea = {{static_cast<int32_t>(tile.x), static_cast<int32_t>(tile.y)}, {tile.size, tile.size}};
+
+        VkClearAttachment clearAttachment{};
+        clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        clearAttachment.clearValue.depthStencil = {1.0f, 0};
+        VkClearRect clearRect{};
+        clearRect.rect = tileArea;
+        clearRect.baseArrayLayer = 0;
+        clearRect.layerCount = 1;
+        vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+        if (draw.batches.empty()) continue;
+
+        RecordSlot atlasSlot;
+        recordShadowDraws(frame, commandBuffer, ShadowCascades::MAX_CASCADES + draw.light, draw.batches, atlasInstanceSet, 0,
+                          draw.batches.size(), atlasSlot, tileArea, tileArea, ShadowTarget::AtlasTile);
+        frameStats.shadowTriangles += atlasSlot.triangles;
+        frameStats.bindCalls += atlasSlot.bindCalls;
+        frameStats.redundantBinds += atlasSlot.redundantBinds;
+    }
     vkCmdEndRenderPass(commandBuffer);
+}
+
+void VulkanRenderer::recordPointShadowPass(FrameContext& frame) {
+    // Pontfény kockák: fényenként egy multiview render pass (a hat lap egyszerre, törléssel), közvetlenül a primary bufferbe
+    VkCommandBuffer commandBuffer = frame.commandBuffer;
+    const VkRect2D pointArea = {{0, 0}, {POINT_SHADOW_SIZE, POINT_SHADOW_SIZE}};
+    VkDescriptorSet pointInstanceSet = pointInstanceBuffers[currentFrame].descriptorSet;
+    for (const PointShadowDraw& draw : pointShadowDraws) {
+        VkClearValue pointClearValue{};
+        pointClearValue.depthStencil = {1.0f, 0};
+
+        VkRenderPassBeginInfo pointRenderPassInfo{};
+        pointRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        pointRenderPassInfo.renderPass = pointShadowRenderPass;
+        pointRenderPassInfo.framebuffer = pointShadowFramebuffers[draw.cube];
+        pointRenderPassInfo.renderArea = pointArea;
+        pointRenderPassInfo.clearValueCount = 1;
+        pointRenderPassInfo.pClearValues = &pointClearValue;
+        vkCmdBeginRenderPass(commandBuffer, &pointRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        if (!draw.batches.empty()) {
+            RecordSlot pointSlot;
+            recordShadowDraws(frame, commandBuffer, draw.light, draw.batches, pointInstanceSet, 0, draw.batches.size(),
+                              pointSlot, pointArea, pointArea, ShadowTarget::Cube);
+            frameStats.shadowTriangles += pointSlot.triangles;
+            frameStats.bindCalls += pointSlot.bindCalls;
+            frameStats.redundantBinds += pointSlot.redundantBinds;
+        }
+        vkCmdEndRenderPass(commandBuffer);
+    }
+}
+
+void VulkanRenderer::recordMainPass(FrameContext& frame) {
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = frame.pipeline->getRenderPass();
+    renderPassInfo.framebuffer = frame.pipeline->getFramebuffers()[frame.imageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = frame.extent;
 
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}}; // Háttérszín (fekete)
+    clearValues[1].depthStencil = {1.0f, 0};
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(frame.commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    if (!frame.mainSecondaries.empty()) {
+        vkCmdExecuteCommands(frame.commandBuffer, static_cast<uint32_t>(frame.mainSecondaries.size()), frame.mainSecondaries.data());
+    }
+    vkCmdEndRenderPass(frame.commandBuffer);
+}
+
+void VulkanRenderer::submitFrame(FrameContext& frame, VulkanSwapchain* swapchain) {
     // Parancsrögzítés lezárása
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 
@@ -620,10 +2782,11 @@ void VulkanRenderer::drawFrame(VulkanSwapchain* swapchain, VulkanPipeline* pipel
     VkSwapchainKHR swapChains[] = {swapchain->getSwapchain()};
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
+    presentInfo.pImageIndices = &frame.imageIndex;
 
     vkQueuePresentKHR(context->getPresentQueue(), &presentInfo);
 
     // Frame index léptetése (szinkronizációhoz)
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-}
\ No newline at end of file
+    frameNumber++;
+}
@@ -9,7 +9,19 @@
 #include "VulkanSwapchain.h"
 #include "VulkanPipeline.h"
 #include "MeshObject.h"
+#include "MeshletCuller.h"
+#include "GpuCuller.h"
+#include "FrustumCuller.h"
+#include "SceneBvh.h"
+#include "GeometryPool.h"
+#include "WorkerPool.h"
+#include "RenderQueue.h"
+#include "ShadowCascades.h"
+#include "ShadowAtlas.h"
+#include "ShadowMoments.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -20,8 +32,9 @@ public:
 
     /**
      * @brief Inicializálja a renderelőt, a szinkronizációs objektumokat és az árnyékoló rendszert.
+     * @param geometryPool A közös vertex/index puffer, amelyben az összes kirajzolt mesh van.
      */
-    void create(VulkanContext* ctx, VulkanSwapchain* swapchain);
+    void create(VulkanContext* ctx, VulkanSwapchain* swapchain, GeometryPool* geometryPool);
 
     /**
      * @brief Felszabadítja a rendererhez tartozó összes GPU erőforrást.
@@ -35,12 +48,170 @@ public:
      */
     void drawFrame(VulkanSwapchain* swapchain, VulkanPipeline* pipeline, glm::vec3 cameraPos, const std::vector<MeshObject*>& objects);
 
+    // Az utolsó képkocka beküldött háromszögei (a kiválasztott LOD szintek alapján, meshlet culling előtt),
+    // a rajzolási hívások száma (instanced csoportok), a frustum culling eredménye és CPU ideje, a (párhuzamos)
+    // parancsrögzítés CPU ideje, a kiadott és a fölöslegesként kihagyott vkCmdBind* hívások száma,
+    // és a pass-ok GPU ideje (timestamp query; a legutóbb befejezett képkockáé, 0, ha nem mérhető).
+    // Statikus visszajátszásnál a rajzolások és a kötések a visszajátszott parancsokat is tartalmazzák.
+    struct FrameStats {
+        uint32_t mainTriangles = 0;
+        uint32_t shadowTriangles = 0;
+        uint32_t mainDrawCalls = 0;
+        uint32_t shadowDrawCalls = 0;
+        uint32_t objectCount = 0;
+        uint32_t mainVisibleObjects = 0;   // A kamera frustumában
+        uint32_t shadowVisibleObjects = 0; // Árnyékvetők a kaszkádok frustumában (kaszkádonként számolva)
+        float cullMs = 0.0f;
+        float sortMs = 0.0f;               // Rendezési kulcsok és radix rendezés
+        float recordMs = 0.0f;
+        uint32_t replayedDraws = 0;        // A rögzített statikus secondary bufferekből visszajátszott rajzolások
+        bool staticRecorded = false;       // A statikus parancsok ebben a képkockában újrarögzültek
+        uint32_t bindCalls = 0;
+        uint32_t redundantBinds = 0;
+        uint32_t shadowCacheTexels = 0;    // Az árnyék gyorsítótárban újrarenderelt texelek (a kaszkádok összege)
+        uint32_t atlasShadowLights = 0;    // Csempét kapott árnyékvető fények az árnyék atlaszban
+        uint32_t atlasRenderedTiles = 0;   // Ebben a képkockában újrarenderelt atlasz csempék (a többi ritkítva vár)
+        uint32_t pointShadowLights = 0;    // Kocka árnyéktérképet kapott pontfények
+        uint32_t pointShadowCasters = 0;   // Árnyékvetők a pontfények hatókörében (fényenként számolva)
+        uint32_t pointShadowFaces = 0;     // Ebből a lapok szerinti culling után rajzolt (példány, lap) párok (legfeljebb 6x)
+        float shadowPassMs = 0.0f;
+        float mainPassMs = 0.0f;
+    };
+
+    /**
+     * @brief LOD választás be/ki kapcsolása (kikapcsolva mindig a teljes részletesség rajzolódik).
+     */
+    void setLodEnabled(bool enabled) { lodEnabled = enabled; }
+    bool isLodEnabled() const { return lodEnabled; }
+    const FrameStats& getFrameStats() const { return frameStats; }
+
+    /**
+     * @brief A rajzolási sor rendezése be/ki (kikapcsolva a látható objektumok sorrendjében rajzol, összehasonlításhoz).
+     */
+    void setDrawSortingEnabled(bool enabled) { drawSorting = enabled; }
+    bool isDrawSortingEnabled() const { return drawSorting; }
+
+    /**
+     * @brief GPU-vezérelt mód be/ki kapcsolása: a culling, a LOD választás és a rajzolási parancsok a GPU-n készülnek,
+     * a CPU képkockánként csak csoportonként egy indirekt hívást rögzít. Nem támogatott eszközön a CPU út marad.
+     * Az objektumok helyének vagy forgásának közvetlen módosítása után invalidateGpuScene() hívandó.
+     */
+    void setGpuDriven(bool enabled) { gpuDriven = enabled; }
+    bool isGpuDriven() const { return gpuDriven && gpuCuller.isSupported(); }
+    bool isGpuDrivenSupported() const { return gpuCuller.isSupported(); }
+    void invalidateGpuScene() { gpuCuller.invalidate(); }
+
+    /**
+     * @brief Statikus visszajátszás be/ki: a jelenet nem animált részének rajzolásai frame slotonként egyszer rögzülnek
+     * secondary command buffer-ekbe, és utána csak visszajátszódnak; a kamera és a fény mátrixa a frame uniform
+     * pufferből jön, így a képkocka CPU költsége nem függ a statikus objektumok számától.
+     * CPU módban a statikus objektumokra nincs culling és LOD választás (a teljes részletesség rajzolódik, a vágást
+     * a GPU végzi); GPU-vezérelt módban a culling pass parancsai játszódnak vissza, így ott mindkettő megmarad.
+     * Az objektumok közvetlen módosítása után invalidateStaticScene() hívandó.
+     */
+    void setStaticReplay(bool enabled) { staticReplay = enabled; }
+    bool isStaticReplay() const { return staticReplay; }
+    void invalidateStaticScene() { staticScene.objects = nullptr; }
+
+    /**
+     * @brief Egy objektum helyének közvetlen módosítása után. GPU-vezérelt módban az objektum leírója töltődik fel újra.
+     * Statikus objektumnál (statikus visszajátszás, CPU út) a model mátrixa a statikus példány pufferben frissül, a
+     * rögzítések változatlanok maradnak, és az árnyék gyorsítótárban csak a régi és az új helyének vetülete renderelődik
+     * újra. Megvárja a GPU-t (a puffereket a futó frame-ek is olvassák).
+     * @param objectIndex Az objektum indexe a drawFrame objects tömbjében; a CPU út dinamikus objektumainál nincs teendő.
+     */
+    void invalidateStaticObject(uint32_t objectIndex);
+
+    /**
+     * @brief Árnyék gyorsítótár be/ki (statikus visszajátszásnál, CPU úton): a statikus árnyékvetők mélysége kaszkádonként
+     * egy külön képben marad, képkockánként az árnyéktérképbe másolódik, és arra csak a dinamikus árnyékvetők rajzolódnak.
+     * Egy réteg csak a kaszkád újraillesztésekor renderelődik újra teljesen (a kamera a tartalékon túl mozdult, lásd
+     * ShadowCascades::Settings::fitSlack), statikus objektum mozgatásakor csak az érintett területe.
+     */
+    void setShadowCacheEnabled(bool enabled) { shadowCacheEnabled = enabled; }
+    bool isShadowCacheEnabled() const { return shadowCacheEnabled; }
+
+    // A fény típusa: pontfény (minden irányba), spot (kúp a direction körül) vagy irányfény (párhuzamos sugarak
+    // a direction irányában, a pozíció nem számít)
+    enum class LightType : uint32_t {
+        Point = 0,
+        Spot = 1,
+        Directional = 2
+    };
+
+    // Az árnyék technikája fényenként. PCF: mélység összehasonlítás a ShadowFilter kernelével. EVSM: előszűrt
+    // exponenciális variancia momentumok (ShadowMoments), fragmentenként egyetlen szűrt minta, így a lágy félárnyék
+    // szélessége nem kerül több mintába; csak a kaszkádokat kapó fénynél (a többi árnyéktípus és a támogatás nélküli
+    // eszköz PCF-fel marad).
+    enum class ShadowTechnique : uint32_t {
+        Pcf = 0,
+        Evsm = 1
+    };
+
+    // Fényforrás a megvilágításhoz. A lista első árnyékvető fénye adja a kaszkádolt árnyéktérkép irányát (irányfényként:
+    // pontfénynél a pozíciójából a jelenet középpontja felé, a kaszkádok a kamera frustumára illeszkednek, lásd
+    // ShadowCascades); a további árnyékvető spot- és irányfények az árnyék atlaszba, a további pontfények kocka
+    // árnyéktérképekbe kerülnek.
+    static const uint32_t MAX_LIGHTS = 64;
+    struct Light {
+        glm::vec3 position;
+        glm::vec3 color;
+        bool castsShadow = false;
+        LightType type = LightType::Point;
+        glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f); // Spot és irányfény: a fény haladási iránya
+        float outerAngle = glm::radians(30.0f);             // Spot: a kúp félszöge
+        float range = 0.0f;                                 // Hatótávolság (0: nincs tompulás)
+        ShadowTechnique shadowTechnique = ShadowTechnique::Pcf;
+    };
+
+    /**
+     * @brief A jelenet fényei; a frame-enkénti fény pufferbe kerülnek, így a shader újrafordítása nélkül cserélhetők.
+     * Legfeljebb MAX_LIGHTS fény, a többi figyelmen kívül marad. Az árnyék atlasz csempéi újraosztódnak.
+     * Az első EVSM fénynél itt jön létre a momentum kép (megvárja a GPU-t, a kötése a futó frame-ek set-jében van).
+     */
+    void setLights(const std::vector<Light>& sceneLights);
+    const std::vector<Light>& getLights() const { return lights; }
+
+    /**
+     * @brief Objektum kijelölése a képernyőn: sugár a kamerából a kurzoron át, az előző drawFrame jelenet BVH-jában.
+     * @param cursorNdc A kurzor normalizált eszköz koordinátái ([-1, 1], Y lefelé nő, mint a Vulkan viewportban).
+     * @param objectIndex Kimenet: a találat indexe az utolsó drawFrame objects tömbjében.
+     * @return Hamis, ha a sugár nem talál objektumot.
+     * GPU-vezérelt módban és statikus visszajátszásnál a BVH csak itt frissül (az utolsó drawFrame jelenetére és idejére).
+     */
+    bool pickObject(glm::vec2 cursorNdc, uint32_t& objectIndex);
+
+    /**
+     * @brief A kaszkádok száma (2..ShadowCascades::MAX_CASCADES); a rétegzett árnyéktérkép mindig MAX_CASCADES rétegű,
+     * így futás közben is változtatható.
+     */
+    void setShadowCascadeCount(uint32_t count) {
+        shadowCascadeSettings.cascadeCount = std::min(std::max(count, 2u), ShadowCascades::MAX_CASCADES);
+    }
+    uint32_t getShadowCascadeCount() const { return shadowCascadeSettings.cascadeCount; }
+
+    // Az árnyék szűrő kernele; minden minta hardveres összehasonlítás (2x2 PCF), a Poisson pontok pixelenként
+    // elforgatva (a maradék zaj a sávosodás helyett). A frame uniform pufferbe kerül, így futás közben váltható.
+    enum class ShadowFilter : uint32_t {
+        Single = 0,    // Egy minta (csak a hardveres 2x2)
+        Poisson4 = 1,  // 4 elforgatott Poisson minta
+        Poisson16 = 2  // 16 Poisson minta; ha a 4 szélső minta egyezik (teljes fény / árnyék), a többi kimarad
+    };
+    void setShadowFilter(ShadowFilter filter) { shadowFilter = filter; }
+    ShadowFilter getShadowFilter() const { return shadowFilter; }
+
+    /**
+     * @brief Támogatja-e az eszköz az EVSM árnyékot (ShadowTechnique::Evsm); ha nem, a fény PCF-fel árnyékol.
+     */
+    bool isMomentShadowSupported() const { return shadowMoments.isSupported(); }
+
     // Getterek az árnyékhoz, hogy a grafikai pipeline össze tudja kapcsolni az erőforrásokat
     VkDescriptorSetLayout getShadowDescriptorSetLayout() const { return shadowDescriptorSetLayout; }
     VkDescriptorSet getShadowDescriptorSet() const { return shadowDescriptorSet; }
 
 private:
     VulkanContext* context; // Referencia a Vulkan környezetre
+    GeometryPool* geometryPool = nullptr; // Közös vertex/index puffer (pass-onként egyszer kötődik)
 
     // --- Szinkronizálás (Frame-ek kezelése) ---
     // Meghatározza, hány képkocka lehet egyszerre feldolgozás alatt a GPU-n (Double/Triple buffering)
@@ -52,27 +223,79 @@ private:
 
     std::vector<VkCommandBuffer> commandBuffers;       // Parancspufferek a GPU parancsok rögzítéséhez
 
+    // --- PÁRHUZAMOS PARANCSRÖGZÍTÉS ---
+    // A pass-ok rajzolásai darabokban, secondary command buffer-ekbe rögzülnek a munkaszálakon; a primary buffer
+    // csak végrehajtja őket. Frame-enként rögzítési feladatonként saját pool (kaszkádonként az árnyék pass darabjai,
+    // utánuk a fő pass-éi).
+    static const size_t MIN_DRAWS_PER_TASK = 64;       // Ennél kevesebb rajzolásért nem éri meg új feladatot indítani
+    struct RecordSlot {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE; // Secondary
+        uint32_t triangles = 0;                         // A darab árnyék pass háromszögei (statisztika)
+        uint32_t bindCalls = 0;
+        uint32_t redundantBinds = 0;
+    };
+    std::unique_ptr<WorkerPool> recordWorkers;
+    uint32_t recordTasksPerPass = 1;
+    std::vector<std::vector<RecordSlot>> recordSlots;  // [frame][pass * recordTasksPerPass + darab], pass: kaszkád, a fő pass MAX_CASCADES
+
     void createCommandBuffers();                       // Parancspufferek lefoglalása
+    void createRecordSlots();                          // Munkaszálak és a párhuzamos rögzítés pool-jai
+    void createRecordSlot(RecordSlot& slot, VkCommandPoolCreateFlags flags);
     void createSyncObjects(VulkanSwapchain* swapchain); // Szinkronizációs eszközök létrehozása
 
     // --- ÁRNYÉK (SHADOW MAPPING) RENDSZER ---
 
-    // Az árnyéktérkép felbontása (2048x2048)
+    // Egy kaszkád árnyéktérképének felbontása (2048x2048, rétegenként)
     const uint32_t shadowMapWidth = 2048;
     const uint32_t shadowMapHeight = 2048;
 
-    // GPU erőforrások az árnyéktérkép tárolásához
+    // Kaszkádolt árnyéktérkép: egy rétegzett mélységkép, rétegenként egy kaszkád (MAX_CASCADES réteg, az aktív
+    // kaszkádok száma futás közben változhat). A fő shader a teljes tömböt, az árnyék pass egy-egy réteget lát.
     VkImage shadowImage = VK_NULL_HANDLE;              // A nyers képobjektum
     VkDeviceMemory shadowImageMemory = VK_NULL_HANDLE; // A képhez rendelt GPU memória
-    VkImageView shadowImageView = VK_NULL_HANDLE;      // Hogyan érjük el a képet (View)
-    VkSampler shadowSampler = VK_NULL_HANDLE;          // Hogyan mintavételezzük a textúrát
+    VkImageView shadowImageView = VK_NULL_HANDLE;      // A teljes tömb (sampler2DArray a fő shaderben)
+    VkImageView shadowLayerViews[ShadowCascades::MAX_CASCADES] = {}; // Rétegenként egy nézet a framebuffer-eknek
+    VkSampler shadowSampler = VK_NULL_HANDLE;          // Összehasonlító mintavételező (hardveres PCF)
 
-    // Árnyék-specifikus Render Pass és Framebuffer
+    // Árnyék-specifikus Render Pass és kaszkádonként egy Framebuffer (a render pass kaszkádonként egyszer fut)
     VkRenderPass shadowRenderPass = VK_NULL_HANDLE;    // A mélységi adatok írásának logikája
-    VkFramebuffer shadowFramebuffer = VK_NULL_HANDLE;  // A célpuffer az árnyék-rendereléshez
+    VkRenderPass shadowLoadRenderPass = VK_NULL_HANDLE; // Gyorsítótárral: a bemásolt statikus mélység betöltése törlés helyett
+    VkFramebuffer shadowFramebuffers[ShadowCascades::MAX_CASCADES] = {};
+
+    // A kaszkádok felosztása és fény mátrixai (képkockánként a kamerához illesztve)
+    ShadowCascades shadowCascades;
+    ShadowCascades::Settings shadowCascadeSettings;
+    ShadowFilter shadowFilter = ShadowFilter::Poisson4;
+
+    // EVSM: a kaszkádok momentumai csökkentett felbontáson, elmosva, mip lánccal (a shader Set 1 Binding 3); a kép
+    // az első EVSM fénnyel jön létre, addig a kötés a mélység tömbre mutat (a shader nem olvassa)
+    ShadowMoments shadowMoments;
+
+    // --- ÁRNYÉK GYORSÍTÓTÁR ---
+    // A statikus árnyékvetők mélysége kaszkádonként egy külön rétegzett képben (első használatkor jön létre), amely a
+    // render pass után másolás forrása marad. Rétegenként a kaszkád illesztése és a statikus jelenet változata, amelyre
+    // készült, és az újrarenderelendő téglalap (üres, ha a szélessége 0). A kaszkádok tartalékkal illeszkednek, így a
+    // kamera kis mozgásai nem érvénytelenítik a réteget (az ára a nagyobb texel méret).
+    static constexpr float SHADOW_CACHE_FIT_SLACK = 0.25f;
+    struct ShadowCacheLayer {
+        uint64_t revision = 0;                     // ShadowCascades::Cascade::revision (0: még nem renderelt)
+        uint64_t sceneVersion = 0;                 // StaticScene::version
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        VkRect2D dirty = {{0, 0}, {0, 0}};
+    };
+    bool shadowCacheEnabled = false;
+    VkImage shadowCacheImage = VK_NULL_HANDLE;
+    VkDeviceMemory shadowCacheImageMemory = VK_NULL_HANDLE;
+    VkImageView shadowCacheLayerViews[ShadowCascades::MAX_CASCADES] = {};
+    VkFramebuffer shadowCacheFramebuffers[ShadowCascades::MAX_CASCADES] = {};
+    VkRenderPass shadowCacheRenderPass = VK_NULL_HANDLE; // Betöltés, a végén másolás forrás layout
+    ShadowCacheLayer shadowCacheLayers[ShadowCascades::MAX_CASCADES];
 
-    // Pipeline az árnyék generáláshoz (csak mélységi adatokat dolgoz fel)
-    VkPipeline shadowPipeline = VK_NULL_HANDLE;
+    // Pipeline az árnyék generáláshoz (csak mélységi adatokat dolgoz fel, csak a pozíció folyamot olvassa);
+    // a kaszkád indexe push constant, így ugyanaz a pipeline minden réteghez
+    VkPipeline shadowPipeline = VK_NULL_HANDLE;         // Full vertex formátumhoz
+    VkPipeline compactShadowPipeline = VK_NULL_HANDLE;  // Compact (kvantált) vertex formátumhoz
     VkPipelineLayout shadowPipelineLayout = VK_NULL_HANDLE;
 
     // Descriptor Set: Az árnyéktérkép textúraként való elérése a fő shaderben
@@ -80,16 +303,435 @@ private:
     VkDescriptorPool shadowDescriptorPool = VK_NULL_HANDLE;
     VkDescriptorSet shadowDescriptorSet = VK_NULL_HANDLE;
 
+    // --- GPU IDŐMÉRÉS ---
+    // Frame-enként 4 timestamp: az árnyék pass (az első kaszkád elejétől az utolsó végéig) és a fő pass eleje és vége
+    static const uint32_t TIMESTAMPS_PER_FRAME = 4;
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;   // VK_NULL_HANDLE, ha a grafikai sor nem támogatja
+    double timestampPeriod = 0.0;                      // Nanoszekundum / tick
+    uint64_t timestampMask = 0;                        // A timestamp érvényes bitjei
+    std::vector<bool> timestampsWritten;               // A frame slot tartalmaz-e már mérést
+    float lastShadowPassMs = 0.0f;
+    float lastMainPassMs = 0.0f;
+
+    // --- FRUSTUM CULLING ---
+    // Objektum szinten, a rajzolási parancsok rögzítése előtt: csak a túlélők jutnak el a draw hívásig.
+    // Kis jelenetnél a lapos SIMD teszt, BVH_CULL_THRESHOLD objektumtól a jelenet BVH lekérdezése a gyorsabb.
+    static const size_t BVH_CULL_THRESHOLD = 4096;
+    FrustumCuller frustumCuller;
+    SceneBvh sceneBvh;                     // A BVH-s cullinghoz képkockánként refit, egyébként csak a kijelöléskor
+    glm::mat4 lastViewProjection = glm::mat4(1.0f); // A kijelöléshez (az utolsó drawFrame kamerája)
+    glm::vec3 lastCameraPos = glm::vec3(0.0f);
+    const std::vector<MeshObject*>* lastObjects = nullptr; // A BVH késleltetett frissítéséhez (lásd pickObject)
+    float lastAnimationTime = 0.0f;
+    bool sceneBvhStale = false;
+    std::vector<uint32_t> mainVisible;   // A kamera által látott objektumok indexei
+    std::vector<uint32_t> shadowVisible[ShadowCascades::MAX_CASCADES]; // Kaszkádonként a látott árnyékvetők indexei
+
+    // --- INSTANCING ---
+    // Frame-enként egy host-visible, tartósan leképezett storage buffer a látható objektumok model mátrixaival
+    // (előbb a fő pass, utána kaszkádonként az árnyék pass példányai). Az azonos geometriájú (és a fő pass-ban azonos textúrájú)
+    // objektumok egyetlen instanced rajzolásba kerülnek, a shader a gl_InstanceIndex alapján olvas.
+    static const uint32_t INITIAL_INSTANCE_CAPACITY = 16384;
+    struct InstanceBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        glm::mat4* mapped = nullptr;
+        uint32_t capacity = 0;                           // Mátrixok száma
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;  // Fő pass: Set 2, árnyék pass: Set 0
+    };
+    std::vector<InstanceBuffer> instanceBuffers;
+    VkDescriptorSetLayout instanceDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool instanceDescriptorPool = VK_NULL_HANDLE;
+
+    // Egy instanced rajzolás: ugyanaz a mesh terület és LOD szint (a fő pass-ban a textúra is),
+    // a példányok mátrixai a pufferben egymás után [firstInstance, firstInstance + instanceCount)
+    struct DrawBatch {
+        const MeshObject* mesh;
+        uint32_t lod;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+    std::vector<DrawBatch> mainBatches;
+    std::vector<DrawBatch> shadowBatches[ShadowCascades::MAX_CASCADES];
+
+    // --- FRAME ADATOK ---
+    // Frame-enként egy host-visible uniform puffer a kamera és a kaszkádok mátrixaival és a kamera pozíciójával (Binding 0),
+    // és egy storage buffer a fénylistával (Binding 1; fő pass: Set 3, árnyék pass: Set 1), a drawFrame egyszer írja.
+    // A rögzített parancsok csak a set-re hivatkoznak, így az adatok a rögzítés után is szabadon frissíthetők.
+    // Elrendezés: std140 / std430 (lásd shader.vert / .frag, shadow_shader.vert).
+    struct GpuLight {
+        glm::vec4 position;                        // xyz: pozíció, w: hatótávolság (0: nincs tompulás)
+        glm::vec4 direction;                       // xyz: irány (spot, irányfény), w: a spot kúp félszögének koszinusza
+        glm::vec4 color;                           // rgb: szín és intenzitás, w: LightType
+        glm::mat4 shadowMatrix;                    // Atlasz árnyék: a csempe legutóbbi renderelésének View * Projection mátrixa
+        glm::vec4 atlasRect;                       // A csempe az atlaszban uv-ben (xy: eltolás, zw: méret); kocka árnyék: x a kocka indexe
+        uint32_t shadowMode;                       // 0: nincs árnyék, 1: kaszkádok, 2: atlasz csempe, 3: kocka árnyéktérkép, 4: kaszkádok EVSM-mel
+        float shadowTexelScale;                    // Egy texel világ mérete (spot, kocka: egységnyi távolságban), normál irányú eltoláshoz
+        float shadowNear;                          // Kocka árnyék: a lapok közeli és távoli síkja (a mélység a fő tengely
+        float shadowFar;                           // menti távolságból számolható)
+    };
+    static_assert(sizeof(GpuLight) == 144, "GpuLight must match the std430 struct in the shaders");
+    struct FrameData {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::mat4 viewProjection;
+        glm::mat4 cascadeMatrices[ShadowCascades::MAX_CASCADES]; // Kaszkádonként a fény View * Projection mátrixa
+        glm::vec4 cascadeSplits;                   // Kaszkádonként a szelet távoli határa (nézeti mélység)
+        glm::vec4 cascadeTexelSizes;               // Kaszkádonként egy árnyék texel világ egységben (normál eltolás)
+        glm::vec4 cameraPosition;                  // xyz
+        uint32_t lightCount;
+        uint32_t cascadeCount;
+        uint32_t shadowFilter;                     // ShadowFilter
+        uint32_t padding;
+    };
+    static_assert(sizeof(FrameData) == (3 + ShadowCascades::MAX_CASCADES) * sizeof(glm::mat4) + 64,
+                  "FrameData must match the std140 block in the shaders");
+    struct FrameUniforms {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        FrameData* mapped = nullptr;
+        VkBuffer lightBuffer = VK_NULL_HANDLE;     // MAX_LIGHTS GpuLight
+        VkDeviceMemory lightMemory = VK_NULL_HANDLE;
+        GpuLight* lights = nullptr;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+    std::vector<FrameUniforms> frameUniforms;
+    VkDescriptorSetLayout frameDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool frameDescriptorPool = VK_NULL_HANDLE;
+
+    // --- STATIKUS VISSZAJÁTSZÁS ---
+    // A nem animált, meshlet nélküli objektumok instanced csoportjai és model mátrixai egyszer készülnek el (LOD 0,
+    // culling nélkül, az árnyék csoportok minden kaszkádban); a dinamikus objektumok a szokásos képkockánkénti úton mennek. Változáskor újraépül
+    // (más tömb, más elemszám, újraépült geometria puffer, rendezés ki/be), ilyenkor megvárja a GPU-t.
+    struct StaticScene {
+        const MeshObject* const* objects = nullptr;
+        size_t objectCount = 0;
+        size_t casterCount = 0;
+        bool sorted = true;
+        VkBuffer sourceIndexBuffer = VK_NULL_HANDLE;
+        VkBuffer sourcePositionBuffers[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+        uint64_t version = 0;                      // Minden újraépítéskor nő (a rögzítések ehhez igazodnak)
+        std::vector<uint32_t> dynamicObjects;      // A dinamikus objektumok indexei, előbb az árnyékvetők
+        size_t dynamicCasterCount = 0;
+        std::vector<DrawBatch> mainBatches;
+        std::vector<DrawBatch> shadowBatches;
+        std::vector<uint32_t> mainSlots;           // Objektumonként a példány helye a fő pass csoportjaiban (UINT32_MAX: dinamikus)
+        std::vector<uint32_t> shadowSlots;         // Objektumonként a példány helye az árnyék csoportokban (UINT32_MAX: nincs)
+        std::vector<glm::vec3> casterCenters;      // A statikus árnyékvetők világbeli AABB-je (az árnyék gyorsítótár
+        std::vector<glm::vec3> casterExtents;      // érvénytelenítéséhez a mozgatás előtti helyen)
+        uint32_t staticObjectCount = 0;
+        uint32_t staticCasterCount = 0;
+        uint32_t mainTriangles = 0;
+        InstanceBuffer instances;                  // A GPU csak olvassa, a frame slotok közösen használják
+    };
+    StaticScene staticScene;
+    bool staticReplay = false;
+
+    // Frame slotonként a kaszkádok és a fő pass statikus secondary buffere; a rögzítés állapotától eltérő jelenet, mód,
+    // pipeline, képméret vagy kaszkád szám esetén újrarögzül (a frame slot előző használata a fence miatt már befejeződött)
+    struct StaticRecording {
+        RecordSlot shadow[ShadowCascades::MAX_CASCADES];
+        RecordSlot main;
+        bool recorded = false;
+        bool gpuPath = false;
+        bool shadowCached = false;                 // A statikus árnyékvetők a gyorsítótárban vannak, a kaszkádok nincsenek rögzítve
+        uint32_t cascadeCount = 0;
+        uint64_t sceneVersion = 0;
+        VkPipeline mainPipeline = VK_NULL_HANDLE;
+        VkExtent2D extent = {0, 0};
+        uint32_t shadowDraws = 0;                  // Kaszkádonként
+        uint32_t mainDraws = 0;
+    };
+    std::vector<StaticRecording> staticRecordings;
+
+    // --- ÁRNYÉK ATLASZ ---
+    // A további árnyékvető spot- és irányfények egy közös mélységképben, fényenként egy csempével (ShadowAtlas). A csempe
+    // mérete a fény képernyőn vetített méretétől függ (a hatótávolság gömbje; irányfénynél mindig a legnagyobb), és csak
+    // jelentős változáskor foglalódik újra; a kamera frustumán kívüli fény csempéje felszabadul. A kis (távoli) csempék
+    // csak minden 2. / 4. képkockában renderelődnek újra, közben a shader a legutóbbi renderelés mátrixával olvassa őket.
+    // Egyetlen render pass, csempénként viewport, scissor és törlés.
+    static const uint32_t SHADOW_ATLAS_SIZE = 4096;
+    static const uint32_t SHADOW_ATLAS_MIN_TILE = 128;
+    static const uint32_t SHADOW_ATLAS_MAX_TILE = 1024;
+    static constexpr float SHADOW_ATLAS_TEXELS_PER_PIXEL = 1.0f; // A csempe felbontása a fény vetített méretéhez képest
+    static constexpr float DEFAULT_SHADOW_RANGE = 100.0f;        // Hatótávolság nélküli spot- és pontfény árnyékának távoli síkja
+    struct AtlasLight {
+        bool allocated = false;
+        ShadowAtlas::Tile tile;
+        bool rendered = false;                      // A csempe tartalma a jelenlegi foglalásé
+        glm::mat4 viewProjection = glm::mat4(1.0f); // A legutóbbi renderelés mátrixa (ezzel olvas a shader)
+        float texelScale = 0.0f;                    // Spot: egy texel világ mérete egységnyi távolságban, irányfény: egy texel világ mérete
+    };
+    // Egy esedékes csempe a képkockában: a fény frustumában lévő árnyékvetők és instanced csoportjaik
+    struct AtlasDraw {
+        uint32_t light;
+        std::vector<uint32_t> visible;
+        std::vector<DrawBatch> batches;
+    };
+    ShadowAtlas shadowAtlas;
+    std::vector<AtlasLight> atlasLights;            // A lights tömb indexei szerint
+    bool atlasLightsReset = true;
+    std::vector<AtlasDraw> atlasDraws;
+    RenderQueue atlasQueue;
+    std::vector<InstanceBuffer> atlasInstanceBuffers; // Frame-enként, az atlasz csempék példányai
+    uint64_t frameNumber = 0;                       // A ritkított újrarenderelés ütemezéséhez
+    VkImage shadowAtlasImage = VK_NULL_HANDLE;
+    VkDeviceMemory shadowAtlasImageMemory = VK_NULL_HANDLE;
+    VkImageView shadowAtlasImageView = VK_NULL_HANDLE;
+    VkFramebuffer shadowAtlasFramebuffer = VK_NULL_HANDLE;
+    VkRenderPass shadowAtlasRenderPass = VK_NULL_HANDLE; // Betöltés, olvasható layout-ból olvasható layout-ba
+
+    // --- PONTFÉNY ÁRNYÉKOK (kocka árnyéktérképek) ---
+    // Árnyékvető pontfényenként egy kocka (6 réteg) egy kocka tömbben. A hat lap egyetlen multiview render pass-ban
+    // készül (VK_KHR_multiview, nézet maszk 0x3F): a CPU fényenként egyszer küldi a hatókörében lévő árnyékvetőket, a
+    // vertex shader a gl_ViewIndex szerinti lapra vetít. Lapok szerinti culling: példányonként egy 6 bites lap maszk (az
+    // AABB mely lapok gúlájába lóg bele), a maszkon kívüli lapokon a vertex shader a clip téren kívülre teszi a csúcsot.
+    // A maszk egy külön, a példány pufferrel párhuzamos pufferben (Set 2) utazik (lásd FaceMaskBuffer).
+    // Multiview vagy kocka tömb nélkül a pontfények árnyék nélkül maradnak; a kaszkádokat kapó fény ezekből kimarad.
+    static const uint32_t POINT_SHADOW_SIZE = 512;
+    static const uint32_t MAX_POINT_SHADOWS = 8;
+    static const uint32_t CUBE_FACES = 6;
+    struct PointShadowDraw {
+        uint32_t light;
+        uint32_t cube;                              // A kocka indexe a tömbben
+        float nearPlane;                            // A lapok közeli és távoli síkja (a távoli a hatótávolság)
+        float farPlane;
+        glm::mat4 bounds;                           // A hatókört befoglaló kocka vetítése a FrustumCuller-nek
+        std::vector<uint32_t> visible;
+        std::vector<uint32_t> faceMasks;            // visible-lel párhuzamosan
+        std::vector<DrawBatch> batches;
+    };
+    std::vector<PointShadowDraw> pointShadowDraws;
+    std::vector<uint32_t> pointShadowCubes;         // A lights tömb indexei szerint a kocka indexe (UINT32_MAX: nincs)
+    std::vector<InstanceBuffer> pointInstanceBuffers; // Frame-enként, a pontfény pass példányai
+
+    // Frame-enként a pontfény pass példányainak lap maszkja (6 bit: mely lapok gúlájába lóg bele az árnyékvető), a
+    // példány pufferrel azonos indexeléssel (Set 2, a példány pufferével azonos layout-tal)
+    struct FaceMaskBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint32_t* mapped = nullptr;
+        uint32_t capacity = 0;                           // Maszkok száma
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+    std::vector<FaceMaskBuffer> pointFaceMaskBuffers;
+    VkPipelineLayout pointShadowPipelineLayout = VK_NULL_HANDLE; // Az árnyék pass layout-ja és a lap maszkok (Set 2)
+    RenderQueue pointQueue;
+    VkImage pointShadowImage = VK_NULL_HANDLE;
+    VkDeviceMemory pointShadowImageMemory = VK_NULL_HANDLE;
+    VkImageView pointShadowCubeView = VK_NULL_HANDLE;  // A teljes kocka tömb (a fő shader olvassa)
+    VkImageView pointShadowFaceViews[MAX_POINT_SHADOWS] = {}; // Kockánként a 6 réteg (a multiview render pass célja)
+    VkFramebuffer pointShadowFramebuffers[MAX_POINT_SHADOWS] = {};
+    VkRenderPass pointShadowRenderPass = VK_NULL_HANDLE;  // Multiview, törléssel
+    VkPipeline pointShadowPipeline = VK_NULL_HANDLE;      // Vertex formátumonként (csak multiview támogatással)
+    VkPipeline compactPointShadowPipeline = VK_NULL_HANDLE;
+
+    // --- RENDEZÉSI SOR ---
+    // Képkockánként a fő pass és a kaszkádok látható objektumai 64 bites kulccsal, radix rendezve (lásd RenderQueue.h);
+    // a csoportosítás és a rögzítés ebben a sorrendben halad, a kötés állapot követése kihagyja az ismétlődő kötéseket
+    RenderQueue renderQueue;
+    bool drawSorting = true;
+
+    // --- MESHLET CULLING ---
+    // Compute pass a frame elején: a meshletes objektumok látható háromszögeit gyűjti ki mindkét pass-hoz
+    // (az árnyék pass-hoz egyszer, az összes kaszkádot lefedő fény mátrixszal)
+    MeshletCuller meshletCuller;
+
+    // --- GPU-VEZÉRELT MÓD ---
+    // Az objektum lista storage bufferekben; a compute culling írja a fő pass és a kaszkádok parancsait és példány mátrixait
+    GpuCuller gpuCuller;
+    bool gpuDriven = false;
+
+    // --- LOD (Level of Detail) ---
+    // Megengedett vetített hiba pixelben; az árnyéktérképen a durvább szint is elfogadható (kaszkádonként a saját
+    // texel sűrűségével, így a távoli kaszkádokba durvább szintek kerülnek)
+    static constexpr float MAIN_LOD_PIXEL_ERROR = 1.0f;
+    static constexpr float SHADOW_LOD_PIXEL_ERROR = 4.0f;
+    bool lodEnabled = true;
+    FrameStats frameStats;
+
+    // A jelenet fényei: meleg, árnyékot vető "nap" és egy hideg kék töltőfény árnyék nélkül
+    std::vector<Light> lights = {
+        {glm::vec3(5.0f, 5.0f, 5.0f), glm::vec3(1.5f, 1.2f, 0.8f), true},
+        {glm::vec3(-5.0f, 3.0f, -5.0f), glm::vec3(0.3f, 0.6f, 1.5f), false},
+    };
+
     // --- Segédfüggvények az inicializáláshoz ---
-    void createShadowResources();      // Kép és Sampler létrehozása
-    void createShadowRenderPass();     // Render Pass definíció a mélységíráshoz
-    void createShadowFramebuffer();    // Framebuffer összeállítása
+    void createShadowResources();      // Rétegzett kép, nézetek és Sampler létrehozása
+    void createShadowRenderPass();     // Render Pass-ok a mélységíráshoz (törléssel, betöltéssel, a gyorsítótárhoz)
+    void createShadowCacheResources(); // Az árnyék gyorsítótár rétegzett képe, nézetei és Framebuffer-ei
+    void createShadowAtlasResources(); // Az árnyék atlasz képe, nézete, Framebuffer-e és a csempe foglaló
+    void createPointShadowResources(); // A pontfények kocka tömbje, nézetei és multiview Framebuffer-ei
+    void createShadowFramebuffers();   // Kaszkádonként egy Framebuffer összeállítása
     void createShadowPipeline();       // Speciális pipeline (csak vertex shader)
-    void createShadowDescriptorSet();  // Az árnyéktérkép regisztrálása a shaderek felé
+    void createShadowDescriptorSet();  // Az árnyéktérkép és az atlasz regisztrálása a shaderek felé
+    void writeMomentShadowDescriptor(); // Az EVSM kötés (Binding 3) írása: a momentum kép, amint létezik
+    void createTimestampQueries();     // Query pool a pass-ok GPU idejének méréséhez
+    void createInstanceResources();    // Példány pufferek és descriptor set-jeik frame-enként (az atlasznak és a pontfényeknek is) és a statikus jelenethez
+    void createFrameResources();       // Frame uniform és fény pufferek és descriptor set-jeik
+
+    /**
+     * @brief Egyetlen mélység csatolós render pass (az árnyék pass változatai csak a betöltésben, a layout-okban és a
+     * függőségekben térnek el, így kompatibilisek: ugyanaz a pipeline és secondary buffer mindegyikkel használható).
+     * @param viewMask Nem nulla: multiview render pass, a maszk bitjei szerinti rétegekbe egyszerre rajzol (ez már nem
+     * kompatibilis a többivel, saját pipeline kell hozzá).
+     */
+    VkRenderPass createDepthRenderPass(VkAttachmentLoadOp loadOp, VkImageLayout initialLayout, VkImageLayout finalLayout,
+                                       const VkSubpassDependency& before, const VkSubpassDependency& after, uint32_t viewMask = 0);
+
+    /**
+     * @brief Egy világbeli AABB vetületének hozzáadása az árnyék gyorsítótár rétegeinek újrarenderelendő téglalapjához
+     * (a réteg készítésekor használt fény mátrixszal, egy texel ráhagyással).
+     */
+    void markShadowCacheDirty(const glm::vec3& center, const glm::vec3& extent);
+
+    /**
+     * @brief Az árnyék atlasz csempéinek kiosztása fontosság szerint, az esedékes csempék kiválasztása és mátrixaik.
+     * @param cascadeLight A kaszkádokat kapó fény indexe (UINT32_MAX, ha nincs); az nem kerül az atlaszba.
+     * @param cameraPlanes A kamera frustum síkjai (a láthatatlan fények csempéje felszabadul).
+     * @param projectionScale A kamera pixel / egység aránya egységnyi távolságban.
+     * @return Az ebben a képkockában renderelendő fények indexei.
+     */
+    std::vector<uint32_t> updateShadowAtlas(uint32_t lightCount, uint32_t cascadeLight, const glm::mat4& view,
+                                            const glm::vec3& cameraPos, const glm::vec4 cameraPlanes[6], float projectionScale);
+
+    /**
+     * @brief A kocka árnyéktérképek kiosztása: a kamera frustumát érintő árnyékvető pontfények közül a fontosabbak
+     * (a hatókör vetített mérete szerint) kapnak kockát, legfeljebb MAX_POINT_SHADOWS.
+     * @return A pontfény pass-ok a fény és a kocka indexével, a lapok síkjaival és a culling mátrixszal (az árnyékvetők
+     * és csoportjaik a culling után töltődnek ki).
+     */
+    std::vector<PointShadowDraw> updatePointShadows(uint32_t lightCount, uint32_t cascadeLight, const glm::vec3& cameraPos,
+                                                    const glm::vec4 cameraPlanes[6], float projectionScale);
 
     /**
-     * @brief Kiszámítja a fényforrás szemszögéből használt nézeti és vetítési mátrixot.
-     * @param lightPos A fényforrás pozíciója a világban.
+     * @brief A példány puffer növelése (duplázással), ha count mátrix nem fér bele.
+     * A puffert használó frame-ek már befejeződtek (fence, illetve a statikus jelenetnél vkDeviceWaitIdle),
+     * így a puffer és a descriptor set szabadon cserélhető.
      */
-    glm::mat4 getLightSpaceMatrix(glm::vec3 lightPos);
+    void ensureInstanceCapacity(InstanceBuffer& instances, uint32_t count);
+    void ensureFaceMaskCapacity(FaceMaskBuffer& faceMasks, uint32_t count);
+
+    /**
+     * @brief Host-visible, tartósan leképezett storage buffer és a kötése a set 0. binding-jába (a példány és a lap maszk
+     * pufferek közös része).
+     */
+    void createMappedStorageBuffer(VkDeviceSize size, VkDescriptorSet descriptorSet, VkBuffer& buffer,
+                                   VkDeviceMemory& memory, void*& mapped);
+
+    /**
+     * @brief A statikus jelenet ellenőrzése (O(1)) és változás esetén újraépítése: a dinamikus objektumok listája,
+     * a statikus objektumok rendezett csoportjai és model mátrixai.
+     */
+    void updateStaticScene(const std::vector<MeshObject*>& objects, size_t shadowCasterCount);
+
+    /**
+     * @brief Egy pass látható objektumainak rendezési kulcsai (pass, pipeline állapot, textúra, geometria és LOD, mélység).
+     * @param visible A pass-ban látható objektumok indexei.
+     * @param lods Objektumonként a pass LOD szintje.
+     * @param byTexture Igaz: a textúra is része a kulcsnak (fő pass); az árnyék pass-nak nem kell.
+     * @param depthPlane A vetítés mélység sora: dot(depthPlane, (pozíció, 1)) a mélység.
+     * @param maxDepth A mélység tartomány felső határa a kvantáláshoz.
+     * @param items Kimenet: visible.size() elem.
+     */
+    void queueDraws(const std::vector<MeshObject*>& objects, const std::vector<uint32_t>& visible,
+                    const std::vector<uint32_t>& lods, uint32_t pass, bool byTexture, const glm::vec4& depthPlane,
+                    float maxDepth, RenderQueue::Item* items) const;
+
+    /**
+     * @brief A rendezett sor egy pass-nyi szakaszának csoportosítása instanced rajzolásokba és a model mátrixok kiírása.
+     * Az egymás melletti, azonos geometriájú, LOD szintű (és a fő pass-ban azonos textúrájú) elemek egy rajzolásba kerülnek;
+     * a meshletes objektumok saját culling kimenetük miatt külön rajzolódnak.
+     * @param items A pass rendezett elemei.
+     * @param lods Objektumonként a pass LOD szintje.
+     * @param byTexture Igaz: a textúra is része a csoport feltételének (fő pass).
+     * @param instanceData A cél példány puffer leképezett memóriája.
+     * @param firstInstance Az első szabad hely a példány pufferben.
+     * @param instanceSlots Kimenet: objektumonként a példány helye (a meshlet culling indirekt parancsához).
+     * @return A következő szabad hely a példány pufferben.
+     */
+    uint32_t buildBatches(const std::vector<MeshObject*>& objects, const RenderQueue::Item* items, size_t count,
+                          const std::vector<uint32_t>& lods, bool byTexture, float animationTime, glm::mat4* instanceData,
+                          uint32_t firstInstance, std::vector<DrawBatch>& batches, std::vector<uint32_t>& instanceSlots);
+
+    /**
+     * @brief Az adott frame slot előző (a fence alapján már befejezett) méréseinek kiolvasása.
+     */
+    void readTimestamps(uint32_t frame);
+
+    // --- KÉPKOCKA LÉPÉSEI ---
+    // A drawFrame pass-onként külön metódusokra bomlik; a képkockánként számolt állapotot a FrameContext viszi egyik
+    // lépésből a másikba (a renderer tagjai csak a képkockákon átívelő állapotot tartják).
+    enum class ShadowTarget { Cascade, AtlasTile, Cube };
+    struct FrameContext {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE; // A frame slot primary buffere
+        uint32_t imageIndex = 0;
+        VkExtent2D extent = {0, 0};
+        VulkanPipeline* pipeline = nullptr;
+        const std::vector<MeshObject*>* objects = nullptr;
+        glm::vec3 cameraPos = glm::vec3(0.0f);
+        float time = 0.0f;                           // Animációs idő
+        bool gpuPath = false;                        // GPU-vezérelt mód
+        bool replayStatic = false;                   // Statikus visszajátszás a CPU úton
+        bool shadowCacheActive = false;
+        bool momentShadows = false;                  // EVSM a kaszkádok fényénél
+
+        // Kamera, kaszkádok és fények
+        glm::mat4 view = glm::mat4(1.0f);
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        uint32_t lightCount = 0;
+        uint32_t cascadeLight = UINT32_MAX;          // A kaszkádokat kapó fény (UINT32_MAX: nincs)
+        glm::vec3 lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+        uint32_t cascadeCount = 0;
+        LodSelection mainSelection;
+        LodSelection shadowSelections[ShadowCascades::MAX_CASCADES];
+        size_t shadowCasterCount = 0;                // A padló (utolsó objektum) nem vet árnyékot
+        std::vector<uint32_t> atlasDue;              // Az ebben a képkockában renderelendő atlasz csempék fényei
+
+        // CPU út: a feldolgozott objektumok (statikus visszajátszásnál csak a dinamikusak) és pass-onként a LOD szintjük
+        std::vector<MeshObject*> dynamicObjects;
+        const std::vector<MeshObject*>* drawObjects = nullptr;
+        size_t drawCasterCount = 0;
+        std::vector<uint32_t> mainLods;
+        std::vector<std::vector<uint32_t>> shadowLods;
+
+        // Rögzítés: a pass-ok közös set-jei és a render pass-okban végrehajtandó secondary bufferek
+        VkDescriptorSet instanceSet = VK_NULL_HANDLE;
+        VkDescriptorSet frameSet = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> shadowSecondaries[ShadowCascades::MAX_CASCADES];
+        std::vector<VkCommandBuffer> mainSecondaries;
+    };
+
+    // Fence, kép kérése és a primary buffer indítása; false, ha a swapchain elavult (a képkocka kimarad)
+    bool beginFrame(FrameContext& frame, VulkanSwapchain* swapchain);
+    // Kamera, kaszkádok, frame uniform puffer, LOD választás paraméterei és a statisztika nullázása
+    void updateFrameData(FrameContext& frame);
+    // Atlasz csempék és pontfény kockák kiosztása, a fénylista a frame pufferbe
+    void updateLights(FrameContext& frame);
+    // Frustum culling és LOD választás (CPU út), vagy a GPU-vezérelt culling pass rögzítése
+    void cullScene(FrameContext& frame);
+    // CPU út: rendezési sor, instanced csoportok és a meshlet culling pass
+    void buildDrawBatches(FrameContext& frame);
+    // Az esedékes atlasz csempék és a pontfény kockák árnyékvetői és csoportjai
+    void buildLightBatches(FrameContext& frame);
+    // A kaszkádok és a fő pass secondary buffereinek (párhuzamos, illetve statikus) rögzítése
+    void recordSecondaries(FrameContext& frame);
+    // Árnyék gyorsítótár, kaszkádok és az EVSM momentumok
+    void recordCascadeShadowPass(FrameContext& frame);
+    void recordAtlasShadowPass(FrameContext& frame);
+    void recordPointShadowPass(FrameContext& frame);
+    void recordMainPass(FrameContext& frame);
+    // A primary buffer lezárása, beküldés és megjelenítés, a frame slot léptetése
+    void submitFrame(FrameContext& frame, VulkanSwapchain* swapchain);
+    // Timestamp a frame slot query-jei közé (ha mérhető)
+    void writeTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage, uint32_t query);
+
+    void recordShadowDraws(const FrameContext& frame, VkCommandBuffer secondary, uint32_t shadowView,
+                           const std::vector<DrawBatch>& batches, VkDescriptorSet instances, size_t begin, size_t end,
+                           RecordSlot& slot, const VkRect2D& area, const VkRect2D& scissor, ShadowTarget target);
+    void recordMainDraws(const FrameContext& frame, VkCommandBuffer secondary, const std::vector<DrawBatch>& batches,
+                         VkDescriptorSet instances, size_t begin, size_t end, RecordSlot& slot);
+    // Munkaszálakon fut: kivétel helyett false-t ad, a hibát a hívó szál jelzi
+    bool recordSecondary(const FrameContext& frame, RecordSlot& slot, bool shadow, uint32_t cascade, bool reusable,
+                         const std::vector<DrawBatch>& batches, VkDescriptorSet instances, size_t begin, size_t end);
 };
\ No newline at end of file
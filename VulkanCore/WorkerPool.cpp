@@ -0,0 +1,83 @@
+/**
+ * @file WorkerPool.cpp
+ * @brief Az állandó munkaszálak ütemezése.
+ */
+#include "WorkerPool.h"
+#include "ParallelFor.h"
+
+WorkerPool::WorkerPool(unsigned threadCount) {
+    threadCount = resolveThreadCount(threadCount);
+    workers.reserve(threadCount - 1);
+    for (unsigned t = 1; t < threadCount; t++) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+size_t WorkerPool::drainTasks(const std::function<void(size_t)>& task, size_t count) {
+    size_t finished = 0;
+    for (size_t index = nextTask.fetch_add(1); index < count; index = nextTask.fetch_add(1)) {
+        task(index);
+        finished++;
+    }
+    return finished;
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) return;
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        taskCount = count;
+        nextTask.store(0);
+        finishedTasks = 0;
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    size_t finished = drainTasks(task, count);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finishedTasks += finished;
+    doneCondition.wait(lock, [&] { return finishedTasks == taskCount && activeWorkers == 0; });
+    currentTask = nullptr;
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+            // A csomag már lezárult, mire a szál felébredt
+            if (!currentTask) continue;
+            task = currentTask;
+            count = taskCount;
+            activeWorkers++;
+        }
+
+        size_t finished = drainTasks(*task, count);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finishedTasks += finished;
+        activeWorkers--;
+        if (finishedTasks == taskCount && activeWorkers == 0) doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file WorkerPool.h
+ * @brief Állandó munkaszálak képkockánként ismétlődő feladatokhoz (a parallelFor minden híváskor szálakat indít,
+ * ami a parancsrögzítés képkockánkénti ütemében már mérhető költség).
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+public:
+    /**
+     * @param threadCount A szálak száma a hívóval együtt (0: a hardver szálak száma).
+     */
+    explicit WorkerPool(unsigned threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief A feladatok [0, taskCount) végrehajtása; a hívó szál is dolgozik, és megvárja az összes végét.
+     * Egy feladat egyszerre csak egy szálon fut, de a szálhoz rendelése nem rögzített.
+     */
+    void run(size_t taskCount, const std::function<void(size_t)>& task);
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    // Az aktuális feladatcsomag (a generation váltása ébreszti a szálakat); a currentTask és a taskCount csak a mutex
+    // alatt olvasható, a szálak a csomag elején lemásolják
+    const std::function<void(size_t)>* currentTask = nullptr;
+    size_t taskCount = 0;
+    std::atomic<size_t> nextTask{0};
+    size_t finishedTasks = 0;
+    // A csomagon éppen dolgozó munkaszálak: a run() ezeket is megvárja, így egy késve induló szál sem nyúlhat a következő
+    // csomag nextTask számlálójához a régi feladattal
+    unsigned activeWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void workerLoop();
+
+    // Feladatok kivétele és futtatása, amíg van; a befejezettek számát adja vissza
+    size_t drainTasks(const std::function<void(size_t)>& task, size_t count);
+};
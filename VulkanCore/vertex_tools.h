@@ -1,10 +1,16 @@
 #pragma once
 
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
 /**
  * Normálvektor számítása egy háromszöghöz a csúcspontjai (v1, v2, v3) alapján.
  * A normálvektor határozza meg a felület orientációját, ami alapvető a fényvisszaverődés kiszámításához.
  */
-glm::vec3 calculateNormal(const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3) {
+inline glm::vec3 calculateNormal(const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3) {
     // Két élvektor meghatározása a háromszög síkján
     const glm::vec3 v1v2 = v1 - v2;
     const glm::vec3 v2v3 = v2 - v3;
@@ -23,7 +29,7 @@ glm::vec3 calculateNormal(const glm::vec3& v1, const glm::vec3& v2, const glm::v
  * * @param v1, v2, v3 A háromszög csúcspontjainak pozíciói
  * @param uv1, uv2, uv3 A csúcspontokhoz tartozó textúra (UV) koordináták
  */
-glm::vec3 calculateTangent(
+inline glm::vec3 calculateTangent(
     const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3,
     const glm::vec2& uv1, const glm::vec2& uv2, const glm::vec2& uv3)
 {
@@ -46,4 +52,151 @@ glm::vec3 calculateTangent(
 
     // Az eredmény normalizálása az irány megtartása mellett
     return glm::normalize(tangent);
-}
\ No newline at end of file
+}
+
+/**
+ * Azonos vertexek összevonása (Vertex Welding).
+ * A duplikált vertexeket tartalmazó háromszöglistából egyedi vertex tömböt és index listát készít.
+ * Két vertex akkor azonos, ha minden komponensük bitre megegyezik (a -0.0 és +0.0 egyezőnek számít).
+ * @param vertices Bemeneti vertex adatok (háromszöglista, vertexenként stride darab float)
+ * @param stride Egy vertex float komponenseinek száma
+ * @param outVertices Kimenet: egyedi vertexek, az első előfordulás sorrendjében
+ * @param outIndices Kimenet: háromszög indexek az egyedi vertexekre
+ */
+inline void weldVertices(const std::vector<float>& vertices, size_t stride,
+                         std::vector<float>& outVertices, std::vector<uint32_t>& outIndices)
+{
+    const size_t inputCount = vertices.size() / stride;
+    outVertices.clear();
+    outIndices.clear();
+    outVertices.reserve(vertices.size());
+    outIndices.reserve(inputCount);
+
+    // Nyílt címzésű hash tábla (kettő hatvány méret, legalább kétszeres kitöltetlenség)
+    size_t tableSize = 1;
+    while (tableSize < inputCount * 2) tableSize <<= 1;
+    const uint32_t emptySlot = 0xFFFFFFFFu;
+    std::vector<uint32_t> table(tableSize, emptySlot);
+
+    std::vector<float> key(stride);
+    for (size_t i = 0; i < inputCount; i++) {
+        // Kanonikus alak: a negatív nulla pozitívvá alakítása, hogy bitre összehasonlítható legyen
+        uint64_t hash = 14695981039346656037ull; // FNV-1a
+        for (size_t c = 0; c < stride; c++) {
+            float value = vertices[i * stride + c];
+            key[c] = (value == 0.0f) ? 0.0f : value;
+
+            uint32_t bits;
+            std::memcpy(&bits, &key[c], sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+
+        size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+        while (true) {
+            uint32_t candidate = table[slot];
+            if (candidate == emptySlot) {
+                // Új egyedi vertex
+                candidate = static_cast<uint32_t>(outVertices.size() / stride);
+                table[slot] = candidate;
+                outVertices.insert(outVertices.end(), key.begin(), key.end());
+                outIndices.push_back(candidate);
+                break;
+            }
+            if (std::memcmp(&outVertices[candidate * stride], key.data(), stride * sizeof(float)) == 0) {
+                // Már létező vertex: csak az indexét használjuk újra
+                outIndices.push_back(candidate);
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+    }
+}
+
+/**
+ * Bitangens vektor számítása egy háromszöghöz (az UV tér 'V' iránya a 3D térben).
+ * Csak a tangens kezességének (handedness) meghatározásához használjuk.
+ */
+inline glm::vec3 calculateBitangent(
+    const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3,
+    const glm::vec2& uv1, const glm::vec2& uv2, const glm::vec2& uv3)
+{
+    glm::vec3 edge1 = v2 - v1;
+    glm::vec3 edge2 = v3 - v1;
+    glm::vec2 deltaUV1 = uv2 - uv1;
+    glm::vec2 deltaUV2 = uv3 - uv1;
+
+    float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+    return f * (deltaUV1.x * edge2 - deltaUV2.x * edge1);
+}
+
+/**
+ * Egy vertex végleges tangensének előállítása a hozzá tartozó háromszögek összegzett tangenséből és bitangenséből.
+ * A tangenst a normálvektorra merőlegesítjük (Gram-Schmidt); ha így nullvektor marad,
+ * a normálvektorra merőleges tartalék irányt kap. A W komponens a kezesség (+1 / -1).
+ */
+inline glm::vec4 finalizeVertexTangent(const glm::vec3& normal, const glm::vec3& tangentSum, const glm::vec3& bitangentSum)
+{
+    // Gram-Schmidt: a tangens normálvektorral párhuzamos részének eltávolítása
+    glm::vec3 t = tangentSum - normal * glm::dot(normal, tangentSum);
+    if (glm::dot(t, t) < 1e-12f) {
+        // Tartalék irány: a normálvektorra merőleges, a legkevésbé párhuzamos tengelyből képezve
+        glm::vec3 axis = std::fabs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        t = glm::cross(normal, axis);
+        if (glm::dot(t, t) < 1e-12f) t = axis;
+    }
+    t = glm::normalize(t);
+
+    float handedness = glm::dot(glm::cross(normal, t), bitangentSum) < 0.0f ? -1.0f : 1.0f;
+    return glm::vec4(t, handedness);
+}
+
+/**
+ * Vertexenkénti tangensek számítása indexelt geometriához (skalár referencia implementáció).
+ * A MeshObject a gyorsabb TangentKernel-t használja; ez a függvény az eredmény ellenőrzésére szolgál.
+ * Minden háromszög tangense hozzáadódik a csúcsaihoz (háromszög sorrendben), majd finalizeVertexTangent() véglegesíti.
+ * Elfajult UV-jú háromszögek (nem véges tangens) kimaradnak.
+ * A W komponens a kezesség: +1, ha a bitangens a cross(N, T) irányába mutat (ezt feltételezi a shader),
+ * -1 tükrözött UV-k esetén.
+ * @param vertices Vertex adatok (Pos(3), Norm(3), UV(2), ... vertexenként stride darab float)
+ * @param stride Egy vertex float komponenseinek száma
+ * @param indices Háromszög indexek
+ */
+inline std::vector<glm::vec4> calculateVertexTangents(const std::vector<float>& vertices, size_t stride,
+                                                      const std::vector<uint32_t>& indices)
+{
+    const size_t vertexCount = vertices.size() / stride;
+    std::vector<glm::vec3> tangentSums(vertexCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> bitangentSums(vertexCount, glm::vec3(0.0f));
+
+    auto position = [&](uint32_t i) { return glm::vec3(vertices[i * stride + 0], vertices[i * stride + 1], vertices[i * stride + 2]); };
+    auto texCoord = [&](uint32_t i) { return glm::vec2(vertices[i * stride + 6], vertices[i * stride + 7]); };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t i1 = indices[i + 0];
+        uint32_t i2 = indices[i + 1];
+        uint32_t i3 = indices[i + 2];
+
+        glm::vec3 tangent = calculateTangent(position(i1), position(i2), position(i3),
+                                             texCoord(i1), texCoord(i2), texCoord(i3));
+        if (!std::isfinite(tangent.x) || !std::isfinite(tangent.y) || !std::isfinite(tangent.z)) {
+            continue;
+        }
+        glm::vec3 bitangent = calculateBitangent(position(i1), position(i2), position(i3),
+                                                 texCoord(i1), texCoord(i2), texCoord(i3));
+
+        tangentSums[i1] += tangent;
+        tangentSums[i2] += tangent;
+        tangentSums[i3] += tangent;
+        bitangentSums[i1] += bitangent;
+        bitangentSums[i2] += bitangent;
+        bitangentSums[i3] += bitangent;
+    }
+
+    std::vector<glm::vec4> tangents(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        glm::vec3 normal(vertices[v * stride + 3], vertices[v * stride + 4], vertices[v * stride + 5]);
+        tangents[v] = finalizeVertexTangent(normal, tangentSums[v], bitangentSums[v]);
+    }
+
+    return tangents;
+}
@@ -12,10 +12,18 @@
 #include <cstdlib>
 #include <vector>
 #include <cstring>
+#include <cstdio>
 #include <map>
 #include <chrono>
 #include <cmath>
 #include <iterator>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <random>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -28,133 +36,80 @@
 #include "VulkanCore/VulkanPipeline.h"
 #include "VulkanCore/VulkanRenderer.h"
 #include "VulkanCore/MeshObject.h"
+#include "VulkanCore/GeometryPool.h"
+#include "VulkanCore/MeshCache.h"
+#include "VulkanCore/MeshImporter.h"
+#include "VulkanCore/ProceduralGeometry.h"
 #include "VulkanCore/Texture.h"
+#include "VulkanCore/TangentKernel.h"
+#include "VulkanCore/FrustumCuller.h"
+#include "VulkanCore/SceneBvh.h"
+#include "VulkanCore/vertex_tools.h"
 
 const uint32_t WIDTH = 1024;
 const uint32_t HEIGHT = 768;
-using namespace std;
 
-// --- GEOMETRIA GENERÁLÓ FÜGGVÉNYEK ---
-// Ezek a függvények nyers vertex adatokat állítanak elő:
-// Stride: 8 float (X, Y, Z, NormX, NormY, NormZ, U, V)
-// A MeshObject osztály fogja ezt később kiegészíteni a Tangens adatokkal (11 floatra).
-
-// Tórusz (fánk) generálása
-std::vector<float> generateTorus(float mainRadius, float tubeRadius, int mainSegments, int tubeSegments) {
-    std::vector<float> vertices;
-    for (int i = 0; i <= mainSegments; ++i) {
-        float u = (float)i / mainSegments * glm::two_pi<float>();
-        float cosU = cos(u);
-        float sinU = sin(u);
-        for (int j = 0; j <= tubeSegments; ++j) {
-            float v = (float)j / tubeSegments * glm::two_pi<float>();
-            float cosV = cos(v);
-            float sinV = sin(v);
-
-            // Pozíció számítása
-            float x = (mainRadius + tubeRadius * cosV) * cosU;
-            float y = (mainRadius + tubeRadius * cosV) * sinU;
-            float z = tubeRadius * sinV;
-
-            // Normálvektor számítása
-            float nx = cosV * cosU;
-            float ny = cosV * sinU;
-            float nz = sinV;
-
-            // Adatok hozzáadása (Pos + Norm + UV)
-            vertices.push_back(x); vertices.push_back(y); vertices.push_back(z);
-            vertices.push_back(nx); vertices.push_back(ny); vertices.push_back(nz);
-            vertices.push_back((float)i / mainSegments * 4.0f); // UV ismétlődés
-            vertices.push_back((float)j / tubeSegments * 1.0f);
-        }
-    }
-    // Indexelés helyett duplikált vertexekkel ("Triangle List") töltjük fel a kimenetet
-    std::vector<float> finalVertices;
-    for (int i = 0; i < mainSegments; ++i) {
-        for (int j = 0; j < tubeSegments; ++j) {
-            int p1 = i * (tubeSegments + 1) + j;
-            int p2 = ((i + 1)) * (tubeSegments + 1) + j;
-            int p3 = p1 + 1;
-            int p4 = p2 + 1;
-
-            auto pushVert = [&](int idx) {
-                for (int k = 0; k < 8; k++) finalVertices.push_back(vertices[idx * 8 + k]);
-            };
-            // Két háromszög alkot egy négyszöget (quad)
-            pushVert(p1); pushVert(p2); pushVert(p3);
-            pushVert(p2); pushVert(p4); pushVert(p3);
-        }
-    }
-    return finalVertices;
-}
+// A mesh-ek GPU oldali vertex formátuma: Compact (20 byte/vertex) vagy Full (44 byte/vertex, referencia)
+const VertexFormat MESH_VERTEX_FORMAT = VertexFormat::Compact;
 
-// Egységkocka generálása
-std::vector<float> generateCube(float size) {
-    float h = size / 2.0f;
-    // Kézzel definiált vertexek: Pos(3), Norm(3), UV(2)
-    std::vector<float> v = {
-        // Hátlap
-        -h, -h,  h,  0, 0, 1,  0, 0,  h, -h,  h,  0, 0, 1,  1, 0,  h,  h,  h,  0, 0, 1,  1, 1,
-        h,  h,  h,  0, 0, 1,  1, 1, -h,  h,  h,  0, 0, 1,  0, 1, -h, -h,  h,  0, 0, 1,  0, 0,
-        // Előlap
-        h, -h, -h,  0, 0, -1, 0, 0, -h, -h, -h,  0, 0, -1, 1, 0, -h,  h, -h,  0, 0, -1, 1, 1,
-        -h,  h, -h,  0, 0, -1, 1, 1,  h,  h, -h,  0, 0, -1, 0, 1,  h, -h, -h,  0, 0, -1, 0, 0,
-        // Bal oldal
-        -h, -h, -h, -1, 0, 0,  0, 0, -h, -h,  h, -1, 0, 0,  1, 0, -h,  h,  h, -1, 0, 0,  1, 1,
-        -h,  h,  h, -1, 0, 0,  1, 1, -h,  h, -h, -1, 0, 0,  0, 1, -h, -h, -h, -1, 0, 0,  0, 0,
-        // Jobb oldal
-         h, -h,  h,  1, 0, 0,  0, 0,  h, -h, -h,  1, 0, 0,  1, 0,  h,  h, -h,  1, 0, 0,  1, 1,
-         h,  h, -h,  1, 0, 0,  1, 1,  h,  h,  h,  1, 0, 0,  0, 1,  h, -h,  h,  1, 0, 0,  0, 0,
-        // Teteje
-        -h,  h,  h,  0, 1, 0,  0, 0,  h,  h,  h,  0, 1, 0,  1, 0,  h,  h, -h,  0, 1, 0,  1, 1,
-         h,  h, -h,  0, 1, 0,  1, 1, -h,  h, -h,  0, 1, 0,  0, 1, -h,  h,  h,  0, 1, 0,  0, 0,
-        // Alja
-        -h, -h, -h,  0, -1, 0, 0, 0,  h, -h, -h,  0, -1, 0, 1, 0,  h, -h,  h,  0, -1, 0, 1, 1,
-         h, -h,  h,  0, -1, 0, 1, 1, -h, -h,  h,  0, -1, 0, 0, 1, -h, -h, -h,  0, -1, 0, 0, 0
-    };
-    return v;
-}
+// A feldolgozott mesh-ek bináris cache-e (lásd MeshCache); a munkakönyvtárhoz képest
+const char* const MESH_CACHE_DIRECTORY = "cache/meshes";
 
-// Piramis generálása
-std::vector<float> generatePyramid(float size, float height) {
-    float h = size / 2.0f;
-    // Normálvektorok kissé trükkösek az oldallapoknál (dőlésszög miatt)
-    std::vector<float> v = {
-        // Alap
-        -h, 0,  h,  0, 0.5f, 0.8f,  0, 0,  h, 0,  h,  0, 0.5f, 0.8f,  1, 0,  0, height, 0, 0, 0.5f, 0.8f, 0.5f, 1,
-         h, 0,  h,  0.8f, 0.5f, 0,  0, 0,  h, 0, -h,  0.8f, 0.5f, 0,  1, 0,  0, height, 0, 0.8f, 0.5f, 0, 0.5f, 1,
-         h, 0, -h,  0, 0.5f, -0.8f, 0, 0, -h, 0, -h,  0, 0.5f, -0.8f, 1, 0,  0, height, 0, 0, 0.5f, -0.8f, 0.5f, 1,
-        -h, 0, -h, -0.8f, 0.5f, 0,  0, 0, -h, 0,  h, -0.8f, 0.5f, 0,  1, 0,  0, height, 0, -0.8f, 0.5f, 0, 0.5f, 1,
-        // Alja (két háromszög)
-        -h, 0, -h,  0, -1, 0,  0, 1,  h, 0, -h,  0, -1, 0,  1, 1,  h, 0,  h,  0, -1, 0,  1, 0,
-         h, 0,  h,  0, -1, 0,  1, 0, -h, 0,  h,  0, -1, 0,  0, 0, -h, 0, -h,  0, -1, 0,  0, 1
-    };
-    return v;
-}
+// A generátorok kódjának változásakor növelendő, hogy a régi cache fájlok érvénytelenné váljanak
+const uint32_t GENERATOR_VERSION = 1;
+using namespace std;
 
-// Padló sík generálása (nagy kiterjedésű quad)
-std::vector<float> generateFloor(float size, float textureRepeat) {
-    float h = size / 2.0f;
-    std::vector<float> v = {
-        -h, 0,  h,  0, 1, 0,  0, 0,
-         h, 0,  h,  0, 1, 0,  textureRepeat, 0,
-         h, 0, -h,  0, 1, 0,  textureRepeat, textureRepeat,
-         h, 0, -h,  0, 1, 0,  textureRepeat, textureRepeat,
-        -h, 0, -h,  0, 1, 0,  0, textureRepeat,
-        -h, 0,  h,  0, 1, 0,  0, 0
-    };
-    return v;
+// --- GEOMETRIA GENERÁLÁS ---
+// A primitívek generátorai a VulkanCore/ProceduralGeometry.h-ban vannak (TorusGenerator, BoxGenerator, ...):
+// a kis primitívek közvetlenül a GeometryPool staging memóriájába íródnak (MeshObject::createProcedural),
+// a LOD-ot és meshleteket igénylő tórusz a 8 float/vertex tömbön át a teljes feldolgozáson megy keresztül.
+
+// Mesh cache kulcs egy generátorhoz: a generátor neve, verziója és paraméterei
+uint64_t generatorKey(const char* name, std::initializer_list<float> parameters) {
+    uint64_t key = MeshCache::hash(name, std::strlen(name));
+    key = MeshCache::hashValue(GENERATOR_VERSION, key);
+    for (float parameter : parameters) key = MeshCache::hashValue(parameter, key);
+    return key;
 }
 
 // --- FŐ ALKALMAZÁS OSZTÁLY ---
 class HelloTriangleApplication {
 public:
+    // --lod-report: a kamera távolodik a jelenettől, távolságonként LOD-dal és nélküle mér, majd kilép
+    bool lodReport = false;
+    // --no-mesh-cache: minden mesh újragenerálása és feldolgozása (hideg indítás mérése)
+    bool useMeshCache = true;
+    // --import <fájl>: külső modell (.obj / .glb) betöltése a jelenetbe
+    std::string importPath;
+    // --cubes <N>: N darab kocka rácsban a padlón, a kocka geometriájának példányaiként (instanced rajzolás)
+    uint32_t instancedCubeCount = 0;
+    // --gpu-driven: culling, LOD és rajzolási parancsok a GPU-n (indirekt rajzolás), ha az eszköz támogatja
+    bool gpuDriven = false;
+    // --unsorted: a rajzolási sor rendezése nélkül (a kötések és a pass idők összehasonlításához)
+    bool unsortedDraws = false;
+    // --static-replay: a nem animált objektumok rajzolásai egyszer rögzülnek, és képkockánként csak visszajátszódnak
+    bool staticReplay = false;
+    // --cascades <N>: az irányított fény árnyék kaszkádjainak száma (2..4)
+    uint32_t shadowCascadeCount = ShadowCascades::MAX_CASCADES;
+    // --shadow-cache: a statikus árnyékvetők mélysége gyorsítótárban marad, képkockánként csak a dinamikusak
+    // renderelődnek (bekapcsolja a statikus visszajátszást is; GPU-vezérelt módban nincs hatása)
+    bool shadowCache = false;
+    // --shadow-filter <1|4|16>: az árnyék PCF kernel mintáinak száma (minden minta hardveres 2x2 összehasonlítás)
+    VulkanRenderer::ShadowFilter shadowFilter = VulkanRenderer::ShadowFilter::Poisson4;
+    // --spot-lights <N>: N darab árnyékvető spotfény körben a padló fölött (az árnyék atlasz csempéibe renderelve)
+    uint32_t spotLightCount = 0;
+    // --point-lights <N>: N darab árnyékvető pontfény körben (kocka árnyéktérképpel, egy multiview pass-ban)
+    uint32_t pointLightCount = 0;
+    // --evsm: a kaszkádokat kapó fény (az első árnyékvető) előszűrt EVSM árnyékkal a PCF kernel helyett
+    bool evsmShadows = false;
+
     void run() {
         initWindow();
 
         // Callback beállítása a billentyűzethez a folyamatos mozgáshoz
         glfwSetWindowUserPointer(window, this);
         glfwSetKeyCallback(window, staticKeyCallback);
+        glfwSetMouseButtonCallback(window, staticMouseButtonCallback);
 
         initVulkan(); // Vulkan rendszer inicializálása
         mainLoop();   // Render ciklus
@@ -172,6 +127,9 @@ private:
 
     VkDescriptorPool descriptorPool; // Memória a shader resource-oknak
 
+    // Közös vertex/index puffer: minden mesh ebből foglal (rajzoláskor frame-enként egyszer kötődik)
+    GeometryPool geometryPool;
+
     // Anyagok (Textúrák)
     Texture rockTexture;
     Texture rustTexture;
@@ -182,6 +140,12 @@ private:
     MeshObject pyramid;
     MeshObject n;
     MeshObject floor;
+    MeshObject importedModel; // Csak --import esetén
+    std::vector<MeshObject> cubeInstances; // Csak --cubes esetén; a kocka geometriáját használják
+
+    // A renderelt jelenet (a padló az utolsó, mert nem vet árnyékot) és a kijelöléshez az objektumok nevei
+    std::vector<MeshObject*> sceneObjects;
+    std::vector<const char*> sceneObjectNames;
 
     // Mélység puffer erőforrások (Z-Buffering)
     VkImage depthImage;
@@ -197,6 +161,28 @@ private:
     // Gombok állapota a sima mozgáshoz (nem "darabos" event alapú)
     std::map<int, bool> keysPressed;
 
+    // Kijelölés: bal klikk után a következő képkockában a renderer jelenet BVH-ján keresztül
+    bool pickRequested = false;
+    glm::vec2 pickCursorNdc = glm::vec2(0.0f);
+    uint32_t pickedObject = UINT32_MAX; // Az utolsó kijelölt objektum indexe a sceneObjects-ben
+    float pickedObjectLift = 0.0f;      // M / Shift+M: a kijelölt objektum függőleges eltolása a következő képkockában
+
+    /**
+     * @brief Bal egérgomb: a kurzor alatti objektum kijelölése (a név a konzolra kerül).
+     */
+    static void staticMouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+        HelloTriangleApplication* app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        if (!app || button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
+
+        double cursorX, cursorY;
+        int width, height;
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+        glfwGetWindowSize(window, &width, &height);
+        if (width == 0 || height == 0) return;
+        app->pickCursorNdc = glm::vec2(2.0f * cursorX / width - 1.0f, 2.0f * cursorY / height - 1.0f);
+        app->pickRequested = true;
+    }
+
     /**
      * @brief Statikus callback, ami elkapja a billentyűzet eseményeket és beállítja a `keysPressed` map-et.
      */
@@ -206,6 +192,23 @@ private:
             HelloTriangleApplication* app = reinterpret_cast<HelloTriangleApplication*>(userPtr);
             if (action == GLFW_PRESS) app->keysPressed[key] = true;
             else if (action == GLFW_RELEASE) app->keysPressed[key] = false;
+
+            // L: LOD választás be/ki (összehasonlításhoz)
+            if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+                app->vulkanRenderer.setLodEnabled(!app->vulkanRenderer.isLodEnabled());
+                std::cout << "LOD " << (app->vulkanRenderer.isLodEnabled() ? "enabled" : "disabled") << std::endl;
+            }
+
+            // G: GPU-vezérelt és CPU-s culling / rajzolás közötti váltás
+            if (key == GLFW_KEY_G && action == GLFW_PRESS && app->vulkanRenderer.isGpuDrivenSupported()) {
+                app->vulkanRenderer.setGpuDriven(!app->vulkanRenderer.isGpuDriven());
+                std::cout << "GPU-driven rendering " << (app->vulkanRenderer.isGpuDriven() ? "enabled" : "disabled") << std::endl;
+            }
+
+            // M / Shift+M: a kijelölt objektum emelése / süllyesztése
+            if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+                app->pickedObjectLift += (mods & GLFW_MOD_SHIFT) ? -0.5f : 0.5f;
+            }
         }
     }
 
@@ -217,6 +220,53 @@ private:
         window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan Normal Mapping", nullptr, nullptr);
     }
 
+    /**
+     * @brief N darab lefelé néző, árnyékvető spotfény egy körben a padló fölött, változó színnel
+     * (a renderer fénylistájának végére, legfeljebb VulkanRenderer::MAX_LIGHTS fényig).
+     */
+    void addSpotLights(uint32_t count) {
+        std::vector<VulkanRenderer::Light> lights = vulkanRenderer.getLights();
+        uint32_t freeSlots = VulkanRenderer::MAX_LIGHTS - std::min<uint32_t>(static_cast<uint32_t>(lights.size()), VulkanRenderer::MAX_LIGHTS);
+        count = std::min(count, freeSlots);
+        for (uint32_t i = 0; i < count; i++) {
+            float angle = glm::two_pi<float>() * i / count;
+            VulkanRenderer::Light spot;
+            spot.position = glm::vec3(6.0f * std::cos(angle), 4.0f, 6.0f * std::sin(angle));
+            // Színkör: a fázisban eltolt koszinuszok a három csatornára
+            spot.color = glm::vec3(0.6f + 0.4f * std::cos(angle), 0.6f + 0.4f * std::cos(angle + 2.094f),
+                                   0.6f + 0.4f * std::cos(angle + 4.189f)) * 2.0f;
+            spot.castsShadow = true;
+            spot.type = VulkanRenderer::LightType::Spot;
+            spot.direction = glm::normalize(glm::vec3(-0.3f * std::cos(angle), -1.0f, -0.3f * std::sin(angle)));
+            spot.outerAngle = glm::radians(35.0f);
+            spot.range = 12.0f;
+            lights.push_back(spot);
+        }
+        vulkanRenderer.setLights(lights);
+    }
+
+    /**
+     * @brief N darab árnyékvető pontfény egy körben, a spotfényeknél alacsonyabban, hogy a tárgyak oldalára is
+     * vessenek árnyékot (a fénylista végére, legfeljebb VulkanRenderer::MAX_LIGHTS fényig).
+     */
+    void addPointLights(uint32_t count) {
+        std::vector<VulkanRenderer::Light> lights = vulkanRenderer.getLights();
+        uint32_t freeSlots = VulkanRenderer::MAX_LIGHTS - std::min<uint32_t>(static_cast<uint32_t>(lights.size()), VulkanRenderer::MAX_LIGHTS);
+        count = std::min(count, freeSlots);
+        for (uint32_t i = 0; i < count; i++) {
+            float angle = glm::two_pi<float>() * (i + 0.5f) / count;
+            VulkanRenderer::Light point;
+            point.position = glm::vec3(4.0f * std::cos(angle), 1.5f, 4.0f * std::sin(angle));
+            point.color = glm::vec3(0.6f + 0.4f * std::sin(angle), 0.6f + 0.4f * std::sin(angle + 2.094f),
+                                    0.6f + 0.4f * std::sin(angle + 4.189f)) * 1.5f;
+            point.castsShadow = true;
+            point.type = VulkanRenderer::LightType::Point;
+            point.range = 8.0f;
+            lights.push_back(point);
+        }
+        vulkanRenderer.setLights(lights);
+    }
+
     void initVulkan() {
         // Inicializálási sorrend kritikus!
         vulkanContext.initInstance(window); // 1. Instance
@@ -224,11 +274,42 @@ private:
             throw std::runtime_error("failed to create window surface!");
         }
         vulkanContext.initDevice(surface); // 2. Fizikai és Logikai eszköz
+        geometryPool.create(&vulkanContext); // Közös geometria puffer (a mesh-ek és a renderer használja)
         vulkanSwapchain.create(&vulkanContext, surface, window); // 3. Swapchain
         createDepthResources(); // 4. Mélység puffer
         // 5. Pipeline létrehozása (Shader betöltés, Vertex layout, stb.)
         vulkanPipeline.create(&vulkanContext, &vulkanSwapchain, depthImageView, findDepthFormat());
-        vulkanRenderer.create(&vulkanContext, &vulkanSwapchain); // 6. Renderer (Sync objects, Cmd Buffers)
+        vulkanRenderer.create(&vulkanContext, &vulkanSwapchain, &geometryPool); // 6. Renderer (Sync objects, Cmd Buffers)
+        vulkanRenderer.setGpuDriven(gpuDriven);
+        vulkanRenderer.setDrawSortingEnabled(!unsortedDraws);
+        vulkanRenderer.setStaticReplay(staticReplay);
+        vulkanRenderer.setShadowCascadeCount(shadowCascadeCount);
+        vulkanRenderer.setShadowCacheEnabled(shadowCache);
+        vulkanRenderer.setShadowFilter(shadowFilter);
+        if (spotLightCount > 0) {
+            addSpotLights(spotLightCount);
+        }
+        if (pointLightCount > 0) {
+            addPointLights(pointLightCount);
+            if (!vulkanContext.isMultiviewSupported() || !vulkanContext.isImageCubeArraySupported()) {
+                std::cout << "Multiview or cube array images not supported by the device, point lights are rendered without shadows" << std::endl;
+            }
+        }
+        if (evsmShadows) {
+            std::vector<VulkanRenderer::Light> lights = vulkanRenderer.getLights();
+            for (VulkanRenderer::Light& light : lights) {
+                if (!light.castsShadow) continue;
+                light.shadowTechnique = VulkanRenderer::ShadowTechnique::Evsm;
+                break;
+            }
+            vulkanRenderer.setLights(lights);
+            if (!vulkanRenderer.isMomentShadowSupported()) {
+                std::cout << "EVSM shadows not supported by the device (RGBA32F filtering), using PCF" << std::endl;
+            }
+        }
+        if (gpuDriven && !vulkanRenderer.isGpuDrivenSupported()) {
+            std::cout << "GPU-driven rendering not supported by the device, using CPU culling" << std::endl;
+        }
         createDescriptorPool(); // 7. Descriptor Pool
         createAssets();         // 8. Textúrák betöltése
         createObjects();        // 9. Geometria létrehozása
@@ -301,45 +382,183 @@ private:
     }
 
     void createObjects() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
         // 1. Torus létrehozása és beállítása
-        std::vector<float> torusVec = generateTorus(1.0f, 0.4f, 32, 16);
-        torus.create(&vulkanContext, torusVec); // Tangens számítás itt történik automatikusan
+        // Tangens számítás itt történik automatikusan; a tórusz meshletekre bontva, GPU-s klaszter cullinggal rajzolódik
+        createMesh(torus, generatorKey("torus", {1.0f, 0.4f, 32.0f, 16.0f}),
+                   [](std::vector<float>& vertices, std::vector<uint32_t>& indices) {
+                       vertices = ProceduralGeometry::toVertexArray(TorusGenerator{1.0f, 0.4f, 32, 16}, indices);
+                   },
+                   true);
         torus.position = glm::vec3(2.0f, 0.0f, 0.0f);
         torus.rotationAxis = glm::vec3(1.0f, 0.0f, 0.0f);
         torus.rotationSpeed = 20.0f;
         torus.setTexture(rockTexture.descriptorSet);
 
         // 2. Kocka
-        std::vector<float> cubeVec = generateCube(1.5f);
-        cube.create(&vulkanContext, cubeVec);
+        // A primitívek közvetlenül a staging memóriába generálódnak; a feltöltés egyszerre, a padló után indul
+        cube.createProcedural(&vulkanContext, &geometryPool, BoxGenerator{1.5f}, MESH_VERTEX_FORMAT);
         cube.position = glm::vec3(-2.0f, 0.0f, 0.0f);
         cube.rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
         cube.rotationSpeed = -30.0f;
         cube.setTexture(rustTexture.descriptorSet);
 
         // 3. Piramis
-        std::vector<float> pyrVec = generatePyramid(1.5f, 2.0f);
-        pyramid.create(&vulkanContext, pyrVec);
+        pyramid.createProcedural(&vulkanContext, &geometryPool, PyramidGenerator{1.5f, 2.0f}, MESH_VERTEX_FORMAT);
         pyramid.position = glm::vec3(0.0f, 2.0f, -2.0f);
         pyramid.rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
         pyramid.rotationSpeed = 45.0f;
         pyramid.setTexture(rockTexture.descriptorSet);
 
         // 4. "N" betű (kockából)
-        std::vector<float> nVec = generateCube(1.0f);
-        n.create(&vulkanContext, nVec);
+        n.createProcedural(&vulkanContext, &geometryPool, BoxGenerator{1.0f}, MESH_VERTEX_FORMAT);
         n.position = glm::vec3(0.0f, 0.0f, 2.0f);
         n.setTexture(rustTexture.descriptorSet);
 
         // 5. Padló
-        std::vector<float> floorVec = generateFloor(20.0f, 4.0f);
-        floor.create(&vulkanContext, floorVec);
+        floor.createProcedural(&vulkanContext, &geometryPool, PlaneGenerator{20.0f, 4.0f}, MESH_VERTEX_FORMAT);
         floor.position = glm::vec3(0.0f, -3.0f, 0.0f);
         floor.setTexture(rustTexture.descriptorSet);
+
+        // A generált primitívek másolása a közös pufferekbe (egy submit)
+        geometryPool.flushUploads();
+
+        // 6. Importált modell (opcionális): nagy mesh, ezért meshletekre bontva
+        if (!importPath.empty()) {
+            importedModel.createImported(&vulkanContext, &geometryPool, useMeshCache ? MESH_CACHE_DIRECTORY : "", importPath,
+                                         MESH_VERTEX_FORMAT, true);
+            importedModel.position = glm::vec3(0.0f, 0.0f, -4.0f);
+            importedModel.setTexture(rockTexture.descriptorSet);
+        }
+
+        // 7. Kocka példányok (opcionális): rács a padlón, geometria és textúra a kockáé,
+        // így a renderer az összeset egy-egy instanced hívással rajzolja pass-onként
+        cubeInstances.resize(instancedCubeCount);
+        uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instancedCubeCount))));
+        const float spacing = 2.5f;
+        for (uint32_t i = 0; i < instancedCubeCount; i++) {
+            MeshObject& instance = cubeInstances[i];
+            instance.createInstanceOf(cube);
+            instance.position = glm::vec3((i % gridSize - (gridSize - 1) * 0.5f) * spacing, -2.25f,
+                                          (i / gridSize) * spacing + 6.0f);
+        }
+
+        sceneObjects = {&torus, &cube, &pyramid, &n};
+        sceneObjectNames = {"torus", "cube", "pyramid", "n"};
+        if (!importPath.empty()) {
+            sceneObjects.push_back(&importedModel);
+            sceneObjectNames.push_back("imported model");
+        }
+        for (MeshObject& instance : cubeInstances) {
+            sceneObjects.push_back(&instance);
+            sceneObjectNames.push_back("cube instance");
+        }
+        sceneObjects.push_back(&floor);
+        sceneObjectNames.push_back("floor");
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        std::cout << "Meshes created in " << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms"
+                  << (useMeshCache ? "" : " (mesh cache disabled)") << std::endl;
+
+        geometryPool.printStats();
+    }
+
+    /**
+     * @brief Mesh létrehozása a bináris cache-en keresztül (vagy nélküle, --no-mesh-cache esetén).
+     */
+    void createMesh(MeshObject& mesh, uint64_t key,
+                    const std::function<void(std::vector<float>&, std::vector<uint32_t>&)>& generator, bool buildMeshlets = false) {
+        if (useMeshCache) {
+            mesh.createCached(&vulkanContext, &geometryPool, MESH_CACHE_DIRECTORY, key, generator, MESH_VERTEX_FORMAT, buildMeshlets);
+            return;
+        }
+
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        generator(vertices, indices);
+        if (indices.empty()) {
+            mesh.create(&vulkanContext, &geometryPool, vertices, MESH_VERTEX_FORMAT, buildMeshlets);
+        } else {
+            mesh.create(&vulkanContext, &geometryPool, std::move(vertices), std::move(indices), MESH_VERTEX_FORMAT, buildMeshlets);
+        }
+    }
+
+    // --- LOD RIPORT ---
+    // Távolságonként (a kamera a -Z tengelyen hátrál) LOD_REPORT_FRAMES képkockát mér LOD-dal, majd nélküle
+    static constexpr float LOD_REPORT_DISTANCES[] = {5.0f, 10.0f, 20.0f, 40.0f, 80.0f};
+    static const int LOD_REPORT_FRAMES = 120;
+
+    struct LodReportRow {
+        float distance;
+        bool lodEnabled;
+        uint32_t mainTriangles;
+        uint32_t shadowTriangles;
+        double frameMs;
+        double shadowPassMs;
+    };
+    std::vector<LodReportRow> lodReportRows;
+    size_t lodReportStep = 0;   // (távolság, LOD be/ki) párok indexe
+    int lodReportFrame = 0;
+    double lodReportTime = 0.0;
+    double lodReportShadowTime = 0.0;
+
+    /**
+     * @brief A riport következő képkockájának előkészítése és az előző mérése. Hamisat ad, ha a riport kész.
+     */
+    bool advanceLodReport(float frameMs) {
+        const size_t stepCount = std::size(LOD_REPORT_DISTANCES) * 2;
+        if (lodReportStep >= stepCount) return false;
+
+        // Az első néhány képkockát kihagyjuk (pipeline bemelegedés, a távolság váltás utáni első frame)
+        if (lodReportFrame >= 4) {
+            lodReportTime += frameMs;
+            lodReportShadowTime += vulkanRenderer.getFrameStats().shadowPassMs;
+        }
+        lodReportFrame++;
+
+        if (lodReportFrame > LOD_REPORT_FRAMES + 4) {
+            const VulkanRenderer::FrameStats& stats = vulkanRenderer.getFrameStats();
+            lodReportRows.push_back({LOD_REPORT_DISTANCES[lodReportStep / 2], vulkanRenderer.isLodEnabled(),
+                                     stats.mainTriangles, stats.shadowTriangles, lodReportTime / LOD_REPORT_FRAMES,
+                                     lodReportShadowTime / LOD_REPORT_FRAMES});
+            lodReportStep++;
+            lodReportFrame = 0;
+            lodReportTime = 0.0;
+            lodReportShadowTime = 0.0;
+            if (lodReportStep >= stepCount) return false;
+        }
+
+        vulkanRenderer.setLodEnabled(lodReportStep % 2 == 0);
+        cameraPosition = glm::vec3(0.0f, 3.0f, -LOD_REPORT_DISTANCES[lodReportStep / 2]);
+        return true;
+    }
+
+    void printLodReport() const {
+        // A mesh-ek LOD láncai (háromszögszám és felhalmozott hiba szintenként); a példányok a forrás mesh-ét osztják
+        std::cout << "LOD chains (triangles, error):" << std::endl;
+        for (size_t i = 0; i < sceneObjects.size(); i++) {
+            if (i > 0 && std::strcmp(sceneObjectNames[i], sceneObjectNames[i - 1]) == 0) continue;
+            std::cout << "  " << sceneObjectNames[i] << ":";
+            for (const MeshObject::LodLevel& lod : sceneObjects[i]->lods) {
+                std::cout << " " << lod.indexCount / 3 << " (" << lod.error << ")";
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "LOD report (camera distance, LOD, main triangles, shadow triangles, avg frame ms, avg shadow pass GPU ms):" << std::endl;
+        for (const LodReportRow& row : lodReportRows) {
+            std::cout << "  " << row.distance << "\t" << (row.lodEnabled ? "on " : "off") << "\t" << row.mainTriangles
+                      << "\t" << row.shadowTriangles << "\t" << row.frameMs << "\t" << row.shadowPassMs << std::endl;
+        }
     }
 
     void mainLoop() {
         auto lastTime = std::chrono::high_resolution_clock::now();
+        double shadowPassTotalMs = 0.0;
+        uint32_t shadowPassSamples = 0;
+        double mainPassTotalMs = 0.0;
+        uint32_t mainPassSamples = 0;
 
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents(); // Ablak események (pl. bezárás, gombnyomás)
@@ -365,12 +584,87 @@ private:
             // F: Le (Lift)
             if (keysPressed[GLFW_KEY_F]) cameraPosition.y -= velocity;
 
+            if (lodReport && !advanceLodReport(deltaTime * 1000.0f)) {
+                printLodReport();
+                break;
+            }
+
+            // A kijelölt objektum mozgatása: GPU-vezérelt módban a culling leírója, statikus objektumnál a statikus
+            // jelenet példány puffere és az árnyék gyorsítótár érintett része is frissül
+            if (pickedObjectLift != 0.0f && pickedObject < sceneObjects.size()) {
+                sceneObjects[pickedObject]->position.y += pickedObjectLift;
+                vulkanRenderer.invalidateStaticObject(pickedObject);
+            }
+            pickedObjectLift = 0.0f;
+
             // Renderelés indítása
-            std::vector<MeshObject*> objects = {&torus, &cube, &pyramid, &n, &floor};
-            vulkanRenderer.drawFrame(&vulkanSwapchain, &vulkanPipeline, cameraPosition, objects);
+            vulkanRenderer.drawFrame(&vulkanSwapchain, &vulkanPipeline, cameraPosition, sceneObjects);
+
+            if (pickRequested) {
+                uint32_t picked;
+                if (vulkanRenderer.pickObject(pickCursorNdc, picked) && picked < sceneObjectNames.size()) {
+                    std::cout << "Picked: " << sceneObjectNames[picked] << std::endl;
+                    pickedObject = picked;
+                } else {
+                    std::cout << "Picked: nothing" << std::endl;
+                    pickedObject = UINT32_MAX;
+                }
+                pickRequested = false;
+            }
+
+            float shadowPassMs = vulkanRenderer.getFrameStats().shadowPassMs;
+            if (shadowPassMs > 0.0f) {
+                shadowPassTotalMs += shadowPassMs;
+                shadowPassSamples++;
+            }
+            float mainPassMs = vulkanRenderer.getFrameStats().mainPassMs;
+            if (mainPassMs > 0.0f) {
+                mainPassTotalMs += mainPassMs;
+                mainPassSamples++;
+            }
         }
         // Kilépés előtt megvárjuk, amíg a GPU befejez mindent
         vkDeviceWaitIdle(vulkanContext.getDevice());
+
+        // Az árnyék pass csak a pozíció folyamot olvassa, a teljes vertex helyett
+        if (shadowPassSamples > 0) {
+            std::cout << "Shadow pass GPU time: " << shadowPassTotalMs / shadowPassSamples << " ms avg over "
+                      << shadowPassSamples << " frames (vertex fetch " << VertexLayout::getPositionStride(MESH_VERTEX_FORMAT)
+                      << " of " << VertexLayout::getStride(MESH_VERTEX_FORMAT) << " bytes/vertex)" << std::endl;
+        }
+
+        // Az azonos geometriájú objektumok instanced hívásokba vonódnak össze
+        const VulkanRenderer::FrameStats& stats = vulkanRenderer.getFrameStats();
+        std::cout << "Draw calls (last frame): main " << stats.mainDrawCalls << " for " << stats.mainVisibleObjects
+                  << " visible objects, shadow " << stats.shadowDrawCalls << " for " << stats.shadowVisibleObjects
+                  << " casters (" << stats.objectCount << " objects in scene"
+                  << (vulkanRenderer.isGpuDriven() ? ", GPU-driven" : "") << ")" << std::endl;
+        std::cout << "Command recording (last frame): " << stats.recordMs << " ms";
+        if (vulkanRenderer.isStaticReplay()) {
+            std::cout << ", " << stats.replayedDraws << " draws replayed from static secondary command buffers";
+        }
+        std::cout << std::endl;
+        if (vulkanRenderer.isShadowCacheEnabled()) {
+            std::cout << "Shadow cache (last frame): " << stats.shadowCacheTexels << " static depth texels re-rendered" << std::endl;
+        }
+        if (stats.atlasShadowLights > 0) {
+            std::cout << "Shadow atlas (last frame): " << stats.atlasShadowLights << " lights with tiles, "
+                      << stats.atlasRenderedTiles << " tiles re-rendered" << std::endl;
+        }
+        if (stats.pointShadowLights > 0) {
+            std::cout << "Point shadows (last frame): " << stats.pointShadowLights << " cube maps, "
+                      << stats.pointShadowCasters << " casters, " << stats.pointShadowFaces << " cube faces drawn (of "
+                      << 6 * stats.pointShadowCasters << ")" << std::endl;
+        }
+
+        // A rendezett sor és az állapot követés hatása (--unsorted: összehasonlítás rendezés nélkül)
+        std::cout << "Render queue (" << (vulkanRenderer.isDrawSortingEnabled() ? "sorted" : "unsorted") << "): "
+                  << stats.bindCalls << " bind calls, " << stats.redundantBinds << " redundant binds skipped, sort "
+                  << stats.sortMs << " ms (last frame)" << std::endl;
+        if (mainPassSamples > 0) {
+            std::cout << "Main pass GPU time: " << mainPassTotalMs / mainPassSamples << " ms avg over " << mainPassSamples
+                      << " frames" << std::endl;
+        }
     }
 
     void cleanup() {
@@ -382,11 +676,11 @@ private:
         rustTexture.cleanup();
         vkDestroyDescriptorPool(vulkanContext.getDevice(), descriptorPool, nullptr);
 
-        torus.cleanup(vulkanContext.getDevice());
-        cube.cleanup(vulkanContext.getDevice());
-        pyramid.cleanup(vulkanContext.getDevice());
-        n.cleanup(vulkanContext.getDevice());
-        floor.cleanup(vulkanContext.getDevice());
+        // A kocka példányok nem birtokolnak geometriát, a cleanup-juk nem szabadít fel semmit
+        for (MeshObject* object : sceneObjects) {
+            object->cleanup(vulkanContext.getDevice());
+        }
+        geometryPool.cleanup();
 
         vkDestroyImageView(vulkanContext.getDevice(), depthImageView, nullptr);
         vkDestroyImage(vulkanContext.getDevice(), depthImage, nullptr);
@@ -398,8 +692,311 @@ private:
     }
 };
 
-int main() {
+// Legjobb idő iterations futásból, ezredmásodpercben (a mikrobenchmarkok közös mérője)
+template <typename Func>
+static double measureBest(int iterations, Func&& func) {
+    double best = 1e30;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// --- MIKROBENCHMARK: TANGENS SZÁMÍTÁS ---
+// Indítás: foobar --bench-tangents
+// Egy nagy tórusz tangenseit számolja a skalár referenciával és a TangentKernel minden elérhető változatával,
+// majd kiírja az időket, a gyorsulást és a referenciától való legnagyobb eltérést.
+int runTangentBenchmark() {
+    const int ITERATIONS = 5;
+    std::vector<uint32_t> indices;
+    std::vector<float> vertices = ProceduralGeometry::toVertexArray(TorusGenerator{1.0f, 0.3f, 1024, 512}, indices);
+    std::cout << "Tangent benchmark: " << vertices.size() / 8 << " vertices, " << indices.size() / 3 << " triangles" << std::endl;
+
+    std::vector<glm::vec4> reference;
+    double referenceTime = measureBest(ITERATIONS, [&] { reference = calculateVertexTangents(vertices, 8, indices); });
+    std::cout << "  reference (scalar, 1 thread): " << referenceTime << " ms" << std::endl;
+
+    std::vector<TangentKernel::Isa> isas = { TangentKernel::Isa::Scalar };
+    if (TangentKernel::detectIsa() != TangentKernel::Isa::Scalar) isas.push_back(TangentKernel::Isa::SSE);
+    if (TangentKernel::detectIsa() == TangentKernel::Isa::AVX2) isas.push_back(TangentKernel::Isa::AVX2);
+
+    bool matches = true;
+    for (TangentKernel::Isa isa : isas) {
+        for (unsigned threads : { 1u, 0u }) {
+            std::vector<glm::vec4> result;
+            double time = measureBest(ITERATIONS, [&] {
+                result = TangentKernel::computeVertexTangents(vertices, 8, indices, isa, threads);
+            });
+
+            // Eltérés a referenciától: XYZ komponensenként, a kezességnek pontosan egyeznie kell
+            float maxError = 0.0f;
+            size_t handednessMismatches = 0;
+            for (size_t i = 0; i < reference.size(); i++) {
+                glm::vec3 diff = glm::abs(glm::vec3(result[i]) - glm::vec3(reference[i]));
+                maxError = std::max(maxError, std::max(diff.x, std::max(diff.y, diff.z)));
+                if (result[i].w != reference[i].w) handednessMismatches++;
+            }
+            if (maxError > TangentKernel::MATCH_EPSILON || handednessMismatches > 0) matches = false;
+
+            std::cout << "  " << TangentKernel::isaName(isa) << (threads == 1 ? ", 1 thread: " : ", all threads: ")
+                      << time << " ms (x" << referenceTime / time << "), max error " << maxError
+                      << ", handedness mismatches " << handednessMismatches << std::endl;
+        }
+    }
+
+    std::cout << (matches ? "Tangent kernel matches the reference." : "Tangent kernel DOES NOT match the reference!") << std::endl;
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- MIKROBENCHMARK: MODELL IMPORTÁLÁS ---
+// Indítás: foobar --bench-import [fájl]
+// A fájlt (alapértelmezés: egy generált, ~4 millió háromszöges OBJ tórusz) egy szálon és az összes szálon betölti,
+// kiírja az időket és a háromszög / másodperc értéket, és ellenőrzi, hogy a két eredmény azonos.
+const char* const IMPORT_BENCHMARK_FILE = "cache/bench_import.obj";
+
+void writeBenchmarkObj(const std::string& path) {
+    std::vector<uint32_t> indices;
+    std::vector<float> vertices = ProceduralGeometry::toVertexArray(TorusGenerator{1.0f, 0.3f, 2048, 1024}, indices);
+
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("failed to create benchmark file: " + path);
+    }
+
+    // Közös pozíció/UV/normál index minden csúcshoz (mint a legtöbb exportált modellnél)
+    std::string text;
+    char line[160];
+    for (size_t i = 0; i < vertices.size(); i += 8) {
+        const float* v = &vertices[i];
+        int length = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+                                   v[0], v[1], v[2], v[6], 1.0f - v[7], v[3], v[4], v[5]);
+        text.append(line, static_cast<size_t>(length));
+        if (text.size() > (1u << 20)) {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            text.clear();
+        }
+    }
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t a = indices[i] + 1, b = indices[i + 1] + 1, c = indices[i + 2] + 1;
+        int length = std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+        text.append(line, static_cast<size_t>(length));
+        if (text.size() > (1u << 20)) {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            text.clear();
+        }
+    }
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+int runImportBenchmark(std::string path) {
+    const int ITERATIONS = 3;
+    if (path.empty()) {
+        path = IMPORT_BENCHMARK_FILE;
+        if (!std::filesystem::exists(path)) {
+            std::cout << "Writing benchmark model: " << path << std::endl;
+            writeBenchmarkObj(path);
+        }
+    }
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+    ImportedMesh reference;
+    bool matches = true;
+    for (unsigned threads : { 1u, 0u }) {
+        // Legjobb idő ITERATIONS futásból (a fájl a lap cache-ben van, így a parzolást mérjük)
+        double best = 1e30;
+        ImportedMesh mesh;
+        for (int i = 0; i < ITERATIONS; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            mesh = MeshImporter::load(path, threads);
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        if (threads == 1) {
+            std::cout << "Import benchmark: " << path << " (" << megabytes << " MB), " << mesh.vertexCount() << " vertices, "
+                      << mesh.triangleCount() << " triangles" << (mesh.hasTangents() ? ", with tangents" : "") << std::endl;
+            reference = std::move(mesh);
+        } else if (mesh.vertices != reference.vertices || mesh.indices != reference.indices) {
+            matches = false;
+        }
+        std::cout << "  " << (threads == 1 ? "1 thread: " : "all threads: ") << best << " ms, "
+                  << reference.triangleCount() / best / 1000.0 << " M triangles/s, " << megabytes / best * 1000.0 << " MB/s"
+                  << std::endl;
+    }
+
+    std::cout << (matches ? "Multithreaded import matches the single threaded result." : "Multithreaded import DOES NOT match!") << std::endl;
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- MIKROBENCHMARK: FRUSTUM CULLING ---
+// Indítás: foobar --bench-culling [objektumszám]
+// Egy nagy, véletlenszerűen benépesített mezőn (alapértelmezés: 50 000 objektum) méri a világbeli határok
+// frissítését és a kamera frustum tesztet a skalár, SSE és AVX2 kernellel, és ellenőrzi, hogy az eredmények azonosak.
+int runCullingBenchmark(size_t objectCount) {
+    const int ITERATIONS = 20;
+
+    // Objektumok 1000 x 1000 egységes mezőn, véletlen forgástengellyel; a határok a három primitív egyike
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> field(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<MeshObject> meshes(objectCount);
+    std::vector<MeshObject*> objects;
+    objects.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; i++) {
+        MeshObject& mesh = meshes[i];
+        mesh.position = glm::vec3(field(random), unit(random) * 5.0f, field(random));
+        mesh.rotationAxis = glm::normalize(glm::vec3(unit(random), 1.0f, unit(random)));
+        mesh.rotationSpeed = unit(random) * 90.0f;
+        float size = 0.5f + (unit(random) + 1.0f);
+        mesh.boundsMin = glm::vec3(-size, 0.0f, -size * 0.5f);
+        mesh.boundsMax = glm::vec3(size, size * 2.0f, size * 0.5f);
+        glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+        mesh.boundingSphere = glm::vec4(center, glm::length(mesh.boundsMax - center));
+        objects.push_back(&mesh);
+    }
+
+    // Kamera a mező közepén, a fő pass-szal azonos vetítéssel (16:9)
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 3.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    proj[1][1] *= -1;
+    glm::mat4 viewProjection = proj * view;
+
+    FrustumCuller culler;
+    double updateTime = measureBest(ITERATIONS, [&] { culler.update(objects, 1.0f); });
+    std::cout << "Culling benchmark: " << objectCount << " objects" << std::endl;
+    std::cout << "  bounds update: " << updateTime << " ms" << std::endl;
+
+    std::vector<FrustumCuller::Isa> isas = { FrustumCuller::Isa::Scalar };
+    if (TangentKernel::detectIsa() != TangentKernel::Isa::Scalar) isas.push_back(FrustumCuller::Isa::SSE);
+    if (TangentKernel::detectIsa() == TangentKernel::Isa::AVX2) isas.push_back(FrustumCuller::Isa::AVX2);
+
+    std::vector<uint32_t> reference;
+    double referenceTime = 0.0;
+    bool matches = true;
+    for (FrustumCuller::Isa isa : isas) {
+        std::vector<uint32_t> visible;
+        double time = measureBest(ITERATIONS, [&] { culler.cull(viewProjection, objectCount, visible, isa); });
+        if (isa == FrustumCuller::Isa::Scalar) {
+            reference = visible;
+            referenceTime = time;
+        } else if (visible != reference) {
+            matches = false;
+        }
+        std::cout << "  " << TangentKernel::isaName(isa) << ": " << time << " ms (x" << referenceTime / time << "), "
+                  << visible.size() << " visible (" << 100.0 * visible.size() / std::max<size_t>(objectCount, 1) << "%)"
+                  << std::endl;
+    }
+
+    std::cout << (matches ? "SIMD culling matches the scalar result." : "SIMD culling DOES NOT match the scalar result!") << std::endl;
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --- MIKROBENCHMARK: JELENET BVH ---
+// Indítás: foobar --bench-bvh
+// 1k, 10k, 100k és 1M objektumos mezőn (állandó sűrűség, így a látható objektumok száma közel állandó) méri
+// az építést, a refitet, a frustum / gömb / sugár lekérdezést, és összeveti a frustum eredményt a lapos SIMD teszttel.
+int runBvhBenchmark() {
+    const int ITERATIONS = 20;
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 3.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    proj[1][1] *= -1;
+    glm::mat4 viewProjection = proj * view;
+
+    std::cout << "BVH benchmark (objects, nodes, build ms, refit ms, frustum: BVH ms / flat SIMD ms, visible, "
+              << "sphere ms, ray ms):" << std::endl;
+    bool matches = true;
+    for (size_t objectCount : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        // Objektumonként ~256 négyzetegység terület a mező méretétől függetlenül
+        float halfSize = 8.0f * std::sqrt(float(objectCount));
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> field(-halfSize, halfSize);
+        std::uniform_real_distribution<float> size(0.25f, 2.0f);
+
+        std::vector<SceneBvh::Aabb> bounds(objectCount);
+        FrustumCuller flat;
+        flat.resize(objectCount);
+        for (size_t i = 0; i < objectCount; i++) {
+            glm::vec3 center(field(random), size(random), field(random));
+            glm::vec3 extent(size(random), size(random), size(random));
+            bounds[i] = {center - extent, center + extent};
+            // A dobozt befoglaló gömb sosem szigorúbb a doboznál, így a két eredmény összevethető
+            flat.setBounds(i, center, extent, glm::vec4(center, glm::length(extent)));
+        }
+
+        SceneBvh bvh;
+        double buildTime = measureBest(ITERATIONS, [&] { bvh.build(bounds); });
+
+        // Forgó objektumok: a dobozok helyben kissé változnak, a topológia marad
+        std::vector<SceneBvh::Aabb> moved = bounds;
+        for (SceneBvh::Aabb& box : moved) box.max += glm::vec3(0.1f);
+        double refitTime = measureBest(ITERATIONS, [&] { bvh.refit(moved); });
+        bvh.refit(bounds);
+
+        std::vector<uint32_t> bvhVisible, flatVisible, sphereResult;
+        double bvhTime = measureBest(ITERATIONS, [&] { bvh.queryFrustum(viewProjection, bvhVisible); });
+        double flatTime = measureBest(ITERATIONS, [&] { flat.cull(viewProjection, objectCount, flatVisible); });
+        double sphereTime = measureBest(ITERATIONS, [&] { bvh.querySphere(glm::vec3(0.0f, 0.0f, 20.0f), 10.0f, sphereResult); });
+        uint32_t hitObject;
+        float hitDistance;
+        double rayTime = measureBest(ITERATIONS, [&] {
+            bvh.raycast(glm::vec3(0.0f, 1.0f, 0.0f), glm::normalize(glm::vec3(0.1f, 0.0f, 1.0f)), 1e6f, hitObject, hitDistance);
+        });
+        if (bvhVisible != flatVisible) matches = false;
+
+        std::cout << "  " << objectCount << "\t" << bvh.getNodeCount() << "\t" << buildTime << "\t" << refitTime << "\t"
+                  << bvhTime << " / " << flatTime << "\t" << bvhVisible.size() << "\t" << sphereTime << "\t" << rayTime
+                  << std::endl;
+    }
+
+    std::cout << (matches ? "BVH frustum query matches the flat test." : "BVH frustum query DOES NOT match the flat test!") << std::endl;
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench-tangents") == 0) {
+        return runTangentBenchmark();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-bvh") == 0) {
+        return runBvhBenchmark();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-culling") == 0) {
+        return runCullingBenchmark(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-import") == 0) {
+        try {
+            return runImportBenchmark(argc > 2 ? argv[2] : "");
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     HelloTriangleApplication app;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--lod-report") == 0) app.lodReport = true;
+        if (std::strcmp(argv[i], "--no-mesh-cache") == 0) app.useMeshCache = false;
+        if (std::strcmp(argv[i], "--import") == 0 && i + 1 < argc) app.importPath = argv[++i];
+        if (std::strcmp(argv[i], "--cubes") == 0 && i + 1 < argc) app.instancedCubeCount = std::strtoul(argv[++i], nullptr, 10);
+        if (std::strcmp(argv[i], "--gpu-driven") == 0) app.gpuDriven = true;
+        if (std::strcmp(argv[i], "--unsorted") == 0) app.unsortedDraws = true;
+        if (std::strcmp(argv[i], "--static-replay") == 0) app.staticReplay = true;
+        if (std::strcmp(argv[i], "--shadow-cache") == 0) app.shadowCache = app.staticReplay = true;
+        if (std::strcmp(argv[i], "--shadow-filter") == 0 && i + 1 < argc) {
+            unsigned long taps = std::strtoul(argv[++i], nullptr, 10);
+            app.shadowFilter = taps >= 16 ? VulkanRenderer::ShadowFilter::Poisson16
+                             : taps >= 4 ? VulkanRenderer::ShadowFilter::Poisson4
+                             : VulkanRenderer::ShadowFilter::Single;
+        }
+        if (std::strcmp(argv[i], "--cascades") == 0 && i + 1 < argc) app.shadowCascadeCount = std::strtoul(argv[++i], nullptr, 10);
+        if (std::strcmp(argv[i], "--spot-lights") == 0 && i + 1 < argc) app.spotLightCount = std::strtoul(argv[++i], nullptr, 10);
+        if (std::strcmp(argv[i], "--point-lights") == 0 && i + 1 < argc) app.pointLightCount = std::strtoul(argv[++i], nullptr, 10);
+        if (std::strcmp(argv[i], "--evsm") == 0) app.evsmShadows = true;
+    }
     try {
         app.run();
     } catch (const std::exception& e) {
@@ -0,0 +1,78 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+// --- PONTFÉNY KOCKA ÁRNYÉK (multiview) ---
+// A render pass a kocka mind a hat lapjába (rétegébe) egyszerre rajzol: a csúcsokat a GPU nézetenként egyszer
+// futtatja, a gl_ViewIndex a lap indexe (+X, -X, +Y, -Y, +Z, -Z). A CPU fényenként egyszer küldi az árnyékvetőket.
+
+// --- BEMENETEK (Input) ---
+// Mint az árnyék pass-ban: csak a pozíció folyam (binding 0).
+layout(location = 0) in vec4 inPosition; // Helyi koordináta (X, Y, Z)
+
+// --- PÉLDÁNY ADATOK (Set 0) ---
+// A pontfény pass saját példány puffere, a többi pass-éval azonos elrendezésben.
+layout(std430, set = 0, binding = 0) readonly buffer InstanceData {
+    mat4 models[];
+} instances;
+
+// --- LAP MASZKOK (Set 2) ---
+// Példányonként (a model mátrixszal azonos indexen) 6 bit: mely lapok gúlájába lóg bele az árnyékvető.
+layout(std430, set = 2, binding = 0) readonly buffer FaceMaskData {
+    uint masks[];
+} faceMasks;
+
+// --- FÉNYEK (Set 1, Binding 1) ---
+// VulkanRenderer::GpuLight (std430): a fény pozíciója és a kocka lapjainak közeli és távoli síkja
+struct Light {
+    vec4 position;
+    vec4 direction;
+    vec4 color;
+    mat4 shadowMatrix;
+    vec4 atlasRect;
+    uint shadowMode;
+    float shadowTexelScale;
+    float shadowNear;
+    float shadowFar;
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer LightData {
+    Light lights[];
+} lightData;
+
+// --- FÉNY (Push Constant) ---
+// A pontfény indexe a fénylistában
+layout(push_constant) uniform ShadowPush {
+    uint light;
+} push;
+
+// Lapok: a kocka mintavételezés irányai (Vulkan: kocka lap választás; s, t és a fő tengely), így a lap rétegébe
+// renderelt kép pontosan azt adja vissza, amit a samplerCube az adott irányban olvas
+const vec3 FACE_S[6] = vec3[](vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0), vec3(1.0, 0.0, 0.0),
+                              vec3(1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0));
+const vec3 FACE_T[6] = vec3[](vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0),
+                              vec3(0.0, 0.0, -1.0), vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0));
+const vec3 FACE_MAJOR[6] = vec3[](vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0),
+                                  vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0));
+
+void main() {
+    mat4 model = instances.models[gl_InstanceIndex];
+    uint faceMask = faceMasks.masks[gl_InstanceIndex];
+
+    // Lapok szerinti culling: a maszkon kívüli lapon minden csúcs ugyanarra a clip téren kívüli pontra kerül,
+    // így a háromszög raszterizálás nélkül kiesik
+    uint face = gl_ViewIndex;
+    if ((faceMask & (1u << face)) == 0u) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    // 90 fokos perspektív vetítés a lap fő tengelye mentén (Vulkan mélység: [0, 1]): w a fő tengely menti távolság,
+    // a mélység z / w = f / (f - n) - n * f / ((f - n) * w)
+    Light light = lightData.lights[push.light];
+    vec3 toVertex = (model * vec4(inPosition.xyz, 1.0)).xyz - light.position.xyz;
+    float nearPlane = light.shadowNear;
+    float farPlane = light.shadowFar;
+    float axisDistance = dot(toVertex, FACE_MAJOR[face]);
+    gl_Position = vec4(dot(toVertex, FACE_S[face]), dot(toVertex, FACE_T[face]),
+                       (axisDistance - nearPlane) * farPlane / (farPlane - nearPlane), axisDistance);
+}
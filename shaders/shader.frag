@@ -1,13 +1,18 @@
 #version 450
 
+// Kocka tömb nélküli eszközön (imageCubeArray) frag_no_cube_array.spv készül POINT_SHADOWS=0-val: ott nincs pontfény
+// árnyék, a 2. kötés csak helykitöltő
+#ifndef POINT_SHADOWS
+#define POINT_SHADOWS 1
+#endif
+
 // --- BEMENETEK (Vertex Shaderből) ---
 // A vertex shaderből érkező interpolált adatok.
 // A 'fragTangent' (location 4) elengedhetetlen a Normal Mappinghez.
 layout(location = 0) in vec3 fragPos;          // Pixel világbeli pozíciója
 layout(location = 1) in vec3 fragNormal;       // Geometriai normálvektor (interpolált)
 layout(location = 2) in vec2 fragTexCoord;     // UV koordináták
-layout(location = 3) in vec4 fragPosLightSpace; // A pixel pozíciója a fény szemszögéből (árnyékhoz)
-layout(location = 4) in vec3 fragTangent;      // Érintő vektor (Tangent) - A TBN mátrix alapja
+layout(location = 4) in vec4 fragTangent;      // Érintő vektor (Tangent) - A TBN mátrix alapja; W: kezesség
 
 // --- KIMENET ---
 layout(location = 0) out vec4 outColor;        // A pixel végső színe
@@ -18,15 +23,124 @@ layout(set = 0, binding = 0) uniform sampler2D diffuseSampler;
 layout(set = 0, binding = 1) uniform sampler2D roughnessSampler;
 layout(set = 0, binding = 2) uniform sampler2D normalSampler; // Normal map (RGB = XYZ vektorok)
 
-// Set 1: Árnyéktérkép (Külön set-ben, mert ez globális, nem anyagonként változik)
-layout(set = 1, binding = 0) uniform sampler2D shadowMap;
+// Set 1: Kaszkádolt árnyéktérkép, rétegenként egy kaszkád (Külön set-ben, mert ez globális, nem anyagonként változik).
+// Összehasonlító mintavételező: a minta a referencia mélység és a 2x2 szomszéd texel összehasonlításának szűrt
+// eredménye (1: megvilágított), így mintánként hardveres PCF.
+layout(set = 1, binding = 0) uniform sampler2DArrayShadow shadowMap;
+// Árnyék atlasz: a további árnyékvető spot- és irányfények csempéi egyetlen mélységképben, ugyanazzal a mintavételezővel
+layout(set = 1, binding = 1) uniform sampler2DShadow shadowAtlas;
+// Pontfények: kockánként 6 réteg egy kocka tömbben (a hat lap egy multiview pass-ban készül); a hardver a lapok határán
+// is folytonosan szűr
+#if POINT_SHADOWS
+layout(set = 1, binding = 2) uniform samplerCubeArrayShadow pointShadowMaps;
+#else
+layout(set = 1, binding = 2) uniform sampler2DArrayShadow pointShadowMaps;
+#endif
+// EVSM: a kaszkádok előszűrt momentumai (shadow_moments.comp) fél felbontáson, mip lánccal; trilineáris, anizotróp
+// mintavételező, összehasonlítás nélkül
+layout(set = 1, binding = 3) uniform sampler2DArray shadowMoments;
+
+// Set 3: Frame adatok (VulkanRenderer::FrameData, std140): a kamera pozíciója és a kaszkádok (Binding 0),
+// valamint a fénylista (VulkanRenderer::GpuLight, std430, Binding 1).
+// A fények adatok, így a számuk, típusuk, helyük és színük a shader újrafordítása nélkül változhat.
+const uint MAX_LIGHTS = 64u; // VulkanRenderer::MAX_LIGHTS
+const uint MAX_CASCADES = 4u; // ShadowCascades::MAX_CASCADES
+
+// VulkanRenderer::LightType
+const uint LIGHT_POINT = 0u;
+const uint LIGHT_SPOT = 1u;
+const uint LIGHT_DIRECTIONAL = 2u;
+
+struct Light {
+    vec4 position;         // xyz: pozíció, w: hatótávolság (0: nincs tompulás)
+    vec4 direction;        // xyz: irány (spot, irányfény), w: a spot kúp félszögének koszinusza
+    vec4 color;            // rgb: szín és intenzitás, w: típus
+    mat4 shadowMatrix;     // Atlasz árnyék: a csempe View * Projection mátrixa
+    vec4 atlasRect;        // A csempe az atlaszban uv-ben (xy: eltolás, zw: méret); kocka árnyék: x a kocka indexe
+    uint shadowMode;       // 0: nincs árnyék, 1: kaszkádok, 2: atlasz csempe, 3: kocka árnyéktérkép, 4: kaszkádok EVSM-mel
+    float shadowTexelScale; // Irányfény: egy texel világ egységben; spot, kocka: egy texel egységnyi távolságon
+    float shadowNear;      // Kocka árnyék: a lapok közeli és távoli síkja
+    float shadowFar;
+};
+
+layout(set = 3, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProjection;
+    mat4 cascadeMatrices[MAX_CASCADES]; // Kaszkádonként a fény View * Projection mátrixa (árnyéktérkép rétegei)
+    vec4 cascadeSplits;      // Kaszkádonként a szelet távoli határa (nézeti mélység)
+    vec4 cascadeTexelSizes;  // Kaszkádonként egy árnyék texel mérete világ egységben
+    vec4 cameraPosition;
+    uint lightCount;
+    uint cascadeCount;
+    uint shadowFilter;       // VulkanRenderer::ShadowFilter: 0: egy minta, 1: 4 Poisson minta, 2: 16 minta korai kilépéssel
+} frame;
+
+layout(std430, set = 3, binding = 1) readonly buffer LightData {
+    Light lights[];
+} lightData;
+
+// Poisson korong (egységsugarú): az első 4 pont a négy negyed szélén van, ezek a 16 mintás kernel korai kilépési
+// mintái; a 4 mintás kernel is ezeket használja
+const vec2 POISSON_DISK[16] = vec2[](
+    vec2(-0.81544232, -0.87912464), vec2(0.97484398, 0.75648379),
+    vec2(0.94558609, -0.76890725), vec2(-0.81409955, 0.91437590),
+    vec2(-0.94201624, -0.39906216), vec2(-0.09418410, -0.92938870),
+    vec2(0.34495938, 0.29387760), vec2(-0.91588581, 0.45771432),
+    vec2(-0.38277543, 0.27676845), vec2(0.44323325, -0.97511554),
+    vec2(0.53742981, -0.47373420), vec2(-0.26496911, -0.41893023),
+    vec2(0.79197514, 0.19090188), vec2(-0.24188840, 0.99706507),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
+
+// A kernel sugara texelben (a hardveres 2x2 szűrés ezen felül még egy texelnyit lágyít)
+const float SHADOW_FILTER_RADIUS = 1.5;
+
+// Pixelenként elforgatott kernel (interleaved gradient noise szög)
+mat2 kernelRotation() {
+    float angle = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    return mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+}
+
+// EVSM (shadow_moments.comp): a mélység torzításának exponensei, a minimális variancia a torzított mélység
+// meredekségével skálázva, és a fény átszivárgás (light bleeding) csökkentése: a Csebisev becslés alsó sávja levágva
+const float EVSM_POSITIVE_EXPONENT = 40.0;
+const float EVSM_NEGATIVE_EXPONENT = 5.0;
+const float EVSM_DEPTH_BIAS = 0.0005;
+const float EVSM_LIGHT_BLEEDING_REDUCTION = 0.3;
 
 /**
- * @brief Árnyékszámítás PCF (Percentage-Closer Filtering) technikával.
- * Lágyítja az árnyékok széleit és csökkenti a recésedést.
+ * @brief Kaszkád választás a nézeti mélység alapján: az első szelet, amelynek távoli határán belül van a pixel
+ * (a kaszkádok számán túl: az árnyék tartományon kívül).
  */
-float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
-    // 1. Perspektív osztás: [-w, w] tartományból [-1, 1]-be
+uint selectCascade(vec3 worldPos) {
+    float viewDepth = -(frame.view * vec4(worldPos, 1.0)).z;
+    uint cascadeCount = min(frame.cascadeCount, MAX_CASCADES);
+    uint cascade = 0;
+    while (cascade < cascadeCount && viewDepth > frame.cascadeSplits[cascade]) {
+        cascade++;
+    }
+    return cascade;
+}
+
+/**
+ * @brief Árnyékszámítás PCF (Percentage-Closer Filtering) technikával, kaszkádolt árnyéktérképből.
+ * Lágyítja az árnyékok széleit és csökkenti a recésedést. Minden minta egy hardveres összehasonlítás (2x2 texel),
+ * a kernel pontjai pixelenként elforgatva, így kevés mintával sincs sávosodás.
+ */
+float calculateShadow(vec3 worldPos, vec3 normal, vec3 lightDir) {
+    // 0. Kaszkád választás
+    uint cascade = selectCascade(worldPos);
+    if (cascade >= min(frame.cascadeCount, MAX_CASCADES)) {
+        return 0.0; // Az árnyék tartományon túl nincs árnyék
+    }
+
+    // Normál irányú eltolás a kaszkád texel méretével: a távoli (durvább) kaszkádoknál arányosan nagyobb
+    float cosTheta = clamp(dot(normal, lightDir), 0.0, 1.0);
+    vec3 offsetPos = worldPos + normal * frame.cascadeTexelSizes[cascade] * (1.0 + 1.5 * (1.0 - cosTheta));
+    vec4 fragPosLightSpace = frame.cascadeMatrices[cascade] * vec4(offsetPos, 1.0);
+
+    // 1. Perspektív osztás: [-w, w] tartományból [-1, 1]-be (ortografikus vetítésnél w = 1)
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 
     // 2. Transzformálás [0, 1] tartományba, hogy textúraként olvashassuk
@@ -41,34 +155,201 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
     // A felület dőlésszögétől függően állítjuk az eltolást.
     // Ha a fény laposan éri a felületet, nagyobb bias kell, merőlegesnél kisebb.
     float currentDepth = projCoords.z;
-    float bias = max(0.005 * (1.0 - dot(normal, lightDir)), 0.0005);
+    // A mélység tartomány kaszkádonként más, a texel szerinti eltolás nagyját a normál irányú eltolás adja.
+    float bias = max(0.002 * (1.0 - cosTheta), 0.0002);
 
     // --- PCF (Percentage-Closer Filtering) ---
-    // A pixel körüli 3x3-as területet mintavételezzük, és átlagoljuk az eredményt.
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0); // Egy texel mérete uv térben
-
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
-            // A szomszédos texel mélységi értéke a shadow map-ből
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-
-            // Összehasonlítás: Ha a mi mélységünk (current) nagyobb mint a tárolt (pcf), akkor árnyékban vagyunk.
-            // A bias-t levonjuk, hogy elkerüljük az önárnyékolási hibákat.
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-        }
+    // A referencia mélység a bias-szal csökkentve, hogy elkerüljük az önárnyékolási hibákat
+    vec4 coord = vec4(projCoords.xy, float(cascade), currentDepth - bias);
+    if (frame.shadowFilter == 0u) {
+        return 1.0 - texture(shadowMap, coord);
+    }
+
+    mat2 rotation = kernelRotation();
+    vec2 kernelScale = SHADOW_FILTER_RADIUS / vec2(textureSize(shadowMap, 0).xy); // A sugár uv térben
+
+    // A 4 szélső minta (mindkét kernel eleje)
+    float lit = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(shadowMap, vec4(coord.xy + offset, coord.zw));
+    }
+
+    // 16 mintás kernel: ha a szélső minták egyeznek (a kernel teljesen fényben vagy árnyékban van), a belső minták
+    // sem változtatnának; csak az árnyék szélén fut a többi 12
+    if (frame.shadowFilter == 1u || lit == 0.0 || lit == 4.0) {
+        return 1.0 - lit / 4.0;
+    }
+    for (int i = 4; i < 16; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(shadowMap, vec4(coord.xy + offset, coord.zw));
     }
-    shadow /= 9.0; // 9 minta átlaga (lágyítás)
+    float shadow = 1.0 - lit / 16.0;
 
     return shadow;
 }
 
+/**
+ * @brief Csebisev felső becslés a megvilágított hányadra egy momentum párból (átlag, négyzet átlag), az átszivárgás
+ * csökkentésével.
+ */
+float chebyshevUpperBound(vec2 moments, float depth, float minVariance) {
+    if (depth <= moments.x) {
+        return 1.0;
+    }
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float difference = depth - moments.x;
+    float pMax = variance / (variance + difference * difference);
+    return clamp((pMax - EVSM_LIGHT_BLEEDING_REDUCTION) / (1.0 - EVSM_LIGHT_BLEEDING_REDUCTION), 0.0, 1.0);
+}
+
+/**
+ * @brief Árnyékszámítás a kaszkádok EVSM momentumaiból: egyetlen trilineáris, anizotróp minta, a félárnyék szélességét
+ * az előszűrés (elmosás és mip lánc) adja. A gradiens a világbeli pozíció deriváltjaiból jön, mert a kaszkád választás
+ * pixelenként eltér (ott az implicit derivált nem értelmezett).
+ */
+float calculateMomentShadow(vec3 worldPos, vec3 normal, vec3 lightDir, vec3 worldPosDx, vec3 worldPosDy) {
+    uint cascade = selectCascade(worldPos);
+    if (cascade >= min(frame.cascadeCount, MAX_CASCADES)) {
+        return 0.0; // Az árnyék tartományon túl nincs árnyék
+    }
+
+    // Ugyanaz a normál irányú eltolás, mint a PCF-nél; külön bias nem kell, a minimális variancia tűri a kis eltérést
+    float cosTheta = clamp(dot(normal, lightDir), 0.0, 1.0);
+    vec3 offsetPos = worldPos + normal * frame.cascadeTexelSizes[cascade] * (1.0 + 1.5 * (1.0 - cosTheta));
+    mat4 lightMatrix = frame.cascadeMatrices[cascade];
+    vec3 projCoords = (lightMatrix * vec4(offsetPos, 1.0)).xyz; // Ortografikus vetítés (w = 1)
+    if (projCoords.z > 1.0) {
+        return 0.0;
+    }
+    vec2 uv = projCoords.xy * 0.5 + 0.5;
+    vec2 uvDx = (lightMatrix * vec4(worldPosDx, 0.0)).xy * 0.5;
+    vec2 uvDy = (lightMatrix * vec4(worldPosDy, 0.0)).xy * 0.5;
+    vec4 moments = textureGrad(shadowMoments, vec3(uv, float(cascade)), uvDx, uvDy);
+
+    // A referencia mélység ugyanúgy torzítva, mint a momentumok
+    float warped = 2.0 * projCoords.z - 1.0;
+    float positive = exp(EVSM_POSITIVE_EXPONENT * warped);
+    float negative = -exp(-EVSM_NEGATIVE_EXPONENT * warped);
+    float positiveMinVariance = EVSM_DEPTH_BIAS * EVSM_POSITIVE_EXPONENT * positive;
+    float negativeMinVariance = EVSM_DEPTH_BIAS * EVSM_NEGATIVE_EXPONENT * negative;
+    float lit = min(chebyshevUpperBound(moments.xy, positive, positiveMinVariance * positiveMinVariance),
+                    chebyshevUpperBound(moments.zw, negative, negativeMinVariance * negativeMinVariance));
+    return 1.0 - lit;
+}
+
+/**
+ * @brief Árnyékszámítás az árnyék atlasz csempéjéből (spot: perspektív, irányfény: ortografikus vetítés).
+ * Ugyanaz a szűrés, mint a kaszkádoknál; a minták a csempe határán belül maradnak, hogy ne olvassanak a szomszédba.
+ */
+float calculateAtlasShadow(Light light, vec3 worldPos, vec3 normal, vec3 lightDir) {
+    // Normál irányú eltolás egy csempe texel méretével: spotnál ez a fénytől mért távolsággal nő
+    bool perspective = uint(light.color.w + 0.5) == LIGHT_SPOT;
+    float texelSize = light.shadowTexelScale;
+    if (perspective) {
+        texelSize *= max(dot(worldPos - light.position.xyz, light.direction.xyz), 0.0);
+    }
+    float cosTheta = clamp(dot(normal, lightDir), 0.0, 1.0);
+    vec3 offsetPos = worldPos + normal * texelSize * (1.0 + 1.5 * (1.0 - cosTheta));
+    vec4 fragPosLightSpace = light.shadowMatrix * vec4(offsetPos, 1.0);
+    if (fragPosLightSpace.w <= 0.0) {
+        return 0.0; // A fény mögött
+    }
+
+    // Perspektív osztás, a csempén kívül (és a távoli síkon túl) nincs árnyék
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    if (projCoords.z > 1.0 || abs(projCoords.x) > 1.0 || abs(projCoords.y) > 1.0) {
+        return 0.0;
+    }
+
+    // Csempe uv -> atlasz uv; a kernel sugaránál (és a hardveres 2x2 szűrésnél) közelebb a csempe széléhez nem mintavételezünk
+    vec2 atlasTexel = 1.0 / vec2(textureSize(shadowAtlas, 0));
+    vec2 inset = (SHADOW_FILTER_RADIUS + 1.0) * atlasTexel;
+    vec2 tileMin = light.atlasRect.xy + inset;
+    vec2 tileMax = light.atlasRect.xy + light.atlasRect.zw - inset;
+    vec2 uv = clamp(light.atlasRect.xy + (projCoords.xy * 0.5 + 0.5) * light.atlasRect.zw, tileMin, tileMax);
+
+    // A perspektív mélység nemlineáris, ott a normál irányú eltolás végzi a munka nagyát
+    float bias = perspective ? 0.00005 : max(0.002 * (1.0 - cosTheta), 0.0002);
+    float reference = projCoords.z - bias;
+    if (frame.shadowFilter == 0u) {
+        return 1.0 - texture(shadowAtlas, vec3(uv, reference));
+    }
+
+    mat2 rotation = kernelRotation();
+    vec2 kernelScale = SHADOW_FILTER_RADIUS * atlasTexel;
+    float lit = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(shadowAtlas, vec3(clamp(uv + offset, tileMin, tileMax), reference));
+    }
+    if (frame.shadowFilter == 1u || lit == 0.0 || lit == 4.0) {
+        return 1.0 - lit / 4.0;
+    }
+    for (int i = 4; i < 16; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(shadowAtlas, vec3(clamp(uv + offset, tileMin, tileMax), reference));
+    }
+    return 1.0 - lit / 16.0;
+}
+
+/**
+ * @brief Árnyékszámítás a pontfény kocka árnyéktérképéből. A tárolt mélység a lap fő tengelye menti távolság
+ * perspektív mélysége, így a referencia is abból számolódik; a kernel a fény irányára merőleges síkban forog.
+ */
+float calculatePointShadow(Light light, vec3 worldPos, vec3 normal, vec3 lightDir) {
+#if !POINT_SHADOWS
+    return 0.0;
+#else
+    // Normál irányú eltolás egy texel méretével a fő tengely menti távolságban
+    vec3 toFragment = worldPos - light.position.xyz;
+    float axisDistance = max(abs(toFragment.x), max(abs(toFragment.y), abs(toFragment.z)));
+    float cosTheta = clamp(dot(normal, lightDir), 0.0, 1.0);
+    float texelSize = light.shadowTexelScale * axisDistance;
+    toFragment += normal * texelSize * (1.0 + 1.5 * (1.0 - cosTheta));
+    axisDistance = max(abs(toFragment.x), max(abs(toFragment.y), abs(toFragment.z)));
+    if (axisDistance >= light.shadowFar) {
+        return 0.0; // A hatókörön túl nincs árnyék
+    }
+
+    // A lap vetítésének mélysége (point_shadow.vert), a nemlineáris mélység miatt kis állandó bias-szal
+    float nearPlane = light.shadowNear;
+    float farPlane = light.shadowFar;
+    float depth = (axisDistance - nearPlane) * farPlane / ((farPlane - nearPlane) * axisDistance);
+    float reference = depth - 0.00005;
+    float cube = light.atlasRect.x;
+    if (frame.shadowFilter == 0u) {
+        return 1.0 - texture(pointShadowMaps, vec4(toFragment, cube), reference);
+    }
+
+    // A kernel a fény irányára merőleges síkban (a fő tengely menti távolsággal skálázva egy texel a lapon)
+    vec3 axis = normalize(toFragment);
+    vec3 tangent = normalize(cross(axis, abs(axis.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(axis, tangent);
+    mat2 rotation = kernelRotation();
+    float kernelScale = SHADOW_FILTER_RADIUS * light.shadowTexelScale * axisDistance;
+
+    float lit = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(pointShadowMaps, vec4(toFragment + tangent * offset.x + bitangent * offset.y, cube), reference);
+    }
+    if (frame.shadowFilter == 1u || lit == 0.0 || lit == 4.0) {
+        return 1.0 - lit / 4.0;
+    }
+    for (int i = 4; i < 16; i++) {
+        vec2 offset = rotation * POISSON_DISK[i] * kernelScale;
+        lit += texture(pointShadowMaps, vec4(toFragment + tangent * offset.x + bitangent * offset.y, cube), reference);
+    }
+    return 1.0 - lit / 16.0;
+#endif
+}
+
 /**
  * @brief Egyszerűsített PBR-szerű világítási modell (Blinn-Phong).
  * A roughness textúrát használja a fényesség (specular) szabályozására.
  */
-vec3 calcLight(vec3 lightPos, vec3 lightColor, vec3 normal, vec3 fragPos, vec3 viewDir, float roughness, bool useShadow, float shadowValue) {
-    vec3 lightDir = normalize(lightPos - fragPos);
+vec3 calcLight(vec3 lightDir, vec3 lightColor, vec3 normal, vec3 viewDir, float roughness, bool useShadow, float shadowValue) {
     vec3 halfwayDir = normalize(lightDir + viewDir); // Blinn-Phong felezővektor
 
     // Diffuse komponens (Lambert)
@@ -103,11 +384,11 @@ void main() {
     // Biztosítjuk, hogy a Tangens (T) és a Normál (N) vektorok merőlegesek legyenek egymásra.
     // Ez korrigálja az interpolációs hibákat a háromszög felületén.
     vec3 N = normalize(fragNormal);   // Interpolált geometriai normál
-    vec3 T = normalize(fragTangent);  // Interpolált tangens
+    vec3 T = normalize(fragTangent.xyz); // Interpolált tangens
     T = normalize(T - dot(T, N) * N); // T újraszámolása N-hez képest
 
-    // Bitangens kiszámítása (Jobbkéz-szabály: N x T)
-    vec3 B = cross(N, T);
+    // Bitangens kiszámítása (Jobbkéz-szabály: N x T, tükrözött UV-k esetén negálva)
+    vec3 B = cross(N, T) * (fragTangent.w < 0.0 ? -1.0 : 1.0);
 
     // TBN Mátrix: Tangent Space -> World Space transzformáció
     mat3 TBN = mat3(T, B, N);
@@ -116,31 +397,66 @@ void main() {
     vec3 finalNormal = normalize(TBN * normalMapValue);
 
     // --- FÉNYSZÁMÍTÁS ---
-    vec3 viewPos = vec3(0.0, 2.0, -8.0); // Ideiglenes: A C++ oldalról kéne jönnie (Uniform Buffer)
-    vec3 viewDir = normalize(viewPos - fragPos);
+    // A kamera pozíciója és a fények a frame uniform pufferből jönnek
+    vec3 viewDir = normalize(frame.cameraPosition.xyz - fragPos);
 
-    // 1. Fényforrás (Nap - Árnyékot vet)
-    vec3 lightPos1 = vec3(5.0, 5.0, 5.0);
-    vec3 lightColor1 = vec3(1.5, 1.2, 0.8); // Meleg napfény
-    vec3 lightDir1 = normalize(lightPos1 - fragPos);
+    // Az EVSM mintavétel gradiensei egységes vezérlési folyamban (a fény ciklus ágai előtt)
+    vec3 fragPosDx = dFdx(fragPos);
+    vec3 fragPosDy = dFdy(fragPos);
 
-    // FONTOS: Az árnyék bias számításhoz az EREDETI geometriai normált (N) használjuk,
-    // nem a normal map által módosítottat (finalNormal), különben műtermékek (artifact) jelennek meg.
-    float shadow = calculateShadow(fragPosLightSpace, N, lightDir1);
+    vec3 lighting = vec3(0.0);
+    for (uint i = 0; i < min(frame.lightCount, MAX_LIGHTS); i++) {
+        Light light = lightData.lights[i];
+        uint type = uint(light.color.w + 0.5);
 
-    // A megvilágításhoz viszont már a részletgazdag finalNormal-t használjuk!
-    vec3 lighting1 = calcLight(lightPos1, lightColor1, finalNormal, fragPos, viewDir, roughness, true, shadow);
+        // Fény irány és tompulás: irányfénynél állandó; pont- és spotfénynél a hatótávolság végén simán nullára fut,
+        // spotnál a kúp szélén is (a belső 15%-os sáv lágyít)
+        vec3 lightDir;
+        float attenuation = 1.0;
+        if (type == LIGHT_DIRECTIONAL) {
+            lightDir = -light.direction.xyz;
+        } else {
+            vec3 toLight = light.position.xyz - fragPos;
+            float lightDistance = length(toLight);
+            lightDir = toLight / max(lightDistance, 0.0001);
+            if (light.position.w > 0.0) {
+                float ratio = lightDistance / light.position.w;
+                float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+                attenuation = window * window;
+            }
+            if (type == LIGHT_SPOT) {
+                float cosOuter = light.direction.w;
+                attenuation *= smoothstep(cosOuter, mix(cosOuter, 1.0, 0.15), dot(-lightDir, light.direction.xyz));
+            }
+        }
+        if (attenuation <= 0.0) {
+            continue;
+        }
+
+        // FONTOS: Az árnyék bias számításhoz az EREDETI geometriai normált (N) használjuk,
+        // nem a normal map által módosítottat (finalNormal), különben műtermékek (artifact) jelennek meg.
+        // A kaszkádok fényénél (legfeljebb egy) a kaszkádokból, a többi árnyékvetőnél az atlasz csempéből vagy a kockából.
+        bool castsShadow = light.shadowMode != 0u;
+        float shadow = 0.0;
+        if (light.shadowMode == 1u) {
+            shadow = calculateShadow(fragPos, N, lightDir);
+        } else if (light.shadowMode == 2u) {
+            shadow = calculateAtlasShadow(light, fragPos, N, lightDir);
+        } else if (light.shadowMode == 3u) {
+            shadow = calculatePointShadow(light, fragPos, N, lightDir);
+        } else if (light.shadowMode == 4u) {
+            shadow = calculateMomentShadow(fragPos, N, lightDir, fragPosDx, fragPosDy);
+        }
 
-    // 2. Fényforrás (Kék töltőfény - Nincs árnyék)
-    vec3 lightPos2 = vec3(-5.0, 3.0, -5.0);
-    vec3 lightColor2 = vec3(0.2, 0.4, 1.0) * 1.5; // Hideg kék fény
-    vec3 lighting2 = calcLight(lightPos2, lightColor2, finalNormal, fragPos, viewDir, roughness, false, 0.0);
+        // A megvilágításhoz viszont már a részletgazdag finalNormal-t használjuk!
+        lighting += attenuation * calcLight(lightDir, light.color.rgb, finalNormal, viewDir, roughness, castsShadow, shadow);
+    }
 
     // Ambient (Szórt) fény: Minimális alap megvilágítás
     vec3 ambient = 0.05 * objectColor;
 
     // Végső színösszeállítás
-    vec3 result = ambient + (lighting1 + lighting2) * objectColor;
+    vec3 result = ambient + lighting * objectColor;
 
     outColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -1,91 +1,91 @@
 #version 450
 
+// --- VERTEX FORMÁTUM (Specialization Constant) ---
+// false: Full formátum (11 float/vertex), true: Compact formátum (20 byte/vertex, lásd VertexFormat.h).
+// Compact esetén a pozíció kvantált [-1, 1] tartományú (a visszaalakítás a model mátrixban van),
+// a normál és a tangens oktaéder kódolású, a pozíció W komponense pedig a tangens kezessége.
+layout(constant_id = 0) const bool COMPACT_VERTICES = false;
+
 // --- BEMENETEK (Vertex Attributes) ---
 // Ezek az adatok jönnek a CPU-ról a Vertex Bufferből (MeshObject.cpp).
-layout(location = 0) in vec3 inPosition; // Helyi koordináta (X, Y, Z)
-layout(location = 1) in vec3 inNormal;   // Normálvektor
+layout(location = 0) in vec4 inPosition; // Helyi koordináta (X, Y, Z); W: tangens kezesség (Full formátumnál 1.0)
+layout(location = 1) in vec3 inNormal;   // Normálvektor (Compact: oktaéder kód az XY-ban)
 layout(location = 2) in vec2 inTexCoord; // UV koordináta
 // ÚJ: Tangens vektor (Normal Mapping-hez szükséges TBN mátrix alapja)
-layout(location = 3) in vec3 inTangent;
+layout(location = 3) in vec3 inTangent;  // Compact: oktaéder kód az XY-ban
 
 // --- KIMENETEK (Varyings) ---
 // Ezeket az adatokat küldjük tovább a Fragment Shader-nek (interpolálva).
 layout(location = 0) out vec3 fragPos;         // Világbeli pozíció (fényekhez)
 layout(location = 1) out vec3 fragNormal;      // Transzformált normálvektor
 layout(location = 2) out vec2 fragTexCoord;    // UV koordináta
-layout(location = 3) out vec4 fragPosLightSpace; // Pozíció a fény szemszögéből (árnyékhoz)
-// ÚJ: Transzformált tangens vektor
-layout(location = 4) out vec3 fragTangent;
-
-// --- PUSH CONSTANTS ---
-// Gyors adatátvitel a CPU-ról (MeshObject::draw hívásban).
-// Max 128 byte, ami pont elég két 4x4-es mátrixnak.
-layout(push_constant) uniform PushConstants {
-    mat4 model; // Model -> World transzformáció
-    mat4 mvp;   // Model -> View -> Projection (végleges képernyő pozícióhoz)
-} push;
-
-// --- FÉNY MÁTRIX SZÁMÍTÁS (Shadow Map) ---
-// Ez a függvény kiszámolja a fény szemszögéből vett View-Projection mátrixot.
-// Megjegyzés: Általában ezt CPU-n számoljuk és Uniform Bufferben küldjük át,
-// de itt hardkódolva van a shaderben az egyszerűség/demonstráció kedvéért.
-mat4 getLightSpaceMatrix() {
-    vec3 lightPos = vec3(5.0, 5.0, 5.0); // Meg kell egyeznie a Fragment shaderrel!
+// ÚJ: Transzformált tangens vektor (W: kezesség a bitangens előjeléhez)
+// (Location 3 szabad: a fény-tér pozíciót a fragment shader számolja, mert a kaszkád fragmensenként dől el)
+layout(location = 4) out vec4 fragTangent;
 
-    // LookAt mátrix manuális felépítése (Fény a (0,0,0) felé néz)
-    vec3 f = normalize(vec3(0.0) - lightPos); // Előre (Forward)
-    vec3 s = normalize(cross(f, vec3(0.0, 1.0, 0.0))); // Jobbra (Side)
-    vec3 u = cross(s, f); // Fel (Up)
+// --- PÉLDÁNY ADATOK (Set 2) ---
+// A renderer frame-enként ide írja a látható objektumok model mátrixait (Model -> World transzformáció).
+// Az azonos geometriájú és textúrájú objektumok egy instanced rajzolásban mennek, a saját mátrixukat
+// a gl_InstanceIndex (firstInstance + példány sorszáma) választja ki.
+layout(std430, set = 2, binding = 0) readonly buffer InstanceData {
+    mat4 models[];
+} instances;
 
-    // Oszlop-folytonos (Column-major) View Mátrix
-    mat4 view = mat4(
-    vec4(s.x, u.x, -f.x, 0.0),
-    vec4(s.y, u.y, -f.y, 0.0),
-    vec4(s.z, u.z, -f.z, 0.0),
-    vec4(0.0, 0.0, 0.0, 1.0)
-    );
+// --- FRAME ADATOK (Set 3) ---
+// Frame-enkénti uniform puffer (VulkanRenderer::FrameData, std140), a CPU minden képkockában egyszer írja.
+// A rögzített (akár több képkockán át visszajátszott) parancsok csak a set-re hivatkoznak, így a kamera
+// a rögzítés után is mozoghat. A kaszkádok fény mátrixai is innen jönnek (a fragment shader használja őket).
+const uint MAX_CASCADES = 4u; // ShadowCascades::MAX_CASCADES
 
-    // Transzláció (eltolás) alkalmazása a View mátrixban
-    view[3][0] = -dot(s, lightPos);
-    view[3][1] = -dot(u, lightPos);
-    view[3][2] = dot(f, lightPos);
+layout(set = 3, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProjection;
+    mat4 cascadeMatrices[MAX_CASCADES]; // Kaszkádonként a fény View * Projection mátrixa (árnyéktérkép rétegei)
+    vec4 cascadeSplits;      // Kaszkádonként a szelet távoli határa (nézeti mélység)
+    vec4 cascadeTexelSizes;  // Kaszkádonként egy árnyék texel mérete világ egységben
+    vec4 cameraPosition;
+    uint lightCount;
+    uint cascadeCount;
+    uint shadowFilter;
+} frame;
 
-    // Ortografikus Projection Mátrix manuális felépítése
-    // Cél: [-10, 10] doboz leképezése [0, 1] mélységre (Vulkan standard)
-    mat4 proj = mat4(1.0);
-    proj[0][0] = 2.0 / 20.0; // 2 / (right - left) -> 2 / (10 - -10)
-    proj[1][1] = 2.0 / 20.0; // 2 / (top - bottom)
-    // Z-tengely: 1 / (near - far) -> 0..1 mapping Vulkanhoz (near=1.0, far=20.0)
-    proj[2][2] = 1.0 / (1.0 - 20.0);
-    proj[3][2] = 1.0 / (1.0 - 20.0) * 1.0; // near * proj[2][2]
-
-    return proj * view;
+// --- OKTAÉDER DEKÓDOLÁS ---
+// A CPU oldali VertexLayout::octEncode() inverze: a [-1, 1] négyzetet visszahajtjuk az egységgömbre.
+vec3 octDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
 }
 
 void main() {
+    // 0. Vertex attribútumok dekódolása a választott formátumból
+    vec3 position = inPosition.xyz;
+    vec3 normal = COMPACT_VERTICES ? octDecode(inNormal.xy) : inNormal;
+    vec3 tangent = COMPACT_VERTICES ? octDecode(inTangent.xy) : inTangent;
+    float handedness = inPosition.w < 0.0 ? -1.0 : 1.0;
+
     // 1. Világkoordináta kiszámítása
     // Szükséges a pontos fény- és árnyékszámításhoz a Fragment shaderben
-    vec4 worldPos = push.model * vec4(inPosition, 1.0);
+    mat4 model = instances.models[gl_InstanceIndex];
+    vec4 worldPos = model * vec4(position, 1.0);
     fragPos = worldPos.xyz;
 
     // 2. Normálvektor transzformálása
     // Csak a forgatást alkalmazzuk (mat3), az eltolást nem, mert a normálvektor csak irányt jelöl.
-    fragNormal = normalize(mat3(push.model) * inNormal);
+    fragNormal = normalize(mat3(model) * normal);
 
     // 3. Textúra koordináta továbbítása
     fragTexCoord = inTexCoord;
 
-    // 4. Árnyék koordináta kiszámítása
-    // A vertex pozícióját áttranszformáljuk a fényforrás koordináta-rendszerébe.
-    // Ebből tudjuk majd, hogy a shadow map melyik pixelét kell olvasni.
-    fragPosLightSpace = getLightSpaceMatrix() * worldPos;
-
-    // 5. ÚJ: Tangens vektor transzformálása
+    // 4. ÚJ: Tangens vektor transzformálása
     // Ugyanúgy forgatjuk, mint a normálvektort, hogy kövesse az objektum orientációját.
     // Ez kritikus a Normal Mapping helyes működéséhez forgó tárgyakon.
-    fragTangent = normalize(mat3(push.model) * inTangent);
+    fragTangent = vec4(normalize(mat3(model) * tangent), handedness);
 
-    // 6. Végső képernyő-pozíció (Clip Space)
+    // 5. Végső képernyő-pozíció (Clip Space)
     // A kamera szemszögéből transzformálva
-    gl_Position = push.mvp * vec4(inPosition, 1.0);
+    gl_Position = frame.viewProjection * worldPos;
 }
\ No newline at end of file
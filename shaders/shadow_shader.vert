@@ -2,19 +2,57 @@
 
 // --- BEMENETEK (Input) ---
 // Az árnyékoláshoz csak a geometria alakja (pozíciója) számít.
-// A színek, normálok és UV koordináták itt nem szükségesek.
-layout(location = 0) in vec3 inPosition; // Helyi koordináta (X, Y, Z)
-
-// --- PUSH CONSTANTS ---
-// Gyors adatátvitel a CPU-ról.
-// Ez a mátrix tartalmazza a teljes transzformációs láncot a fény szemszögéből:
-// lightMVP = LightProjection * LightView * Model
-layout(push_constant) uniform PushConstants {
-    mat4 lightMVP;
+// A színek, normálok és UV koordináták itt nem szükségesek, ezért a pipeline csak a pozíció folyamot (binding 0) köti be.
+// vec4: a Compact formátum (R16G16B16A16_SNORM) W komponense a tangens kezessége, itt nem használjuk.
+layout(location = 0) in vec4 inPosition; // Helyi koordináta (X, Y, Z)
+
+// --- PÉLDÁNY ADATOK (Set 0) ---
+// Ugyanaz a frame-enkénti model mátrix puffer, mint a fő pass-ban; a gl_InstanceIndex választ belőle.
+layout(std430, set = 0, binding = 0) readonly buffer InstanceData {
+    mat4 models[];
+} instances;
+
+// --- FRAME ADATOK (Set 1) ---
+// Ugyanaz a frame-enkénti uniform puffer, mint a fő pass-ban; itt csak a kaszkádok fény mátrixai kellenek
+// (LightProjection * LightView). A blokk eleje a teljes elrendezéssel egyezik (std140).
+// Az atlasz csempéinek mátrixai a fénylistából (Binding 1) jönnek.
+const uint MAX_CASCADES = 4u; // ShadowCascades::MAX_CASCADES
+
+layout(set = 1, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProjection;
+    mat4 cascadeMatrices[MAX_CASCADES];
+} frame;
+
+// VulkanRenderer::GpuLight (std430), a fő pass fragment shaderével közös lista
+struct Light {
+    vec4 position;
+    vec4 direction;
+    vec4 color;
+    mat4 shadowMatrix; // Az atlasz csempe View * Projection mátrixa
+    vec4 atlasRect;
+    uint shadowMode;
+    float shadowTexelScale;
+    float shadowNear;
+    float shadowFar;
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer LightData {
+    Light lights[];
+} lightData;
+
+// --- CÉL NÉZET (Push Constant) ---
+// A rögzített secondary buffer kaszkádja (az árnyéktérkép rétege), vagy MAX_CASCADES + a fény indexe az atlasz
+// csempéhez; rögzítéskor egyszer kerül be, így a statikus visszajátszásnál sem változik
+layout(push_constant) uniform ShadowPush {
+    uint target;
 } push;
 
 void main() {
-    // A csúcspont transzformálása a fény "Clip Space" terébe.
-    // A végeredmény Z komponense fogja reprezentálni a mélységet az árnyéktérképen.
-    gl_Position = push.lightMVP * vec4(inPosition, 1.0);
+    // A csúcspont transzformálása a kaszkád (vagy az atlasz fényének) "Clip Space" terébe.
+    // A végeredmény Z komponense fogja reprezentálni a mélységet az árnyéktérkép rétegén vagy a csempén.
+    mat4 lightMatrix = push.target < MAX_CASCADES ? frame.cascadeMatrices[push.target]
+                                                  : lightData.lights[push.target - MAX_CASCADES].shadowMatrix;
+    gl_Position = lightMatrix * instances.models[gl_InstanceIndex] * vec4(inPosition.xyz, 1.0);
 }
\ No newline at end of file